@@ -3,6 +3,10 @@
 // Andrei Gaponenko, 2012
 //
 // Modifed by Brian Pollack to use shared_ptrs to BFMaps for consistent use across classes.
+//
+// The lookup structures are immutable once setMaps() has been called.  The
+// per-caller state (which map was used for the previous point) lives in a
+// Cursor, so that any number of threads can query the same manager.
 
 #ifndef BFCacheManager_hh
 #define BFCacheManager_hh
@@ -54,69 +58,111 @@ namespace mu2e {
                 : myMap(my), inner(in) {}
         };
 
-        // Inner map lists optimized for the last used map
-        mutable const CacheElement* innerForLastInner;
-        mutable const CacheElement* innerForLastOuter;  // never null
-
-        // Outer maps in the user-specified order
-        MapList outer;
-
-        typedef std::map<std::shared_ptr<const BFMap>, CacheElement> CacheType;
-        CacheType innerCache;  // keys are all inner maps
-        CacheType outerCache;  // keys are outer maps and 0
-        int counter;
-
        public:
+        // Locality hint: remembers the maps used for the previous point so that
+        // the next lookup starts there.  A cursor is owned by its user and must
+        // not be shared between threads; it may be used with any manager, and is
+        // reset automatically when it is handed to a different one.
+        class Cursor {
+           public:
+            Cursor() = default;
+
+           private:
+            friend class BFCacheManager;
+            unsigned long owner_ = 0;  // id of the manager this cursor was last used with
+            // Inner map lists optimized for the last used map
+            const CacheElement* innerForLastInner_ = nullptr;
+            const CacheElement* innerForLastOuter_ = nullptr;  // never null once attached
+        };
+
         BFCacheManager();
 
+        // The cursors point into the cache structures, which are not relocatable.
+        BFCacheManager(BFCacheManager const&) = delete;
+        BFCacheManager& operator=(BFCacheManager const&) = delete;
+
         void setMaps(const MapContainerType& innerMaps, const MapContainerType& outerMaps);
 
-        // Returns pointers to an appropriate field map, or 0.
-        std::shared_ptr<const BFMap> findMap(const CLHEP::Hep3Vector& x) const {
+        // Returns pointers to an appropriate field map, or 0.  The lookup order is
+        // taken from, and the result recorded in, the caller's cursor.
+        std::shared_ptr<const BFMap> findMap(const CLHEP::Hep3Vector& x, Cursor& cursor) const {
+            if (cursor.owner_ != id_) {
+                attach(cursor);
+            }
+
             // First try to find if the point belong to any of the inner maps
 
-            if (innerForLastInner) {  // we were in an inner map last time
+            if (cursor.innerForLastInner_) {  // we were in an inner map last time
 
-                if (innerForLastInner->myMap->isValid(x)) {
+                if (cursor.innerForLastInner_->myMap->isValid(x)) {
                     // Cache update not needed, we are still in the same inner map
-                    return innerForLastInner->myMap;
+                    return cursor.innerForLastInner_->myMap;
                 }
 
                 // The lookup order here is optimized
-                std::shared_ptr<const BFMap> newinner = innerForLastInner->inner.findMap(x);
+                std::shared_ptr<const BFMap> newinner = cursor.innerForLastInner_->inner.findMap(x);
                 if (newinner) {  // Update cache
                     CacheType::const_iterator p = innerCache.find(newinner);
                     assert(p != innerCache.end());
-                    innerForLastInner = &p->second;
+                    cursor.innerForLastInner_ = &p->second;
                     return newinner;
                 }
             } else {  // We were not in an inner map last time
 
                 // innerForLastOuter is never null
-                std::shared_ptr<const BFMap> newinner = innerForLastOuter->inner.findMap(x);
+                std::shared_ptr<const BFMap> newinner = cursor.innerForLastOuter_->inner.findMap(x);
                 if (newinner) {  // Update cache
                     CacheType::const_iterator p = innerCache.find(newinner);
                     assert(p != innerCache.end());
-                    innerForLastInner = &p->second;
+                    cursor.innerForLastInner_ = &p->second;
                     return newinner;
                 }
             }
 
             // The current point is not in any of the inner maps
-            innerForLastInner = 0;
+            cursor.innerForLastInner_ = 0;
 
             // The lookup order of the outer maps is always the same
             std::shared_ptr<const BFMap> newouter = outer.findMap(x);
 
             // Keep the inner map lookup optimized
-            if (innerForLastOuter->myMap != newouter) {
+            if (cursor.innerForLastOuter_->myMap != newouter) {
                 CacheType::const_iterator p = outerCache.find(newouter);
                 assert(p != outerCache.end());
-                innerForLastOuter = &p->second;
+                cursor.innerForLastOuter_ = &p->second;
             }
 
             return newouter;
         }
+
+        // As above, using a cursor private to the calling thread.
+        std::shared_ptr<const BFMap> findMap(const CLHEP::Hep3Vector& x) const {
+            thread_local Cursor cursor;
+            return findMap(x, cursor);
+        }
+
+        // The inner map findMap last returned through this cursor, or 0 if that was an
+        // outer map or no map.  findMap returns this map again for any point it contains.
+        const BFMap* lastInnerMap(const Cursor& cursor) const {
+            return (cursor.owner_ == id_ && cursor.innerForLastInner_)
+                       ? cursor.innerForLastInner_->myMap.get()
+                       : nullptr;
+        }
+
+       private:
+        // Point a cursor at the start of this manager's lookup structures.
+        void attach(Cursor& cursor) const;
+
+        // Unique over the lifetime of the job, so that a stale cursor is never
+        // mistaken for one attached to this instance.
+        unsigned long id_;
+
+        // Outer maps in the user-specified order
+        MapList outer;
+
+        typedef std::map<std::shared_ptr<const BFMap>, CacheElement> CacheType;
+        CacheType innerCache;  // keys are all inner maps
+        CacheType outerCache;  // keys are outer maps and 0
     };
 }  // namespace mu2e
 
@@ -12,10 +12,13 @@
 //
 
 //#include <iosfwd>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 #include "Offline/BFieldGeom/inc/BFInterpolationStyle.hh"
 #include "Offline/BFieldGeom/inc/BFMap.hh"
+#include "Offline/BFieldGeom/inc/BFMapFile.hh"
 #include "Offline/BFieldGeom/inc/BFMapType.hh"
 #include "Offline/BFieldGeom/inc/Container3D.hh"
 #include "CLHEP/Vector/ThreeVector.h"
@@ -62,17 +65,41 @@ namespace mu2e {
               _dx(dx),
               _dy(dy),
               _dz(dz),
-              _field(_nx, _ny, _nz),
+              _field(),
+              _fieldData(nullptr),
               _isDefined(_nx, _ny, _nz, false),
               _allDefined(false),
               _interpStyle(style){};
 
+        // _fieldData may point into this object.
+        BFGridMap(BFGridMap const&) = delete;
+        BFGridMap& operator=(BFGridMap const&) = delete;
+
         bool getBFieldWithStatus(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const override;
 
+        void getBFieldsWithStatus(std::size_t n,
+                                  const CLHEP::Hep3Vector* points,
+                                  CLHEP::Hep3Vector* results,
+                                  bool* status) const override;
+
+        // The gradient is that of the trilinear interpolant, so it is constant along
+        // each axis within a grid cell.
+        bool getBFieldAndGradient(const CLHEP::Hep3Vector&,
+                                  CLHEP::Hep3Vector&,
+                                  Gradient&) const override;
+
+        // Replace the double-precision field values with float32 component arrays
+        // (structure of arrays), halving the memory and enabling the vectorized
+        // batch kernel.  The values can not be modified or written out afterwards.
+        void makeCompact();
+        bool isCompact() const { return _compact; }
+
         // Validity checker
         bool isValid(const CLHEP::Hep3Vector& point) const override;
+        // Checked against the grid dimensions, which hold for every storage of the
+        // values (owned, mapped or compact); _field is empty for the latter two.
         bool isValid(const GridPoint& ipoint) const {
-            return _field.isValid(ipoint.ix, ipoint.iy, ipoint.iz);
+            return ipoint.ix < _nx && ipoint.iy < _ny && ipoint.iz < _nz;
         }
 
         unsigned int nx() const { return _nx; }
@@ -97,6 +124,22 @@ namespace mu2e {
                                 CLHEP::Hep3Vector neighborPoints[3],
                                 CLHEP::Hep3Vector neighborBF[3][3][3]) const;
 
+        // Unscaled field value at a grid point, without safety features.
+        CLHEP::Hep3Vector field(unsigned ix, unsigned iy, unsigned iz) const {
+            const std::size_t index = (std::size_t(ix) * _ny + iy) * _nz + iz;
+            if (_compact) {
+                return CLHEP::Hep3Vector(_bxc[index], _byc[index], _bzc[index]);
+            }
+            return _fieldData[index];
+        }
+
+        bool isDefined(unsigned ix, unsigned iy, unsigned iz) const {
+            return _allDefined || _isDefined(ix, iy, iz);
+        }
+
+        // True if the field values are read in place from a memory-mapped file.
+        bool isMapped() const { return _mapFile != nullptr; }
+
         void print(std::ostream& os) const override;
 
        private:
@@ -106,8 +149,19 @@ namespace mu2e {
         // Distance between points.
         double _dx, _dy, _dz;
 
-        // Vector arrays for gridpoints and field values
+        // Vector arrays for gridpoints and field values.  The values are either
+        // owned (_field) or live in a read-only file mapping (_mapFile); _fieldData
+        // points to the first of them in both cases.
         mu2e::Container3D<CLHEP::Hep3Vector> _field;
+        std::shared_ptr<const BFMapFile> _mapFile;
+        const CLHEP::Hep3Vector* _fieldData;
+
+        // Compact storage: one float array per component, same ordering as _field.
+        // When _compact is set these are the only field values.
+        bool _compact = false;
+        std::vector<float> _bxc, _byc, _bzc;
+
+        // Bit packed.
         mu2e::Container3D<bool> _isDefined;
 
         // If all grid points are valid then _isDefined is not needed.
@@ -116,11 +170,23 @@ namespace mu2e {
         // Flag to flip Y component for maps that assume XZ-plane symmetry.
         bool _flipy = true;
 
+        // The field values have been multiplied by -1 (bfield.flipMaps).
+        bool _flipped = false;
+
         // method for interpolation between field grid points
         BFInterpolationStyle _interpStyle;
 
         // Functions used internally and by the code that populates the maps.
 
+        // Allocate owned, zeroed storage for the field values.
+        void allocateField();
+
+        // Read the field values in place from a mapped file; all points are defined.
+        void attachFile(std::shared_ptr<const BFMapFile> const& file);
+
+        // Copy mapped field values into owned storage, so that they can be modified.
+        void makeFieldWritable();
+
         // method to store the neighbors
         bool getNeighbors(int ix, int iy, int iz, CLHEP::Hep3Vector neighborsBF[3][3][3]) const;
 
@@ -138,7 +204,16 @@ namespace mu2e {
 
         std::size_t iZ(double z) const { return static_cast<std::size_t>(lround((z - _zmin) / _dz)); }
 
-        bool interpolateTriLinear(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const;
+        // Also fills the gradient of the interpolant if grad is not null.
+        bool interpolateTriLinear(const CLHEP::Hep3Vector&,
+                                  CLHEP::Hep3Vector&,
+                                  Gradient* grad = nullptr) const;
+
+        // Vectorized trilinear interpolation on the compact storage.
+        void interpolateTriLinearCompact(std::size_t n,
+                                         const CLHEP::Hep3Vector* points,
+                                         CLHEP::Hep3Vector* results,
+                                         bool* status) const;
 
     };
 
@@ -11,6 +11,8 @@
 // Rewritten again by Brian Pollack to become pure-virtual base class for all types of BFMaps
 //
 
+#include <array>
+#include <cstddef>
 #include <ostream>
 #include <string>
 #include "Offline/BFieldGeom/inc/BFInterpolationStyle.hh"
@@ -23,6 +25,9 @@ namespace mu2e {
        public:
         friend class BFieldManagerMaker;
 
+        // Field gradient: element i is dB/dx_i, in tesla/mm.
+        typedef std::array<CLHEP::Hep3Vector, 3> Gradient;
+
         BFMap(std::string const& filename,
               double xmin,
               double xmax,
@@ -53,6 +58,24 @@ namespace mu2e {
         // Accessors
         virtual bool getBFieldWithStatus(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const = 0;
 
+        // Field at n points; status[i] is what getBFieldWithStatus would return for points[i].
+        // Maps with a vectorized kernel override this.
+        virtual void getBFieldsWithStatus(std::size_t n,
+                                          const CLHEP::Hep3Vector* points,
+                                          CLHEP::Hep3Vector* results,
+                                          bool* status) const {
+            for (std::size_t i = 0; i < n; ++i) {
+                status[i] = getBFieldWithStatus(points[i], results[i]);
+            }
+        }
+
+        // Field and its gradient at one point, from a single evaluation of the map.
+        // The return value is what getBFieldWithStatus would return; outside the
+        // map both the field and the gradient are zero.
+        virtual bool getBFieldAndGradient(const CLHEP::Hep3Vector&,
+                                          CLHEP::Hep3Vector&,
+                                          Gradient&) const = 0;
+
         // Validity checker
         virtual bool isValid(const CLHEP::Hep3Vector& point) const = 0;
 
@@ -0,0 +1,77 @@
+#ifndef BFieldGeom_BFMapFile_hh
+#define BFieldGeom_BFMapFile_hh
+//
+// Read-only, memory-mapped view of a grid field map stored in the Mu2e
+// binary map format (file type .bfmap).  The field values are read in place:
+// nothing is parsed or copied at startup, pages are only loaded when they are
+// first used, and all processes on a node that map the same file share the
+// same physical pages.
+//
+// Layout, all numbers in the byte order of the machine that wrote the file:
+//   BFMapFileHeader, padded with zeros to dataOffset (a multiple of the page size)
+//   nx*ny*nz field values, each 3 doubles (bx,by,bz) in tesla, in the same
+//   order as Container3D: the z index varies fastest.
+// The header carries an endian tag and a format version; a file with the
+// wrong byte order or an unknown version is rejected, never reinterpreted.
+//
+// The grid is already in the Mu2e coordinate system (any G4BL offset has
+// been applied) and all grid points are defined.  The header records whether
+// the field was flipped, so that a flipped map is not flipped again when read.
+//
+
+#include <cstdint>
+#include <string>
+
+#include "CLHEP/Vector/ThreeVector.h"
+
+namespace mu2e {
+
+    struct BFMapFileHeader {
+        char magic[8];       // "MU2EBFLD"
+        uint32_t endianTag;  // endianTagValue, as written by the producer
+        uint32_t version;    // format version
+        uint32_t nx, ny, nz;
+        uint32_t flipy;      // map is defined for y>0 only, By flips sign for y<0
+        uint32_t flipped;    // field values were multiplied by -1 (bfield.flipMaps) before writing
+        double xmin, ymin, zmin;
+        double dx, dy, dz;
+        uint64_t dataOffset;  // start of the field values, bytes from the start of the file
+        uint64_t dataSize;    // size of the field values in bytes
+    };
+
+    class BFMapFile {
+       public:
+        static constexpr uint32_t endianTagValue = 0x01020304;
+        static constexpr uint32_t currentVersion = 2;
+
+        // Map the file and check that it is a valid field map; throws if not.
+        explicit BFMapFile(std::string const& filename);
+        ~BFMapFile();
+
+        BFMapFile(BFMapFile const&) = delete;
+        BFMapFile& operator=(BFMapFile const&) = delete;
+
+        std::string const& filename() const { return _filename; }
+        BFMapFileHeader const& header() const { return *static_cast<BFMapFileHeader const*>(_addr); }
+
+        // First of nx*ny*nz field values.
+        CLHEP::Hep3Vector const* field() const {
+            return reinterpret_cast<CLHEP::Hep3Vector const*>(static_cast<char const*>(_addr) +
+                                                              header().dataOffset);
+        }
+
+        // Write a map in this format.  The magic, endian tag, version and data
+        // offset/size fields of the header are filled in here.
+        static void write(std::string const& filename,
+                          BFMapFileHeader header,
+                          CLHEP::Hep3Vector const* field);
+
+       private:
+        std::string _filename;
+        void* _addr;
+        std::size_t _size;
+    };
+
+}  // end namespace mu2e
+
+#endif /* BFieldGeom_BFMapFile_hh */
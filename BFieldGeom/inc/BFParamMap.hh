@@ -42,6 +42,10 @@ namespace mu2e {
 
         bool getBFieldWithStatus(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const override;
 
+        bool getBFieldAndGradient(const CLHEP::Hep3Vector&,
+                                  CLHEP::Hep3Vector&,
+                                  Gradient&) const override;
+
         bool isValid(const CLHEP::Hep3Vector& point) const override;
 
         void print(std::ostream& os) const override;
@@ -55,14 +59,12 @@ namespace mu2e {
         vector<vector<double> > _Bs;
         vector<double> _Ds;
         vector<vector<double> > _kms;
-        mutable vector<vector<double> > _iv;
-        mutable vector<vector<double> > _ivp;
 
         // pre calculate additional constants needed for eval
         void calcConstants();
 
-        // evaluate the fit for a given point.
-        bool evalFit(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const;
+        // evaluate the fit for a given point, and its gradient if grad is not null.
+        bool evalFit(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&, Gradient* grad = nullptr) const;
     };  // namespace mu2e
 
 }  // end namespace mu2e
@@ -60,13 +60,24 @@ namespace mu2e {
         // to trigger the map-writing hack inside the BFieldManagerMaker code.
         bool writeBinaries() const { return writeBinaries_; }
 
+        // Also write the maps in the mappable binary format (.bfmap).
+        bool writeMappedMaps() const { return writeMappedMaps_; }
+
+        // Store grid maps as float32 component arrays (see BFGridMap::makeCompact).
+        bool compactMaps() const { return compactMaps_; }
+
         int verbosityLevel() const { return verbosityLevel_; }
 
         bool flipBFieldMaps() const { return flipBFieldMaps_; }
 
        private:
         BFieldConfig()
-            : scaleFactor_(1.), writeBinaries_(false), verbosityLevel_(1), flipBFieldMaps_(false) {}
+            : scaleFactor_(1.),
+              writeBinaries_(false),
+              writeMappedMaps_(false),
+              compactMaps_(false),
+              verbosityLevel_(1),
+              flipBFieldMaps_(false) {}
 
         // G4BL, PARAM or possible future types.
         BFMapType mapType_;
@@ -89,6 +100,8 @@ namespace mu2e {
         CLHEP::Hep3Vector dsGradientValue_;
 
         bool writeBinaries_;
+        bool writeMappedMaps_;
+        bool compactMaps_;
         int verbosityLevel_;
         bool flipBFieldMaps_;
     };
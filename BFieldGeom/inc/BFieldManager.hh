@@ -38,12 +38,40 @@ namespace mu2e {
         // Maps for various parts of the detector.
         typedef std::vector<std::shared_ptr<const BFMap>> MapContainerType;
 
-        // Get field at an arbitrary point.
+        // Caller-owned map-locality hint; one per thread (or per track, stepper, ...).
+        typedef BFCacheManager::Cursor Cursor;
+
+        // Get field at an arbitrary point.  The first form keeps its locality
+        // hint in thread-local storage, so both forms are safe to call concurrently.
         bool getBFieldWithStatus(const CLHEP::Hep3Vector&, CLHEP::Hep3Vector&) const;
         bool getBFieldWithStatus(const CLHEP::Hep3Vector&,
-                                 BFCacheManager const&,
+                                 Cursor&,
                                  CLHEP::Hep3Vector&) const;
 
+        // Field and its gradient (see BFMap::Gradient) from one evaluation of the
+        // map containing the point; both are zero outside all maps.
+        bool getBFieldAndGradient(const CLHEP::Hep3Vector&,
+                                  CLHEP::Hep3Vector&,
+                                  BFMap::Gradient&) const;
+        bool getBFieldAndGradient(const CLHEP::Hep3Vector&,
+                                  Cursor&,
+                                  CLHEP::Hep3Vector&,
+                                  BFMap::Gradient&) const;
+
+        // Field at n points, zero for points outside all maps; status[i] is what
+        // getBFieldWithStatus would return.  Consecutive points in the same map are
+        // evaluated with one call to that map's batch interface.  The map of the
+        // previous point is kept in the cursor, as for single points.
+        void getBFieldsWithStatus(std::size_t n,
+                                  const CLHEP::Hep3Vector* points,
+                                  CLHEP::Hep3Vector* results,
+                                  bool* status) const;
+        void getBFieldsWithStatus(std::size_t n,
+                                  const CLHEP::Hep3Vector* points,
+                                  Cursor&,
+                                  CLHEP::Hep3Vector* results,
+                                  bool* status) const;
+
         // Just return zero for out of range.
         CLHEP::Hep3Vector getBField(const CLHEP::Hep3Vector& pos) const {
             // Default c'tor sets all components to zero - which is what we need here.
@@ -53,10 +81,10 @@ namespace mu2e {
         }
 
         CLHEP::Hep3Vector getBField(const CLHEP::Hep3Vector& pos,
-                                    BFCacheManager const& cmgr) const {
+                                    Cursor& cursor) const {
             // Default c'tor sets all components to zero - which is what we need here.
             CLHEP::Hep3Vector result;
-            getBFieldWithStatus(pos, cmgr, result);
+            getBFieldWithStatus(pos, cursor, result);
             return result;
         }
 
@@ -71,7 +99,7 @@ namespace mu2e {
           return result;
         }
 
-        BFCacheManager cacheManager() const { return cm_; }
+        const BFCacheManager& cacheManager() const { return cm_; }
 
         const MapContainerType& getInnerMaps() const { return innerMaps_; }
         MapContainerType& getInnerMaps() { return innerMaps_; }
@@ -1,18 +1,20 @@
 // Andrei Gaponenko, 2012
 
+#include <atomic>
+
 #include "Offline/BFieldGeom/inc/BFCacheManager.hh"
 
 namespace mu2e {
 
+    namespace {
+        // 0 is reserved for cursors that were never attached.
+        std::atomic<unsigned long> nextCacheManagerId{1};
+    }
+
     BFCacheManager::BFCacheManager():
-    innerForLastInner(0),
-    innerForLastOuter(0),
-    counter(0)
+    id_(nextCacheManagerId++)
     {
         outerCache.insert( std::make_pair<std::shared_ptr<const BFMap>>(0, CacheElement(0, MapList())) );
-        CacheType::const_iterator p = outerCache.find(0);
-        assert(p != outerCache.end());
-        innerForLastOuter = &p->second;
     }
 
     void BFCacheManager::setMaps(const MapContainerType& innerMaps,
@@ -45,6 +47,16 @@ namespace mu2e {
         CacheType::iterator p = outerCache.find(0);
         assert(p != outerCache.end());
         p->second = CacheElement(0, defaultInnerList);
-        innerForLastOuter = &p->second;
+
+        // Cursors attached before now may hold the old lookup order
+        id_ = nextCacheManagerId++;
+    }
+
+    void BFCacheManager::attach(Cursor& cursor) const {
+        CacheType::const_iterator p = outerCache.find(0);
+        assert(p != outerCache.end());
+        cursor.owner_ = id_;
+        cursor.innerForLastInner_ = 0;
+        cursor.innerForLastOuter_ = &p->second;
     }
 }  // namespace mu2e
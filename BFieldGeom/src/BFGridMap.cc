@@ -10,6 +10,7 @@
 
 // C++ includes
 #include <iomanip>
+#include <algorithm>
 #include <iostream>
 
 // Framework includes
@@ -49,6 +50,58 @@ namespace mu2e {
         return true;
     }
 
+    void BFGridMap::allocateField() {
+        _mapFile.reset();
+        _field = Container3D<CLHEP::Hep3Vector>(_nx, _ny, _nz);
+        _fieldData = &_field.get(0, 0, 0);
+    }
+
+    void BFGridMap::attachFile(std::shared_ptr<const BFMapFile> const& file) {
+        BFMapFileHeader const& h = file->header();
+        if (h.nx != _nx || h.ny != _ny || h.nz != _nz) {
+            throw cet::exception("GEOM")
+                << "BFGridMap: grid of mapped file " << file->filename() << " (" << h.nx << ","
+                << h.ny << "," << h.nz << ") does not match the map " << _key << " (" << _nx
+                << "," << _ny << "," << _nz << ")\n";
+        }
+        _field.cleart();
+        _mapFile = file;
+        _fieldData = file->field();
+        _isDefined = Container3D<bool>();
+        _allDefined = true;
+    }
+
+    void BFGridMap::makeFieldWritable() {
+        if (_compact) {
+            throw cet::exception("GEOM")
+                << "BFGridMap: the field values of the compact map " << _key
+                << " can not be modified\n";
+        }
+        if (!_mapFile)
+            return;
+        std::shared_ptr<const BFMapFile> file(_mapFile);
+        allocateField();
+        std::copy(file->field(), file->field() + std::size_t(_nx) * _ny * _nz, &_field.get(0, 0, 0));
+    }
+
+    void BFGridMap::makeCompact() {
+        if (_compact)
+            return;
+        const std::size_t npoints = std::size_t(_nx) * _ny * _nz;
+        _bxc.resize(npoints);
+        _byc.resize(npoints);
+        _bzc.resize(npoints);
+        for (std::size_t i = 0; i < npoints; ++i) {
+            _bxc[i] = _fieldData[i].x();
+            _byc[i] = _fieldData[i].y();
+            _bzc[i] = _fieldData[i].z();
+        }
+        _compact = true;
+        _fieldData = nullptr;
+        _field.cleart();
+        _mapFile.reset();
+    }
+
     CLHEP::Hep3Vector BFGridMap::cellFraction(const CLHEP::Hep3Vector& pos,
                                               const GridPoint& ipos) const {
         const CLHEP::Hep3Vector gridpos(grid2point(ipos.ix, ipos.iy, ipos.iz));
@@ -68,9 +121,9 @@ namespace mu2e {
                 unsigned int yindex = iy + j - 1;
                 for (int k = 0; k != 3; ++k) {
                     unsigned int zindex = iz + k - 1;
-                    if (!_isDefined(xindex, yindex, zindex))
+                    if (!isDefined(xindex, yindex, zindex))
                         return false;
-                    neighborsBF[i][j][k] = _field(xindex, yindex, zindex);
+                    neighborsBF[i][j][k] = field(xindex, yindex, zindex);
                     /*
                               cout << "Neighbor(" << xindex << "," << yindex << "," << zindex
                               << ") = (" << neighborsBF(i,j,k).x() << ","
@@ -162,13 +215,142 @@ namespace mu2e {
         return retval;
     }
 
+    bool BFGridMap::getBFieldAndGradient(const CLHEP::Hep3Vector& testpoint,
+                                         CLHEP::Hep3Vector& result,
+                                         Gradient& grad) const {
+        if (_interpStyle != BFInterpolationStyle::trilinear) {
+            throw cet::exception("GEOM")
+                << "Unrecognized option for interpolation into the BField: " << _interpStyle
+                << "\n";
+        }
+        bool retval = interpolateTriLinear(testpoint, result, &grad);
+        result *= _scaleFactor;
+        for (auto& g : grad) {
+            g *= _scaleFactor;
+        }
+        return retval;
+    }
+
+    void BFGridMap::getBFieldsWithStatus(std::size_t n,
+                                         const CLHEP::Hep3Vector* points,
+                                         CLHEP::Hep3Vector* results,
+                                         bool* status) const {
+        if (_interpStyle != BFInterpolationStyle::trilinear) {
+            throw cet::exception("GEOM")
+                << "Unrecognized option for interpolation into the BField: " << _interpStyle
+                << "\n";
+        }
+        if (_compact && _nx > 1 && _ny > 1 && _nz > 1) {
+            interpolateTriLinearCompact(n, points, results, status);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                status[i] = interpolateTriLinear(points[i], results[i]);
+            }
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            results[i] *= _scaleFactor;
+        }
+    }
+
+    namespace {
+        // Points are processed in blocks: first the cell and weights of every point,
+        // then, one component at a time, the gather of the 8 corners and the blend.
+        // Each stage is a simple loop over the block with no branches, which the
+        // compiler turns into SIMD code.
+        constexpr std::size_t compactBlock = 64;
+
+        void blendCompact(const float* __restrict__ b,
+                          const std::size_t* __restrict__ base,
+                          const float* __restrict__ wx,
+                          const float* __restrict__ wy,
+                          const float* __restrict__ wz,
+                          std::size_t m,
+                          std::size_t sx,
+                          std::size_t sy,
+                          float* __restrict__ out) {
+            for (std::size_t ip = 0; ip < m; ++ip) {
+                const float* c = b + base[ip];
+                const float c00 = c[0] + wz[ip] * (c[1] - c[0]);
+                const float c01 = c[sy] + wz[ip] * (c[sy + 1] - c[sy]);
+                const float c10 = c[sx] + wz[ip] * (c[sx + 1] - c[sx]);
+                const float c11 = c[sx + sy] + wz[ip] * (c[sx + sy + 1] - c[sx + sy]);
+                const float c0 = c00 + wy[ip] * (c01 - c00);
+                const float c1 = c10 + wy[ip] * (c11 - c10);
+                out[ip] = c0 + wx[ip] * (c1 - c0);
+            }
+        }
+    }  // namespace
+
+    // Same algorithm as interpolateTriLinear, in single precision on the compact arrays.
+    // Requires at least 2 grid points in each dimension.
+    void BFGridMap::interpolateTriLinearCompact(std::size_t n,
+                                                const CLHEP::Hep3Vector* points,
+                                                CLHEP::Hep3Vector* results,
+                                                bool* status) const {
+        const std::size_t sx = std::size_t(_ny) * _nz;
+        const std::size_t sy = _nz;
+        const double xcells = _nx - 1;
+        const double ycells = _ny - 1;
+        const double zcells = _nz - 1;
+
+        std::size_t base[compactBlock];
+        float wx[compactBlock], wy[compactBlock], wz[compactBlock];
+        float bx[compactBlock], by[compactBlock], bz[compactBlock];
+
+        for (std::size_t first = 0; first < n; first += compactBlock) {
+            const std::size_t m = std::min(compactBlock, n - first);
+            const CLHEP::Hep3Vector* p = points + first;
+
+            // Cell indices and fractional position in the cell.  Points outside the
+            // map are clamped into it so the gathers stay in range; they are zeroed below.
+            for (std::size_t ip = 0; ip < m; ++ip) {
+                const double ux = (p[ip].x() - _xmin) / _dx;
+                const double uy = ((_flipy ? std::abs(p[ip].y()) : p[ip].y()) - _ymin) / _dy;
+                const double uz = (p[ip].z() - _zmin) / _dz;
+                const double ix = std::floor(ux);
+                const double iy = std::floor(uy);
+                const double iz = std::floor(uz);
+                // The same test as interpolateTriLinear: the cell index is inside the grid.
+                status[first + ip] = ix >= 0. && ix <= xcells && iy >= 0. && iy <= ycells &&
+                                     iz >= 0. && iz <= zcells;
+                const double cx = std::min(std::max(ix, 0.), xcells - 1.);
+                const double cy = std::min(std::max(iy, 0.), ycells - 1.);
+                const double cz = std::min(std::max(iz, 0.), zcells - 1.);
+                base[ip] = (std::size_t(cx) * _ny + std::size_t(cy)) * _nz + std::size_t(cz);
+                wx[ip] = ux - cx;
+                wy[ip] = uy - cy;
+                wz[ip] = uz - cz;
+            }
+
+            blendCompact(_bxc.data(), base, wx, wy, wz, m, sx, sy, bx);
+            blendCompact(_byc.data(), base, wx, wy, wz, m, sx, sy, by);
+            blendCompact(_bzc.data(), base, wx, wy, wz, m, sx, sy, bz);
+
+            for (std::size_t ip = 0; ip < m; ++ip) {
+                if (status[first + ip]) {
+                    // Need the signed value of p.y() here.
+                    const double sign = (_flipy && p[ip].y() < 0) ? -1. : 1.;
+                    results[first + ip] = CLHEP::Hep3Vector(bx[ip], sign * by[ip], bz[ip]);
+                } else {
+                    if (_warnIfOutside) {
+                        mf::LogWarning("GEOM")
+                            << "Point is outside of the valid region of the map: " << _key << "\n"
+                            << "Point in input coordinates: " << p[ip] << "\n";
+                    }
+                    results[first + ip] = CLHEP::Hep3Vector(0., 0., 0.);
+                }
+            }
+        }
+    }
+
     // The algorithm is:
     // Find the grid cube in which the point lives - this defines eight corner points.
     // Assign a weight to each corner that is the "distance" to each corner - see below for
     // its precise definition.  The field value at the test point is the weighted sum of
     // each of the 8 corner points.
     bool BFGridMap::interpolateTriLinear(const CLHEP::Hep3Vector& p,
-                                         CLHEP::Hep3Vector& result) const {
+                                         CLHEP::Hep3Vector& result,
+                                         Gradient* grad) const {
         double px = p.x();
         double py = p.y();
         if (_flipy)
@@ -188,9 +370,20 @@ namespace mu2e {
                     << "Point in input coordinates: " << p << "\n";
             }
             result = CLHEP::Hep3Vector(0., 0., 0.);
+            if (grad)
+                grad->fill(CLHEP::Hep3Vector(0., 0., 0.));
             return false;
         }
 
+        // A point on the upper face of the map belongs to the last cell; this also keeps
+        // the corner lookups below inside the field array.
+        if (i == int(_nx) - 1 && i > 0)
+            --i;
+        if (j == int(_ny) - 1 && j > 0)
+            --j;
+        if (k == int(_nz) - 1 && k > 0)
+            --k;
+
         // Trilinear fractional weighting factors.
         double fx = 1.0 - (px - _xmin - i * _dx) / _dx;
         double fy = 1.0 - (py - _ymin - j * _dy) / _dy;
@@ -199,10 +392,10 @@ namespace mu2e {
         // Field values at the 8 corner points.
         // Guess that a copy is faster than a pointer for reasons of locality
         // of reference in the downstream code?
-        CLHEP::Hep3Vector c[8] = {_field(i, j, k),         _field(i + 1, j, k),
-                                  _field(i, j + 1, k),     _field(i + 1, j + 1, k),
-                                  _field(i, j, k + 1),     _field(i + 1, j, k + 1),
-                                  _field(i, j + 1, k + 1), _field(i + 1, j + 1, k + 1)};
+        CLHEP::Hep3Vector c[8] = {field(i, j, k),         field(i + 1, j, k),
+                                  field(i, j + 1, k),     field(i + 1, j + 1, k),
+                                  field(i, j, k + 1),     field(i + 1, j, k + 1),
+                                  field(i, j + 1, k + 1), field(i + 1, j + 1, k + 1)};
 
         double bx = c[0].x() * fx * fy * fz + c[1].x() * (1.0 - fx) * fy * fz +
                     c[2].x() * fx * (1.0 - fy) * fz + c[3].x() * (1.0 - fx) * (1.0 - fy) * fz +
@@ -223,11 +416,34 @@ namespace mu2e {
                     c[7].z() * (1.0 - fx) * (1.0 - fy) * (1.0 - fz);
 
         // Need the signed value of p.y() here - the variable py will not do.
-        if (_flipy && p.y() < 0)
+        const bool reflect = _flipy && p.y() < 0;
+        if (reflect)
             by = -by;
 
         result = CLHEP::Hep3Vector(bx, by, bz);
 
+        if (grad) {
+            // Differentiate the weights above; corner n has offsets (n&1, (n>>1)&1, (n>>2)&1).
+            const double wx[2] = {fx, 1.0 - fx}, dwx[2] = {-1.0 / _dx, 1.0 / _dx};
+            const double wy[2] = {fy, 1.0 - fy}, dwy[2] = {-1.0 / _dy, 1.0 / _dy};
+            const double wz[2] = {fz, 1.0 - fz}, dwz[2] = {-1.0 / _dz, 1.0 / _dz};
+            CLHEP::Hep3Vector gx, gy, gz;
+            for (int n = 0; n < 8; ++n) {
+                const int a = n & 1, b = (n >> 1) & 1, d = (n >> 2) & 1;
+                gx += c[n] * (dwx[a] * wy[b] * wz[d]);
+                gy += c[n] * (wx[a] * dwy[b] * wz[d]);
+                gz += c[n] * (wx[a] * wy[b] * dwz[d]);
+            }
+            // For y < 0 the field is B(x,y,z) = R B(x,-y,z) with R = diag(1,-1,1),
+            // so dB/dy picks up an extra sign from the chain rule.
+            if (reflect) {
+                gx.setY(-gx.y());
+                gz.setY(-gz.y());
+                gy = CLHEP::Hep3Vector(-gy.x(), gy.y(), -gy.z());
+            }
+            *grad = {gx, gy, gz};
+        }
+
         return true;
     }
 
@@ -281,7 +497,7 @@ namespace mu2e {
 
         // check if the point had a field defined
 
-        if (!_isDefined(ix, iy, iz)) {
+        if (!isDefined(ix, iy, iz)) {
             if (_warnIfOutside) {
                 mf::LogWarning("GEOM")
                     << "Point's field is not defined in the map: " << _key << "\n"
@@ -299,7 +515,7 @@ namespace mu2e {
                 unsigned int yindex = iy + j - 1;
                 for (int k = 0; k != 3; ++k) {
                     unsigned int zindex = iz + k - 1;
-                    if (!_isDefined(xindex, yindex, zindex)) {
+                    if (!isDefined(xindex, yindex, zindex)) {
                         if (_warnIfOutside) {
                             mf::LogWarning("GEOM")
                                 << "Point's neighboring field is not defined in the map: " << _key
@@ -310,7 +526,7 @@ namespace mu2e {
                         }
                         return false;
                     }
-                    neighborBF[i][j][k] = _field(xindex, yindex, zindex);
+                    neighborBF[i][j][k] = field(xindex, yindex, zindex);
                     // Reassign y sign
                     if (_flipy && sign == -1) {
                         neighborBF[i][j][k].setY(-neighborBF[i][j][k].y());
@@ -340,11 +556,11 @@ namespace mu2e {
              << endl;
         cout << "Distance:       " << _dx << " " << _dy << " " << _dz << endl;
 
-        cout << "Field at the edges: " << _field(0, 0, 0) << ", " << _field(_nx - 1, 0, 0) << ", "
-             << _field(0, _ny - 1, 0) << ", " << _field(0, 0, _nz - 1) << ", "
-             << _field(_nx - 1, _ny - 1, 0) << ", " << _field(_nx - 1, _ny - 1, _nz - 1) << endl;
+        cout << "Field at the edges: " << field(0, 0, 0) << ", " << field(_nx - 1, 0, 0) << ", "
+             << field(0, _ny - 1, 0) << ", " << field(0, 0, _nz - 1) << ", "
+             << field(_nx - 1, _ny - 1, 0) << ", " << field(_nx - 1, _ny - 1, _nz - 1) << endl;
 
-        cout << "Field in the middle: " << _field(_nx / 2, _ny / 2, _nz / 2) << endl;
+        cout << "Field in the middle: " << field(_nx / 2, _ny / 2, _nz / 2) << endl;
 
         if (_warnIfOutside) {
             cout << "Will warn if outside of the valid region." << endl;
@@ -0,0 +1,173 @@
+//
+// Read-only, memory-mapped view of a grid field map in the Mu2e binary map format.
+//
+
+// C++ includes
+#include <cstring>
+#include <iostream>
+
+// Includes from C ( needed for block IO ).
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Framework includes
+#include "cetlib_except/exception.h"
+
+// Mu2e includes
+#include "Offline/BFieldGeom/inc/BFMapFile.hh"
+
+using namespace std;
+
+namespace mu2e {
+
+    namespace {
+        const char bfmapMagic[8] = {'M', 'U', '2', 'E', 'B', 'F', 'L', 'D'};
+
+        // The field values are read in place as Hep3Vectors.
+        static_assert(sizeof(CLHEP::Hep3Vector) == 3 * sizeof(double),
+                      "BFMapFile requires CLHEP::Hep3Vector to be laid out as 3 doubles");
+
+        // Round up to a multiple of the page size so that the values are page aligned.
+        uint64_t dataOffsetFor(uint64_t headerSize) {
+            const uint64_t page = sysconf(_SC_PAGESIZE);
+            return ((headerSize + page - 1) / page) * page;
+        }
+    }  // namespace
+
+    BFMapFile::BFMapFile(string const& filename) : _filename(filename), _addr(nullptr), _size(0) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            int errsave = errno;
+            throw cet::exception("GEOM") << "BFMapFile: Error opening " << filename
+                                         << "  errno: " << errsave << " " << strerror(errsave) << "\n";
+        }
+
+        struct stat info;
+        if (fstat(fd, &info)) {
+            int errsave = errno;
+            close(fd);
+            throw cet::exception("GEOM") << "BFMapFile: Error doing fstat() on " << filename
+                                         << "  errno: " << errsave << " " << strerror(errsave) << "\n";
+        }
+        _size = info.st_size;
+        if (_size < sizeof(BFMapFileHeader)) {
+            close(fd);
+            throw cet::exception("GEOM") << "BFMapFile: " << filename << " is too short ("
+                                         << _size << " bytes) to hold a field map header\n";
+        }
+
+        // Read-only and shared: the pages come straight from the page cache and are
+        // shared with every other process that maps the same file.
+        _addr = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        int errsave = errno;
+        close(fd);
+        if (_addr == MAP_FAILED) {
+            _addr = nullptr;
+            throw cet::exception("GEOM") << "BFMapFile: Error doing mmap() on " << filename
+                                         << "  errno: " << errsave << " " << strerror(errsave) << "\n";
+        }
+
+        BFMapFileHeader const& h = header();
+        string problem;
+        if (memcmp(h.magic, bfmapMagic, sizeof(bfmapMagic)) != 0) {
+            problem = "not a Mu2e binary field map";
+        } else if (h.endianTag != endianTagValue) {
+            problem = "endian mismatch; regenerate the file on this architecture or use the text format";
+        } else if (h.version != currentVersion) {
+            problem = "unsupported format version " + to_string(h.version) + ", expected " +
+                      to_string(currentVersion);
+        } else if (h.dataSize != uint64_t(h.nx) * h.ny * h.nz * sizeof(CLHEP::Hep3Vector) ||
+                   h.dataOffset < sizeof(BFMapFileHeader) || h.dataOffset + h.dataSize != _size) {
+            problem = "inconsistent sizes in the header";
+        }
+        if (!problem.empty()) {
+            munmap(_addr, _size);
+            _addr = nullptr;
+            throw cet::exception("GEOM") << "BFMapFile: " << filename << ": " << problem << "\n";
+        }
+    }
+
+    BFMapFile::~BFMapFile() {
+        if (_addr != nullptr) {
+            munmap(_addr, _size);
+        }
+    }
+
+    void BFMapFile::write(string const& filename,
+                          BFMapFileHeader header,
+                          CLHEP::Hep3Vector const* field) {
+        memcpy(header.magic, bfmapMagic, sizeof(bfmapMagic));
+        header.endianTag = endianTagValue;
+        header.version = currentVersion;
+        header.dataOffset = dataOffsetFor(sizeof(BFMapFileHeader));
+        header.dataSize = uint64_t(header.nx) * header.ny * header.nz * sizeof(CLHEP::Hep3Vector);
+
+        cout << "Writing magnetic field map in mappable binary format to file: " << filename
+             << endl;
+
+        // An existing map is never replaced.
+        if (access(filename.c_str(), F_OK) == 0) {
+            throw cet::exception("GEOM") << "BFMapFile::write Error opening " << filename
+                                         << "  File already exists.\n";
+        }
+
+        // Write to a name private to this process and link it to the final name
+        // once complete, so that a failed write never leaves a truncated map behind.
+        const string tmpname = filename + "." + to_string(getpid()) + ".tmp";
+        mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+        int flags = O_CREAT | O_WRONLY | O_TRUNC | O_EXCL;
+        int fd = open(tmpname.c_str(), flags, mode);
+        if (fd < 0) {
+            int errsave = errno;
+            throw cet::exception("GEOM") << "BFMapFile::write Error opening " << tmpname
+                                         << "  errno: " << errsave << " " << strerror(errsave) << "\n";
+        }
+
+        // Remove the temporary file and throw.
+        auto fail = [&](string const& what, int errsave) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            unlink(tmpname.c_str());
+            throw cet::exception("GEOM") << "BFMapFile::write Error " << what << " "
+                                         << filename << "  errno: " << errsave << " "
+                                         << strerror(errsave) << "\n";
+        };
+
+        // Header, zero padded up to the data offset.
+        string head(header.dataOffset, '\0');
+        memcpy(&head[0], &header, sizeof(header));
+
+        auto writeAll = [&](void const* buf, size_t nbytes, char const* what) {
+            char const* p = static_cast<char const*>(buf);
+            while (nbytes > 0) {
+                ssize_t s = ::write(fd, p, nbytes);
+                if (s < 0) {
+                    fail(string("writing ") + what + " to", errno);
+                }
+                p += s;
+                nbytes -= s;
+            }
+        };
+        writeAll(head.data(), head.size(), "header");
+        writeAll(field, header.dataSize, "field values");
+
+        int status = close(fd);
+        fd = -1;
+        if (status != 0) {
+            fail("closing", errno);
+        }
+        // link() does not replace a file that appeared in the meantime.
+        if (link(tmpname.c_str(), filename.c_str()) != 0) {
+            fail("creating", errno);
+        }
+        unlink(tmpname.c_str());
+
+        cout << "Writing complete for file: " << filename << endl;
+    }
+
+}  // end namespace mu2e
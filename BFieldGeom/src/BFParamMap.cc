@@ -57,7 +57,20 @@ namespace mu2e {
         return retval;
     }
 
-    bool BFParamMap::evalFit(const CLHEP::Hep3Vector& p, CLHEP::Hep3Vector& result) const {
+    bool BFParamMap::getBFieldAndGradient(const CLHEP::Hep3Vector& testpoint,
+                                          CLHEP::Hep3Vector& result,
+                                          Gradient& grad) const {
+        bool retval = evalFit(testpoint, result, &grad);
+        result *= _scaleFactor;
+        for (auto& g : grad) {
+            g *= _scaleFactor;
+        }
+        return retval;
+    }
+
+    bool BFParamMap::evalFit(const CLHEP::Hep3Vector& p,
+                             CLHEP::Hep3Vector& result,
+                             Gradient* grad) const {
         // Check validity.  Return a zero field and optionally print a warning.
         if (!isValid(p)) {
             if (_warnIfOutside) {
@@ -66,6 +79,8 @@ namespace mu2e {
                     << "Point in input coordinates: " << p << "\n";
             }
             result = CLHEP::Hep3Vector(0, 0, 0);
+            if (grad)
+                grad->fill(CLHEP::Hep3Vector(0, 0, 0));
             return false;
         }
 
@@ -76,21 +91,30 @@ namespace mu2e {
         double cos_nphi, cos_kmsz;
         double sin_nphi, sin_kmsz;
         double abp, abm;
-        vector<double> out(3, 0);
+        // Bessel function values for this point, indexed n*_ms+m.  The scratch space is
+        // per thread, so concurrent calls are safe, and is only allocated on the first
+        // call; the recursive calls for the gradient below come after its last use here.
+        static thread_local vector<double> scratch;
+        scratch.resize(2 * _ns * _ms);
+        double* const iv = scratch.data();
+        double* const ivp = iv + _ns * _ms;
         phi = atan2(p.y(), p.x() + 3896);
         r = sqrt(pow(p.x() + 3896, 2) + pow(p.y(), 2));
         double abs_r = abs(r);
+        // The cylindrical derivatives are singular on the axis; near it the gradient
+        // is taken from central differences instead.
+        const bool analytic = grad != nullptr && abs_r >= 1.0;
 
         for (int n = 0; n < _ns; ++n) {
             for (int m = 1; m <= _ms; ++m) {
                 tmp_rho = _kms[n][m - 1] * abs_r;
                 bessels[0] = gsl_sf_bessel_In(n, tmp_rho);
                 bessels[1] = gsl_sf_bessel_In(n + 1, tmp_rho);
-                _iv[n][m - 1] = bessels[0];
+                iv[n * _ms + m - 1] = bessels[0];
                 if (tmp_rho == 0) {
-                    _ivp[n][m - 1] = 0.5 * (gsl_sf_bessel_In(n - 1, 0) + bessels[1]);
+                    ivp[n * _ms + m - 1] = 0.5 * (gsl_sf_bessel_In(n - 1, 0) + bessels[1]);
                 } else {
-                    _ivp[n][m - 1] = (n / tmp_rho) * bessels[0] + bessels[1];
+                    ivp[n * _ms + m - 1] = (n / tmp_rho) * bessels[0] + bessels[1];
                 }
             }
         }
@@ -98,6 +122,10 @@ namespace mu2e {
         double br(0.0);
         double bphi(0.0);
         double bz(0.0);
+        // Derivatives of br, bphi and bz with respect to (r, phi, z).
+        double dbr[3] = {0.0, 0.0, 0.0};
+        double dbphi[3] = {0.0, 0.0, 0.0};
+        double dbz[3] = {0.0, 0.0, 0.0};
         // Here is the meat of the calculation:
         for (int n = 0; n < _ns; ++n) {
             cos_nphi = cos(n * phi + _Ds[n]);
@@ -107,10 +135,28 @@ namespace mu2e {
                 sin_kmsz = sin(_kms[n][m] * p.z());
                 abp = _As[n][m] * cos_kmsz + _Bs[n][m] * sin_kmsz;
                 abm = -_As[n][m] * sin_kmsz + _Bs[n][m] * cos_kmsz;
-                br += cos_nphi * _ivp[n][m] * _kms[n][m] * abp;
-                bz += cos_nphi * _iv[n][m] * _kms[n][m] * abm;
+                const double bi = iv[n * _ms + m];
+                const double bip = ivp[n * _ms + m];
+                br += cos_nphi * bip * _kms[n][m] * abp;
+                bz += cos_nphi * bi * _kms[n][m] * abm;
                 if (abs_r > 1e-10) {
-                    bphi += n * sin_nphi * (1 / abs_r) * _iv[n][m] * abp;
+                    bphi += n * sin_nphi * (1 / abs_r) * bi * abp;
+                }
+                if (analytic) {
+                    // d(abp)/dz = k abm, d(abm)/dz = -k abp, d(cos_nphi)/dphi = n sin_nphi,
+                    // and I'' from the modified Bessel equation.
+                    const double k = _kms[n][m];
+                    const double rho = k * abs_r;
+                    const double bipp = bi * (1.0 + n * n / (rho * rho)) - bip / rho;
+                    dbr[0] += cos_nphi * bipp * k * k * abp;
+                    dbr[1] += n * sin_nphi * bip * k * abp;
+                    dbr[2] += cos_nphi * bip * k * k * abm;
+                    dbz[0] += cos_nphi * bip * k * k * abm;
+                    dbz[1] += n * sin_nphi * bi * k * abm;
+                    dbz[2] -= cos_nphi * bi * k * k * abp;
+                    dbphi[0] += n * sin_nphi * abp * (k * bip - bi / abs_r) / abs_r;
+                    dbphi[1] -= n * n * cos_nphi * bi * abp / abs_r;
+                    dbphi[2] += n * sin_nphi * bi * k * abm / abs_r;
                 }
             }
         }
@@ -119,6 +165,33 @@ namespace mu2e {
         double sp = sin(phi);
         result = CLHEP::Hep3Vector(br * cp - bphi * sp, br * sp + bphi * cp, bz);
 
+        if (analytic) {
+            // Cartesian components, differentiated in (r, phi, z)...
+            const CLHEP::Hep3Vector dr(dbr[0] * cp - dbphi[0] * sp, dbr[0] * sp + dbphi[0] * cp,
+                                       dbz[0]);
+            const CLHEP::Hep3Vector dphi(dbr[1] * cp - br * sp - dbphi[1] * sp - bphi * cp,
+                                         dbr[1] * sp + br * cp + dbphi[1] * cp - bphi * sp,
+                                         dbz[1]);
+            const CLHEP::Hep3Vector dz(dbr[2] * cp - dbphi[2] * sp, dbr[2] * sp + dbphi[2] * cp,
+                                       dbz[2]);
+            // ...then in (x, y, z).
+            *grad = {dr * cp - dphi * (sp / abs_r), dr * sp + dphi * (cp / abs_r), dz};
+        } else if (grad) {
+            const double h = 0.5;
+            for (int i = 0; i < 3; ++i) {
+                const CLHEP::Hep3Vector dp(i == 0 ? h : 0., i == 1 ? h : 0., i == 2 ? h : 0.);
+                CLHEP::Hep3Vector bplus, bminus;
+                // One-sided at the edge of the map.
+                const bool okplus = evalFit(p + dp, bplus);
+                const bool okminus = evalFit(p - dp, bminus);
+                if (!okplus)
+                    bplus = result;
+                if (!okminus)
+                    bminus = result;
+                (*grad)[i] = (bplus - bminus) / ((okplus && okminus) ? 2. * h : h);
+            }
+        }
+
         return true;
     }
 
@@ -146,13 +219,6 @@ namespace mu2e {
                 _kms[n].push_back(m * M_PI / _Reff);
             }
         }
-
-        for (int n = 0; n < _ns; ++n) {
-            vector<double> tmp_v1(_ms, 0.0);
-            vector<double> tmp_v2(_ms, 0.0);
-            _iv.push_back(tmp_v1);
-            _ivp.push_back(tmp_v2);
-        }
     }
 
 }  // end namespace mu2e
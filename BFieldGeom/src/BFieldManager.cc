@@ -5,6 +5,7 @@
 // Modified by Brian Pollack to allow for polymorphic BField class.
 
 // Includes from C++
+#include <algorithm>
 #include <iostream>
 
 // Framework includes
@@ -21,16 +22,24 @@ namespace mu2e {
     // and looks up the field in that map.
     bool BFieldManager::getBFieldWithStatus(const CLHEP::Hep3Vector& point,
                                             CLHEP::Hep3Vector& result) const {
-        return getBFieldWithStatus(point, cm_, result);
+        auto m = cm_.findMap(point);
+
+        if (m) {
+            m->getBFieldWithStatus(point, result);
+        } else {
+            result = CLHEP::Hep3Vector(0., 0., 0.);
+        }
+
+        return (m != 0);
     }
 
 
     // Get field at an arbitrary point. This code figures out which map to use
     // and looks up the field in that map.
     bool BFieldManager::getBFieldWithStatus(const CLHEP::Hep3Vector& point,
-                                            BFCacheManager const& cmgr,
+                                            Cursor& cursor,
                                             CLHEP::Hep3Vector& result) const {
-        auto m = cmgr.findMap(point);
+        auto m = cm_.findMap(point, cursor);
 
         if (m) {
             m->getBFieldWithStatus(point, result);
@@ -42,6 +51,85 @@ namespace mu2e {
     }
 
 
+    bool BFieldManager::getBFieldAndGradient(const CLHEP::Hep3Vector& point,
+                                             CLHEP::Hep3Vector& result,
+                                             BFMap::Gradient& grad) const {
+        auto m = cm_.findMap(point);
+
+        if (m) {
+            m->getBFieldAndGradient(point, result, grad);
+        } else {
+            result = CLHEP::Hep3Vector(0., 0., 0.);
+            grad.fill(CLHEP::Hep3Vector(0., 0., 0.));
+        }
+
+        return (m != 0);
+    }
+
+
+    bool BFieldManager::getBFieldAndGradient(const CLHEP::Hep3Vector& point,
+                                             Cursor& cursor,
+                                             CLHEP::Hep3Vector& result,
+                                             BFMap::Gradient& grad) const {
+        auto m = cm_.findMap(point, cursor);
+
+        if (m) {
+            m->getBFieldAndGradient(point, result, grad);
+        } else {
+            result = CLHEP::Hep3Vector(0., 0., 0.);
+            grad.fill(CLHEP::Hep3Vector(0., 0., 0.));
+        }
+
+        return (m != 0);
+    }
+
+
+    void BFieldManager::getBFieldsWithStatus(std::size_t n,
+                                             const CLHEP::Hep3Vector* points,
+                                             CLHEP::Hep3Vector* results,
+                                             bool* status) const {
+        thread_local Cursor cursor;
+        getBFieldsWithStatus(n, points, cursor, results, status);
+    }
+
+
+    void BFieldManager::getBFieldsWithStatus(std::size_t n,
+                                             const CLHEP::Hep3Vector* points,
+                                             Cursor& cursor,
+                                             CLHEP::Hep3Vector* results,
+                                             bool* status) const {
+        std::size_t first = 0;
+        while (first < n) {
+            auto m = cm_.findMap(points[first], cursor);
+            // Extend the run while the points stay in the same map.  Inside the last
+            // inner map findMap would return that map again, so only its range is checked.
+            const BFMap* inner = cm_.lastInnerMap(cursor);
+            std::size_t last = first + 1;
+            if (inner) {
+                while (last < n && inner->isValid(points[last])) {
+                    ++last;
+                }
+            } else {
+                while (last < n && cm_.findMap(points[last], cursor) == m) {
+                    ++last;
+                }
+            }
+            if (m) {
+                m->getBFieldsWithStatus(last - first, points + first, results + first,
+                                        status + first);
+                // As for single points, the status only says whether a map was found.
+                std::fill(status + first, status + last, true);
+            } else {
+                for (std::size_t i = first; i < last; ++i) {
+                    results[i] = CLHEP::Hep3Vector(0., 0., 0.);
+                    status[i] = false;
+                }
+            }
+            first = last;
+        }
+    }
+
+
   BFieldManager::BFieldManager(MapContainerType const& innerMaps,
                                MapContainerType const& outerMaps):
     innerMaps_(innerMaps),outerMaps_(outerMaps) {
@@ -0,0 +1,133 @@
+//
+// Accuracy and speed of the compact (float32) BFGridMap storage against the
+// double-precision storage.
+//
+// Each map file named in the configuration is loaded twice, once as is and once
+// converted with BFGridMap::makeCompact.  Random points inside the map are then
+// evaluated with the double-precision path, the compact single-point path and
+// the compact batch kernel.  The largest deviation of each compact path from
+// the double-precision one is printed, together with the time per point; the
+// job fails if a deviation is larger than the tolerance.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Run.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Sequence.h"
+
+#include "Offline/BFieldGeom/inc/BFGridMap.hh"
+#include "Offline/ConfigTools/inc/ConfigFileLookupPolicy.hh"
+#include "Offline/GeometryService/inc/BFieldManagerMaker.hh"
+
+#include "CLHEP/Vector/ThreeVector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mu2e {
+
+  class BFieldCompactCheck : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Sequence<std::string> mapFiles{Name("mapFiles"), Comment("Grid map files to check (.txt, .header or .bfmap)")};
+        fhicl::Atom<unsigned> nPoints{Name("nPoints"), Comment("Number of random points per map"), 1000000};
+        fhicl::Atom<double> tolerance{Name("tolerance"), Comment("Largest allowed deviation of any field component (T)"), 1.e-5};
+        fhicl::Atom<unsigned> seed{Name("seed"), Comment("Seed for the point generator"), 12345};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit BFieldCompactCheck(const Parameters& conf) : art::EDAnalyzer(conf), conf_(conf()) {}
+
+      void beginRun(const art::Run& run) override;
+      void analyze(const art::Event&) override {};
+
+    private:
+      using Points = std::vector<CLHEP::Hep3Vector>;
+
+      void check(std::string const& filename) const;
+
+      Config conf_;
+  };
+
+  namespace {
+    double maxDeviation(std::vector<CLHEP::Hep3Vector> const& a, std::vector<CLHEP::Hep3Vector> const& b) {
+      double dmax(0.);
+      for(size_t i=0; i < a.size(); ++i){
+        dmax = std::max({dmax, std::abs(a[i].x()-b[i].x()), std::abs(a[i].y()-b[i].y()), std::abs(a[i].z()-b[i].z())});
+      }
+      return dmax;
+    }
+
+    template <typename F> double nsPerPoint(size_t npoints, F const& f) {
+      auto start = std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double,std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count()/npoints;
+    }
+  }
+
+  void BFieldCompactCheck::check(std::string const& filename) const {
+    ConfigFileLookupPolicy resolve;
+    std::string path = resolve(filename);
+    BFInterpolationStyle style(BFInterpolationStyle::trilinear);
+    auto ref = BFieldManagerMaker::makeGridMap("reference", path, 1.0, style);
+    auto compact = BFieldManagerMaker::makeGridMap("compact", path, 1.0, style);
+    compact->makeCompact();
+
+    // points inside the map, both signs of y so that the y reflection is exercised
+    std::mt19937 gen(conf_.seed());
+    std::uniform_real_distribution<double> ux(ref->xmin(),ref->xmax()), uy(ref->ymin(),ref->ymax()), uz(ref->zmin(),ref->zmax());
+    std::bernoulli_distribution flip(0.5);
+    Points points(conf_.nPoints());
+    for(auto& point : points){
+      double y = uy(gen);
+      point = CLHEP::Hep3Vector(ux(gen), flip(gen) ? -y : y, uz(gen));
+    }
+
+    Points bref(points.size()), bsingle(points.size()), bbatch(points.size());
+    std::unique_ptr<bool[]> status(new bool[points.size()]);
+    double tref = nsPerPoint(points.size(),[&](){
+        for(size_t i=0; i < points.size(); ++i)ref->getBFieldWithStatus(points[i],bref[i]); });
+    double tsingle = nsPerPoint(points.size(),[&](){
+        for(size_t i=0; i < points.size(); ++i)compact->getBFieldWithStatus(points[i],bsingle[i]); });
+    double tbatch = nsPerPoint(points.size(),[&](){
+        compact->getBFieldsWithStatus(points.size(),points.data(),bbatch.data(),status.get()); });
+
+    unsigned nbad = std::count(status.get(),status.get()+points.size(),false);
+    double dsingle = maxDeviation(bref,bsingle);
+    double dbatch = maxDeviation(bref,bbatch);
+    size_t npt = size_t(ref->nx())*ref->ny()*ref->nz();
+
+    std::cout << "BFieldCompactCheck: " << filename << "\n"
+      << "  grid " << ref->nx() << " x " << ref->ny() << " x " << ref->nz()
+      << ", field storage " << npt*3*sizeof(double)/1024 << " KiB double, "
+      << npt*3*sizeof(float)/1024 << " KiB compact\n"
+      << "  double single point  " << tref << " ns/point\n"
+      << "  compact single point " << tsingle << " ns/point, max deviation " << dsingle << " T\n"
+      << "  compact batch        " << tbatch << " ns/point, max deviation " << dbatch << " T\n"
+      << "  points reported outside the map by the batch kernel: " << nbad << std::endl;
+
+    if(dsingle > conf_.tolerance() || dbatch > conf_.tolerance() || nbad > 0){
+      throw cet::exception("BFIELDTEST") << "BFieldCompactCheck: compact map " << filename
+        << " differs from the double-precision map beyond tolerance " << conf_.tolerance() << " T\n";
+    }
+  }
+
+  void BFieldCompactCheck::beginRun(const art::Run& run) {
+    for(auto const& filename : conf_.mapFiles()){
+      check(filename);
+    }
+  }
+
+}  // namespace mu2e
+
+DEFINE_ART_MODULE(mu2e::BFieldCompactCheck)
@@ -0,0 +1,153 @@
+//
+// Stress test and throughput benchmark for concurrent BFieldManager lookups.
+//
+// A fixed set of points is generated along random straight-line walks through
+// a box (so that consecutive lookups mostly stay in one map, as they do when
+// stepping a track).  The points are then looked up
+//   1) on one thread, through the thread-local locality hint;
+//   2) on N threads, each through the thread-local locality hint;
+//   3) on N threads, each with its own caller-owned BFieldManager::Cursor;
+// and the throughput of each configuration is printed.  Every multithreaded
+// result is compared with the single-threaded one; any difference is an error.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Run.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Sequence.h"
+
+#include "Offline/BFieldGeom/inc/BFieldManager.hh"
+#include "Offline/GeometryService/inc/GeomHandle.hh"
+
+#include "CLHEP/Vector/ThreeVector.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace mu2e {
+
+  class BFieldThreadBench : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<unsigned> nWalks{Name("nWalks"), Comment("Number of straight-line walks"), 1000};
+        fhicl::Atom<unsigned> nSteps{Name("nSteps"), Comment("Number of points per walk"), 1000};
+        fhicl::Atom<double> stepSize{Name("stepSize"), Comment("Distance between points on a walk (mm)"), 10.};
+        fhicl::Sequence<double> boxMin{Name("boxMin"), Comment("Lower corner of the start box, Mu2e frame (mm)")};
+        fhicl::Sequence<double> boxMax{Name("boxMax"), Comment("Upper corner of the start box, Mu2e frame (mm)")};
+        fhicl::Sequence<unsigned> nThreads{Name("nThreads"), Comment("Thread counts to benchmark"), std::vector<unsigned>{1,2,4,8,16}};
+        fhicl::Atom<unsigned> seed{Name("seed"), Comment("Seed for the point generator"), 12345};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit BFieldThreadBench(const Parameters& conf);
+
+      void beginRun(const art::Run& run) override;
+      void analyze(const art::Event&) override {};
+
+    private:
+      using Points = std::vector<CLHEP::Hep3Vector>;
+
+      void makePoints(Points& points) const;
+      // Returns the wall time in seconds.
+      double runThreads(BFieldManager const& bfmgr, Points const& points, unsigned nthreads,
+          bool ownCursor, std::vector<Points>& results) const;
+
+      Config conf_;
+  };
+
+  BFieldThreadBench::BFieldThreadBench(const Parameters& conf) :
+    art::EDAnalyzer(conf),
+    conf_(conf()) {
+      if(conf_.boxMin().size() != 3 || conf_.boxMax().size() != 3){
+        throw cet::exception("BFIELDTEST") << "BFieldThreadBench: boxMin and boxMax must have 3 elements\n";
+      }
+    }
+
+  void BFieldThreadBench::makePoints(Points& points) const {
+    std::mt19937 gen(conf_.seed());
+    auto const& bmin = conf_.boxMin();
+    auto const& bmax = conf_.boxMax();
+    std::uniform_real_distribution<double> ux(bmin[0],bmax[0]), uy(bmin[1],bmax[1]), uz(bmin[2],bmax[2]);
+    std::uniform_real_distribution<double> ucos(-1.,1.), uphi(0.,2*M_PI);
+    points.clear();
+    points.reserve(conf_.nWalks()*conf_.nSteps());
+    for(unsigned iwalk=0; iwalk < conf_.nWalks(); ++iwalk){
+      CLHEP::Hep3Vector pos(ux(gen),uy(gen),uz(gen));
+      double cost = ucos(gen);
+      double phi = uphi(gen);
+      double sint = sqrt(1.-cost*cost);
+      CLHEP::Hep3Vector step(conf_.stepSize()*sint*cos(phi),conf_.stepSize()*sint*sin(phi),conf_.stepSize()*cost);
+      for(unsigned istep=0; istep < conf_.nSteps(); ++istep){
+        points.push_back(pos);
+        pos += step;
+      }
+    }
+  }
+
+  double BFieldThreadBench::runThreads(BFieldManager const& bfmgr, Points const& points, unsigned nthreads,
+      bool ownCursor, std::vector<Points>& results) const {
+    results.assign(nthreads,Points(points.size()));
+    auto work = [&](unsigned ithread){
+      Points& res = results[ithread];
+      BFieldManager::Cursor cursor;
+      for(size_t ipt=0; ipt < points.size(); ++ipt){
+        res[ipt] = ownCursor ? bfmgr.getBField(points[ipt],cursor) : bfmgr.getBField(points[ipt]);
+      }
+    };
+    auto start = std::chrono::steady_clock::now();
+    if(nthreads == 1){
+      work(0);
+    } else {
+      std::vector<std::thread> threads;
+      for(unsigned ithread=0; ithread < nthreads; ++ithread)threads.emplace_back(work,ithread);
+      for(auto& thread : threads)thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  void BFieldThreadBench::beginRun(const art::Run& run) {
+    GeomHandle<BFieldManager> bfmgr;
+
+    Points points;
+    makePoints(points);
+
+    // reference: the single-threaded path
+    std::vector<Points> reference;
+    double tref = runThreads(*bfmgr,points,1,false,reference);
+    double rref = points.size()/tref;
+    std::cout << "BFieldThreadBench: " << points.size() << " lookups per thread" << std::endl;
+    std::cout << "BFieldThreadBench: single thread " << rref*1e-6 << " Mlookups/s" << std::endl;
+
+    for(bool ownCursor : {false, true}){
+      for(unsigned nthreads : conf_.nThreads()){
+        std::vector<Points> results;
+        double t = runThreads(*bfmgr,points,nthreads,ownCursor,results);
+        unsigned nbad(0);
+        for(auto const& res : results){
+          for(size_t ipt=0; ipt < points.size(); ++ipt){
+            if(res[ipt] != reference[0][ipt])++nbad;
+          }
+        }
+        double rate = nthreads*points.size()/t;
+        std::cout << "BFieldThreadBench: " << (ownCursor ? "caller cursor " : "thread local  ")
+          << nthreads << " threads " << rate*1e-6 << " Mlookups/s, speedup " << rate/rref
+          << ", mismatches " << nbad << std::endl;
+        if(nbad > 0){
+          throw cet::exception("BFIELDTEST") << "BFieldThreadBench: " << nbad
+            << " field values differ from the single-threaded result\n";
+        }
+      }
+    }
+  }
+
+}  // namespace mu2e
+
+DEFINE_ART_MODULE(mu2e::BFieldThreadBench)
@@ -201,6 +201,13 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
     int       _findTrackLoopIndex;
 //-----------------------------------------------------------------------------
+// workspace reused for each time cluster: the best helix of the triplet search
+// and the saved hit usage restored by the phi-z and xy fits when they fail
+//-----------------------------------------------------------------------------
+    CalHelixFinderData                                _bestTriplet;
+    std::array<int,CalHelixFinderData::kNMaxChHits>   _phiZHitsUsed;
+    std::array<int,CalHelixFinderData::kNMaxChHits>   _xyHitsUsed;
+//-----------------------------------------------------------------------------
 // functions
 //-----------------------------------------------------------------------------
   public:
@@ -292,7 +299,7 @@ namespace mu2e {
 
 
     //performs the search of the best triplet
-    void  searchBestTriplet   (CalHelixFinderData& Helix, CalHelixFinderData& TmpHelix, int UseMPVdfdz=0);
+    void  searchBestTriplet   (CalHelixFinderData& Helix, CalHelixFinderData& Best, int UseMPVdfdz=0);
 
     void  defineHelixParams   (CalHelixFinderData& Helix) const;
 
@@ -12,6 +12,7 @@
 #include "Offline/RecoDataProducts/inc/StrawHit.hh"
 #include "Offline/RecoDataProducts/inc/StrawHitIndex.hh"
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
 #include "Offline/RecoDataProducts/inc/StrawHit.hh"
 #include "Offline/DataProducts/inc/Helicity.hh"
 
@@ -126,6 +127,7 @@ namespace mu2e {
     TrkFitDirection                   _fdir;
 
     const ComboHitCollection*         _chcol;
+    const ComboHitStore*              _chstore;        // z- and time-ordered view of _chcol
     // const StrawHitPositionCollection* _shpos;
     const StrawHitFlagCollection*     _shfcol;
 
@@ -168,7 +170,19 @@ namespace mu2e {
     std::array<float,StrawId::_nupanels>                  _phiPanel;
 
     std::vector<ComboHit>                                 _chHitsToProcess;
+    std::vector<StrawHitFlag>                             _chFlags;   // flags of _chHitsToProcess before the fit
     std::array<int,kNMaxChHits>                           _hitsUsed;
+//-----------------------------------------------------------------------------
+// phi and weights the fits set on the used hits of a helix candidate, saved
+// with the candidate, which doesn't hold the hits
+//-----------------------------------------------------------------------------
+    struct HitFit_t {
+      int    index;
+      float  hphi;
+      float  xyWeight;
+      float  zphiWeight;
+    };
+    std::vector<HitFit_t>                                 _hitFits;
 
     //    std::array<int,StrawId::_nupanels*PanelZ_t::kNMaxPanelHits>  _hitsUsed;
 //-----------------------------------------------------------------------------
@@ -180,6 +194,7 @@ namespace mu2e {
     CalHelixFinderData& operator=(const CalHelixFinderData &) = default;
 
     const ComboHitCollection*         chcol () { return _chcol ; }
+    const ComboHitStore*              chstore() { return _chstore; }
     // const StrawHitPositionCollection* shpos () { return _shpos ; }
     const StrawHitFlagCollection*     shfcol() { return _shfcol; }
 
@@ -192,11 +207,21 @@ namespace mu2e {
 
     void          orderID           (ChannelID* X, ChannelID* O);
 
+    void          deleteHelix();
     void          print(const char* Title);
     void          clearTimeClusterInfo();
     void          clearHelixInfo();
     void          clearTempVariables();
     void          clearResults();
+                                        // copy the helix parameters and the used-hit flags, not the hits
+    void          copyFrom(const CalHelixFinderData& Data, bool CopyDiag);
+                                        // save the fit values of the used hits of Helix / set them back
+    void          saveHitFits   (const CalHelixFinderData& Helix);
+    void          restoreHitFits(const CalHelixFinderData& Candidate);
+                                        // exchange the hits of the time cluster with Data
+    void          swapHits      (CalHelixFinderData& Data);
+                                        // set the hit flags back to the ones before the fit
+    void          resetHitFlags ();
 
   };
 
@@ -85,6 +85,7 @@ namespace mu2e {
 // event object labels
 //-----------------------------------------------------------------------------
     std::string                           _shLabel ; // MakeStrawHit label (makeSH)
+    std::string                           _chsLabel; // ComboHitStore of the _shLabel hits (makeCHS)
     // std::string                           _shpLabel;
     std::string                           _timeclLabel;
 
@@ -105,11 +106,14 @@ namespace mu2e {
     fhicl::ParameterSet*                  _timeOffsets;
 
     const ComboHitCollection*             _chcol;
+    const ComboHitStore*                  _chstore;
+    ComboHitStore                         _localStore;    // used when the event has no store of the _shLabel hits
     const TimeClusterCollection*          _timeclcol;
 
     HelixTraj*                            _helTraj;
     CalHelixFinderAlg                     _hfinder;
     CalHelixFinderData                    _hfResult;
+    CalHelixFinderData                    _tmpResult; // helicity hypothesis, reused to keep its hit storage
     std::vector<mu2e::Helicity>           _hels; // helicity values to fit
 
     double                                _bz0;
@@ -135,6 +139,7 @@ namespace mu2e {
       fhicl::Atom<int>                           debugLevel{           Name("debugLevel"),                 Comment("Debug"),0 };
       fhicl::Atom<int>                           printfreq{            Name("printFrequency"),                  Comment("Print Frequency") };
       fhicl::Atom<std::string>                   shLabel{              Name("StrawHitCollectionLabel"),                    Comment("StrawHit Collection Label") };
+      fhicl::Atom<std::string>                   chsLabel{             Name("ComboHitStoreLabel"),                         Comment("ComboHitStore of the StrawHit Collection, made locally if missing") };
       fhicl::Atom<std::string>                   timeclLabel{          Name("TimeClusterCollectionLabel"),                Comment("TimeCluster Collection Label") };
       fhicl::Atom<int>                           minNHitsTimeCluster{  Name("minNHitsTimeCluster"),        Comment("Min NHits in TimeCluster") };
       fhicl::Atom<int>                           fitparticle{          Name("fitparticle"),                      Comment("Particle Type Searched For") };
@@ -71,6 +71,7 @@ namespace mu2e {
       fhicl::Atom<bool>            testHitMask       {Name("testHitMask"       ), Comment("if true, test hit mask"      ) };
       fhicl::Sequence<std::string> goodHitMask       {Name("goodHitMask"       ), Comment("good hit mask"               ) };
       fhicl::Sequence<std::string> bkgHitMask        {Name("bkgHitMask"        ), Comment("background hit mask"         ) };
+      fhicl::Atom<bool>            concurrentStations{Name("concurrentStations"), Comment("if true, find seeds of the stations concurrently") };
     };
   public:
 //-----------------------------------------------------------------------------
@@ -122,6 +123,7 @@ namespace mu2e {
     bool            _testHitMask;
     StrawHitFlag    _goodHitMask;
     StrawHitFlag    _bkgHitMask;
+    bool            _concurrentStations;   // find and prune the seeds of different stations concurrently
 //-----------------------------------------------------------------------------
 // functions
 //-----------------------------------------------------------------------------
@@ -143,6 +145,7 @@ namespace mu2e {
 
     void         findSeeds           (int Station, int Face);
     void         findSeeds           ();
+    void         findStationSeeds    (int Station);
     void         linkDeltaSeeds      ();                        // do it in upstream direction
     int          mergeDeltaCandidates();
 
@@ -18,6 +18,7 @@ namespace fhicl {
 #include "Offline/DataProducts/inc/StrawId.hh"
 #include "Offline/RecoDataProducts/inc/StereoHit.hh"
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
 #include "Offline/RecoDataProducts/inc/TimeCluster.hh"
 #include "Offline/TrackerGeom/inc/Straw.hh"
 #include "Offline/TrackerGeom/inc/Tracker.hh"
@@ -110,6 +111,7 @@ namespace mu2e {
       art::InputTag                 sdmcCollTag;
 
       const ComboHitCollection*     chcol;
+      const ComboHitStore*          chstore;                 // z- and time-ordered view of chcol
       ComboHitCollection*           outputChColl;
 
       DeltaFinderAlg*               _finder;
@@ -118,7 +120,6 @@ namespace mu2e {
 
       int                           _nComboHits;
       int                           _nStrawHits;
-      std::vector<const ComboHit*>  _v;                      // sorted
 
       ManagedList<DeltaSeed>        fListOfSeeds       [kNStations];
       std::vector<DeltaSeed*>       fListOfProtonSeeds [kNStations];
@@ -133,10 +134,6 @@ namespace mu2e {
       FaceZ_t                       fFaceData      [kNStations][kNFaces];
       int                           stationUsed    [kNStations];
 //-----------------------------------------------------------------------------
-// station #2 is the same as station #0 etc...
-//-----------------------------------------------------------------------------
-      int                           panelOverlap[2][12][12];
-//-----------------------------------------------------------------------------
 // functions
 //-----------------------------------------------------------------------------
       Data_t();
@@ -11,6 +11,7 @@
 #include "art/Framework/Principal/Handle.h"
 #include "art/Utilities/make_tool.h"
 #include "art_root_io/TFileService.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "fhiclcpp/types/Sequence.h"
 
@@ -22,6 +23,7 @@
 
 #include "Offline/RecoDataProducts/inc/CaloCluster.hh"
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
 #include "Offline/RecoDataProducts/inc/HelixHit.hh"
 #include "Offline/RecoDataProducts/inc/HelixSeed.hh"
 #include "Offline/RecoDataProducts/inc/StrawHitIndex.hh"
@@ -38,6 +40,11 @@
 
 #include "CLHEP/Units/PhysicalConstants.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
 namespace mu2e {
 
   using namespace AgnosticHelixFinderTypes;
@@ -50,6 +57,7 @@ namespace mu2e {
       using Comment = fhicl::Comment;
       fhicl::Atom<int>             diagLevel              {Name("diagLevel"            ), Comment("turn tool on or off"         )  };
       fhicl::Atom<art::InputTag>   chCollLabel            {Name("chCollLabel"          ), Comment("combo hit collection label"  )  };
+      fhicl::Atom<art::InputTag>   chStoreLabel           {Name("chStoreLabel"         ), Comment("combo hit store label, made locally if missing")  };
       fhicl::Atom<art::InputTag>   tcCollLabel            {Name("tcCollLabel"          ), Comment("time cluster coll label"     )  };
       fhicl::Atom<art::InputTag>   ccCollLabel            {Name("ccCollLabel"          ), Comment("Calo Cluster coll label"     )  };
       fhicl::Atom<bool>            findMultipleHelices    {Name("findMultipleHelices"  ), Comment("allow more than one helix"   )  };
@@ -91,12 +99,17 @@ namespace mu2e {
       fhicl::Atom<float>           maxEDepAvg             {Name("maxEDepAvg"           ), Comment("max avg edep of combohits"   )  };
       fhicl::Atom<float>           tzSlopeSigThresh       {Name("tzSlopeSigThresh"     ), Comment("direction ambiguous if below")  };
       fhicl::Sequence<int>         validHelixDirections   {Name("validHelixDirections" ), Comment("only save desired directions")  };
+      fhicl::Atom<std::string>     seedingMode            {Name("seedingMode"          ), Comment("triplet or hough"            )  };
+      fhicl::Atom<float>           houghCellSize          {Name("houghCellSize"        ), Comment("circle center cell size (mm)")  };
+      fhicl::Atom<int>             houghMinVotes          {Name("houghMinVotes"        ), Comment("min hit pairs in seed cell"  )  };
+      fhicl::Atom<int>             houghMaxSeeds          {Name("houghMaxSeeds"        ), Comment("max seed cells per search"   )  };
 
       fhicl::Table<AgnosticHelixFinderTypes::Config> diagPlugin  {Name("diagPlugin"), Comment("diag plugin"                   )  };
     };
 
     struct cHit {
       int     hitIndice = 0; // index of point in _chColl
+      uint32_t storePos = 0; // position of point in _chStore
       float   circleError2 = 1.0;
       float   helixPhi = 0.0;
       float   helixPhiError2 = 0.0;
@@ -140,6 +153,18 @@ namespace mu2e {
       STOPPINGTARGET = -2
     };
 
+    enum class SeedingMode {
+      TRIPLET,
+      HOUGH
+    };
+
+    struct houghCell {
+      int     votes = 0;
+      float   sumX = 0.0; // sums of the voting circle centers and radii
+      float   sumY = 0.0;
+      float   sumR = 0.0;
+    };
+
   private:
     //-----------------------------------------------------------------------------
     // tool on or off
@@ -150,6 +175,7 @@ namespace mu2e {
     // event object labels
     //-----------------------------------------------------------------------------
     art::InputTag _chLabel;
+    art::InputTag _chStoreLabel;
     art::InputTag _tcLabel;
     art::InputTag _ccLabel;
 
@@ -157,6 +183,8 @@ namespace mu2e {
     // collections
     //-----------------------------------------------------------------------------
     const ComboHitCollection*      _chColl;
+    const ComboHitStore*           _chStore;
+    ComboHitStore                  _localStore; // used when the event has no store of _chLabel
     const TimeClusterCollection*   _tcColl;
     const CaloClusterCollection*   _ccColl;
 
@@ -202,6 +230,10 @@ namespace mu2e {
     float    _maxEDepAvg;
     float    _tzSlopeSigThresh;
     std::vector<int> _validHelixDirections;
+    SeedingMode      _seedingMode;
+    float            _houghCellSize;
+    int              _houghMinVotes;
+    int              _houghMaxSeeds;
 
     //-----------------------------------------------------------------------------
     // diagnostics
@@ -223,6 +255,9 @@ namespace mu2e {
     float                         _bz0;
     bool                          _intenseEvent;
     bool                          _intenseCluster;
+    std::unordered_map<int64_t, houghCell>     _houghCells; // circle center cells, by packed cell indices
+    std::vector<std::pair<int, int64_t>>       _houghSeeds; // (votes, cell) of the seed cells, best first
+    std::vector<std::pair<int64_t, size_t>>    _flagGrid;   // (cell, _tcHits index) of the hits considered in setFlags
 
     //-----------------------------------------------------------------------------
     // stuff for tool
@@ -267,7 +302,12 @@ namespace mu2e {
     void         setTripletJ               (size_t& tcHitsIndex, triplet& trip, LoopCondition& outcome);
     void         setTripletK               (size_t& tcHitsIndex, triplet& trip, LoopCondition& outcome);
     void         initTriplet               (triplet& trip, LoopCondition& outcome);
-    void         initSeedCircle            (LoopCondition& outcome);
+    void         initSeedCircle            (float& xC, float& yC, float& rC, LoopCondition& outcome);
+    bool         processSeedCircle         (size_t tc, HelixSeedCollection& HSColl, float& xC, float& yC, float& rC,
+                                            bool& uselessSeed, bool& findAnotherHelix);
+    void         houghVotePair             (XYZVectorF& p1, XYZVectorF& p2, float& rMin2, float& rMax2);
+    static int64_t cellKey                 (int ix, int iy) { return (int64_t)(((uint64_t)(uint32_t)ix << 32) | (uint32_t)iy); }
+    void         findHoughSeeds            ();
     void         initHelixPhi              ();
     void         findSeedPhiLines          (LoopCondition& outcome);
     float        underEstimateSlope        (float& phi1, float& phi1Err2, float& phi2, float& phi2Err2, float& dz);
@@ -288,6 +328,7 @@ namespace mu2e {
     art::EDProducer{config},
     _diagLevel                     (config().diagLevel()                             ),
     _chLabel                       (config().chCollLabel()                           ),
+    _chStoreLabel                  (config().chStoreLabel()                          ),
     _tcLabel                       (config().tcCollLabel()                           ),
     _ccLabel                       (config().ccCollLabel()                           ),
     _findMultipleHelices           (config().findMultipleHelices()                   ),
@@ -328,11 +369,21 @@ namespace mu2e {
     _chi2LineSaveThresh            (config().chi2LineSaveThresh()                    ),
     _maxEDepAvg                    (config().maxEDepAvg()                            ),
     _tzSlopeSigThresh              (config().tzSlopeSigThresh()                      ),
-    _validHelixDirections          (config().validHelixDirections()                  )
+    _validHelixDirections          (config().validHelixDirections()                  ),
+    _houghCellSize                 (config().houghCellSize()                         ),
+    _houghMinVotes                 (config().houghMinVotes()                         ),
+    _houghMaxSeeds                 (config().houghMaxSeeds()                         )
 
     {
 
+      if (config().seedingMode() == "triplet") { _seedingMode = SeedingMode::TRIPLET; }
+      else if (config().seedingMode() == "hough") { _seedingMode = SeedingMode::HOUGH; }
+      else {
+        throw cet::exception("CONFIG") << "AgnosticHelixFinder: unknown seedingMode " << config().seedingMode() << std::endl;
+      }
+
       consumes<ComboHitCollection>     (_chLabel);
+      consumes<ComboHitStore>          (_chStoreLabel);
       consumes<TimeClusterCollection>  (_tcLabel);
       consumes<CaloClusterCollection>  (_ccLabel);
       produces<HelixSeedCollection>    ();
@@ -386,6 +437,16 @@ namespace mu2e {
       _chColl = chCollH.product();
     } else { _chColl = 0; }
 
+    // the store must hold the same hits as _chColl, in the same order.  Without one in the event it is made
+    // here; only its z order is used, so the time bin is arbitrary
+    auto chStoreH = evt.getHandle<ComboHitStore>(_chStoreLabel);
+    if (chStoreH.isValid() && _chColl != 0 && chStoreH->matches(*_chColl, chCollH.id())) {
+      _chStore = chStoreH.product();
+    } else if (_chColl != 0) {
+      _localStore.fill(*_chColl, chCollH.id(), 40.);
+      _chStore = &_localStore;
+    } else { _chStore = 0; }
+
     auto _tcCollH = evt.getValidHandle<TimeClusterCollection>(_tcLabel);
     if (_tcCollH.product() != 0) {
       _tcColl = _tcCollH.product();
@@ -476,7 +537,7 @@ namespace mu2e {
 
     int hitIndice = _tcHits[tcHitsIndex].hitIndice;
 
-    if (hitIndice >= 0) { return _chColl->at(hitIndice).pos(); }
+    if (hitIndice >= 0) { return _chStore->pos(_tcHits[tcHitsIndex].storePos); }
     if (hitIndice == HitType::STOPPINGTARGET) { return _stopTargPos; }
     if (hitIndice == HitType::CALOCLUSTER) { return _caloPos; }
 
@@ -612,13 +673,14 @@ namespace mu2e {
     for (size_t i = 0; i < _tcColl->at(tc)._strawHitIdxs.size(); i++) {
       cHit hit;
       hit.hitIndice = _tcColl->at(tc)._strawHitIdxs[i];
+      hit.storePos = _chStore->position(hit.hitIndice);
       _tcHits.push_back(hit);
     }
 
     // order from largest z to smallest z (skip over stopping target and calo cluster since they
     // aren't in _chColl)
     std::sort(_tcHits.begin() + sortStartIndex, _tcHits.end(), [&](const cHit& a, const cHit& b) {
-        return _chColl->at(a.hitIndice).pos().z() > _chColl->at(b.hitIndice).pos().z();
+        return _chStore->z(a.storePos) > _chStore->z(b.storePos);
       });
 
   }
@@ -630,27 +692,48 @@ namespace mu2e {
 
     // do isolation and average flagging
     if (_doIsolationFlag == true || _doAverageFlag == true) {
+      // bin the hits in x-y cells at least as large as both cuts, so the hits near a hit are in the
+      // 3x3 cells around it
+      float cellSize = 1.01 * std::max(_doIsolationFlag ? _isoRad : 0.0f, _doAverageFlag ? _minDistCut : 0.0f);
+      cellSize = std::max(cellSize, 1.0f);
+      _flagGrid.clear();
+      for (size_t i = 0; i < _tcHits.size(); i++) {
+        if (_tcHits[i].inHelix == true || _tcHits[i].hitIndice < 0) { continue; }
+        XYZVectorF pos = getPos(i);
+        _flagGrid.emplace_back(cellKey((int)std::floor(pos.x() / cellSize), (int)std::floor(pos.y() / cellSize)), i);
+      }
+      std::sort(_flagGrid.begin(), _flagGrid.end());
       for (size_t i = 0; i < _tcHits.size(); i++) {
         if (_tcHits[i].inHelix == true || _tcHits[i].hitIndice < 0) { continue; }
         int nHitsNear = 0;
         XYZVectorF seedPos = getPos(i);
-        for (size_t j = 0; j < _tcHits.size(); j++) {
-          if (_tcHits[j].inHelix == true || _tcHits[j].hitIndice < 0) { continue; }
-          if (j == i) { continue; }
-          XYZVectorF testPos = getPos(j);
-          // do isolation flagging
-          if (_doIsolationFlag == true) {
-            if ((seedPos-testPos).Perp2() < _isoRad * _isoRad) { nHitsNear++; }
-            if (nHitsNear < _isoMinHitsNear) { _tcHits[i].isolated = true; }
-            else { _tcHits[i].isolated = false; }
-          }
-          // do averaging out
-          if (_doAverageFlag == true) {
-            if (_tcHits[i].averagedOut == true) { continue; }
-            if (_tcHits[j].averagedOut == true) { continue; }
-            if ((seedPos-testPos).Perp2() <= _minDistCut * _minDistCut) { _tcHits[j].averagedOut = true; }
+        int ix = (int)std::floor(seedPos.x() / cellSize);
+        int iy = (int)std::floor(seedPos.y() / cellSize);
+        for (int dx = -1; dx <= 1; dx++) {
+          for (int dy = -1; dy <= 1; dy++) {
+            auto range = std::equal_range(_flagGrid.begin(), _flagGrid.end(), std::make_pair(cellKey(ix + dx, iy + dy), size_t(0)),
+                [](auto const& a, auto const& b) { return a.first < b.first; });
+            for (auto icell = range.first; icell != range.second; icell++) {
+              size_t j = icell->second;
+              if (j == i) { continue; }
+              XYZVectorF testPos = getPos(j);
+              if (_doIsolationFlag == true) {
+                if ((seedPos-testPos).Perp2() < _isoRad * _isoRad) { nHitsNear++; }
+              }
+              // do averaging out.  Only hits j are flagged, so the order of the cells doesn't matter
+              if (_doAverageFlag == true) {
+                if (_tcHits[i].averagedOut == true) { continue; }
+                if (_tcHits[j].averagedOut == true) { continue; }
+                if ((seedPos-testPos).Perp2() <= _minDistCut * _minDistCut) { _tcHits[j].averagedOut = true; }
+              }
+            }
           }
         }
+        // do isolation flagging, if there is any other hit to compare with
+        if (_doIsolationFlag == true && _flagGrid.size() > 1) {
+          if (nHitsNear < _isoMinHitsNear) { _tcHits[i].isolated = true; }
+          else { _tcHits[i].isolated = false; }
+        }
       }
     }
   }
@@ -685,9 +768,23 @@ namespace mu2e {
     // set flags before starting search so that we know what hits to use for tripletting
     if (_doIsolationFlag == true || _doAverageFlag == true) { setFlags(); }
 
+    // seed from the hashed circle-center accumulator if requested
+    if (_seedingMode == SeedingMode::HOUGH) {
+      findHoughSeeds();
+      for (size_t iseed = 0; iseed < _houghSeeds.size(); iseed++) {
+        houghCell const& cell = _houghCells[_houghSeeds[iseed].second];
+        float xC = cell.sumX / cell.votes;
+        float yC = cell.sumY / cell.votes;
+        float rC = cell.sumR / cell.votes;
+        _circleFitter.clear();
+        _lineFitter.clear();
+        bool uselessSeed = true;
+        if (processSeedCircle(tc, HSColl, xC, yC, rC, uselessSeed, findAnotherHelix)) { return; }
+      }
+      return;
+    }
+
     // now we loop over triplets
-    bool foundPhiZRemoval = true;
-    bool pointRecovered = true;
     for (size_t i = 0; i < _tcHits.size() - 2; i++) {
       bool uselessSeed = true;
       triplet tripletInfo;
@@ -709,62 +806,176 @@ namespace mu2e {
           initTriplet(tripletInfo, loopCondition);
           // now initialize seed circle if triplet circle passed condition check
           if (loopCondition == CONTINUE) { continue; }
-          initSeedCircle(loopCondition);
-          if (loopCondition == CONTINUE) { continue; }
-          uselessSeed = false;
-          initHelixPhi();
-          findSeedPhiLines(loopCondition);
-          if (loopCondition == CONTINUE) { continue; }
-          resolve2PiAmbiguities();
-          // refine the seed phi lines by removing the worst hits
-          for (size_t ii = 0; ii < _seedPhiLines.size(); ii++) {
-            if ((int)_seedPhiLines[ii].tcHitsIndices.size() < _minFinalSeedHits) { continue; }
-            foundPhiZRemoval = true;
-            while (foundPhiZRemoval == true) {
-              refinePhiLine(ii, foundPhiZRemoval);
-            }
-          }
-          initFinalSeed(loopCondition);
-          if (loopCondition == CONTINUE) { continue; }
-          pointRecovered = true;
-          while (pointRecovered == true) { recoverPoints(pointRecovered); }
-          checkHelixViability(loopCondition);
-          if (loopCondition == CONTINUE) { continue; }
-          // before saving helix we make sure it has enough hits
-          int nStrawHitsInHelix = 0;
-          int nComboHitsInHelix = 0;
-          int nStrawHitsInTimeCluster = 0;
-          int nComboHitsInTimeCluster = 0;
-          // compute number of usable hits in time cluster, and number of hits in candidate helix
-          for (size_t q = 0; q < _tcHits.size(); q++) {
-            if (_tcHits[q].inHelix == true || _tcHits[q].hitIndice < 0) { continue; }
-            int hitIndice = _tcHits[q].hitIndice;
-            nStrawHitsInTimeCluster = nStrawHitsInTimeCluster + _chColl->at(hitIndice).nStrawHits();
-            nComboHitsInTimeCluster = nComboHitsInTimeCluster + 1;
-            if (_tcHits[q].used == false) { continue; }
-            nStrawHitsInHelix = nStrawHitsInHelix + _chColl->at(hitIndice).nStrawHits();
-            nComboHitsInHelix = nComboHitsInHelix + 1;
-          }
-          if (nStrawHitsInHelix >= _minNHelixStrawHits && nComboHitsInHelix >= _minNHelixComboHits) {
-            saveHelix(tc, HSColl);
-            if (_diagLevel == 1) { _diagInfo.nHelices++; }
-            // we only want to search for another helix if we have enough remaining hits after saving helix
-            int remainingStrawHits = nStrawHitsInTimeCluster - nStrawHitsInHelix;
-            int remainingComboHits = nComboHitsInTimeCluster - nComboHitsInHelix;
-            if (remainingStrawHits < _minNHelixStrawHits || remainingComboHits < _minNHelixComboHits) {
-              return;
-            } else {
-              findAnotherHelix = true;
-              if (_doIsolationFlag == true || _doAverageFlag == true) { resetFlags(); }
-              return;
-            }
-          }
+          float xC = _circleFitter.x0();
+          float yC = _circleFitter.y0();
+          float rC = _circleFitter.radius();
+          if (processSeedCircle(tc, HSColl, xC, yC, rC, uselessSeed, findAnotherHelix)) { return; }
         }
       }
       _tcHits[i].uselessTripletSeed = uselessSeed;
     }
   }
 
+  //-----------------------------------------------------------------------------
+  // build a helix from a seed circle, returns true if a helix was saved
+  //-----------------------------------------------------------------------------
+  bool AgnosticHelixFinder::processSeedCircle(size_t tc, HelixSeedCollection& HSColl, float& xC, float& yC, float& rC,
+                                              bool& uselessSeed, bool& findAnotherHelix) {
+
+    LoopCondition loopCondition;
+    bool foundPhiZRemoval = true;
+    bool pointRecovered = true;
+    initSeedCircle(xC, yC, rC, loopCondition);
+    if (loopCondition == CONTINUE) { return false; }
+    uselessSeed = false;
+    initHelixPhi();
+    findSeedPhiLines(loopCondition);
+    if (loopCondition == CONTINUE) { return false; }
+    resolve2PiAmbiguities();
+    // refine the seed phi lines by removing the worst hits
+    for (size_t ii = 0; ii < _seedPhiLines.size(); ii++) {
+      if ((int)_seedPhiLines[ii].tcHitsIndices.size() < _minFinalSeedHits) { continue; }
+      foundPhiZRemoval = true;
+      while (foundPhiZRemoval == true) {
+        refinePhiLine(ii, foundPhiZRemoval);
+      }
+    }
+    initFinalSeed(loopCondition);
+    if (loopCondition == CONTINUE) { return false; }
+    pointRecovered = true;
+    while (pointRecovered == true) { recoverPoints(pointRecovered); }
+    checkHelixViability(loopCondition);
+    if (loopCondition == CONTINUE) { return false; }
+    // before saving helix we make sure it has enough hits
+    int nStrawHitsInHelix = 0;
+    int nComboHitsInHelix = 0;
+    int nStrawHitsInTimeCluster = 0;
+    int nComboHitsInTimeCluster = 0;
+    // compute number of usable hits in time cluster, and number of hits in candidate helix
+    for (size_t q = 0; q < _tcHits.size(); q++) {
+      if (_tcHits[q].inHelix == true || _tcHits[q].hitIndice < 0) { continue; }
+      int hitIndice = _tcHits[q].hitIndice;
+      nStrawHitsInTimeCluster = nStrawHitsInTimeCluster + _chColl->at(hitIndice).nStrawHits();
+      nComboHitsInTimeCluster = nComboHitsInTimeCluster + 1;
+      if (_tcHits[q].used == false) { continue; }
+      nStrawHitsInHelix = nStrawHitsInHelix + _chColl->at(hitIndice).nStrawHits();
+      nComboHitsInHelix = nComboHitsInHelix + 1;
+    }
+    if (nStrawHitsInHelix >= _minNHelixStrawHits && nComboHitsInHelix >= _minNHelixComboHits) {
+      saveHelix(tc, HSColl);
+      if (_diagLevel == 1) { _diagInfo.nHelices++; }
+      // we only want to search for another helix if we have enough remaining hits after saving helix
+      int remainingStrawHits = nStrawHitsInTimeCluster - nStrawHitsInHelix;
+      int remainingComboHits = nComboHitsInTimeCluster - nComboHitsInHelix;
+      if (remainingStrawHits < _minNHelixStrawHits || remainingComboHits < _minNHelixComboHits) {
+        return true;
+      } else {
+        findAnotherHelix = true;
+        if (_doIsolationFlag == true || _doAverageFlag == true) { resetFlags(); }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //-----------------------------------------------------------------------------
+  // vote for the centers of the circles through 2 points within the radius range. The centers
+  // lie on the perpendicular bisector of the points, at distance t from their midpoint, with
+  // radius^2 = (half chord)^2 + t^2
+  //-----------------------------------------------------------------------------
+  void AgnosticHelixFinder::houghVotePair(XYZVectorF& p1, XYZVectorF& p2, float& rMin2, float& rMax2) {
+
+    float dx = p2.x() - p1.x();
+    float dy = p2.y() - p1.y();
+    float chord2 = dx * dx + dy * dy;
+    float halfChord2 = chord2 / 4.0;
+    if (halfChord2 >= rMax2) { return; }
+    float chord = std::sqrt(chord2);
+    float xM = (p1.x() + p2.x()) / 2.0;
+    float yM = (p1.y() + p2.y()) / 2.0;
+    float uX = -dy / chord;
+    float uY = dx / chord;
+    float tMin = std::sqrt(std::max(rMin2 - halfChord2, float(0.0)));
+    float tMax = std::sqrt(rMax2 - halfChord2);
+    int nSteps = (int)((tMax - tMin) / _houghCellSize) + 1;
+
+    // each side of the chord, one vote per cell crossed
+    for (int side = -1; side <= 1; side += 2) {
+      int64_t lastKey = std::numeric_limits<int64_t>::min();
+      for (int step = 0; step <= nSteps; step++) {
+        float t = std::min(tMin + step * _houghCellSize, tMax);
+        float xC = xM + side * t * uX;
+        float yC = yM + side * t * uY;
+        int64_t key = cellKey((int)std::floor(xC / _houghCellSize), (int)std::floor(yC / _houghCellSize));
+        if (key == lastKey) { continue; }
+        lastKey = key;
+        houghCell& cell = _houghCells[key];
+        cell.votes++;
+        cell.sumX += xC;
+        cell.sumY += yC;
+        cell.sumR += std::sqrt(halfChord2 + t * t);
+      }
+    }
+  }
+
+  //-----------------------------------------------------------------------------
+  // fill the circle center accumulator from the pairs of points allowed in a triplet, and
+  // select the seed cells: local maxima with enough votes, most votes first
+  //-----------------------------------------------------------------------------
+  void AgnosticHelixFinder::findHoughSeeds() {
+
+    _houghCells.clear();
+    _houghSeeds.clear();
+
+    float rMin = _minHelixPerpMomentum / (_bz0 * mmTconversion);
+    float rMax = _maxHelixPerpMomentum / (_bz0 * mmTconversion);
+    float rMin2 = rMin * rMin;
+    float rMax2 = rMax * rMax;
+
+    for (size_t i = 0; i < _tcHits.size(); i++) {
+      XYZVectorF posI = getPos(i);
+      int hitIndiceI = _tcHits[i].hitIndice;
+      if (posI.z() < _minTripletSeedZ) { break; }
+      // in busy clusters only seed from the stopping target and calo cluster, as the triplets do
+      if ((_intenseEvent == true || _intenseCluster == true) && hitIndiceI >= 0) { break; }
+      if (!passesFlags(i)) { continue; }
+      for (size_t j = i + 1; j < _tcHits.size(); j++) {
+        XYZVectorF posJ = getPos(j);
+        float dz = posI.z() - posJ.z();
+        if (hitIndiceI >= 0 && dz > _maxTripletDz) { break; }
+        if (!passesFlags(j) || dz < _minTripletDz ||
+            (posI-posJ).Perp2() < _minTripletDist * _minTripletDist) { continue; }
+        houghVotePair(posI, posJ, rMin2, rMax2);
+      }
+    }
+
+    // seed cells must have at least as many votes as any of their neighbors, ties going to the lower key
+    for (auto const& icell : _houghCells) {
+      if (icell.second.votes < _houghMinVotes) { continue; }
+      int ix = (int32_t)((uint64_t)icell.first >> 32);
+      int iy = (int32_t)(icell.first & 0xFFFFFFFF);
+      bool isMax = true;
+      for (int dx = -1; dx <= 1 && isMax; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+          if (dx == 0 && dy == 0) { continue; }
+          int64_t key = cellKey(ix + dx, iy + dy);
+          auto jcell = _houghCells.find(key);
+          if (jcell == _houghCells.end()) { continue; }
+          if (jcell->second.votes > icell.second.votes ||
+              (jcell->second.votes == icell.second.votes && key < icell.first)) {
+            isMax = false;
+            break;
+          }
+        }
+      }
+      if (isMax) { _houghSeeds.emplace_back(icell.second.votes, icell.first); }
+    }
+    std::sort(_houghSeeds.begin(), _houghSeeds.end(), [](auto const& a, auto const& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+      });
+    if ((int)_houghSeeds.size() > _houghMaxSeeds) { _houghSeeds.resize(_houghMaxSeeds); }
+  }
+
   //-----------------------------------------------------------------------------
   // check flags to see if point is good for triplet-ing with
   //-----------------------------------------------------------------------------
@@ -886,12 +1097,9 @@ namespace mu2e {
   //-----------------------------------------------------------------------------
   // start with initial seed circle
   //-----------------------------------------------------------------------------
-  void AgnosticHelixFinder::initSeedCircle(LoopCondition& outcome) {
+  void AgnosticHelixFinder::initSeedCircle(float& xC, float& yC, float& rC, LoopCondition& outcome) {
 
-    // get triplet circle parameters then clear fitter
-    float xC = _circleFitter.x0();
-    float yC = _circleFitter.y0();
-    float rC = _circleFitter.radius();
+    // start the fit from the seed circle parameters
     _circleFitter.clear();
 
     // project error bars onto the triplet circle found and add to fitter those within defined max
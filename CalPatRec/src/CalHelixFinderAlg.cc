@@ -69,11 +69,6 @@ namespace mu2e {
     bool operator()(mu2e::ComboHit const& p1, mu2e::ComboHit const& p2) { return p1._pos.z() < p2._pos.z(); }
   };
 
-  // comparison functor for sorting byuniquePanel ID
-  struct panelcomp {
-    bool operator()(mu2e::ComboHit const& p1, mu2e::ComboHit const& p2) { return p1.strawId().uniquePanel() < p2.strawId().uniquePanel(); }
-  };
-
 //-----------------------------------------------------------------------------
   void CalHelixFinderAlg::defineHelixParams(CalHelixFinderData& Helix) const {
 
@@ -1267,7 +1262,7 @@ namespace mu2e {
                                           int                 UseInteligentWeight,
                                           int                 DoCleanUp           ) {
 
-    auto              hitsUsed  = Helix._hitsUsed;
+    std::copy_n(Helix._hitsUsed.begin(), Helix._nFiltPoints, _phiZHitsUsed.begin());
 
     bool              success(false);
     int               nPointsRemoved(0);
@@ -1537,7 +1532,7 @@ namespace mu2e {
     }
 
     if (!success) {
-      Helix._hitsUsed = hitsUsed;
+      std::copy_n(_phiZHitsUsed.begin(), Helix._nFiltPoints, Helix._hitsUsed.begin());
     }
 
     return success;
@@ -1563,7 +1558,7 @@ namespace mu2e {
     if (fCaloTime > 0) clPhi = polyAtan2(fCaloY,fCaloX);
 
     const vector<StrawHitIndex>& shIndices = Helix._timeCluster->hits();
-    ChannelID cx, co;
+    const TrackerTopology& topology = _tracker->topology();
 
     int     size           = Helix._timeCluster->nhits();
     int     nFiltPoints(0), nFiltStrawHits(0);
@@ -1572,9 +1567,11 @@ namespace mu2e {
     int loc;
     StrawHitFlag flag;
 
-    //sort the hits by z coordinate
-    ComboHitCollection ordChCol;
-    ordChCol.reserve(size);
+    // store positions of the selected hits: in the store the hits are ordered by z-ordered face
+    // and panel, and by time within a panel, so sorting the positions sorts the hits
+    const ComboHitStore* store = Helix.chstore();
+    std::vector<uint32_t> ordPos;
+    ordPos.reserve(size);
 
     if (_debug >0 ){
       printf("-----------------------------------------------------------------------------------/n");
@@ -1620,26 +1617,18 @@ namespace mu2e {
                  ch.pos().x(), ch.pos().y(), ch.pos().z());
         }
 
-        ordChCol.push_back(ComboHit(ch));
+        ordPos.push_back(store->position(loc));
       }
     }
-    std::sort(ordChCol.begin(), ordChCol.end(),panelcomp());
-
-    for (unsigned i=0; i<ordChCol.size(); ++i) {
-      ComboHit& ch = ordChCol[i];
+    std::sort(ordPos.begin(), ordPos.end());
 
-      cx.Station                 = ch.strawId().station();//straw.id().getStation();
-      cx.Plane                   = ch.strawId().plane() % 2;//straw.id().getPlane() % 2;
-      cx.Face                    = ch.strawId().face();
-      cx.Panel                   = ch.strawId().panel();//straw.id().getPanel();
+    for (unsigned i=0; i<ordPos.size(); ++i) {
+      const ComboHit& ch = Helix.chcol()->at(store->index(ordPos[i]));
 
-      // get Z-ordered location
-      Helix.orderID(&cx, &co);
-
-      int os       = co.Station;
-      int of       = co.Face;
-      //FIXME!!! COMPARE OF WITH ch.sid().uniqueFace()
-      int op       = co.Panel;
+      // get Z-ordered location: panels 0,2,4 are panels 0,1,2 of the first face of a plane, 1,3,5 of the second
+      int os       = ch.strawId().station();
+      int of       = topology.orderedFace(ch.strawId());
+      int op       = ch.strawId().panel()/2;
 
       int       stationId = os;
       int       faceId    = of + stationId*StrawId::_nfaces*FaceZ_t::kNPlanesPerStation;//FaceZ_t::kNFaces;
@@ -1651,6 +1640,7 @@ namespace mu2e {
       if ((op < 0) || (op >= FaceZ_t::kNPanels )) printf(" >>> ERROR: wrong panel   number: %i\n",op);
 
       Helix._chHitsToProcess.push_back(mu2e::ComboHit(ch));
+      Helix._chFlags.push_back(ch.flag());
 
       if (pz->idChBegin < 0 ){
         pz->idChBegin = Helix._chHitsToProcess.size() - 1;
@@ -2004,7 +1994,10 @@ namespace mu2e {
 
 
 //--------------------------------------------------------------------------------
-  void CalHelixFinderAlg::searchBestTriplet   (CalHelixFinderData& Helix, CalHelixFinderData& TmpHelix, int UseMPVdfdz){
+// the trial helices are fit in place on Helix, Best keeps the parameters, the
+// used-hit flags and the hit fit values of the best one
+//--------------------------------------------------------------------------------
+  void CalHelixFinderAlg::searchBestTriplet   (CalHelixFinderData& Helix, CalHelixFinderData& Best, int UseMPVdfdz){
     int       nSh = Helix._nFiltStrawHits;
     int       nHitsTested(0);
 
@@ -2018,30 +2011,31 @@ namespace mu2e {
         panelz = &facez->panelZs[p];
         int       nhits  = panelz->nChHits();
         for (int i=0; i<nhits; ++i){
-          if (Helix._nStrawHits > (nSh - nHitsTested))   continue;
+          if (Best._nStrawHits > (nSh - nHitsTested))   continue;
           if ((nSh - nHitsTested) < _minNHits        )  continue;
-          //clear the info of the tmp object used to test the triplet
-          TmpHelix.clearResults();
+          //clear the info of the helix used to test the triplet
+          Helix.clearResults();
 
           HitInfo_t          seed(f,p,panelz->idChBegin + i);
-          findTrack(seed,TmpHelix,UseMPVdfdz);
+          findTrack(seed,Helix,UseMPVdfdz);
 
           nHitsTested += Helix._chHitsToProcess[panelz->idChBegin + i].nStrawHits();
 
           //compare tripletHelix with bestTripletHelix
           //2019-02-08: gianipez chanceg the logic;
           //2019-02-15: gianipez put the old logic back. FIXME!
-          if (( TmpHelix._nStrawHits >  Helix._nStrawHits) ||
-              ((TmpHelix._nStrawHits == Helix._nStrawHits) && (TmpHelix._helixChi2 < Helix._helixChi2))) {
-          // int   deltaNSh = TmpHelix._nStrawHits -  Helix._nStrawHits;
+          if (( Helix._nStrawHits >  Best._nStrawHits) ||
+              ((Helix._nStrawHits == Best._nStrawHits) && (Helix._helixChi2 < Best._helixChi2))) {
+          // int   deltaNSh = Helix._nStrawHits -  Best._nStrawHits;
           // if ( ( deltaNSh >=  _minDeltaNShPatRec)  ||
-          //      ( deltaNSh>=0 && (deltaNSh-_minDeltaNShPatRec < 0) && (TmpHelix._helixChi2 < Helix._helixChi2)) ||
-          //      ((TmpHelix._nStrawHits == Helix._nStrawHits) && (TmpHelix._helixChi2 < Helix._helixChi2)) ) {
-            Helix = TmpHelix;
+          //      ( deltaNSh>=0 && (deltaNSh-_minDeltaNShPatRec < 0) && (Helix._helixChi2 < Best._helixChi2)) ||
+          //      ((Helix._nStrawHits == Best._nStrawHits) && (Helix._helixChi2 < Best._helixChi2)) ) {
+            Best.copyFrom(Helix, _diag > 0);
+            Best.saveHitFits(Helix);
           }
           if (_debug > 5) {
             printf("[CalHelixFinderAlg::doPatternRecognition]: calling findTrack(i=%i,Helix,useDefaltDfDz=FALSE,useMPVdfdz=%i)",panelz->idChBegin +i,UseMPVdfdz);
-            printf(" : np=%3i _goodPointsTrkCandidate=%3i\n",nSh,Helix._nStrawHits);
+            printf(" : np=%3i _goodPointsTrkCandidate=%3i\n",nSh,Best._nStrawHits);
           }
         }//end loop over the hits on the panel
       }//end panels loop
@@ -2062,20 +2056,23 @@ namespace mu2e {
       _debug  = 0;
     }
 
-    CalHelixFinderData tripletHelix(Helix);
-    tripletHelix._helix = NULL;//FIXME!
+    _bestTriplet.copyFrom(Helix, _diag > 0);  // kept if no triplet gives a better helix
+    _bestTriplet.saveHitFits(Helix);
 
     _findTrackLoopIndex = 1;                 // debugging
-    searchBestTriplet(Helix, tripletHelix);
+    searchBestTriplet(Helix, _bestTriplet);
     //-----------------------------------------------------------------------------
     // 2014-11-09 gianipez: if no track was found requiring the recalculation of dfdz
     // look for a track candidate using the default value of dfdz and the target center
     //-----------------------------------------------------------------------------
     _findTrackLoopIndex = 2;                 // *DEBUGGING*
     if (fUseDefaultDfDz == 0) {
-      searchBestTriplet(Helix, tripletHelix, useMPVdfdz);
+      searchBestTriplet(Helix, _bestTriplet, useMPVdfdz);
    }
 
+    Helix.copyFrom(_bestTriplet, _diag > 0);
+    Helix.restoreHitFits(_bestTriplet);
+
     if (_debug == 0){
       _debug  = _debug2;
       _debug2 = 0;
@@ -2489,7 +2486,7 @@ namespace mu2e {
                                                HitInfo_t           SeedIndex,
                                                const char*         Banner,
                                                int                 Print  ) {
-    auto           hitsUsed = Trk._hitsUsed;
+    std::copy_n(Trk._hitsUsed.begin(), Trk._nFiltPoints, _xyHitsUsed.begin());
     float         x, y, r, r_start;
     float         hitChi2Worst;
 
@@ -2662,7 +2659,7 @@ namespace mu2e {
       //      Trk._chi2   = Trk._sxy.chi2DofCircle();
 
     }else {
-      Trk._hitsUsed = hitsUsed;   //restore the info of the used-hits that was originally passed to the procedure
+      std::copy_n(_xyHitsUsed.begin(), Trk._nFiltPoints, Trk._hitsUsed.begin());   //restore the info of the used-hits that was originally passed to the procedure
       doWeightedCircleFit (Trk,SeedIndex,helCenter_start,r_start,0,Banner);
     }
 
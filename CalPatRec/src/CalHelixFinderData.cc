@@ -4,6 +4,8 @@
 #include "Offline/CalPatRec/inc/CalHelixFinderData.hh"
 #include "BTrk/TrkBase/HelixTraj.hh"
 
+#include <algorithm>
+
 using CLHEP::HepVector;
 using CLHEP::HepSymMatrix;
 
@@ -14,8 +16,13 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
   CalHelixFinderData::CalHelixFinderData() {
     _helix = NULL;
+    _nFiltPoints    = 0;
+    _nFiltStrawHits = 0;
+    _hitsUsed.fill(0);
     _goodhits.reserve(kNMaxChHits);
     _chHitsToProcess. reserve(kNMaxChHits);
+    _chFlags.reserve(kNMaxChHits);
+    _hitFits.reserve(kNMaxChHits);
   }
 
 //-----------------------------------------------------------------------------
@@ -68,7 +75,13 @@ namespace mu2e {
 
 //-----------------------------------------------------------------------------
   CalHelixFinderData::~CalHelixFinderData() {
+    deleteHelix();
+  }
+
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::deleteHelix() {
     if (_helix) delete _helix;
+    _helix = NULL;
   }
 
 //-----------------------------------------------------------------------------
@@ -104,6 +117,7 @@ namespace mu2e {
     _timeClusterPtr = art::Ptr<TimeCluster>();
 
     _chHitsToProcess.clear();
+    _chFlags.clear();
 
     _goodhits.clear();
 
@@ -154,6 +168,7 @@ namespace mu2e {
     _timeClusterPtr = art::Ptr<TimeCluster>();
 
     _chHitsToProcess.clear();
+    _chFlags.clear();
 
     _nFiltPoints    = 0;
     _nFiltStrawHits = 0;
@@ -202,14 +217,14 @@ void CalHelixFinderData::clearHelixInfo() {
 
   }
 //-----------------------------------------------------------------------------
-// don't clear the diagnostics part.
+// don't clear the diagnostics part, nor the hits of the time cluster, which
+// findTrack reads from the trial helix.
+// only the flags of the _nFiltPoints hits can be set, the rest of _hitsUsed stays 0
 //-----------------------------------------------------------------------------
    void CalHelixFinderData::clearResults() {
 
     _goodhits.clear();
 
-    _chHitsToProcess.clear();
-
     _fit.setFailure(1,"failure");
 
     _sxy.clear();
@@ -235,9 +250,101 @@ void CalHelixFinderData::clearHelixInfo() {
     _seedIndex   = HitInfo_t();
     _candIndex   = HitInfo_t();
 
-    _hitsUsed    = {0};
+    std::fill_n(_hitsUsed.begin(), _nFiltPoints, 0);
+  }
+
+//-----------------------------------------------------------------------------
+// helix parameters, counters and the first _nFiltPoints entries of _hitsUsed (the
+// others are 0). The hits, the face structure and the owned _helix are not copied:
+// the candidates of a time cluster are fit on one set of hits, and a candidate
+// which doesn't hold them keeps the fit values of its hits with saveHitFits.
+// The diagnostics are copied only if requested
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::copyFrom(const CalHelixFinderData& Data, bool CopyDiag) {
+
+    _timeCluster     = Data._timeCluster;
+    _timeClusterPtr  = Data._timeClusterPtr;
+
+    _helicity        = Data._helicity;
+
+    _goodhits        = Data._goodhits;
+
+    _seedIndex       = Data._seedIndex;
+    _candIndex       = Data._candIndex;
+
+    _nStrawHits      = Data._nStrawHits;
+    _nComboHits      = Data._nComboHits;
+
+    _nXYSh           = Data._nXYSh;
+    _nZPhiSh         = Data._nZPhiSh;
+
+    _helixChi2       = Data._helixChi2;
+
+    _tpart           = Data._tpart;
+    _fdir            = Data._fdir;
+
+    _chcol           = Data._chcol;
+    _chstore         = Data._chstore;
+    _shfcol          = Data._shfcol;
+
+    _fit             = Data._fit;
+
+    _sxy             = Data._sxy;
+    _szphi           = Data._szphi;
+
+    _center          = Data._center;
+    _radius          = Data._radius;
+
+    _dfdz            = Data._dfdz;
+    _fz0             = Data._fz0;
+
+    if (CopyDiag) _diag = Data._diag;
+
+    std::copy_n(Data._hitsUsed.begin(), Data._nFiltPoints, _hitsUsed.begin());
+    if (_nFiltPoints > Data._nFiltPoints) {
+      std::fill(_hitsUsed.begin()+Data._nFiltPoints, _hitsUsed.begin()+_nFiltPoints, 0);
+    }
+
+    _nFiltPoints     = Data._nFiltPoints;
+    _nFiltStrawHits  = Data._nFiltStrawHits;
   }
 
+//-----------------------------------------------------------------------------
+// the fits read the phi and the weights of a hit only after setting them, except
+// for the hits already used by the helix, so these are the only ones to keep
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::saveHitFits(const CalHelixFinderData& Helix) {
+    _hitFits.clear();
+    for (int i=0; i<Helix._nFiltPoints; ++i) {
+      if (Helix._hitsUsed[i] == 0)                        continue;
+      const ComboHit* hit = &Helix._chHitsToProcess[i];
+      _hitFits.push_back(HitFit_t{i, hit->_hphi, hit->_xyWeight, hit->_zphiWeight});
+    }
+  }
+
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::restoreHitFits(const CalHelixFinderData& Candidate) {
+    for (const HitFit_t& hf : Candidate._hitFits) {
+      ComboHit* hit    = &_chHitsToProcess[hf.index];
+      hit->_hphi       = hf.hphi;
+      hit->_xyWeight   = hf.xyWeight;
+      hit->_zphiWeight = hf.zphiWeight;
+    }
+  }
+
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::swapHits(CalHelixFinderData& Data) {
+    _chHitsToProcess.swap(Data._chHitsToProcess);
+    _chFlags.swap(Data._chFlags);
+    _oTracker.swap(Data._oTracker);
+  }
+
+//-----------------------------------------------------------------------------
+// the fits flag outliers on the hits
+//-----------------------------------------------------------------------------
+  void CalHelixFinderData::resetHitFlags() {
+    for (size_t i=0; i<_chFlags.size(); ++i) _chHitsToProcess[i]._flag = _chFlags[i];
+  }
 
 //-----------------------------------------------------------------------------
   void CalHelixFinderData::print(const char* Title) {
@@ -55,6 +55,7 @@ namespace mu2e {
     _debugLevel(config().debugLevel()),
     _printfreq(config().printfreq()),
     _shLabel(config().shLabel()),
+    _chsLabel(config().chsLabel()),
     _timeclLabel(config().timeclLabel()),
     _minNHitsTimeCluster(config().minNHitsTimeCluster()),
     _fitparticle(config().fitparticle()),
@@ -63,6 +64,7 @@ namespace mu2e {
     _maxEDepAvg(config().maxEDepAvg()),
     _hfinder(config().hfinder()){
       consumes<ComboHitCollection>(_shLabel);
+      consumes<ComboHitStore>(_chsLabel);
       consumes<TimeClusterCollection>(_timeclLabel);
 
       std::vector<int> helvals = config().Helicities();
@@ -150,6 +152,9 @@ namespace mu2e {
         _hfResult._phiPanel[faceId*FaceZ_t::kNPanels + op] = TVector2::Phi_0_2pi(polyAtan2(panel->straw0MidPoint().y(),panel->straw0MidPoint().x()));
       }
     }
+                                        // the helices are fit on _tmpResult
+    _tmpResult._zFace    = _hfResult._zFace;
+    _tmpResult._phiPanel = _hfResult._phiPanel;
 
     if (_debugLevel > 10){
       printf("//----------------------------------------------//\n");
@@ -183,6 +188,22 @@ namespace mu2e {
              _shLabel.data());
     }
 
+//-----------------------------------------------------------------------------
+// use the ComboHitStore of the event if it was made from the hits, otherwise
+// make it here. Only its z and time order is used, the time bin is arbitrary
+//-----------------------------------------------------------------------------
+    _chstore = 0;
+    if (_chcol != 0) {
+      art::Handle<ComboHitStore> chsH;
+      if (evt.getByLabel(_chsLabel, chsH) && chsH->matches(*_chcol,_strawhitsH.id())) {
+        _chstore = chsH.product();
+      }
+      else {
+        _localStore.fill(*_chcol,_strawhitsH.id(),40.);
+        _chstore = &_localStore;
+      }
+    }
+
     // art::Handle<mu2e::StrawHitPositionCollection> shposH;
     // if (evt.getByLabel(_shpLabel,shposH)) {
     //   _shpcol = shposH.product();
@@ -246,6 +267,7 @@ namespace mu2e {
     _hfResult._tpart  = _tpart;
     _hfResult._fdir   = _fdir;
     _hfResult._chcol  = _chcol;
+    _hfResult._chstore = _chstore;
     // _hfResult._shpos  = _shpcol;
     //_hfResult._shfcol = _shfcol;
 
@@ -274,26 +296,32 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
 // Step 1: now loop over the two possible helicities.
 //         Find initial helical approximation of a track for both hypothesis
+//         on the hits moved to _tmpResult; the outlier flags set by one
+//         hypothesis are reset before the next one
 //-----------------------------------------------------------------------------
+      _tmpResult.swapHits(_hfResult);
+
       std::vector<float> nHitsRatio_vec;
       for (size_t i=0; i<_hels.size(); ++i){
 //-----------------------------------------------------------------------------
 // create track definitions for the helix fit from this initial information
 // track fitting objects for this peak
 //-----------------------------------------------------------------------------
-        CalHelixFinderData tmpResult(_hfResult);
-        tmpResult.clearHelixInfo();
+        if (i > 0) _tmpResult.resetHitFlags();
+        _tmpResult.deleteHelix();
+        _tmpResult.copyFrom(_hfResult, _diagLevel > 0);
+        _tmpResult.clearHelixInfo();
 
-        tmpResult._helicity       = _hels[i];
+        _tmpResult._helicity       = _hels[i];
 
-        int rc = _hfinder.findHelix(tmpResult);
+        int rc = _hfinder.findHelix(_tmpResult);
 
         if (!rc)                         continue;
         HelixSeed     tmp_helix_seed;
 
-        initHelixSeed(tmp_helix_seed, tmpResult);
+        initHelixSeed(tmp_helix_seed, _tmpResult);
         if (_diagLevel > 0) {
-          nHitsRatio_vec.push_back(tmpResult._diag.nHitsRatio);
+          nHitsRatio_vec.push_back(_tmpResult._diag.nHitsRatio);
         }
         if (tmp_helix_seed._eDepAvg > _maxEDepAvg) continue;
         helix_seed_vec.push_back(tmp_helix_seed);
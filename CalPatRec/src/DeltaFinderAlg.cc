@@ -3,6 +3,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "Offline/CalPatRec/inc/DeltaFinderAlg.hh"
 
+#include "tbb/parallel_for.h"
+
 namespace mu2e {
 
   using namespace DeltaFinderTypes;
@@ -44,7 +46,8 @@ namespace mu2e {
     _testOrder             (config().testOrder()        ),
     _testHitMask           (config().testHitMask()      ),
     _goodHitMask           (config().goodHitMask()      ),
-    _bkgHitMask            (config().bkgHitMask()       )
+    _bkgHitMask            (config().bkgHitMask()       ),
+    _concurrentStations    (config().concurrentStations())
   {
 
     _data    = Data;
@@ -218,6 +221,8 @@ namespace mu2e {
 
     FaceZ_t* fz1 = _data->faceData(Station,Face);
     int      nh1 = fz1->fHitData.size();
+
+    const TrackerTopology& topology = _data->tracker->topology();
 //-----------------------------------------------------------------------------
 // modulo misalignments, panels in stations 2 and 3 are oriented exactly the same
 // way as in stations 0 and 1, etc
@@ -237,12 +242,6 @@ namespace mu2e {
       const ComboHit* ch1 = hd1->fHit;
       int   seed_found    = 0;
 //-----------------------------------------------------------------------------
-// panels 0,2,4 are panels 0,1,2 in the first  (#0) face of a plane
-// panels 1,3,5 are panels 0,1,2 in the second (#1) face
-//-----------------------------------------------------------------------------
-      int    ip1 = ch1->strawId().panel() / 2;
-      Pzz_t* pz1 = fz1->Panel(ip1);
-//-----------------------------------------------------------------------------
 // figure out the first and the last timing bins to loop over
 // loop over 3 bins (out of > 20) - the rest cant contain hits of interest
 //-----------------------------------------------------------------------------
@@ -287,13 +286,9 @@ namespace mu2e {
           float dtcorr = hd1->fCorrTime-hd2->fCorrTime;
           if (fabs(dtcorr) > _maxDriftTime)                           continue;
 //-----------------------------------------------------------------------------
-// 'ip2' - panel index within its face
 // check overlap in phi between the panels coresponding to the wires - 120 deg
 //-----------------------------------------------------------------------------
-          int    ip2  = ch2->strawId().panel() / 2;
-          Pzz_t* pz2  = fz2->Panel(ip2);
-          float  n1n2 = pz1->nx*pz2->nx+pz1->ny*pz2->ny;
-          if (n1n2 < -0.5)                                            continue;
+          if (not topology.looseOverlap(ch1->strawId(),ch2->strawId())) continue;
 //-----------------------------------------------------------------------------
 // hits are consistent in time,
 //-----------------------------------------------------------------------------
@@ -396,16 +391,28 @@ namespace mu2e {
 // TODO: update the time as more hits are added
 //-----------------------------------------------------------------------------
   void DeltaFinderAlg::findSeeds() {
+//-----------------------------------------------------------------------------
+// a station's seeds are made of the station's hits only and are stored in the
+// station's own seed lists, so the stations can be processed concurrently
+// with the same result
+//-----------------------------------------------------------------------------
+    if (_concurrentStations) {
+      tbb::parallel_for(0,int(kNStations),[this](int s) { findStationSeeds(s); });
+    }
+    else {
+      for (int s=0; s<kNStations; ++s) findStationSeeds(s);
+    }
+  }
 
-    for (int s=0; s<kNStations; ++s) {
-      for (int face=0; face<kNFaces-1; face++) {
 //-----------------------------------------------------------------------------
-// find seeds starting from 'face' in a given station 's'
+  void DeltaFinderAlg::findStationSeeds(int Station) {
+    for (int face=0; face<kNFaces-1; face++) {
 //-----------------------------------------------------------------------------
-        findSeeds(s,face);
-      }
-      pruneSeeds(s);
+// find seeds starting from 'face' in a given station
+//-----------------------------------------------------------------------------
+      findSeeds(Station,face);
     }
+    pruneSeeds(Station);
   }
 
 //-----------------------------------------------------------------------------
@@ -628,65 +635,43 @@ namespace mu2e {
 // use only "good" hits
 //-----------------------------------------------------------------------------
   int DeltaFinderAlg::orderHits() {
-    ChannelID cx, co;
 //-----------------------------------------------------------------------------
-// vector of pointers to CH, ordered in time. Initial list is not touched
+// the hit store lists the hits of each Z-ordered face in time order, so the face
+// data are filled without sorting. The collection itself is not touched
 //-----------------------------------------------------------------------------
-    _data->_v.resize(_data->_nComboHits);
-
-    for (int i=0; i<_data->_nComboHits; i++) {
-      _data->_v[i] = &(*_data->chcol)[i];
-    }
+    const ComboHitStore* store = _data->chstore;
 
-    std::sort(_data->_v.begin(), _data->_v.end(),
-              [](const ComboHit*& a, const ComboHit*& b) { return a->time() < b->time(); });
-//-----------------------------------------------------------------------------
-// at this point hits in '_v' are already ordered in time
-//-----------------------------------------------------------------------------
-    for (int ih=0; ih<_data->_nComboHits; ih++) {
-      const ComboHit* ch = _data->_v[ih];
-
-      const StrawHitFlag* flag   = &ch->flag();
-      if (_testHitMask && (! flag->hasAllProperties(_goodHitMask) || flag->hasAnyProperty(_bkgHitMask)) ) continue;
-
-      // float corr_time    = ch->correctedTime();
-
-      cx.Station                 = ch->strawId().station();
-      cx.Plane                   = ch->strawId().plane() % 2;
-      cx.Face                    = -1;
-      cx.Panel                   = ch->strawId().panel();
-//-----------------------------------------------------------------------------
-// get Z-ordered location
-//-----------------------------------------------------------------------------
-      ChannelID::orderID(&cx, &co);
-
-      int os       = co.Station;
-      int of       = co.Face;
-      int op       = co.Panel;
-
-      if (_printErrors) {
-        if ((os < 0) || (os >= kNStations     )) printf(" >>> ERROR: wrong station number: %i\n",os);
-        if ((of < 0) || (of >= kNFaces        )) printf(" >>> ERROR: wrong face    number: %i\n",of);
-        if ((op < 0) || (op >= kNPanelsPerFace)) printf(" >>> ERROR: wrong panel   number: %i\n",op);
-      }
+    for (int os=0; os<kNStations; os++) {
+      for (int of=0; of<kNFaces; of++) {
+        ComboHitStore::Range range = store->faceHits(os,of);
 //-----------------------------------------------------------------------------
 // prototype face-based hit storage
-// hits are already time-ordered - that makes it easy to define fFirst
+// hits are time-ordered - that makes it easy to define fFirst
 // for each face, define multiple time bins and indices of the first and the last
 // hits in each bin
 //-----------------------------------------------------------------------------
-      FaceZ_t* fz  = &_data->fFaceData[os][of];
-      int      loc = fz->fHitData.size();
+        FaceZ_t* fz  = &_data->fFaceData[os][of];
 
-      fz->fHitData.push_back(HitData_t(ch,of));
-      int time_bin = int (ch->time()/_timeBin);
+        for (uint32_t it=range.begin; it<range.end; it++) {
+          uint32_t        ipos = store->timeOrdered(it);
+          const ComboHit* ch   = &(*_data->chcol)[store->index(ipos)];
 
-      if (time_bin < kMaxNTimeBins) {
-        if (fz->fFirst[time_bin] < 0) fz->fFirst[time_bin] = loc;
-        fz->fLast[time_bin] = loc;
-      }
-      else {
-        printf("ERROR in DeltaFinderAlg::orderHits : hist time = %10.3f time_bin=%i TOO LARGE, ignored\n",ch->time(),time_bin);
+          const StrawHitFlag* flag   = &ch->flag();
+          if (_testHitMask && (! flag->hasAllProperties(_goodHitMask) || flag->hasAnyProperty(_bkgHitMask)) ) continue;
+
+          int loc = fz->fHitData.size();
+
+          fz->fHitData.push_back(HitData_t(ch,of));
+          int time_bin = int (store->time(ipos)/_timeBin);
+
+          if (time_bin < kMaxNTimeBins) {
+            if (fz->fFirst[time_bin] < 0) fz->fFirst[time_bin] = loc;
+            fz->fLast[time_bin] = loc;
+          }
+          else {
+            printf("ERROR in DeltaFinderAlg::orderHits : hist time = %10.3f time_bin=%i TOO LARGE, ignored\n",ch->time(),time_bin);
+          }
+        }
       }
     }
 
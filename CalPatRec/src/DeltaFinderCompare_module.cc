@@ -0,0 +1,81 @@
+//
+// Compare the output of 2 DeltaFinder instances run on the same hits, for instance with concurrent and
+// serial station processing: the flags of the output ComboHits and the hits of the output TimeClusters.
+// The job fails on the first difference.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/TimeCluster.hh"
+
+#include <iostream>
+
+namespace mu2e {
+
+  class DeltaFinderCompare : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<art::InputTag> reference{Name("Reference"), Comment("Reference DeltaFinder")};
+        fhicl::Atom<art::InputTag> test{Name("Test"), Comment("DeltaFinder compared to the reference")};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit DeltaFinderCompare(const Parameters& conf);
+
+      void analyze(const art::Event& event) override;
+      void endJob() override;
+
+    private:
+      art::InputTag ref_, test_;
+      size_t nevents_ = 0;
+      size_t nhits_ = 0;
+      size_t nclusters_ = 0;
+  };
+
+  DeltaFinderCompare::DeltaFinderCompare(const Parameters& conf) :
+    art::EDAnalyzer(conf),
+    ref_(conf().reference()),
+    test_(conf().test()) {
+      consumes<ComboHitCollection>(ref_);
+      consumes<TimeClusterCollection>(ref_);
+      consumes<ComboHitCollection>(test_);
+      consumes<TimeClusterCollection>(test_);
+    }
+
+  void DeltaFinderCompare::analyze(const art::Event& event) {
+    auto const& hits = *event.getValidHandle<ComboHitCollection>(ref_);
+    auto const& clusters = *event.getValidHandle<TimeClusterCollection>(ref_);
+    auto const& thits = *event.getValidHandle<ComboHitCollection>(test_);
+    auto const& tclusters = *event.getValidHandle<TimeClusterCollection>(test_);
+    if(hits.size() != thits.size() || clusters.size() != tclusters.size())
+      throw cet::exception("DeltaFinderCompare") << event.id() << ": " << ref_ << " has " << hits.size() << " hits and "
+        << clusters.size() << " clusters, " << test_ << " has " << thits.size() << " and " << tclusters.size() << std::endl;
+    for(size_t ihit=0; ihit < hits.size(); ++ihit){
+      if(!(hits[ihit].flag() == thits[ihit].flag()))
+        throw cet::exception("DeltaFinderCompare") << event.id() << ": hit " << ihit << " flag differs between "
+          << ref_ << " and " << test_ << std::endl;
+    }
+    for(size_t icl=0; icl < clusters.size(); ++icl){
+      if(clusters[icl].hits() != tclusters[icl].hits())
+        throw cet::exception("DeltaFinderCompare") << event.id() << ": cluster " << icl << " hits differ between "
+          << ref_ << " and " << test_ << std::endl;
+    }
+    ++nevents_;
+    nhits_ += hits.size();
+    nclusters_ += clusters.size();
+  }
+
+  void DeltaFinderCompare::endJob() {
+    std::cout << "DeltaFinderCompare: " << ref_ << " and " << test_ << " agree on " << nhits_ << " hits and "
+      << nclusters_ << " clusters in " << nevents_ << " events" << std::endl;
+  }
+}
+
+using mu2e::DeltaFinderCompare;
+DEFINE_ART_MODULE(DeltaFinderCompare)
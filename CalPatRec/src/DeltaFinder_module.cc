@@ -64,6 +64,7 @@ namespace mu2e {
       using Comment = fhicl::Comment;
       fhicl::Atom<art::InputTag>   sschCollTag            {Name("sschCollTag"       )    , Comment("SS ComboHit collection name") };
       fhicl::Atom<art::InputTag>   chCollTag              {Name("chCollTag"         )    , Comment("ComboHit collection Name"   ) };
+      fhicl::Atom<art::InputTag>   chStoreTag             {Name("chStoreTag"        )    , Comment("ComboHitStore of chCollTag, made locally if missing" ) };
       fhicl::Atom<art::InputTag>   sdmcCollTag            {Name("sdmcCollTag"       )    , Comment("StrawDigiMC collection Name") };
       fhicl::Atom<int>             debugLevel             {Name("debugLevel"        )    , Comment("debug level"                ) };
       fhicl::Atom<int>             diagLevel              {Name("diagLevel"         )    , Comment("diag level"                 ) };
@@ -85,6 +86,8 @@ namespace mu2e {
 //-----------------------------------------------------------------------------
     art::InputTag   _sschCollTag;
     art::InputTag   _chCollTag;
+    art::InputTag   _chStoreTag;
+    ComboHitStore   _localStore;               // used when the event has no store of _chCollTag
     art::InputTag   _sdmcCollTag;
 
     int             _writeFilteredComboHits;   // write filtered combo hits
@@ -135,6 +138,7 @@ namespace mu2e {
     art::EDProducer{config},
     _sschCollTag           (config().sschCollTag()       ),
     _chCollTag             (config().chCollTag()         ),
+    _chStoreTag            (config().chStoreTag()        ),
     _sdmcCollTag           (config().sdmcCollTag()       ),
     _writeFilteredComboHits(config().writeFilteredComboHits()    ),
     // _writeStrawHitFlags    (config().writeStrawHitFlags()),
@@ -147,6 +151,7 @@ namespace mu2e {
   {
 
     consumesMany<ComboHitCollection>(); // ??? Necessary because fillStrawHitIndices calls getManyByType.
+    consumes<ComboHitStore>(_chStoreTag);
 
     produces<IntensityInfoTimeCluster>();
 
@@ -207,6 +212,19 @@ namespace mu2e {
     auto sschcH = Evt.getValidHandle<mu2e::ComboHitCollection>(_sschCollTag);
     _sschColl   = sschcH.product();
 
+//-----------------------------------------------------------------------------
+// use the ComboHitStore of the event if there is one made from chcol,
+// otherwise (paths without makeCHS, hits read from a file) make it here
+//-----------------------------------------------------------------------------
+    auto chsH   = Evt.getHandle<mu2e::ComboHitStore>(_chStoreTag);
+    if (chsH.isValid() and chsH->matches(*_data.chcol,chcH.id())) {
+      _data.chstore = chsH.product();
+    }
+    else {
+      _localStore.fill(*_data.chcol,chcH.id(),_finder->_timeBin);
+      _data.chstore = &_localStore;
+    }
+
     return (_data.chcol != nullptr) and (_sschColl != nullptr);
   }
 
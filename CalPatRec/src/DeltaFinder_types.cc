@@ -126,34 +126,6 @@ namespace mu2e {
         }
         stationUsed[ist] = 1;
       }
-//-----------------------------------------------------------------------------
-// precalculate overlaps between panels - 12x12 matrix,
-// use first aand second stations for that
-// a panel covers 120 deg, two panels overlap if n1*n2 > -sin(30 deg) = -0.5
-//-----------------------------------------------------------------------------
-      for (int ich=0; ich<2; ich++) {
-        for (int f1=0; f1<3; f1++) {
-          FaceZ_t* fz1 = &fFaceData[ich][f1];
-          for (int ip1=0; ip1<3; ip1++) {
-            Pzz_t* pz1 = fz1->Panel(ip1);
-            for (int f2=f1+1; f2<4; f2++) {
-              FaceZ_t* fz2 = &fFaceData[ich][f2];
-              for (int ip2=0; ip2<3; ip2++) {
-                Pzz_t* pz2 = fz2->Panel(ip2);
-                float n1n2 = pz1->nx*pz2->nx+pz1->ny*pz2->ny;
-                if (n1n2 >= -0.5-1.e-6) {
-                  panelOverlap[ich][pz1->fID][pz2->fID] = 1;
-                  panelOverlap[ich][pz2->fID][pz1->fID] = 1;
-                }
-                else {
-                  panelOverlap[ich][pz1->fID][pz2->fID] = 0;
-                  panelOverlap[ich][pz2->fID][pz1->fID] = 0;
-                }
-              }
-            }
-          }
-        }
-      }
     }
 //-----------------------------------------------------------------------------
     int Data_t::nSeedsTot() {
@@ -0,0 +1,111 @@
+//
+// Compare the HelixSeeds of 2 helix finders run on the same hits, for instance AgnosticHelixFinder with
+// triplet and hough seeding.  A reference helix is found by the test finder if a test helix shares at
+// least a given fraction of its hits.  The fraction of reference helices found and the number of test
+// helices with no reference partner are printed at the end of the job.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/RecoDataProducts/inc/HelixSeed.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace mu2e {
+
+  class HelixSeedCompare : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<art::InputTag> reference{Name("Reference"), Comment("Reference HelixSeed producer")};
+        fhicl::Atom<art::InputTag> test{Name("Test"), Comment("HelixSeed producer compared to the reference")};
+        fhicl::Atom<float> minSharedFraction{Name("MinSharedFraction"), Comment("Fraction of the reference helix hits a test helix must share"), 0.5};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit HelixSeedCompare(const Parameters& conf);
+
+      void analyze(const art::Event& event) override;
+      void endJob() override;
+
+    private:
+      typedef std::vector<uint16_t> HitList;
+      // the hits of a helix, as sorted indices into the collection the helix finder read
+      static HitList helixHits(HelixSeed const& hseed);
+      static size_t nShared(HitList const& hits1, HitList const& hits2);
+
+      art::InputTag ref_, test_;
+      float minfrac_;
+      size_t nevents_ = 0;
+      size_t nref_ = 0;
+      size_t ntest_ = 0;
+      size_t nfound_ = 0;
+      size_t nextra_ = 0;
+  };
+
+  HelixSeedCompare::HelixSeedCompare(const Parameters& conf) :
+    art::EDAnalyzer(conf),
+    ref_(conf().reference()),
+    test_(conf().test()),
+    minfrac_(conf().minSharedFraction()) {
+      consumes<HelixSeedCollection>(ref_);
+      consumes<HelixSeedCollection>(test_);
+    }
+
+  HelixSeedCompare::HitList HelixSeedCompare::helixHits(HelixSeed const& hseed) {
+    HitList hits;
+    for(auto const& hit : hseed.hits())
+      for(size_t ich=0; ich < hit.nCombo(); ++ich) hits.push_back(hit.index(ich));
+    std::sort(hits.begin(),hits.end());
+    return hits;
+  }
+
+  size_t HelixSeedCompare::nShared(HitList const& hits1, HitList const& hits2) {
+    size_t nshared(0);
+    auto ihit1 = hits1.begin();
+    auto ihit2 = hits2.begin();
+    while(ihit1 != hits1.end() && ihit2 != hits2.end()){
+      if(*ihit1 < *ihit2) ++ihit1;
+      else if(*ihit2 < *ihit1) ++ihit2;
+      else { ++nshared; ++ihit1; ++ihit2; }
+    }
+    return nshared;
+  }
+
+  void HelixSeedCompare::analyze(const art::Event& event) {
+    auto const& refhelices = *event.getValidHandle<HelixSeedCollection>(ref_);
+    auto const& testhelices = *event.getValidHandle<HelixSeedCollection>(test_);
+    std::vector<HitList> refhits, testhits;
+    for(auto const& hseed : refhelices) refhits.push_back(helixHits(hseed));
+    for(auto const& hseed : testhelices) testhits.push_back(helixHits(hseed));
+    std::vector<bool> matched(testhits.size(),false);
+    for(auto const& rhits : refhits){
+      bool found(false);
+      for(size_t itest=0; itest < testhits.size(); ++itest){
+        if(nShared(rhits,testhits[itest]) >= minfrac_*rhits.size()){
+          found = true;
+          matched[itest] = true;
+        }
+      }
+      if(found)++nfound_;
+    }
+    ++nevents_;
+    nref_ += refhits.size();
+    ntest_ += testhits.size();
+    nextra_ += std::count(matched.begin(),matched.end(),false);
+  }
+
+  void HelixSeedCompare::endJob() {
+    std::cout << "HelixSeedCompare: " << nevents_ << " events, " << nref_ << " " << ref_ << " helices, " << ntest_
+      << " " << test_ << " helices; " << nfound_ << " reference helices found (efficiency "
+      << (nref_ > 0 ? double(nfound_)/nref_ : 0.0) << "), " << nextra_ << " test helices not in the reference" << std::endl;
+  }
+}
+
+using mu2e::HelixSeedCompare;
+DEFINE_ART_MODULE(HelixSeedCompare)
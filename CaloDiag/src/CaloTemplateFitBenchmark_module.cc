@@ -0,0 +1,195 @@
+//
+// Timing and resolution of the calorimeter template fit (CaloTemplateWFUtil, Levenberg-Marquardt) against a
+// TMinuit MIGRAD fit of the same function, as done by CaloTemplateWFUtil before.
+//
+// Waveforms are generated at beginRun from the calorimeter pulse shape: a baseline, 1 peak or, for a fraction
+// of them, a pile-up peak, and gaussian noise. Both fits start from the same smeared true parameters. The time
+// per fit, the amplitude and time resolution of single peaks, and the chi2 difference between the fits are printed.
+//
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Run.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/CaloReco/inc/CaloTemplateWFUtil.hh"
+#include "Offline/Mu2eUtilities/inc/CaloPulseShape.hh"
+
+#include "TMinuit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // TMinuit objective, identical to the former CaloTemplateWFUtil one
+    unsigned                    npTot_(0);
+    std::vector<double>         xvec_{},yvec_{};
+    const mu2e::CaloPulseShape* pulseShapePtr_(nullptr);
+
+    void myfcn(int&, double*, double& f, double* par, int)
+    {
+        f=0;
+        for (unsigned i=0;i<xvec_.size();++i)
+        {
+            double val(par[0]);
+            for (unsigned ip=1; ip+1<npTot_; ip+=2) val += par[ip]*pulseShapePtr_->evaluate(xvec_[i]-par[ip+1]);
+            if (std::abs(par[0]) > 1e-5) f += (yvec_[i]-val)*(yvec_[i]-val)/par[0];
+        }
+    }
+
+    struct Resolution
+    {
+        void   add(double x) {sum_ += x; sum2_ += x*x; ++n_;}
+        double mean()  const {return n_ > 0 ? sum_/n_ : 0;}
+        double rms()   const {return n_ > 0 ? std::sqrt(std::max(sum2_/n_-mean()*mean(),0.0)) : 0;}
+        double   sum_  = 0;
+        double   sum2_ = 0;
+        unsigned n_    = 0;
+    };
+}
+
+
+namespace mu2e {
+
+  class CaloTemplateFitBenchmark : public art::EDAnalyzer
+  {
+     public:
+        struct Config
+        {
+            using Name    = fhicl::Name;
+            using Comment = fhicl::Comment;
+            fhicl::Atom<unsigned> nWaveforms     { Name("nWaveforms"),     Comment("Number of generated waveforms"), 20000 };
+            fhicl::Atom<unsigned> nSamples       { Name("nSamples"),       Comment("Number of samples per waveform"), 40 };
+            fhicl::Atom<double>   digiSampling   { Name("digiSampling"),   Comment("Digitization time sampling (ns)") };
+            fhicl::Atom<double>   baseline       { Name("baseline"),       Comment("Waveform baseline (ADC)"), 50 };
+            fhicl::Atom<double>   noise          { Name("noise"),          Comment("Gaussian noise (ADC)"), 2 };
+            fhicl::Atom<double>   minAmplitude   { Name("minAmplitude"),   Comment("Smallest generated amplitude (ADC)"), 30 };
+            fhicl::Atom<double>   maxAmplitude   { Name("maxAmplitude"),   Comment("Largest generated amplitude (ADC)"), 1500 };
+            fhicl::Atom<double>   pileUpFraction { Name("pileUpFraction"), Comment("Fraction of waveforms with a second peak"), 0.3 };
+            fhicl::Atom<double>   minPeakAmplitude { Name("minPeakAmplitude"), Comment("Minimum peak amplitude of the template fit") };
+            fhicl::Atom<double>   minDTPeaks     { Name("minDTPeaks"),     Comment("Minimum time difference between peaks of the template fit") };
+            fhicl::Atom<unsigned> seed           { Name("seed"),           Comment("Seed for the waveform generator"), 12345 };
+        };
+
+        explicit CaloTemplateFitBenchmark(const art::EDAnalyzer::Table<Config>& config) : art::EDAnalyzer{config}, conf_(config()) {}
+
+        void beginRun(const art::Run&) override;
+        void analyze(const art::Event&) override {};
+
+     private:
+        Config conf_;
+  };
+
+
+  void CaloTemplateFitBenchmark::beginRun(const art::Run&)
+  {
+      const double sampling = conf_.digiSampling();
+      CaloPulseShape pulseShape(sampling);
+      pulseShape.buildShapes();
+      pulseShapePtr_ = &pulseShape;
+      CaloTemplateWFUtil fitter(conf_.minPeakAmplitude(),sampling,conf_.minDTPeaks(),-1);
+      fitter.initialize();
+
+      std::mt19937 gen(conf_.seed());
+      std::normal_distribution<double>       gaus(0.0,1.0);
+      std::uniform_real_distribution<double> flat(0.0,1.0);
+
+      const unsigned nsamples = conf_.nSamples();
+      const double t0   = 0.0;
+      const double tmin = t0 + 0.25*nsamples*sampling;
+      const double tmax = t0 + 0.5*nsamples*sampling;
+      std::vector<double> x(nsamples), y(nsamples), par0;
+      for (unsigned i=0;i<nsamples;++i) x[i] = t0 + (i+0.5)*sampling;
+      xvec_ = x;
+
+      Resolution ampLM, timeLM, ampMinuit, timeMinuit, dchi2;
+      double tLM(0), tMinuit(0), maxdchi2(0);
+      unsigned nworse(0);
+      for (unsigned iwf=0;iwf<conf_.nWaveforms();++iwf)
+      {
+          // generate the waveform
+          double amp   = conf_.minAmplitude() + flat(gen)*(conf_.maxAmplitude()-conf_.minAmplitude());
+          double time  = tmin + flat(gen)*(tmax-tmin);
+          bool   pileUp = flat(gen) < conf_.pileUpFraction();
+          double amp2  = pileUp ? 0.5*(conf_.minAmplitude() + flat(gen)*(conf_.maxAmplitude()-conf_.minAmplitude())) : 0.0;
+          double time2 = time + 2*conf_.minDTPeaks()*(0.5+flat(gen));
+          for (unsigned i=0;i<nsamples;++i)
+          {
+             double val = conf_.baseline() + amp*pulseShape.evaluate(x[i]-time) + amp2*pulseShape.evaluate(x[i]-time2);
+             y[i] = std::round(val + conf_.noise()*gaus(gen));
+          }
+          yvec_ = y;
+
+          // common starting point
+          par0 = {conf_.baseline()+conf_.noise()*gaus(gen), amp*(1+0.1*gaus(gen)), time+0.5*sampling*gaus(gen)};
+          if (pileUp) {par0.push_back(amp2*(1+0.1*gaus(gen))); par0.push_back(time2+0.5*sampling*gaus(gen));}
+
+          // Levenberg-Marquardt
+          auto start = std::chrono::steady_clock::now();
+          fitter.reset();
+          fitter.setXYVector(x,y);
+          fitter.setPar(par0);
+          fitter.fit();
+          tLM += std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now()-start).count();
+
+          // Minuit
+          start = std::chrono::steady_clock::now();
+          npTot_ = par0.size();
+          TMinuit minuit(npTot_);
+          minuit.SetFCN(myfcn);
+          int ierr(0);
+          double arglist[2] = {-1,0};
+          minuit.mnexcm("SET PRI", arglist ,1,ierr);
+          arglist[0] = 1;
+          minuit.mnexcm("SET NOW", arglist, 1, ierr);
+          minuit.mnexcm("SET STR", arglist ,1,ierr);
+          for (unsigned ip=0;ip<npTot_;++ip) minuit.mnparm(ip, ("par "+std::to_string(ip)).c_str(), par0[ip], 0.001, 0, 1e6, ierr);
+          arglist[0] = 2000;
+          arglist[1] = 0.1;
+          minuit.mnexcm("MIGRAD", arglist ,2,ierr);
+          tMinuit += std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now()-start).count();
+
+          std::vector<double> parMinuit(npTot_), errMinuit(npTot_);
+          for (unsigned ip=0;ip<npTot_;++ip) minuit.GetParameter(ip,parMinuit[ip],errMinuit[ip]);
+          double fmin(0), edm(0), errdef(0);
+          int nvpar(0), nparx(0), istat(0);
+          minuit.mnstat(fmin,edm,errdef,nvpar,nparx,istat);
+
+          // compare the fits only when no component has been removed
+          if (fitter.par().size() == npTot_)
+          {
+             double diff = fitter.chi2()-fmin;
+             dchi2.add(diff);
+             maxdchi2 = std::max(maxdchi2,diff);
+             if (diff > 0.1) ++nworse;
+          }
+          if (!pileUp && fitter.nPeaks() == 1)
+          {
+             ampLM.add(fitter.par()[1]/amp-1);
+             timeLM.add(fitter.par()[2]-time);
+             ampMinuit.add(parMinuit[1]/amp-1);
+             timeMinuit.add(parMinuit[2]-time);
+          }
+      }
+      pulseShapePtr_ = nullptr;
+
+      unsigned nwf = std::max(1u,conf_.nWaveforms());
+      std::cout<<std::setprecision(4)
+               <<"CaloTemplateFitBenchmark "<<conf_.nWaveforms()<<" waveforms, us/fit: LM "<<tLM/nwf<<" TMinuit "<<tMinuit/nwf<<std::endl
+               <<"  single peak amplitude bias/resolution: LM "<<ampLM.mean()<<" / "<<ampLM.rms()
+               <<" TMinuit "<<ampMinuit.mean()<<" / "<<ampMinuit.rms()<<std::endl
+               <<"  single peak time bias/resolution (ns): LM "<<timeLM.mean()<<" / "<<timeLM.rms()
+               <<" TMinuit "<<timeMinuit.mean()<<" / "<<timeMinuit.rms()<<std::endl
+               <<"  chi2(LM)-chi2(TMinuit): mean "<<dchi2.mean()<<" max "<<maxdchi2
+               <<", LM worse by more than 0.1 in "<<nworse<<" of "<<dchi2.n_<<" fits"<<std::endl;
+  }
+}
+
+DEFINE_ART_MODULE(mu2e::CaloTemplateFitBenchmark)
@@ -6,7 +6,7 @@
 // Each peak in the waveform is described by two parameters: amplitide and peak time
 // For a single peak, the amplitude can be found analytically for a given start time, and a
 // quasi-Netwon method can be used to fit the waveform.
-// If there are more than one peak, we use a generic gradient descent method, namely minuit.
+// If there are more than one peak, we use a generic Levenberg-Marquardt fit (see CaloTemplateWFUtil).
 //
 // There is an additional option to refit the leding edge of the first peak to improve
 // timing accuracy
@@ -89,6 +89,9 @@ namespace mu2e {
        std::vector<double> resAmpErr_;
        std::vector<double> resTime_;
        std::vector<double> resTimeErr_;
+       std::vector<double> parInit_;    // work space for the peak finding, reused between waveforms
+       std::vector<double> ysub_;
+       std::vector<double> ywork_;
 
        TH1F* _hTime;
        TH1F* _hTimeErr;
@@ -1,6 +1,11 @@
 #ifndef CaloTemplateWFUtil_HH
 #define CaloTemplateWFUtil_HH
 
+// Fit of a waveform to a baseline plus a sum of pulse templates, each with an amplitude and a peak time.
+// The minimization is a Levenberg-Marquardt fit of the modified chi2 (see note in the .cc file). All the fit
+// state and work space are owned by the instance and reused from one waveform to the next, so different
+// instances can be used concurrently.
+
 #include "Offline/Mu2eUtilities/inc/CaloPulseShape.hh"
 #include <vector>
 #include <string>
@@ -46,13 +51,20 @@ namespace mu2e {
 
      private:
         bool                selectComponent(const std::vector<double>& tempPar, const std::vector<double>& tempErr, unsigned ip);
+        double              fitFunction    (double x, const double* par, unsigned npar) const;
+        double              objective      (const double* par, unsigned npar, bool derivatives);
+        unsigned            minimize       (unsigned npar, double& fmin);
 
         CaloPulseShape      pulseCache_;
         double              minPeakAmplitude_;
         double              minDTPeaks_;
-        int                 fitStrategy_;
+        int                 fitStrategy_;   // Minuit strategy, kept for configuration compatibility
         int                 diagLevel_;
         int                 printLevel_;
+        std::vector<double> xvec_;
+        std::vector<double> yvec_;
+        unsigned            x0_;
+        unsigned            x1_;
         std::vector<double> param_;
         std::vector<double> paramErr_;
         unsigned            nParTot_;
@@ -60,6 +72,19 @@ namespace mu2e {
         unsigned            nParBkg_;
         double              chi2_;
         unsigned            status_;
+
+        // minimization work space, sized for the largest fit seen so far
+        std::vector<bool>   parFree_;
+        std::vector<double> deriv_;
+        std::vector<double> jtj_;
+        std::vector<double> jtr_;
+        std::vector<double> rhs_;
+        std::vector<double> hess_;
+        std::vector<double> step_;
+        std::vector<double> trial_;
+        std::vector<double> tempPar_;
+        std::vector<double> tempErr_;
+        double              sumSq_;
   };
 
 }
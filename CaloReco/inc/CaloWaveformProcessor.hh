@@ -3,12 +3,26 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
 
 namespace mu2e {
 
   class CaloWaveformProcessor {
 
      public:
+        // a peak found by the batch extraction
+        struct Peak
+        {
+           size_t index;  // index of the waveform in the batch
+           double amplitude;
+           double amplitudeErr;
+           double time;
+           double timeErr;
+           double chi2;
+           int    ndf;
+           bool   isPileUp;
+        };
+
         virtual ~CaloWaveformProcessor() {};
 
         virtual void     initialize() = 0;
@@ -24,6 +38,15 @@ namespace mu2e {
         virtual double   time(unsigned int i)         const = 0;
         virtual double   timeErr(unsigned int i)      const = 0;
         virtual bool     isPileUp(unsigned int i)     const = 0;
+
+        // extract the peaks of a batch of waveforms, sample i of waveform j being at time t0s[j]+(i+0.5)*sampling.
+        // The peaks are appended to peaks, in waveform order
+        void             extractBatch(const std::vector<const std::vector<int>*>& waveforms, const std::vector<double>& t0s,
+                                      double sampling, std::vector<Peak>& peaks);
+
+     private:
+        std::vector<double> xBuffer_;
+        std::vector<double> yBuffer_;
    };
 
 }
@@ -93,6 +93,9 @@ namespace mu2e {
         int                                          maxPlots_;
         int                                          diagLevel_;
         std::unique_ptr<CaloWaveformProcessor>       waveformProcessor_;
+        std::vector<const std::vector<int>*>         waveforms_;
+        std::vector<double>                          t0s_;
+        std::vector<CaloWaveformProcessor::Peak>     peaks_;
   };
 
 
@@ -133,45 +136,37 @@ namespace mu2e {
       const auto& caloDigis = *caloDigisHandle;
       ConditionsHandle<CalorimeterCalibrations> calorimeterCalibrations("ignored");
 
-      double totEnergyReco(0);
-      std::vector<double> x{},y{};
+      // process all the waveforms in one batch
+      waveforms_.clear();
+      t0s_.clear();
+      peaks_.clear();
       for (const auto& caloDigi : caloDigis)
       {
-          int    SiPMID   = caloDigi.SiPMID();
-          double t0       = caloDigi.t0();
+          waveforms_.push_back(&caloDigi.waveform());
+          t0s_.push_back(caloDigi.t0());
+      }
+      waveformProcessor_->extractBatch(waveforms_, t0s_, digiSampling_, peaks_);
+
+      double totEnergyReco(0);
+      for (const auto& peak : peaks_)
+      {
+          int    SiPMID   = caloDigis[peak.index].SiPMID();
           double adc2MeV  = calorimeterCalibrations->ADC2MeV(SiPMID);
-          const std::vector<int>& waveform = caloDigi.waveform();
-
-          size_t index = &caloDigi - &caloDigis.front();
-          art::Ptr<CaloDigi> caloDigiPtr(caloDigisHandle, index);
-
-          x.clear();y.clear();
-          for (unsigned int i=0;i<waveform.size();++i)
-          {
-              x.push_back(t0 + (i+0.5)*digiSampling_); // add 0.5 to be in middle of bin
-              y.push_back(waveform.at(i));
-          }
-
-          waveformProcessor_->reset();
-          waveformProcessor_->extract(x,y);
-          if (diagLevel_ > 2) std::cout<<"CaloRecoDigiMaker found "<<waveformProcessor_->nPeaks()<<" peaks for SiPMID="<<SiPMID<<std::endl;
-
-          for (int i=0;i<waveformProcessor_->nPeaks();++i)
-          {
-              double eDep      = waveformProcessor_->amplitude(i)*adc2MeV;
-              double eDepErr   = waveformProcessor_->amplitudeErr(i)*adc2MeV;
-              double time      = waveformProcessor_->time(i) - pbtOffset; // correct to time since protons
-              double timeErr   = waveformProcessor_->timeErr(i);
-              bool   isPileUp  = waveformProcessor_->isPileUp(i);
-              double chi2      = waveformProcessor_->chi2();
-              int    ndf       = waveformProcessor_->ndf();
-
-              if (diagLevel_ > 2) std::cout<<"Found reco digi hit with eDep="<<eDep<<"  time="<<time<<" chi2="<<chi2<<"  ndf="<<ndf<<std::endl;
-              if (chi2/float(ndf) > maxChi2Cut_) continue;
-
-              if (SiPMID%2==0) totEnergyReco += eDep;
-              recoCaloHits.emplace_back(CaloRecoDigi(caloDigiPtr, eDep, eDepErr, time, timeErr, chi2, ndf, isPileUp));
-          }
+          art::Ptr<CaloDigi> caloDigiPtr(caloDigisHandle, peak.index);
+
+          double eDep      = peak.amplitude*adc2MeV;
+          double eDepErr   = peak.amplitudeErr*adc2MeV;
+          double time      = peak.time - pbtOffset; // correct to time since protons
+          double timeErr   = peak.timeErr;
+          bool   isPileUp  = peak.isPileUp;
+          double chi2      = peak.chi2;
+          int    ndf       = peak.ndf;
+
+          if (diagLevel_ > 2) std::cout<<"Found reco digi hit for SiPMID="<<SiPMID<<" with eDep="<<eDep<<"  time="<<time<<" chi2="<<chi2<<"  ndf="<<ndf<<std::endl;
+          if (chi2/float(ndf) > maxChi2Cut_) continue;
+
+          if (SiPMID%2==0) totEnergyReco += eDep;
+          recoCaloHits.emplace_back(CaloRecoDigi(caloDigiPtr, eDep, eDepErr, time, timeErr, chi2, ndf, isPileUp));
       }
 
       if (diagLevel_ > 1) std::cout<<"[CaloRecoDigiMaker] Total energy reco "<<totEnergyReco <<std::endl;
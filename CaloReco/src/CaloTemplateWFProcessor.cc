@@ -119,17 +119,19 @@ namespace mu2e {
    void CaloTemplateWFProcessor::setPrimaryPeakPar1(const std::vector<double>& xvec, const std::vector<double>& yvecOrig)
    {
         if (windowPeak_ > xvec.size()) return;
-        std::vector<double> parInit{},yvec(yvecOrig);
+        auto& parInit = parInit_;
+        auto& ywork   = ywork_;
+        parInit.clear();
+        ywork.assign(yvecOrig.begin(),yvecOrig.end());
 
         //estimate the noise level with the first few bins
-        if (yvec.size() <= numNoiseBins_) return;
-        float noise= std::accumulate(yvec.begin(),yvec.begin()+numNoiseBins_,0)/float(numNoiseBins_);
+        if (ywork.size() <= numNoiseBins_) return;
+        float noise= std::accumulate(ywork.begin(),ywork.begin()+numNoiseBins_,0)/float(numNoiseBins_);
         parInit.push_back(noise);
-        for (auto& val : yvec) val -= noise;
+        for (auto& val : ywork) val -= noise;
 
         if (diagLevel_>1) std::cout<<"[CaloTemplateWFProcessor] Noise level "<<noise<<std::endl;
 
-        std::vector<double> ywork(yvec);
         for (auto i=windowPeak_;i+windowPeak_<xvec.size();++i)
         {
             if (std::max_element(ywork.begin()+i-windowPeak_,ywork.begin()+i+windowPeak_+1) != ywork.begin()+i) continue;
@@ -165,14 +167,18 @@ namespace mu2e {
    void CaloTemplateWFProcessor::setPrimaryPeakPar2(const std::vector<double>& xvec, const std::vector<double>& yvecOrig)
    {
         if (windowPeak_ > xvec.size()) return;
-        std::vector<double> parInit{},yvec(yvecOrig);
+        auto& parInit = parInit_;
+        auto& yvec    = ysub_;
+        auto& ywork   = ywork_;
+        parInit.clear();
+        yvec.assign(yvecOrig.begin(),yvecOrig.end());
 
         //estimate the noise level with the first few bins
         float noise= std::accumulate(yvec.begin(),yvec.begin()+numNoiseBins_,0)/float(numNoiseBins_);
         parInit.push_back(noise);
         for (auto& val : yvec) val -= noise;
 
-        std::vector<double> ywork(yvec);
+        ywork.assign(yvec.begin(),yvec.end());
         for (auto i=windowPeak_;i<int(xvec.size())-windowPeak_;++i)
         {
             if (std::max_element(ywork.begin()+i-windowPeak_,ywork.begin()+i+windowPeak_+1) != ywork.begin()+i) continue;
@@ -255,10 +261,12 @@ namespace mu2e {
         if (windowPeak_ > xvec.size()) return;
         if (xvec.size() != yvec.size()) throw cet::exception("CATEGORY")<<"CaloTemplateWFProcessor::setSecondaryPeakPar  xvec and yvec must have the same size";
 
-        std::vector<double> ywork(yvec);
+        auto& ywork   = ywork_;
+        auto& parInit = parInit_;
+        ywork.assign(yvec.begin(),yvec.end());
         for (unsigned j=0;j<xvec.size();++j) ywork[j] -= fmutil_.eval_fcn(xvec[j]);
 
-        std::vector<double> parInit(fmutil_.par());
+        parInit = fmutil_.par();
         for (auto i=windowPeak_;i<ywork.size()-windowPeak_;++i)
         {
              if (std::max_element(ywork.begin()+i-windowPeak_,ywork.begin()+i+windowPeak_+1) != ywork.begin()+i) continue;
@@ -1,12 +1,13 @@
 #include "Offline/CaloReco/inc/CaloTemplateWFUtil.hh"
 #include "Offline/Mu2eUtilities/inc/CaloPulseShape.hh"
 
-#include "TMinuit.h"
 #include "TF1.h"
 #include "TH2.h"
 #include "TCanvas.h"
 
 #include <algorithm>
+#include <cmath>
+#include <iostream>
 #include <vector>
 #include <sstream>
 
@@ -15,35 +16,56 @@
 // Instead of using the full covariance matrix, one can obtain similr results if the expected numnber of events
 // in a bin is replaced by the background estimate, and the uncertainty on the efficiency is modified to account for
 // the signal (see doc-db 36707 for a full explanation)
+//
+// The function minimized is therefore f = sum (y-F)^2/b, where F is the model and b the baseline. The minimization is
+// a Levenberg-Marquardt fit using the exact gradient of f and the approximate Hessian 2 J^T J/b, J being the derivatives
+// of F. As in the former Minuit fit, the parameters are bounded to [0,1e6] and their errors are taken from the inverse
+// Hessian for an error definition UP=1.
 
 
-//An anonymous namespace to use Minuit
 namespace
 {
-    unsigned              npTot_(0),npFcn_(0),npBkg_(0),x0_(0),x1_(0);
-    std::vector<double>   xvec_{},yvec_{};
-    mu2e::CaloPulseShape* pulseCachePtr_=(nullptr);
-
-    double logn(double x, double *par) {return par[0]*pulseCachePtr_->evaluate(x-par[1]); }
-
-    double fitfunction(double x, double *par)
+    constexpr double   parMin_(0.0);
+    constexpr double   parMax_(1e6);
+    constexpr double   minBaseline_(1e-5);  // the modified chi2 is not defined below
+    constexpr double   edmTolerance_(1e-4); // same as MIGRAD with tolerance 0.1
+    constexpr double   maxLambda_(1e10);
+    constexpr unsigned maxIterations_(200);
+
+    // in place Cholesky decomposition of the symmetric positive definite n x n matrix a into its lower triangle L
+    bool cholesky(double* a, unsigned n)
     {
-        double result(par[0]);
-        for (unsigned i=npBkg_; i<npTot_; i+=npFcn_) result += logn(x,&par[i]);
-        return result;
+        for (unsigned j=0;j<n;++j)
+        {
+            double d = a[j*n+j];
+            for (unsigned k=0;k<j;++k) d -= a[j*n+k]*a[j*n+k];
+            if (!(d > 0)) return false;
+            d = std::sqrt(d);
+            a[j*n+j] = d;
+            for (unsigned i=j+1;i<n;++i)
+            {
+                double s = a[i*n+j];
+                for (unsigned k=0;k<j;++k) s -= a[i*n+k]*a[j*n+k];
+                a[i*n+j] = s/d;
+            }
+        }
+        return true;
     }
-    double fitfunctionPlot(double* x, double *par) {return fitfunction(x[0],par);}
 
-    void myfcn(int& npar, double* , double &f, double *par, int)
+    // solve L L^T x = b, overwriting b with x
+    void choleskySolve(const double* l, double* b, unsigned n)
     {
-        f=0;
-        for (unsigned i=x0_;i<x1_;++i)
+        for (unsigned i=0;i<n;++i)
+        {
+            double s = b[i];
+            for (unsigned k=0;k<i;++k) s -= l[i*n+k]*b[k];
+            b[i] = s/l[i*n+i];
+        }
+        for (unsigned i=n;i-- > 0;)
         {
-            double x = xvec_[i];
-            double y = yvec_[i];
-            double val = fitfunction(x, par);
-            // modified fit function
-            if (fabs(par[0]) > 1e-5) f += (y-val)*(y-val)/par[0];
+            double s = b[i];
+            for (unsigned k=i+1;k<n;++k) s -= l[k*n+i]*b[k];
+            b[i] = s/l[i*n+i];
         }
     }
 }
@@ -64,25 +86,26 @@ namespace mu2e {
       fitStrategy_(1),
       diagLevel_(0),
       printLevel_(printLevel),
+      xvec_(),
+      yvec_(),
+      x0_(0),
+      x1_(0),
       param_(),
       paramErr_(),
       nParTot_(3),
       nParFcn_(2),
       nParBkg_(1),
-      chi2_(999.0)
-   {
-      pulseCachePtr_ = &pulseCache_;
-      npTot_ = nParTot_;
-      npFcn_ = nParFcn_;
-      npBkg_ = nParBkg_;
-   }
+      chi2_(999.0),
+      status_(0),
+      sumSq_(0.0)
+   {}
 
 
    //-----------------------------------------------------------------------------------------------------
    void   CaloTemplateWFUtil::initialize ()                                                                 {pulseCache_.buildShapes();}
-   void   CaloTemplateWFUtil::reset      ()                                                                 {param_.clear(); paramErr_.clear(); nParTot_=0; npTot_ = 0;}
-   void   CaloTemplateWFUtil::setXYVector(const std::vector<double>& xvec, const std::vector<double>& yvec) {xvec_ = xvec; yvec_ = yvec; x0_=0; x1_ = xvec_.size();}
-   void   CaloTemplateWFUtil::setPar     (const std::vector<double>& par)                                   {param_ = par; nParTot_ = npTot_ = par.size();}
+   void   CaloTemplateWFUtil::reset      ()                                                                 {param_.clear(); paramErr_.clear(); nParTot_=0;}
+   void   CaloTemplateWFUtil::setXYVector(const std::vector<double>& xvec, const std::vector<double>& yvec) {xvec_.assign(xvec.begin(),xvec.end()); yvec_.assign(yvec.begin(),yvec.end()); x0_=0; x1_ = xvec_.size();}
+   void   CaloTemplateWFUtil::setPar     (const std::vector<double>& par)                                   {param_.assign(par.begin(),par.end()); nParTot_ = param_.size();}
 
    //-----------------------------------------------------------------------------------------------------
    void CaloTemplateWFUtil::fit()
@@ -91,31 +114,12 @@ namespace mu2e {
        if (param_.empty() || param_.size()>49 || xvec_.empty()) return;
        if (nParTot_ < nParBkg_  || (nParTot_-nParBkg_)%nParFcn_ !=0) return;
 
-       int ierr(0),nvpar(999), nparx(999), istat(999);
-       double arglist[2]={0,0}, edm(999), errdef(999);
-
-       TMinuit minuit(nParTot_);
-       minuit.SetFCN(myfcn);
-
-       arglist[0] = printLevel_;
-       minuit.mnexcm("SET PRI", arglist ,1,ierr);
-       arglist[0] = 1;
-       minuit.mnexcm("SET NOW", arglist, 1, ierr);
-       arglist[0] = fitStrategy_;
-       minuit.mnexcm("SET STR", arglist ,1,ierr);
-
-       for (unsigned ip=0;ip<nParTot_;++ip)
-       {
-             std::string sss = "par " + std::to_string(ip);
-            minuit.mnparm(ip, sss.c_str(),  param_[ip],  0.001,  0,  1e6, ierr);
-       }
-
        // Perform first fit with initial model
        //
-       arglist[0] = 2000;
-       arglist[1] = 0.1;
-       minuit.mnexcm("MIGRAD", arglist ,2,ierr);
-       //if (!minuit.fCstatu.Contains("CONVERGED")) minuit.mnexcm("MIGRAD", arglist ,2,ierr);
+       parFree_.assign(nParTot_,true);
+       paramErr_.assign(nParTot_,0.0);
+       double fmin(0);
+       unsigned istat = minimize(nParTot_,fmin);
 
 
        // Remove small or "duplicate" components and redo the fit with simplified model if there is more than one peak
@@ -124,54 +128,40 @@ namespace mu2e {
        if (nParTot_ > nParFcn_+nParBkg_)
        {
            bool refit(false);
-           std::vector<double> tempPar(nParTot_,0),tempErr(nParTot_,1);
-           for (unsigned i=0;i<nParTot_;++i) minuit.GetParameter(i,tempPar[i],tempErr[i]);
+           tempPar_ = param_;
+           tempErr_ = paramErr_;
 
            for (unsigned ip=nParBkg_; ip<nParTot_; ip += nParFcn_)
            {
-               if (selectComponent(tempPar,tempErr,ip)) continue;
-               minuit.mnparm(ip,   "fixed par", 0, 0.01, -1e6, 1e6, ierr);
-               minuit.mnparm(ip+1, "fixed par", 0, 0.01, -1e6, 1e6, ierr);
-               minuit.FixParameter(ip);
-               minuit.FixParameter(ip+1);
+               if (selectComponent(tempPar_,tempErr_,ip)) continue;
+               param_[ip]    = param_[ip+1]    = 0.0;
+               paramErr_[ip] = paramErr_[ip+1] = 0.0;
+               parFree_[ip]  = parFree_[ip+1]  = false;
                refit = true;
            }
 
-           if (refit) minuit.mnexcm("MIGRAD", arglist ,2, ierr);
+           if (refit) istat = minimize(nParTot_,fmin);
        }
 
 
        // Save the results - exclude low components
        //
-       param_.clear();
-       paramErr_.clear();
-
-       unsigned i(0);
+       unsigned i(0),j(0);
        while (i<nParTot_)
        {
-           double val(0),err(0);
-           minuit.GetParameter(i,val,err);
-
            //if the amplitude is too small, jump to the next peak
-           if (val<1 && i >=nParBkg_ && (i-nParBkg_)%nParFcn_==0) {i+=nParFcn_;continue;}
+           if (param_[i]<1 && i >=nParBkg_ && (i-nParBkg_)%nParFcn_==0) {i+=nParFcn_;continue;}
 
-           param_.push_back(val);
-           paramErr_.push_back(err);
+           param_[j]    = param_[i];
+           paramErr_[j] = paramErr_[i];
            ++i;
+           ++j;
        }
+       param_.resize(j);
+       paramErr_.resize(j);
 
-       minuit.mnstat(chi2_,edm,errdef,nvpar,nparx,istat);
-
-       //recalculate the chi2 removing the baseline to better reject the noise ?
-       //chi2_=0;
-       //for (unsigned i=x0_;i<x1_;++i)
-       //{
-       //    double val = fitfunction(xvec_[i], &param_[0]);
-       //    if (yvec_[i]>1e-5) chi2_ += (yvec_[i]-val)*(yvec_[i]-val)/(yvec_[i]-param_[0]);
-       //}
-
+       chi2_    = fmin;
        nParTot_ = param_.size();
-       npTot_   = nParTot_;
        status_  = istat;
    }
 
@@ -184,34 +174,25 @@ namespace mu2e {
        if (param_.size()<nParBkg_+nParFcn_ || xvec_.empty()) return;
 
        unsigned imax(0),ilow(0);
-       while (xvec_[imax]<param_[2]) ++imax;
+       while (imax+1<xvec_.size() && xvec_[imax]<param_[2]) ++imax;
        for (unsigned i=imax;i>0;--i) if ((yvec_[i]-param_[0])/(yvec_[imax]-param_[0])>0.1) ilow = i;
        if (imax < ilow+4) return; //need at least 4 points to fit
        x0_ = 0;
        //x0_ = ilow;
        x1_ = imax;
 
-       int ierr(0),nvpar(999), nparx(999), istat(999);
-       double arglist[2]={0,0}, edm(999), errdef(999),chi(9999),val(0),err(0);
-
-       TMinuit minuit(nParBkg_+nParFcn_);
-       minuit.SetFCN(myfcn);
-
-       arglist[0] = printLevel_;
-       minuit.mnexcm("SET PRI", arglist ,1,ierr);
-       arglist[0] = 1;
-       minuit.mnexcm("SET NOW", arglist, 1, ierr);
-       arglist[0] = fitStrategy_;
-       minuit.mnexcm("SET STR", arglist ,1,ierr);
-
-       for (unsigned ip=0;ip<nParBkg_+nParFcn_;++ip) minuit.mnparm(ip, "par",  param_[ip],  0.001, 0,  1e6, ierr);
-
-       arglist[0] = 2000;
-       arglist[1] = 0.1;
-       minuit.mnexcm("MIGRAD", arglist ,2,ierr);
+       // fit the baseline and the first peak, but only keep the new peak time
+       tempPar_ = param_;
+       tempErr_ = paramErr_;
+       unsigned npar = nParBkg_+nParFcn_;
+       parFree_.assign(npar,true);
+       double fmin(0);
+       unsigned istat = minimize(npar,fmin);
 
-       minuit.GetParameter(nParBkg_+1,val,err);
-       minuit.mnstat(chi,edm,errdef,nvpar,nparx,istat);
+       double val = param_[nParBkg_+1];
+       double err = paramErr_[nParBkg_+1];
+       param_    = tempPar_;
+       paramErr_ = tempErr_;
 
        param_[nParBkg_+1]    = val;
        paramErr_[nParBkg_+1] = err;
@@ -221,6 +202,139 @@ namespace mu2e {
        x1_     = xvec_.size();
    }
 
+   //----------------------------------------------------------------------------------
+   // Levenberg-Marquardt minimization of the first npar parameters, fixed parameters keep their values.
+   // Returns the Minuit-like covariance status: 3 for a full covariance matrix, 1 for a diagonal approximation,
+   // 0 if the fit did not converge within maxIterations_ (the errors are then those at the last point)
+   unsigned CaloTemplateWFUtil::minimize(unsigned npar, double& fmin)
+   {
+       unsigned n2 = npar*npar;
+       if (jtj_.size() < n2)      {jtj_.resize(n2); hess_.resize(n2);}
+       if (deriv_.size() < npar)  {deriv_.resize(npar); jtr_.resize(npar); step_.resize(npar); trial_.resize(npar); rhs_.resize(npar);}
+
+       double* par = param_.data();
+       for (unsigned j=0;j<npar;++j) if (parFree_[j]) par[j] = std::min(std::max(par[j], j==0 ? minBaseline_ : parMin_), parMax_);
+
+       double lambda(1e-3);
+       double f = objective(par,npar,true);
+       bool converged(false);
+       unsigned iter(0);
+       for (;iter<maxIterations_ && !converged;++iter)
+       {
+           // minus the gradient of f = S/b
+           double b = par[0];
+           for (unsigned j=0;j<npar;++j) rhs_[j] = parFree_[j] ? 2.0*jtr_[j]/b : 0.0;
+           if (parFree_[0]) rhs_[0] += sumSq_/(b*b);
+
+           bool improved(false);
+           while (!improved && lambda < maxLambda_)
+           {
+               for (unsigned j=0;j<npar;++j)
+                  for (unsigned k=0;k<npar;++k)
+                     hess_[j*npar+k] = (parFree_[j] && parFree_[k]) ? 2.0*jtj_[j*npar+k]/b : double(j==k);
+               for (unsigned j=0;j<npar;++j)
+                  if (parFree_[j]) hess_[j*npar+j] += lambda*std::max(hess_[j*npar+j],1e-6);
+
+               std::copy(rhs_.begin(),rhs_.begin()+npar,step_.begin());
+               if (!cholesky(hess_.data(),npar)) {lambda *= 10; continue;}
+               choleskySolve(hess_.data(),step_.data(),npar);
+
+               for (unsigned j=0;j<npar;++j)
+               {
+                  trial_[j] = par[j];
+                  if (parFree_[j]) trial_[j] = std::min(std::max(par[j]+step_[j], j==0 ? minBaseline_ : parMin_), parMax_);
+               }
+               double ftrial = objective(trial_.data(),npar,false);
+               if (ftrial < f)
+               {
+                  double edm(0);
+                  for (unsigned j=0;j<npar;++j) edm += 0.5*rhs_[j]*step_[j];
+                  converged = (f-ftrial < edmTolerance_ && edm < edmTolerance_);
+                  std::copy(trial_.begin(),trial_.begin()+npar,par);
+                  f = objective(par,npar,true);
+                  lambda = std::max(0.1*lambda,1e-9);
+                  improved = true;
+               }
+               else lambda *= 10;
+           }
+           // no step decreases f: at a minimum (possibly on a bound)
+           if (!improved) converged = true;
+
+           if (printLevel_ > 0) std::cout<<"[CaloTemplateWFUtil::minimize] iteration "<<iter<<" f="<<f<<" lambda="<<lambda<<std::endl;
+       }
+       fmin = f;
+
+       // parameter errors from the covariance p0 (J^T J)^-1 of the free parameters
+       for (unsigned j=0;j<npar;++j)
+          for (unsigned k=0;k<npar;++k)
+             hess_[j*npar+k] = (parFree_[j] && parFree_[k]) ? jtj_[j*npar+k] : double(j==k);
+
+       bool fullCov = cholesky(hess_.data(),npar);
+       unsigned istat = converged ? (fullCov ? 3 : 1) : 0;
+       for (unsigned j=0;j<npar;++j)
+       {
+           paramErr_[j] = 0.0;
+           if (!parFree_[j]) continue;
+           double var(0);
+           if (fullCov)
+           {
+              std::fill(step_.begin(),step_.begin()+npar,0.0);
+              step_[j] = 1.0;
+              choleskySolve(hess_.data(),step_.data(),npar);
+              var = step_[j];
+           }
+           else if (jtj_[j*npar+j] > 0) var = 1.0/jtj_[j*npar+j];
+           paramErr_[j] = std::sqrt(par[0]*var);
+       }
+
+       if (printLevel_ >= 0) std::cout<<"[CaloTemplateWFUtil::minimize] "<<(converged ? "converged" : "not converged")
+                                      <<" after "<<iter<<" iterations, f="<<fmin<<std::endl;
+       return istat;
+   }
+
+   //----------------------------------------------------------------------------------
+   // f = sum (y-F)^2/b over the fit range. Optionally accumulates J^T J and J^T (y-F)
+   double CaloTemplateWFUtil::objective(const double* par, unsigned npar, bool derivatives)
+   {
+       if (derivatives)
+       {
+           std::fill(jtj_.begin(),jtj_.begin()+npar*npar,0.0);
+           std::fill(jtr_.begin(),jtr_.begin()+npar,0.0);
+           deriv_[0] = 1.0;
+       }
+
+       double sum(0);
+       for (unsigned i=x0_;i<x1_;++i)
+       {
+           double x   = xvec_[i];
+           double val = par[0];
+           for (unsigned ip=nParBkg_; ip+nParFcn_<=npar; ip += nParFcn_)
+           {
+               double slope(0);
+               double shape = pulseCache_.evaluate(x-par[ip+1],slope);
+               val += par[ip]*shape;
+               if (derivatives) {deriv_[ip] = shape; deriv_[ip+1] = -par[ip]*slope;}
+           }
+           double res = yvec_[i]-val;
+           sum += res*res;
+
+           if (!derivatives) continue;
+           for (unsigned j=0;j<npar;++j)
+           {
+               if (deriv_[j] == 0.0) continue;
+               jtr_[j] += deriv_[j]*res;
+               for (unsigned k=0;k<=j;++k) jtj_[j*npar+k] += deriv_[j]*deriv_[k];
+           }
+       }
+
+       if (derivatives)
+          for (unsigned j=0;j<npar;++j)
+             for (unsigned k=j+1;k<npar;++k) jtj_[j*npar+k] = jtj_[k*npar+j];
+
+       sumSq_ = sum;
+       return sum/par[0];
+   }
+
    //----------------------------------------------------------------------------------
    bool CaloTemplateWFUtil::selectComponent(const std::vector<double>& tempPar, const std::vector<double>& tempErr, unsigned ip)
    {
@@ -230,7 +344,7 @@ namespace mu2e {
        if (tempErr[ip] >1e3)                                              return false;
 
        //remove peaks close in time with smaller amplitude
-       for (unsigned ip2=nParBkg_; ip2<npTot_; ip2 += nParFcn_)
+       for (unsigned ip2=nParBkg_; ip2<nParTot_; ip2 += nParFcn_)
        {
            if (ip==ip2) continue;
            double dt = std::abs(tempPar[ip2+1]-tempPar[ip+1]);
@@ -243,17 +357,24 @@ namespace mu2e {
 
 
 
+   //----------------------------------------------------------------------
+   double CaloTemplateWFUtil::fitFunction(double x, const double* par, unsigned npar) const
+   {
+       double result(par[0]);
+       for (unsigned i=nParBkg_; i+nParFcn_<=npar; i+=nParFcn_) result += par[i]*pulseCache_.evaluate(x-par[i+1]);
+       return result;
+   }
    //----------------------------------------------------------------------
    double CaloTemplateWFUtil::eval_fcn(double x)
    {
        if (param_.size()<nParFcn_) return 0.0;
-       return fitfunction(x,&param_[0]);
+       return fitFunction(x,&param_[0],param_.size());
    }
    //------------------------------------------------------------
    double CaloTemplateWFUtil::eval_logn(double x, int ioffset)
    {
        if (param_.size() < ioffset+nParFcn_) return 0.0;
-       return logn(x,&param_[ioffset]);
+       return param_[ioffset]*pulseCache_.evaluate(x-param_[ioffset+1]);
    }
    //------------------------------------------------------------
    double CaloTemplateWFUtil::maxAmplitude()
@@ -269,7 +390,7 @@ namespace mu2e {
       double s1(0),s2(0);
       for (unsigned i=i0;i<=i1;++i)
       {
-         double ff = pulseCachePtr_->evaluate(xvalues[i]-x0);
+         double ff = pulseCache_.evaluate(xvalues[i]-x0);
 
          s1 += ff*ff;
          s2 += yvalues[i]*ff;
@@ -285,7 +406,7 @@ namespace mu2e {
       double chi2(0);
       for (unsigned i=i0;i<=i1;++i)
       {
-         double cc = A*pulseCachePtr_->evaluate(xvalues[i]-x0)-yvalues[i];
+         double cc = A*pulseCache_.evaluate(xvalues[i]-x0)-yvalues[i];
          chi2 += cc*cc;
       }
       return chi2;
@@ -312,14 +433,17 @@ namespace mu2e {
        h.SetStats(0);
        h.SetMinimum(0);
 
-       TF1 f("f",fitfunctionPlot,xvec_[x0_],xvec_[x1_-1],param_.size());
-       for (unsigned i=0;i<param_.size();++i) f.SetParameter(i,param_[i]);
+       unsigned npar = param_.size();
+       auto fitfunctionPlot = [this,npar](double* x, double* par) {return fitFunction(x[0],par,npar);};
+
+       TF1 f("f",fitfunctionPlot,xvec_[x0_],xvec_[x1_-1],npar);
+       for (unsigned i=0;i<npar;++i) f.SetParameter(i,param_[i]);
 
        std::vector<TF1*> f2(nParTot_);
        int nPeaks(0);
        for (unsigned i=nParBkg_;i<nParTot_;i+=nParFcn_)
        {
-          f2[nPeaks] = new TF1("f2",fitfunctionPlot,xvec_[x0_],xvec_[x1_-1],param_.size());
+          f2[nPeaks] = new TF1("f2",fitfunctionPlot,xvec_[x0_],xvec_[x1_-1],npar);
           for (unsigned j=0;j<nParTot_;++j) f2[nPeaks]->SetParameter(i,0);
           f2[nPeaks]->SetParameter(i,param_[i]);
           f2[nPeaks]->SetParameter(i+1,param_[i+1]);
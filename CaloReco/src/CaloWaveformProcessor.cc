@@ -0,0 +1,29 @@
+#include "Offline/CaloReco/inc/CaloWaveformProcessor.hh"
+#include "cetlib_except/exception.h"
+
+namespace mu2e {
+
+   void CaloWaveformProcessor::extractBatch(const std::vector<const std::vector<int>*>& waveforms, const std::vector<double>& t0s,
+                                            double sampling, std::vector<Peak>& peaks)
+   {
+       if (waveforms.size() != t0s.size()) throw cet::exception("CATEGORY")<<"CaloWaveformProcessor::extractBatch  waveforms and t0s must have the same size";
+
+       for (size_t iwf=0;iwf<waveforms.size();++iwf)
+       {
+           const auto& waveform = *waveforms[iwf];
+           xBuffer_.resize(waveform.size());
+           yBuffer_.resize(waveform.size());
+           for (size_t i=0;i<waveform.size();++i)
+           {
+               xBuffer_[i] = t0s[iwf] + (i+0.5)*sampling; // add 0.5 to be in middle of bin
+               yBuffer_[i] = waveform[i];
+           }
+
+           reset();
+           extract(xBuffer_,yBuffer_);
+           for (int i=0;i<nPeaks();++i)
+              peaks.push_back(Peak{iwf,amplitude(i),amplitudeErr(i),time(i),timeErr(i),chi2(),ndf(),isPileUp(i)});
+       }
+   }
+
+}
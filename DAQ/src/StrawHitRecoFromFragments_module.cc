@@ -280,7 +280,7 @@ void art::StrawHitRecoFromFragments::analyze_tracker_(
 
       // flag straw and electronic cross-talk
       if (_flagXT) {
-        _shrUtils.flagCrossTalk(shCol, chCol);
+        _shrUtils.flagCrossTalk(shCol, chCol, tt);
       }
     }
   }
@@ -8,13 +8,17 @@
 // this class through the service, and asks the update method
 // for appropriate tables.  Database tables can be overridden by a text file.
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
+#include <set>
 #include <shared_mutex>
 
 #include "Offline/DbService/inc/DbReader.hh"
 #include "Offline/DbTables/inc/DbCache.hh"
 #include "Offline/DbTables/inc/DbId.hh"
 #include "Offline/DbTables/inc/DbLiveTable.hh"
+#include "Offline/DbTables/inc/DbNodeCache.hh"
 #include "Offline/DbTables/inc/DbSet.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DbTables/inc/DbTableCollection.hh"
@@ -26,7 +30,7 @@ class DbEngine {
  public:
   DbEngine() :
       _verbose(0), _saveCsv(true), _nearestMatch(false), _initialized(false),
-      _lockWaitTime(0), _lockTime(0) {}
+      _lockWaitTime(0), _lockTime(0), _nPrefetched(0), _prefetchTime(0) {}
   // the big read of the IOV structure is done in beginJob
   int beginJob();
   int endJob();
@@ -46,15 +50,22 @@ class DbEngine {
   std::shared_ptr<DbValCache>& valCache() { return _vcache; }
   DbReader& reader() { return _reader; }
   DbCache& cache() { return _cache; }
+  DbNodeCache& nodeCache() { return _nodeCache; }
   // these are the only methods that can be called from threads,
   // such as DbHandle, after the single-threaded configuration
   DbLiveTable update(int tid, uint32_t run, uint32_t subrun);
+  // read ahead, into the cache, the tables for this run:subrun and the
+  // next nIov IoVs after it, for every table update has been asked for.
+  // Meant to be run on a background thread, so update finds them ready.
+  void prefetch(uint32_t run, uint32_t subrun, int nIov);
   // ruten tid for table name and reverce, for connecting handles
   int tidByName(std::string const& name);
 
  private:
   // call beginRun on first use, if needed
   void lazyBeginJob();
+  // return the table for this cid, from the cache or read and cached
+  DbTable::cptr_t loadTable(int tid, int cid, bool prefetching);
   // set cid and tid for override text tables - called during intialization
   int setOverrideId();
   int updateOverrideTid();
@@ -67,16 +78,25 @@ class DbEngine {
   bool _nearestMatch;           // match to nearby data, without proper IOV
   DbTableCollection _override;  // the text tables
   DbCache _cache;               // cache of table contents
+  DbNodeCache _nodeCache;       // table contents shared on the node
   std::shared_ptr<DbValCache> _vcache;  // full db iov heirarchy
   bool _initialized;
   DbSet _dbset;                              // simple set of relevant iovs
   std::map<std::string, int> _overrideTids;  // fake tids for text tables
 
+  std::set<int> _usedTids;  // tables asked for by update, to prefetch
+
   // lock for threaded access
   mutable std::shared_mutex _mutex;
-  // count the time locked
-  std::chrono::microseconds _lockWaitTime;
-  std::chrono::microseconds _lockTime;
+  // one table read at a time, outside _mutex so that threads
+  // finding their tables in the cache do not wait for the read
+  std::mutex _readMutex;
+  // count the time (us) waiting for locks and holding them, in update
+  std::atomic<int64_t> _lockWaitTime;
+  std::atomic<int64_t> _lockTime;
+  // tables read by prefetch, and the time (us) it spent
+  int _nPrefetched;
+  int64_t _prefetchTime;
 };
 }  // namespace mu2e
 #endif
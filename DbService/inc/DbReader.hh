@@ -46,6 +46,8 @@ class DbReader {
   int multiQuery(std::vector<QueryForm>& qfv);
 
   int fillTableByCid(DbTable::ptr_t ptr, int cid);
+  // same, and also return the csv text the table was filled from
+  int fillTableByCid(DbTable::ptr_t ptr, int cid, std::string& csv);
   int fillValTables(DbValCache& vcache);
 
   std::string& lastError() { return _lastError; }
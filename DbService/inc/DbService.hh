@@ -1,9 +1,12 @@
 #ifndef DbService_DbService_hh
 #define DbService_DbService_hh
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "Offline/DbService/inc/DbEngine.hh"
+#include "Offline/GeneralUtilities/inc/BackgroundQueue.hh"
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
 #include "art/Framework/Services/Registry/ServiceTable.h"
@@ -13,6 +16,10 @@
 #include "fhiclcpp/types/OptionalSequence.h"
 #include "fhiclcpp/types/Sequence.h"
 
+namespace art {
+class SubRun;
+}
+
 namespace mu2e {
 
 class DbService {
@@ -28,6 +35,11 @@ class DbService {
         Comment("while adding tables, check purge every this many (20)")};
     fhicl::OptionalAtom<float> purgeEnd{
         Name("purgeEnd"), Comment("purge to this fraction of limit (0.9)")};
+    fhicl::OptionalAtom<std::string> nodeCacheDir{
+        Name("nodeCacheDir"),
+        Comment("if set, share tables with the other jobs of this user on "
+                "the node through files in a private subdirectory of this "
+                "directory, for ex. /dev/shm/mu2e_dbcache")};
   };
 
   struct Config {
@@ -41,7 +53,8 @@ class DbService {
                                     Comment("which database to use"), "none"};
     fhicl::OptionalSequence<std::string> textFile{
         Name("textFile"),
-        Comment("list of text files containing override table data")};
+        Comment("list of text files containing override table data, "
+                "or binary files named *.dbbin")};
     fhicl::Atom<int> verbose{Name("verbose"), Comment("verbose flag, 0 to 10"),
                              0};
     fhicl::Atom<bool> saveCsv{
@@ -56,6 +69,10 @@ class DbService {
     fhicl::OptionalAtom<int> retryTimeout{
         Name("retryTimeout"),
         Comment("how long to keep retrying to read database (3600s)")};
+    fhicl::OptionalAtom<int> prefetchIovs{
+        Name("prefetchIovs"),
+        Comment("if >=0, at each new subrun read the tables in use for it "
+                "and this many following IoVs on a background thread")};
     fhicl::Atom<bool> nearestMatch{
         Name("nearestMatch"),
         Comment("if no proper IoV, accept nearby calibrations, default false"),
@@ -73,11 +90,19 @@ class DbService {
 
   // Functions registered for callbacks.
   void postBeginJob();
+  void preBeginSubRun(art::SubRun const& subrun);
   void postEndJob();
 
   // how the DbHandle interacts with this service
   DbEngine& engine() { return _engine; }
 
+  // services which read through the engine on threads of their own
+  // register how to stop those threads; postEndJob calls them, last
+  // registered first, before the engine is shut down
+  void addEndJobStop(std::function<void()> stop) {
+    _endJobStops.emplace_back(std::move(stop));
+  }
+
  private:
   // This is not copyable or assignable - private and unimplemented.
   DbService const& operator=(DbService const& rhs);
@@ -88,6 +113,9 @@ class DbService {
 
   DbVersion _version;
   DbEngine _engine;
+  int _prefetchIovs;
+  BackgroundQueue _prefetcher;
+  std::vector<std::function<void()>> _endJobStops;
 };
 
 }  // namespace mu2e
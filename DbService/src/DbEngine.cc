@@ -2,6 +2,7 @@
 #include "Offline/DbService/inc/DbValTool.hh"
 #include "Offline/DbTables/inc/DbTableFactory.hh"
 #include "cetlib_except/exception.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <mutex>
@@ -22,6 +23,8 @@ int mu2e::DbEngine::beginJob() {
   _reader.setVerbose(_verbose);
   _reader.setTimeVerbose(_verbose);
   _reader.setSaveCsv(_saveCsv);
+  _nodeCache.setDbName(_id.name());
+  _nodeCache.setVerbose(_verbose);
 
   // this is used to assign nominal tid's and cid's to tables that
   // are read in through a file, and may not be declared in the database
@@ -107,6 +110,7 @@ mu2e::DbLiveTable mu2e::DbEngine::update(int tid, uint32_t run,
   DbTable::cptr_t ptr;
   int cid = -1;
   DbIoV iov;
+  bool newTid = false;
 
   // try to find the needed cid and the table itself
   {
@@ -115,8 +119,15 @@ mu2e::DbLiveTable mu2e::DbEngine::update(int tid, uint32_t run,
     cid = row.cid();
     iov = row.iov();
     ptr = _cache.get(row.cid());
+    newTid = _usedTids.count(tid) == 0;
   }  // read lock goes out of scope
 
+  // remember the tables in use, for prefetch
+  if (newTid) {
+    std::unique_lock lock(_mutex);
+    _usedTids.insert(tid);
+  }
+
   // if no cid now, then table can't be found - have to stop
   if (cid < 0) {
     throw cet::exception("DBENGINE_UPDATE_FAILED")
@@ -126,44 +137,14 @@ mu2e::DbLiveTable mu2e::DbEngine::update(int tid, uint32_t run,
 
   // if it wasn't found in cache, try to read from database
   if (!ptr) {
-    auto stime = std::chrono::high_resolution_clock::now();
-    std::unique_lock lock(_mutex);  // write lock
-    auto mtime = std::chrono::high_resolution_clock::now();
-    auto dt =
-        std::chrono::duration_cast<std::chrono::microseconds>(mtime - stime);
-    _lockWaitTime += dt;
-
-    // have to check if some other thread loaded it
-    // since the above read attempt
-    if (_cache.hasTable(cid)) {
-      ptr = _cache.get(cid);
-    } else {
-      auto const& tabledef = _vcache->valTables().row(tid);
-      // this makes the memory
-      auto ncptr = DbTableFactory::newTable(tabledef.name());
-      // the actual http read
-      int rc = _reader.fillTableByCid(ncptr, cid);
-
-      // reader does not abort, so do it here
-      if (rc != 0) {
-        auto const& tabledef = _vcache->valTables().row(tid);
-        throw cet::exception("DBENGINE_UPDATE_FAILED")
-            << " DbEngine::update failed to find table " << tabledef.name()
-            << " for run:subrun " << run << ":" << subrun << ", cid =" << cid
-            << ", rc =" << rc << "\n";
-      }
-
-      // make it const
-      ptr = std::const_pointer_cast<const mu2e::DbTable, mu2e::DbTable>(ncptr);
-      // push to cache
-      _cache.add(cid, ptr);
+    try {
+      ptr = loadTable(tid, cid, false);
+    } catch (cet::exception const& e) {
+      throw cet::exception("DBENGINE_UPDATE_FAILED", "", e)
+          << " DbEngine::update failed for run:subrun " << run << ":"
+          << subrun << "\n";
     }
-
-    auto etime = std::chrono::high_resolution_clock::now();
-    dt = std::chrono::duration_cast<std::chrono::microseconds>(etime - mtime);
-    _lockTime += dt;
-
-  }  // write lock goes out of scope
+  }
 
   // this code handles the case where an override takes effect
   // in the middle of a database IOV - remove the override
@@ -179,6 +160,116 @@ mu2e::DbLiveTable mu2e::DbEngine::update(int tid, uint32_t run,
   return dblt;
 }
 
+mu2e::DbTable::cptr_t mu2e::DbEngine::loadTable(int tid, int cid,
+                                                bool prefetching) {
+  auto stime = std::chrono::high_resolution_clock::now();
+  std::lock_guard rlock(_readMutex);  // one read at a time
+  auto mtime = std::chrono::high_resolution_clock::now();
+
+  // have to check if another thread, or the prefetch,
+  // read it while this one was waiting
+  DbTable::cptr_t ptr;
+  {
+    std::shared_lock lock(_mutex);
+    ptr = _cache.get(cid);
+  }
+
+  bool read = false;
+  if (!ptr) {
+    auto const& tabledef = _vcache->valTables().row(tid);
+    // this makes the memory
+    auto ncptr = DbTableFactory::newTable(tabledef.name());
+    // another process on this node may have read it already,
+    // otherwise the actual http read
+    int rc = 0;
+    if (!_nodeCache.fill(*ncptr, cid, _saveCsv)) {
+      std::string csv;
+      rc = _reader.fillTableByCid(ncptr, cid, csv);
+      if (rc == 0) _nodeCache.add(*ncptr, cid, csv);
+    }
+
+    // reader does not abort, so do it here
+    if (rc != 0) {
+      throw cet::exception("DBENGINE_UPDATE_FAILED")
+          << " DbEngine::loadTable failed to read table " << tabledef.name()
+          << ", cid =" << cid << ", rc =" << rc << "\n";
+    }
+
+    // make it const
+    ptr = std::const_pointer_cast<const mu2e::DbTable, mu2e::DbTable>(ncptr);
+    // push to cache, which is only changed under the write lock
+    std::unique_lock lock(_mutex);
+    _cache.add(cid, ptr);
+    read = true;
+  }
+
+  auto etime = std::chrono::high_resolution_clock::now();
+  auto waited =
+      std::chrono::duration_cast<std::chrono::microseconds>(mtime - stime);
+  auto locked =
+      std::chrono::duration_cast<std::chrono::microseconds>(etime - mtime);
+  if (prefetching) {
+    if (read) _nPrefetched++;
+    _prefetchTime += (waited + locked).count();
+  } else {
+    _lockWaitTime += waited.count();
+    _lockTime += locked.count();
+  }
+
+  return ptr;
+}
+
+void mu2e::DbEngine::prefetch(uint32_t run, uint32_t subrun, int nIov) {
+  lazyBeginJob();  // initialize if needed
+  if (!_vcache || nIov < 0) return;
+
+  // the IoVs of each table in use, from the one holding run:subrun on
+  std::vector<std::pair<int, int>> wanted;  // tid, cid
+  {
+    std::shared_lock lock(_mutex);
+    for (int tid : _usedTids) {
+      auto iter = _dbset.emap().find(tid);
+      if (iter == _dbset.emap().end()) continue;
+      std::vector<DbSet::EIoV const*> ahead;
+      for (auto const& ee : iter->second) {
+        auto const& v = ee.iov();
+        if (v.inInterval(run, subrun) || v.startRun() > run ||
+            (v.startRun() == run && v.startSubrun() > subrun)) {
+          ahead.push_back(&ee);
+        }
+      }
+      std::sort(ahead.begin(), ahead.end(),
+                [](DbSet::EIoV const* a, DbSet::EIoV const* b) {
+                  return std::make_pair(a->iov().startRun(),
+                                        a->iov().startSubrun()) <
+                         std::make_pair(b->iov().startRun(),
+                                        b->iov().startSubrun());
+                });
+      for (size_t i = 0; i < ahead.size() && int(i) <= nIov; i++) {
+        if (!_cache.hasTable(ahead[i]->cid())) {
+          wanted.emplace_back(tid, ahead[i]->cid());
+        }
+      }
+    }
+  }
+
+  for (auto const& w : wanted) {
+    try {
+      loadTable(w.first, w.second, true);
+    } catch (cet::exception const& e) {
+      // not fatal here - update will fail if the table is really needed
+      if (_verbose > 0) {
+        cout << "DbEngine::prefetch failed to read cid " << w.second << ": "
+             << e.what() << endl;
+      }
+    }
+  }
+  if (_verbose > 5) {
+    cout << "DbEngine::prefetch for run:subrun " << run << ":" << subrun
+         << " found " << wanted.size() << " tables to read" << endl;
+  }
+}
+
 int mu2e::DbEngine::tidByName(std::string const& name) {
   lazyBeginJob();  // initialize if needed
 
@@ -298,7 +389,7 @@ void mu2e::DbEngine::lazyBeginJob() {
   auto mtime = std::chrono::high_resolution_clock::now();
   auto dt =
       std::chrono::duration_cast<std::chrono::microseconds>(mtime - stime);
-  _lockWaitTime += dt;
+  _lockWaitTime += dt.count();
 
   // if another thread initialized since the above check
   if (_initialized) return;
@@ -307,7 +398,7 @@ void mu2e::DbEngine::lazyBeginJob() {
 
   auto etime = std::chrono::high_resolution_clock::now();
   dt = std::chrono::duration_cast<std::chrono::microseconds>(etime - mtime);
-  _lockTime += dt;
+  _lockTime += dt.count();
 
   // write lock destroyed on return
 
@@ -321,13 +412,16 @@ int mu2e::DbEngine::endJob() {
     std::cout << "    Total time in reading DB: " << _reader.totalTime() << " s"
               << std::endl;
     std::cout << "    Total time waiting for locks: "
-              << _lockWaitTime.count() * 1.0e-6 << " s" << std::endl;
-    std::cout << "    Total time in locks: " << _lockTime.count() * 1.0e-6
-              << " s" << std::endl;
+              << _lockWaitTime * 1.0e-6 << " s" << std::endl;
+    std::cout << "    Total time in locks: " << _lockTime * 1.0e-6 << " s"
+              << std::endl;
+    std::cout << "    Tables prefetched: " << _nPrefetched << " in "
+              << _prefetchTime * 1.0e-6 << " s" << std::endl;
     std::cout << "    valcache memory: " << _vcache->size() << " b"
               << std::endl;
     std::cout << "  Database cache stats:\n";
     _cache.printStats();
+    _nodeCache.printStats();
   }
   return 0;
 }
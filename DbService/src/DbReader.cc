@@ -63,6 +63,11 @@ int mu2e::DbReader::multiQuery(std::vector<QueryForm>& qfv) {
 
 int mu2e::DbReader::fillTableByCid(DbTable::ptr_t ptr, int cid) {
   std::string csv;
+  return fillTableByCid(ptr, cid, csv);
+}
+
+int mu2e::DbReader::fillTableByCid(DbTable::ptr_t ptr, int cid,
+                                   std::string& csv) {
   StringVec where;
   where.emplace_back("cid:eq:" + std::to_string(cid));
   int rc = query(csv, ptr->query(), ptr->dbname(), where, ptr->orderBy());
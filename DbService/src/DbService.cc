@@ -2,6 +2,7 @@
 #include "Offline/DbService/inc/DbIdList.hh"
 #include "Offline/DbService/inc/DbService.hh"
 #include "Offline/DbTables/inc/DbUtil.hh"
+#include "art/Framework/Principal/SubRun.h"
 #include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
@@ -11,11 +12,17 @@ DbService::DbService(Parameters const& config,
                      art::ActivityRegistry& iRegistry) :
     _config(config()),
     _verbose(config().verbose()),
-    _version(config().purpose(), config().version()) {
+    _version(config().purpose(), config().version()), _prefetchIovs(-1),
+    _prefetcher("DbService") {
   // register callbacks
   iRegistry.sPostBeginJob.watch(this, &DbService::postBeginJob);
   iRegistry.sPostEndJob.watch(this, &DbService::postEndJob);
 
+  _config.prefetchIovs(_prefetchIovs);
+  if (_prefetchIovs >= 0) {
+    iRegistry.sPreBeginSubRun.watch(this, &DbService::preBeginSubRun);
+  }
+
   if (_verbose > 0) {
     std::cout << "DbService  " << config().purpose() << " "
               << config().version() << "   " << config().dbName() << std::endl;
@@ -83,6 +90,10 @@ DbService::DbService(Parameters const& config,
   if (_config.cacheParameters().purgeEnd(purgeEnd)) {
     _engine.cache().setPurgeEnd(purgeEnd);
   }
+  std::string nodeCacheDir;
+  if (_config.cacheParameters().nodeCacheDir(nodeCacheDir)) {
+    _engine.nodeCache().setDirectory(nodeCacheDir);
+  }
 
   // service will start calling the database at the first event,
   // so the service can exist without the DB being contacted.
@@ -103,8 +114,23 @@ DbService::~DbService() {}
 /********************************************************/
 void DbService::postBeginJob() {}
 
+/********************************************************/
+void DbService::preBeginSubRun(art::SubRun const& subrun) {
+  // anything still queued for the previous subrun is now less urgent
+  _prefetcher.clearPending();
+  uint32_t run = subrun.run(), sr = subrun.subRun();
+  int nIov = _prefetchIovs;
+  _prefetcher.post(
+      [this, run, sr, nIov]() { _engine.prefetch(run, sr, nIov); });
+}
+
 /********************************************************/
 void DbService::postEndJob() {
+  // dependent prefetch threads first, then our own
+  for (auto it = _endJobStops.rbegin(); it != _endJobStops.rend(); ++it) {
+    (*it)();
+  }
+  _prefetcher.stop();
   // just print summaries according to verbosity
   _engine.endJob();
 }
@@ -0,0 +1,126 @@
+//
+// Convert DbService override files between text and the binary
+// .dbbin form, and time loading tables both ways.
+//
+//   dbBinary INPUT OUTPUT
+//     copy the tables in INPUT to OUTPUT; either may be text or .dbbin,
+//     which is chosen by the file name, as in DbService textFile
+//
+//   dbBinary --bench FILE [NREPEAT=100]
+//     for each table class in FILE, time filling a table from its csv
+//     text and from its binary form, NREPEAT times each, and check that
+//     both give the same rows.  Tables without a binary form
+//     (binaryVersion 0) are listed as such.
+//
+
+#include "Offline/DbTables/inc/DbTableFactory.hh"
+#include "Offline/DbTables/inc/DbUtil.hh"
+#include "cetlib_except/exception.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// the rows as text, made the same way for either fill
+string rowText(mu2e::DbTable const& table) {
+  ostringstream ss;
+  for (size_t i = 0; i < table.nrow(); i++) {
+    table.rowToCsv(ss, i);
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+int bench(string const& fn, int nrepeat) {
+  auto coll = mu2e::DbUtil::readFile(fn, true);
+
+  cout << left << setw(24) << "table" << right << setw(8) << "nrow"
+       << setw(12) << "csv bytes" << setw(12) << "bin bytes" << setw(12)
+       << "csv us" << setw(12) << "bin us" << setw(9) << "ratio" << endl;
+
+  int rc = 0;
+  set<string> done;
+  for (auto const& lt : coll) {
+    mu2e::DbTable const& source = lt.table();
+    if (!done.insert(source.name()).second) continue;
+
+    // text saved by readBinaryFile may have been made from the rows
+    auto csvTable = mu2e::DbTableFactory::newTable(source.name());
+    csvTable->fill(source.csv(), true);
+    string const& csv = csvTable->csv();
+
+    double csvTime = 0.0;
+    for (int i = 0; i < nrepeat; i++) {
+      auto t = mu2e::DbTableFactory::newTable(source.name());
+      auto start = chrono::steady_clock::now();
+      t->fill(csv, false);
+      auto end = chrono::steady_clock::now();
+      csvTime += chrono::duration<double, micro>(end - start).count();
+    }
+    csvTime /= nrepeat;
+
+    cout << left << setw(24) << source.name() << right << setw(8)
+         << source.nrow() << setw(12) << csv.size();
+    if (source.binaryVersion() == 0) {
+      cout << setw(12) << "-" << setw(12) << fixed << setprecision(1)
+           << csvTime << setw(12) << "-" << setw(9) << "-"
+           << "   no binary form" << endl;
+      continue;
+    }
+
+    string buffer;
+    source.toBinary(buffer);
+    double binTime = 0.0;
+    mu2e::DbTable::ptr_t binTable;
+    for (int i = 0; i < nrepeat; i++) {
+      binTable = mu2e::DbTableFactory::newTable(source.name());
+      auto start = chrono::steady_clock::now();
+      binTable->fillBinary(buffer.data(), buffer.size(), false);
+      auto end = chrono::steady_clock::now();
+      binTime += chrono::duration<double, micro>(end - start).count();
+    }
+    binTime /= nrepeat;
+
+    cout << setw(12) << buffer.size() << setw(12) << fixed << setprecision(1)
+         << csvTime << setw(12) << binTime << setw(9) << setprecision(1)
+         << (binTime > 0.0 ? csvTime / binTime : 0.0);
+    if (rowText(*binTable) != rowText(*csvTable)) {
+      cout << "   ROWS DIFFER";
+      rc = 1;
+    }
+    cout << endl;
+  }
+  return rc;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  vector<string> words(argv + 1, argv + argc);
+
+  try {
+    if (words.size() >= 2 && words.size() <= 3 && words[0] == "--bench") {
+      int nrepeat = words.size() > 2 ? stoi(words[2]) : 100;
+      if (nrepeat < 1) nrepeat = 1;
+      return bench(words[1], nrepeat);
+    }
+    if (words.size() == 2 && words[0].substr(0, 2) != "--") {
+      auto coll = mu2e::DbUtil::readFile(words[0], true);
+      mu2e::DbUtil::writeFile(words[1], coll);
+      return 0;
+    }
+  } catch (cet::exception const& e) {
+    cout << "dbBinary failed: " << e.what() << endl;
+    return 2;
+  }
+
+  cout << "Usage: dbBinary INPUT OUTPUT\n"
+       << "       dbBinary --bench FILE [NREPEAT]" << endl;
+  return 1;
+}
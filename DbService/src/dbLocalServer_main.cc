@@ -0,0 +1,263 @@
+//
+// A stand-in for the conditions database web server, for tests.
+//
+// It answers the query urls made by DbReader from a directory of csv
+// files, one per database table, named by the table as in the database
+// (val.tables.csv, tst.calib1.csv, ...).  The first line of each file
+// holds the column names; fields are passed on as written, quotes and
+// all.  The t (table), c (columns), w (where, of the form
+// column:op:value with op one of eq,ne,lt,le,gt,ge) and o (order)
+// arguments are understood; dbname and z are ignored.  Like the real
+// server, the reply starts with a line of column titles.
+//
+// Requests are handled one at a time, and each is printed on stdout,
+// so a test can count how many tables a job really fetched.
+//
+// To use it, point a database name at it in a Database/connections.txt
+// found first in MU2E_SEARCH_PATH, as in DbService/test/Database:
+//
+//   dbLocalServer DIRECTORY [PORT] [MAXREQUESTS]
+//
+// The server exits after MAXREQUESTS requests, if given.
+//
+
+#include "Offline/DbTables/inc/DbUtil.hh"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+typedef vector<string> StringVec;
+
+struct Reply {
+  int code;
+  string body;
+};
+
+// split on a single character, keeping empty fields
+StringVec split(string const& s, char c) {
+  StringVec words;
+  size_t i = 0, j;
+  while ((j = s.find(c, i)) != string::npos) {
+    words.emplace_back(s.substr(i, j - i));
+    i = j + 1;
+  }
+  words.emplace_back(s.substr(i));
+  return words;
+}
+
+string urlDecode(string const& s) {
+  string out;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '%' && i + 2 < s.size()) {
+      out += char(stoi(s.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    } else if (s[i] == '+') {
+      out += ' ';
+    } else {
+      out += s[i];
+    }
+  }
+  return out;
+}
+
+// compare as numbers if both are numbers, otherwise as text
+int compare(string const& a, string const& b) {
+  char *ea, *eb;
+  double da = strtod(a.c_str(), &ea);
+  double db = strtod(b.c_str(), &eb);
+  if (!a.empty() && !b.empty() && *ea == '\0' && *eb == '\0') {
+    return da < db ? -1 : (da > db ? 1 : 0);
+  }
+  return a.compare(b);
+}
+
+bool pass(string const& value, string const& op, string const& target) {
+  int c = compare(value, target);
+  if (op == "eq") return c == 0;
+  if (op == "ne") return c != 0;
+  if (op == "lt") return c < 0;
+  if (op == "le") return c <= 0;
+  if (op == "gt") return c > 0;
+  if (op == "ge") return c >= 0;
+  throw runtime_error("unknown operator " + op);
+}
+
+Reply answer(string const& directory, string const& query) {
+  string table, select, order;
+  StringVec where;
+  for (auto const& arg : split(query, '&')) {
+    size_t eq = arg.find('=');
+    if (eq == string::npos) continue;
+    string key = arg.substr(0, eq);
+    string value = urlDecode(arg.substr(eq + 1));
+    if (key == "t") table = value;
+    if (key == "c") select = value;
+    if (key == "w") where.emplace_back(value);
+    if (key == "o") order = value;
+  }
+  if (table.empty() || table.find('/') != string::npos) {
+    return Reply{400, "no table\n"};
+  }
+
+  ifstream in(directory + "/" + table + ".csv");
+  if (!in) return Reply{404, "no table " + table + "\n"};
+  stringstream ss;
+  ss << in.rdbuf();
+  StringVec lines = mu2e::DbUtil::splitCsvLines(ss.str());
+  if (lines.empty()) return Reply{500, "empty table " + table + "\n"};
+  StringVec columns = mu2e::DbUtil::splitCsv(lines[0]);
+  auto column = [&](string const& name) {
+    auto it = find(columns.begin(), columns.end(), name);
+    if (it == columns.end()) {
+      throw runtime_error("no column " + name + " in " + table);
+    }
+    return size_t(it - columns.begin());
+  };
+
+  vector<StringVec> rows;
+  for (size_t i = 1; i < lines.size(); i++) {
+    rows.emplace_back(mu2e::DbUtil::splitCsv(lines[i]));
+  }
+
+  for (auto const& w : where) {
+    StringVec parts = split(w, ':');
+    if (parts.size() != 3) throw runtime_error("bad where " + w);
+    size_t icol = column(parts[0]);
+    rows.erase(remove_if(rows.begin(), rows.end(),
+                         [&](StringVec const& r) {
+                           return !pass(r.at(icol), parts[1], parts[2]);
+                         }),
+               rows.end());
+  }
+
+  if (!order.empty()) {
+    vector<size_t> icols;
+    for (auto const& o : split(order, ',')) icols.push_back(column(o));
+    stable_sort(rows.begin(), rows.end(),
+                [&](StringVec const& a, StringVec const& b) {
+                  for (size_t icol : icols) {
+                    int c = compare(a.at(icol), b.at(icol));
+                    if (c != 0) return c < 0;
+                  }
+                  return false;
+                });
+  }
+
+  vector<size_t> icols;
+  StringVec titles = select.empty() ? columns : split(select, ',');
+  for (auto const& t : titles) icols.push_back(column(t));
+
+  string body;
+  for (size_t i = 0; i < titles.size(); i++) {
+    body += (i > 0 ? "," : "") + titles[i];
+  }
+  body += "\n";
+  for (auto const& r : rows) {
+    for (size_t i = 0; i < icols.size(); i++) {
+      body += (i > 0 ? "," : "") + r.at(icols[i]);
+    }
+    body += "\n";
+  }
+  return Reply{200, body};
+}
+
+void send(int fd, Reply const& reply) {
+  ostringstream ss;
+  ss << "HTTP/1.1 " << reply.code << (reply.code == 200 ? " OK" : " Error")
+     << "\r\nContent-Type: text/plain\r\nContent-Length: "
+     << reply.body.size() << "\r\nConnection: close\r\n\r\n"
+     << reply.body;
+  string s = ss.str();
+  const char* p = s.data();
+  size_t n = s.size();
+  while (n > 0) {
+    ssize_t w = ::write(fd, p, n);
+    if (w < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    p += w;
+    n -= w;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 4) {
+    cout << "Usage: dbLocalServer DIRECTORY [PORT] [MAXREQUESTS]" << endl;
+    return 1;
+  }
+  string directory(argv[1]);
+  int port = argc > 2 ? stoi(argv[2]) : 17171;
+  long maxRequests = argc > 3 ? stol(argv[3]) : -1;
+
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  int yes = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (sock < 0 || bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(sock, 64) != 0) {
+    int errsave = errno;
+    cout << "dbLocalServer could not listen on port " << port
+         << "  errno: " << errsave << " " << strerror(errsave) << endl;
+    return 2;
+  }
+  cout << "dbLocalServer serving " << directory << " on port " << port
+       << endl;
+
+  long nRequests = 0;
+  while (maxRequests < 0 || nRequests < maxRequests) {
+    int fd = accept(sock, nullptr, nullptr);
+    if (fd < 0) continue;
+
+    // read up to the end of the request headers
+    string request;
+    char buf[4096];
+    while (request.find("\r\n\r\n") == string::npos) {
+      ssize_t n = read(fd, buf, sizeof(buf));
+      if (n <= 0) break;
+      request.append(buf, n);
+    }
+    string line = request.substr(0, request.find("\r\n"));
+    StringVec words = split(line, ' ');
+
+    Reply reply{400, "bad request\n"};
+    if (words.size() == 3 && words[0] == "GET") {
+      string target = words[1];
+      size_t q = target.find('?');
+      try {
+        reply = answer(directory, q == string::npos ? "" : target.substr(q + 1));
+      } catch (exception const& e) {
+        reply = Reply{500, string(e.what()) + "\n"};
+      }
+      nRequests++;
+      cout << "dbLocalServer request " << nRequests << " " << reply.code << " "
+           << target << endl;
+    }
+    send(fd, reply);
+    close(fd);
+  }
+
+  close(sock);
+  return 0;
+}
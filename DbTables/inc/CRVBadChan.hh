@@ -1,6 +1,7 @@
 #ifndef DbTables_CRVBadChan_hh
 #define DbTables_CRVBadChan_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "cetlib_except/exception.h"
 #include <cstdint>
@@ -49,6 +50,22 @@ class CRVBadChan : public DbTable {
     sstream << r.status();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::status);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<std::uint16_t>();
+    auto status = in.column<int>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], status[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
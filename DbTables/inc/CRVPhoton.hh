@@ -2,6 +2,7 @@
 #define DbTables_CRVPhoton_hh
 
 #include "Offline/DataProducts/inc/CRVId.hh"
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "cetlib_except/exception.h"
 #include <cstdint>
@@ -61,6 +62,22 @@ class CRVPhoton : public DbTable {
     sstream << r.photonYieldDeviation();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::photonYieldDeviation);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<std::uint16_t>();
+    auto photonYieldDeviation = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], photonYieldDeviation[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
@@ -2,6 +2,7 @@
 #define DbTables_CRVSiPM_hh
 
 #include "Offline/DataProducts/inc/CRVId.hh"
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "cetlib_except/exception.h"
 #include <cstdint>
@@ -64,11 +65,31 @@ class CRVSiPM : public DbTable {
     Row const& r = _rows.at(irow);
     sstream << r.channel() << ",";
     sstream << std::fixed << std::setprecision(3);
-    sstream << r.pedestal();
-    sstream << r.pulseHeight();
+    sstream << r.pedestal() << ",";
+    sstream << r.pulseHeight() << ",";
     sstream << r.pulseArea();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::pedestal);
+    out.column(_rows, &Row::pulseHeight);
+    out.column(_rows, &Row::pulseArea);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<std::uint16_t>();
+    auto pedestal = in.column<float>();
+    auto pulseHeight = in.column<float>();
+    auto pulseArea = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], pedestal[i], pulseHeight[i], pulseArea[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
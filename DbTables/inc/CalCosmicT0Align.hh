@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DataProducts/inc/CaloSiPMId.hh"
 
@@ -74,6 +75,32 @@ namespace mu2e {
       sstream << r.nev();
     }
 
+    int binaryVersion() const override { return 1; }
+    void toBinary(std::string& buffer) const override {
+      DbBinaryWriter out(buffer, *this);
+      out.column<CaloSiPMId::value_type>(
+          _rows, [](Row const& r) { return r.roid().id(); });
+      out.column(_rows, &Row::t0val);
+      out.column(_rows, &Row::t0err);
+      out.column(_rows, &Row::t0width);
+      out.column(_rows, &Row::chi2);
+      out.column<int>(_rows, [](Row const& r) { return int(r.nev()); });
+    }
+    void fromBinary(const char* data, std::size_t size) override {
+      DbBinaryReader in(data, size, *this);
+      auto roid = in.column<CaloSiPMId::value_type>();
+      auto t0val = in.column<float>();
+      auto t0err = in.column<float>();
+      auto t0width = in.column<float>();
+      auto chi2 = in.column<float>();
+      auto nev = in.column<int>();
+      _rows.reserve(in.nrow());
+      for (std::size_t i = 0; i < in.nrow(); i++) {
+        _rows.emplace_back(CaloSiPMId(roid[i]), t0val[i], t0err[i], t0width[i],
+                           chi2[i], nev[i]);
+      }
+    }
+
     void clear() override { baseClear(); _rows.clear();}
 
   private:
@@ -13,6 +13,7 @@ S Middleton 2023
 #include <sstream>
 #include <map>
 #include "cetlib_except/exception.h"
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DataProducts/inc/CaloSiPMId.hh"
 
@@ -65,6 +66,23 @@ namespace mu2e {
       sstream << r.ADC2MeV();
     }
 
+    int binaryVersion() const override { return 1; }
+    void toBinary(std::string& buffer) const override {
+      DbBinaryWriter out(buffer, *this);
+      out.column<CaloSiPMId::value_type>(
+          _rows, [](Row const& r) { return r.roid().id(); });
+      out.column(_rows, &Row::ADC2MeV);
+    }
+    void fromBinary(const char* data, std::size_t size) override {
+      DbBinaryReader in(data, size, *this);
+      auto roid = in.column<CaloSiPMId::value_type>();
+      auto ADC2MeV = in.column<float>();
+      _rows.reserve(in.nrow());
+      for (std::size_t i = 0; i < in.nrow(); i++) {
+        _rows.emplace_back(CaloSiPMId(roid[i]), ADC2MeV[i]);
+      }
+    }
+
     virtual void clear() override { baseClear(); _rows.clear();}
 
   private:
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DataProducts/inc/CaloSiPMId.hh"
 
@@ -61,6 +62,27 @@ namespace mu2e {
       sstream << r.chisq();
     }
 
+    int binaryVersion() const override { return 1; }
+    void toBinary(std::string& buffer) const override {
+      DbBinaryWriter out(buffer, *this);
+      out.column<CaloSiPMId::value_type>(
+          _rows, [](Row const& r) { return r.roid().id(); });
+      out.column(_rows, &Row::LAS);
+      out.column(_rows, &Row::ErrLAS);
+      out.column(_rows, &Row::chisq);
+    }
+    void fromBinary(const char* data, std::size_t size) override {
+      DbBinaryReader in(data, size, *this);
+      auto roid = in.column<CaloSiPMId::value_type>();
+      auto LAS = in.column<float>();
+      auto ErrLAS = in.column<float>();
+      auto chisq = in.column<float>();
+      _rows.reserve(in.nrow());
+      for (std::size_t i = 0; i < in.nrow(); i++) {
+        _rows.emplace_back(CaloSiPMId(roid[i]), LAS[i], ErrLAS[i], chisq[i]);
+      }
+    }
+
     virtual void clear() override { baseClear(); _rows.clear();}
 
   private:
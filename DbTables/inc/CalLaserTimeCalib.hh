@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DataProducts/inc/CaloSiPMId.hh"
 
@@ -70,6 +71,30 @@ namespace mu2e {
       sstream << r.nev();
     }
 
+    int binaryVersion() const override { return 1; }
+    void toBinary(std::string& buffer) const override {
+      DbBinaryWriter out(buffer, *this);
+      out.column<CaloSiPMId::value_type>(
+          _rows, [](Row const& r) { return r.roid().id(); });
+      out.column(_rows, &Row::T0);
+      out.column(_rows, &Row::ErrT0);
+      out.column(_rows, &Row::chisq);
+      out.column(_rows, &Row::nev);
+    }
+    void fromBinary(const char* data, std::size_t size) override {
+      DbBinaryReader in(data, size, *this);
+      auto roid = in.column<CaloSiPMId::value_type>();
+      auto T0 = in.column<float>();
+      auto ErrT0 = in.column<float>();
+      auto chisq = in.column<float>();
+      auto nev = in.column<int>();
+      _rows.reserve(in.nrow());
+      for (std::size_t i = 0; i < in.nrow(); i++) {
+        _rows.emplace_back(CaloSiPMId(roid[i]), T0[i], ErrT0[i], chisq[i],
+                           nev[i]);
+      }
+    }
+
     virtual void clear() override { baseClear(); _rows.clear();}
 
     private:
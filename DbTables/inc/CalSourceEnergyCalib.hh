@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DataProducts/inc/CaloSiPMId.hh"
 
@@ -102,9 +103,64 @@ namespace mu2e {
       sstream << r.secescErrEPeak()<<",";
       sstream << r.secescWidth()<<",";
       sstream << r.secescErrWidth()<<",";
+      sstream << r.frFull()<<",";
+      sstream << r.frFirst()<<",";
+      sstream << r.frSecond()<<",";
       sstream << r.chisq();
     }
 
+    int binaryVersion() const override { return 1; }
+    void toBinary(std::string& buffer) const override {
+      DbBinaryWriter out(buffer, *this);
+      out.column<CaloSiPMId::value_type>(
+          _rows, [](Row const& r) { return r.roid().id(); });
+      out.column(_rows, &Row::fullEPeak);
+      out.column(_rows, &Row::fullErrEPeak);
+      out.column(_rows, &Row::fullWidth);
+      out.column(_rows, &Row::fullErrWidth);
+      out.column(_rows, &Row::firstescEPeak);
+      out.column(_rows, &Row::firstescErrEPeak);
+      out.column(_rows, &Row::firstescWidth);
+      out.column(_rows, &Row::firstescErrWidth);
+      out.column(_rows, &Row::secescEPeak);
+      out.column(_rows, &Row::secescErrEPeak);
+      out.column(_rows, &Row::secescWidth);
+      out.column(_rows, &Row::secescErrWidth);
+      out.column(_rows, &Row::frFull);
+      out.column(_rows, &Row::frFirst);
+      out.column(_rows, &Row::frSecond);
+      out.column(_rows, &Row::chisq);
+    }
+    void fromBinary(const char* data, std::size_t size) override {
+      DbBinaryReader in(data, size, *this);
+      auto roid = in.column<CaloSiPMId::value_type>();
+      auto fullEPeak = in.column<float>();
+      auto fullErrEPeak = in.column<float>();
+      auto fullWidth = in.column<float>();
+      auto fullErrWidth = in.column<float>();
+      auto firstescEPeak = in.column<float>();
+      auto firstescErrEPeak = in.column<float>();
+      auto firstescWidth = in.column<float>();
+      auto firstescErrWidth = in.column<float>();
+      auto secescEPeak = in.column<float>();
+      auto secescErrEPeak = in.column<float>();
+      auto secescWidth = in.column<float>();
+      auto secescErrWidth = in.column<float>();
+      auto frFull = in.column<float>();
+      auto frFirst = in.column<float>();
+      auto frSecond = in.column<float>();
+      auto chisq = in.column<float>();
+      _rows.reserve(in.nrow());
+      for (std::size_t i = 0; i < in.nrow(); i++) {
+        _rows.emplace_back(CaloSiPMId(roid[i]), fullEPeak[i], fullErrEPeak[i],
+                           fullWidth[i], fullErrWidth[i], firstescEPeak[i],
+                           firstescErrEPeak[i], firstescWidth[i],
+                           firstescErrWidth[i], secescEPeak[i],
+                           secescErrEPeak[i], secescWidth[i], secescErrWidth[i],
+                           frFull[i], frFirst[i], frSecond[i], chisq[i]);
+      }
+    }
+
     virtual void clear() override { baseClear(); _rows.clear();}
 
   private:
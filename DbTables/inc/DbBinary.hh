@@ -0,0 +1,169 @@
+#ifndef DbTables_DbBinary_hh
+#define DbTables_DbBinary_hh
+
+// A typed, column-wise binary form of the rows of a DbTable.  It is used
+// where tables are stored by the code itself rather than by the database -
+// the node-local cache (DbNodeCache) and .dbbin override files - so that
+// loading a table is a copy of each column into the row vector, instead
+// of splitting and parsing csv text.
+//
+// A table writes one column for each name in its column list (query()),
+// in that order, each as an array of one type, and reads them back in the
+// same order.  The reader checks the number of columns and the type and
+// length of every column, so a mismatch is an error, never a misreading.
+//
+// Layout, all numbers in the byte order of the machine that wrote it:
+//   uint64 nrow, uint32 ncolumn, uint32 0
+//   for each column: uint32 type, uint32 0, uint64 nbytes,
+//                    nbytes of values, zero padded to a multiple of 8
+//   a string column holds nrow+1 uint64 offsets, then the characters
+
+#include "Offline/DbTables/inc/DbTable.hh"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mu2e {
+
+namespace DbBinary {
+// type code of a column: kind in the high bits, size in the low byte
+enum kind { signedKind = 1, unsignedKind = 2, floatKind = 3, stringKind = 4 };
+template <class T>
+constexpr uint32_t typeCode() {
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "DbBinary columns hold numbers or strings");
+  return (std::is_floating_point<T>::value
+              ? floatKind
+              : (std::is_signed<T>::value ? signedKind : unsignedKind)) << 8 |
+         sizeof(T);
+}
+template <>
+constexpr uint32_t typeCode<std::string>() {
+  return stringKind << 8;
+}
+// the number of columns in a column list
+std::size_t ncolumn(std::string const& query);
+}  // namespace DbBinary
+
+template <class T>
+class DbBinaryColumn {
+ public:
+  explicit DbBinaryColumn(const char* data) : _data(data) {}
+  // the data may not be aligned for T
+  T operator[](std::size_t i) const {
+    T value;
+    std::memcpy(&value, _data + i * sizeof(T), sizeof(T));
+    return value;
+  }
+
+ private:
+  const char* _data;
+};
+
+template <>
+class DbBinaryColumn<std::string> {
+ public:
+  DbBinaryColumn(const char* data, std::size_t nrow) :
+      _offsets(data), _chars(data + (nrow + 1) * sizeof(uint64_t)) {}
+  std::string operator[](std::size_t i) const {
+    uint64_t b, e;
+    std::memcpy(&b, _offsets + i * sizeof(uint64_t), sizeof(uint64_t));
+    std::memcpy(&e, _offsets + (i + 1) * sizeof(uint64_t), sizeof(uint64_t));
+    return std::string(_chars + b, e - b);
+  }
+
+ private:
+  const char* _offsets;
+  const char* _chars;
+};
+
+class DbBinaryWriter {
+ public:
+  // start the binary form of the table in buffer
+  DbBinaryWriter(std::string& buffer, DbTable const& table);
+
+  // append a column holding the value of get for every row
+  template <class ROW, class T>
+  void column(std::vector<ROW> const& rows, T (ROW::*get)() const) {
+    column<T>(rows, [get](ROW const& r) { return (r.*get)(); });
+  }
+  template <class ROW, class T>
+  void column(std::vector<ROW> const& rows, T const& (ROW::*get)() const) {
+    column<T>(rows, [get](ROW const& r) { return (r.*get)(); });
+  }
+  template <class T, class ROW, class GET>
+  void column(std::vector<ROW> const& rows, GET const& get);
+
+ private:
+  void startColumn(uint32_t type, std::size_t nbytes);
+  void endColumn();
+
+  std::string& _buffer;
+  std::string _name;
+  std::size_t _nrow;
+  std::size_t _ncolumn;
+  std::size_t _icolumn;
+};
+
+class DbBinaryReader {
+ public:
+  // check the header against the table, which will be filled from data
+  DbBinaryReader(const char* data, std::size_t size, DbTable const& table);
+  std::size_t nrow() const { return _nrow; }
+
+  // the next column, which must hold values of type T
+  template <class T>
+  DbBinaryColumn<T> column() {
+    const char* data = nextColumn(DbBinary::typeCode<T>(), sizeof(T));
+    return DbBinaryColumn<T>(data);
+  }
+
+ private:
+  const char* nextColumn(uint32_t type, std::size_t valueSize);
+
+  const char* _data;
+  std::size_t _size;
+  std::size_t _pos;
+  std::string _name;
+  std::size_t _nrow;
+  std::size_t _ncolumn;
+  std::size_t _icolumn;
+};
+
+template <>
+inline DbBinaryColumn<std::string> DbBinaryReader::column<std::string>() {
+  const char* data = nextColumn(DbBinary::typeCode<std::string>(), 0);
+  return DbBinaryColumn<std::string>(data, _nrow);
+}
+
+template <class T, class ROW, class GET>
+void DbBinaryWriter::column(std::vector<ROW> const& rows, GET const& get) {
+  if constexpr (std::is_same<T, std::string>::value) {
+    std::vector<uint64_t> offsets(1, 0);
+    std::string chars;
+    for (auto const& r : rows) {
+      chars += get(r);
+      offsets.push_back(chars.size());
+    }
+    std::size_t nbytes = offsets.size() * sizeof(uint64_t) + chars.size();
+    startColumn(DbBinary::typeCode<T>(), nbytes);
+    _buffer.append(reinterpret_cast<const char*>(offsets.data()),
+                   offsets.size() * sizeof(uint64_t));
+    _buffer.append(chars);
+  } else {
+    startColumn(DbBinary::typeCode<T>(), rows.size() * sizeof(T));
+    std::size_t pos = _buffer.size();
+    _buffer.resize(pos + rows.size() * sizeof(T));
+    for (auto const& r : rows) {
+      T value = get(r);
+      std::memcpy(&_buffer[pos], &value, sizeof(T));
+      pos += sizeof(T);
+    }
+  }
+  endColumn();
+}
+
+}  // namespace mu2e
+#endif
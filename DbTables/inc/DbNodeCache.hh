@@ -0,0 +1,93 @@
+#ifndef DbTables_DbNodeCache_hh
+#define DbTables_DbNodeCache_hh
+
+// A cache of DbTable contents shared by all the processes on a node.
+// DbCache holds tables for one process; this one holds them in files,
+// normally in a tmpfs directory such as /dev/shm, so that when many jobs
+// on a node need the same calibrations, only the first one reads them
+// from the database and the others map the file written by the first.
+//
+// There is one file per table, named by the database, the table name,
+// the cid and a hash of the table schema (db table name, column list,
+// order and binary row format), so a change in the table definition
+// can never pick up stale content.  The file holds a DbNodeCacheHeader
+// followed by the rows, either in the table's binary row format
+// (DbTable::toBinary) or, for tables without one, the csv text.
+// Files are written to a temporary name and renamed into place, so a
+// reader sees either a complete file or none.  The files are only shared
+// between the jobs of one user: they live in a directory of that user,
+// mode 0700, under the configured directory, and a directory or file not
+// owned by the user, or writeable by others, is never read.  Any problem with the
+// cache is reported and treated as a miss - the table is then read
+// from the database as usual.
+
+#include "Offline/DbTables/inc/DbTable.hh"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/stat.h>
+
+namespace mu2e {
+
+struct DbNodeCacheHeader {
+  char magic[8];           // "MU2EDBTC"
+  uint32_t endianTag;      // endianTagValue, as written by the producer
+  uint32_t version;        // file layout version
+  uint64_t schema;         // DbNodeCache::schema() of the table
+  int32_t cid;             // the calibration id of the content
+  int32_t binaryVersion;   // DbTable::binaryVersion(), 0 for csv text
+  uint64_t nrow;           // rows in the table, checked after reading
+  uint64_t dataSize;       // bytes following the header
+};
+
+class DbNodeCache {
+ public:
+  static constexpr uint32_t endianTagValue = 0x01020304;
+  static constexpr uint32_t currentVersion = 1;
+
+  DbNodeCache() :
+      _verbose(0), _nHit(0), _nMiss(0), _nWritten(0), _nFailed(0),
+      _readTime(0) {}
+
+  // the cache is off until a directory is set; the database name
+  // separates the content of different databases
+  void setDirectory(std::string const& directory) { _directory = directory; }
+  void setDbName(std::string const& dbName) { _dbName = dbName; }
+  void setVerbose(int verbose = 0) { _verbose = verbose; }
+  bool enabled() const { return !_directory.empty(); }
+
+  // fill the (empty) table with the content for this cid, if it is in
+  // the cache, and return true.  On a miss, the table is left empty.
+  bool fill(DbTable& table, int cid, bool saveCsv);
+  // save a table that was just read from the database;
+  // csv is the text it was filled from
+  void add(DbTable const& table, int cid, std::string const& csv);
+
+  // hash of everything that defines the table content for a given cid
+  static uint64_t schema(DbTable const& table);
+  std::string fileName(DbTable const& table, int cid) const;
+  // the directory of the current user under the configured directory
+  std::string userDirectory() const;
+
+  void printStats() const;
+
+ private:
+  bool makeDirectory() const;
+  // true if the user directories exist and are private to this user
+  bool checkDirectories(std::string& problem) const;
+  // owned by this user and not writeable by group or others
+  static bool ownedPrivate(struct stat const& info);
+
+  std::string _directory;
+  std::string _dbName;
+  int _verbose;
+  int _nHit;
+  int _nMiss;
+  int _nWritten;
+  int _nFailed;
+  std::chrono::microseconds _readTime;
+};
+
+}  // namespace mu2e
+
+#endif
@@ -43,6 +43,8 @@ class DbTable {
 
   // take the cvs text from a query and build out the table contents
   int fill(const std::string& csv, bool saveCsv = true);
+  // build the table contents from the binary form made by toBinary
+  int fillBinary(const char* data, std::size_t size, bool saveCsv = true);
   // in case table was filled with binary values, convert to csv
   int toCsv();
 
@@ -52,6 +54,14 @@ class DbTable {
   virtual void rowToCsv(std::ostringstream& stream, size_t irow) const = 0;
   // remove all rows
   virtual void clear() = 0;
+
+  // binary form of the rows (see DbBinary), as held in the node-local
+  // table cache and .dbbin files.  binaryVersion() is 0 for a table without
+  // one, which is then stored as csv text and parsed again on reading.
+  // Change the version whenever the columns written by toBinary change.
+  virtual int binaryVersion() const { return 0; }
+  virtual void toBinary(std::string& buffer) const;
+  virtual void fromBinary(const char* data, std::size_t size);
   void baseClear() { _csv.clear(); }
 
  private:
@@ -10,6 +10,13 @@ class DbUtil {
  public:
   static DbTableCollection readFile(std::string const& fn, bool saveCsv = true);
   static void writeFile(std::string const& fn, DbTableCollection const& coll);
+  // the same content in binary form (see DbBinary), chosen by
+  // readFile and writeFile for file names ending in .dbbin
+  static DbTableCollection readBinaryFile(std::string const& fn,
+                                          bool saveCsv = true);
+  static void writeBinaryFile(std::string const& fn,
+                              DbTableCollection const& coll);
+  static bool isBinaryFile(std::string const& fn);
 
   // split a csv string into lines on \n
   static std::vector<std::string> splitCsvLines(std::string const& csv);
@@ -6,6 +6,7 @@
 #define DbTables_TrkAlignElement_hh
 
 #include "Offline/DataProducts/inc/StrawId.hh"
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DbTables/inc/TrkAlignParams.hh"
 #include <iomanip>
@@ -64,6 +65,36 @@ class TrkAlignElement : public DbTable {
     sstream << r.rz() << ",";
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &TrkAlignParams::index);
+    out.column<std::uint16_t>(
+        _rows, [](TrkAlignParams const& r) { return r.id().asUint16(); });
+    out.column(_rows, &TrkAlignParams::dx);
+    out.column(_rows, &TrkAlignParams::dy);
+    out.column(_rows, &TrkAlignParams::dz);
+    out.column(_rows, &TrkAlignParams::rx);
+    out.column(_rows, &TrkAlignParams::ry);
+    out.column(_rows, &TrkAlignParams::rz);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto index = in.column<int>();
+    auto strawId = in.column<std::uint16_t>();
+    auto dx = in.column<float>();
+    auto dy = in.column<float>();
+    auto dz = in.column<float>();
+    auto rx = in.column<float>();
+    auto ry = in.column<float>();
+    auto rz = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(index[i], StrawId(strawId[i]), dx[i], dy[i], dz[i],
+                         rx[i], ry[i], rz[i]);
+    }
+  }
+
   void clear() override {
     baseClear();
     _rows.clear();
@@ -1,6 +1,7 @@
 #ifndef DbTables_TrkAlignStraw_hh
 #define DbTables_TrkAlignStraw_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "Offline/DbTables/inc/TrkStrawEndAlign.hh"
 #include "CLHEP/Vector/ThreeVector.h"
@@ -68,6 +69,49 @@ class TrkAlignStraw : public DbTable {
     sstream << r._straw_hv_dW;
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column<int>(_rows, [](TrkStrawEndAlign const& r) { return r._index; });
+    out.column<std::uint16_t>(
+        _rows, [](TrkStrawEndAlign const& r) { return r.id().asUint16(); });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._wire_cal_dV; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._wire_cal_dW; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._wire_hv_dV; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._wire_hv_dW; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._straw_cal_dV; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._straw_cal_dW; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._straw_hv_dV; });
+    out.column<float>(
+        _rows, [](TrkStrawEndAlign const& r) { return r._straw_hv_dW; });
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto index = in.column<int>();
+    auto strawId = in.column<std::uint16_t>();
+    auto wireCalDV = in.column<float>();
+    auto wireCalDW = in.column<float>();
+    auto wireHvDV = in.column<float>();
+    auto wireHvDW = in.column<float>();
+    auto strawCalDV = in.column<float>();
+    auto strawCalDW = in.column<float>();
+    auto strawHvDV = in.column<float>();
+    auto strawHvDW = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(index[i], StrawId(strawId[i]), wireCalDV[i],
+                         wireCalDW[i], wireHvDV[i], wireHvDW[i], strawCalDV[i],
+                         strawCalDW[i], strawHvDV[i], strawHvDW[i]);
+    }
+  }
+
   virtual void clear() {
     baseClear();
     _rows.clear();
@@ -1,6 +1,7 @@
 #ifndef DbTables_TrkDelayPanel_hh
 #define DbTables_TrkDelayPanel_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include <iomanip>
 #include <map>
@@ -53,6 +54,22 @@ class TrkDelayPanel : public DbTable {
     sstream << r.delay();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::index);
+    out.column(_rows, &Row::delay);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto index = in.column<int>();
+    auto delay = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(index[i], delay[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
@@ -1,6 +1,7 @@
 #ifndef DbTables_TrkDelayRStraw_hh
 #define DbTables_TrkDelayRStraw_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include <iomanip>
 #include <map>
@@ -60,6 +61,24 @@ class TrkDelayRStraw : public DbTable {
     sstream << r.delayCal();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::straw);
+    out.column(_rows, &Row::delayHv);
+    out.column(_rows, &Row::delayCal);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto straw = in.column<int>();
+    auto delayHv = in.column<float>();
+    auto delayCal = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(straw[i], delayHv[i], delayCal[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
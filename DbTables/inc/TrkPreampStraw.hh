@@ -1,6 +1,7 @@
 #ifndef DbTables_TrkPreampStraw_hh
 #define DbTables_TrkPreampStraw_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "cetlib_except/exception.h"
 #include <iomanip>
@@ -74,6 +75,31 @@ class TrkPreampStraw : public DbTable {
     sstream << r.gain();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::index);
+    out.column(_rows, &Row::delayHv);
+    out.column(_rows, &Row::delayCal);
+    out.column(_rows, &Row::thresholdHv);
+    out.column(_rows, &Row::thresholdCal);
+    out.column(_rows, &Row::gain);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto index = in.column<int>();
+    auto delayHv = in.column<float>();
+    auto delayCal = in.column<float>();
+    auto thresholdHv = in.column<float>();
+    auto thresholdCal = in.column<float>();
+    auto gain = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(index[i], delayHv[i], delayCal[i], thresholdHv[i],
+                         thresholdCal[i], gain[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
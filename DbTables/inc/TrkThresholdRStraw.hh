@@ -1,6 +1,7 @@
 #ifndef DbTables_TrkThresholdRStraw_hh
 #define DbTables_TrkThresholdRStraw_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include <iomanip>
 #include <map>
@@ -60,6 +61,24 @@ class TrkThresholdRStraw : public DbTable {
     sstream << r.thresholdCal();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::index);
+    out.column(_rows, &Row::thresholdHv);
+    out.column(_rows, &Row::thresholdCal);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto index = in.column<int>();
+    auto thresholdHv = in.column<float>();
+    auto thresholdCal = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(index[i], thresholdHv[i], thresholdCal[i]);
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
@@ -1,6 +1,7 @@
 #ifndef DbTables_TstCalib1_hh
 #define DbTables_TstCalib1_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include "cetlib_except/exception.h"
 #include <iomanip>
@@ -61,6 +62,25 @@ class TstCalib1 : public DbTable {
     sstream << std::fixed << std::setprecision(3) << r.dToE();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::flag);
+    out.column(_rows, &Row::dToE);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<int>();
+    auto flag = in.column<int>();
+    auto dToE = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], flag[i], dToE[i]);
+      _chanIndex[_rows.back().channel()] = _rows.size() - 1;
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
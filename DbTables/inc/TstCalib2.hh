@@ -1,6 +1,7 @@
 #ifndef DbTables_TstCalib2_hh
 #define DbTables_TstCalib2_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include <iomanip>
 #include <map>
@@ -50,6 +51,23 @@ class TstCalib2 : public DbTable {
     sstream << r.status();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::status);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<int>();
+    auto status = in.column<std::string>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], status[i]);
+      _chanIndex[_rows.back().channel()] = _rows.size() - 1;
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
@@ -1,6 +1,7 @@
 #ifndef DbTables_TstCalib3_hh
 #define DbTables_TstCalib3_hh
 
+#include "Offline/DbTables/inc/DbBinary.hh"
 #include "Offline/DbTables/inc/DbTable.hh"
 #include <iomanip>
 #include <map>
@@ -84,6 +85,42 @@ class TstCalib3 : public DbTable {
     sstream << r.v9();
   }
 
+  int binaryVersion() const override { return 1; }
+  void toBinary(std::string& buffer) const override {
+    DbBinaryWriter out(buffer, *this);
+    out.column(_rows, &Row::channel);
+    out.column(_rows, &Row::v0);
+    out.column(_rows, &Row::v1);
+    out.column(_rows, &Row::v2);
+    out.column(_rows, &Row::v3);
+    out.column(_rows, &Row::v4);
+    out.column(_rows, &Row::v5);
+    out.column(_rows, &Row::v6);
+    out.column(_rows, &Row::v7);
+    out.column(_rows, &Row::v8);
+    out.column(_rows, &Row::v9);
+  }
+  void fromBinary(const char* data, std::size_t size) override {
+    DbBinaryReader in(data, size, *this);
+    auto channel = in.column<int>();
+    auto v0 = in.column<float>();
+    auto v1 = in.column<float>();
+    auto v2 = in.column<float>();
+    auto v3 = in.column<float>();
+    auto v4 = in.column<float>();
+    auto v5 = in.column<float>();
+    auto v6 = in.column<float>();
+    auto v7 = in.column<float>();
+    auto v8 = in.column<float>();
+    auto v9 = in.column<float>();
+    _rows.reserve(in.nrow());
+    for (std::size_t i = 0; i < in.nrow(); i++) {
+      _rows.emplace_back(channel[i], v0[i], v1[i], v2[i], v3[i], v4[i], v5[i],
+                         v6[i], v7[i], v8[i], v9[i]);
+      _chanIndex[_rows.back().channel()] = _rows.size() - 1;
+    }
+  }
+
   virtual void clear() override {
     baseClear();
     _rows.clear();
@@ -0,0 +1,112 @@
+#include "Offline/DbTables/inc/DbBinary.hh"
+#include "cetlib_except/exception.h"
+#include <algorithm>
+
+namespace {
+struct TableHeader {
+  uint64_t nrow;
+  uint32_t ncolumn;
+  uint32_t pad;
+};
+struct ColumnHeader {
+  uint32_t type;
+  uint32_t pad;
+  uint64_t nbytes;
+};
+std::size_t padded(std::size_t n) { return (n + 7) / 8 * 8; }
+}  // namespace
+
+std::size_t mu2e::DbBinary::ncolumn(std::string const& query) {
+  return std::count(query.begin(), query.end(), ',') + 1;
+}
+
+mu2e::DbBinaryWriter::DbBinaryWriter(std::string& buffer,
+                                     DbTable const& table) :
+    _buffer(buffer),
+    _name(table.name()), _nrow(table.nrow()),
+    _ncolumn(DbBinary::ncolumn(table.query())), _icolumn(0) {
+  TableHeader h{_nrow, uint32_t(_ncolumn), 0};
+  _buffer.clear();
+  _buffer.append(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+void mu2e::DbBinaryWriter::startColumn(uint32_t type, std::size_t nbytes) {
+  if (_icolumn >= _ncolumn) {
+    throw cet::exception("DBBINARY_BAD_COLUMN_COUNT")
+        << "DbBinaryWriter " << _name << " has only " << _ncolumn
+        << " columns\n";
+  }
+  ColumnHeader h{type, 0, nbytes};
+  _buffer.append(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+void mu2e::DbBinaryWriter::endColumn() {
+  _buffer.resize(padded(_buffer.size()), '\0');
+  _icolumn++;
+}
+
+mu2e::DbBinaryReader::DbBinaryReader(const char* data, std::size_t size,
+                                     DbTable const& table) :
+    _data(data),
+    _size(size), _pos(sizeof(TableHeader)), _name(table.name()), _nrow(0),
+    _ncolumn(DbBinary::ncolumn(table.query())), _icolumn(0) {
+  if (size < sizeof(TableHeader)) {
+    throw cet::exception("DBBINARY_BAD_SIZE")
+        << "DbBinaryReader " << _name << " data is too short\n";
+  }
+  TableHeader h;
+  std::memcpy(&h, data, sizeof(h));
+  if (h.ncolumn != _ncolumn) {
+    throw cet::exception("DBBINARY_BAD_COLUMN_COUNT")
+        << "DbBinaryReader " << _name << " data has " << h.ncolumn
+        << " columns, the table has " << _ncolumn << "\n";
+  }
+  _nrow = h.nrow;
+}
+
+const char* mu2e::DbBinaryReader::nextColumn(uint32_t type,
+                                             std::size_t valueSize) {
+  if (_icolumn >= _ncolumn) {
+    throw cet::exception("DBBINARY_BAD_COLUMN_COUNT")
+        << "DbBinaryReader " << _name << " has only " << _ncolumn
+        << " columns\n";
+  }
+  ColumnHeader h;
+  if (_pos + sizeof(h) > _size) {
+    throw cet::exception("DBBINARY_BAD_SIZE")
+        << "DbBinaryReader " << _name << " data ends before column "
+        << _icolumn << "\n";
+  }
+  std::memcpy(&h, _data + _pos, sizeof(h));
+  const char* values = _data + _pos + sizeof(h);
+  // a string column starts with nrow+1 offsets
+  std::size_t minBytes = valueSize > 0 ? _nrow * valueSize
+                                       : (_nrow + 1) * sizeof(uint64_t);
+  bool sizeOK = valueSize > 0 ? h.nbytes == minBytes : h.nbytes >= minBytes;
+  if (h.type != type || !sizeOK ||
+      _pos + sizeof(h) + h.nbytes > _size) {
+    throw cet::exception("DBBINARY_BAD_COLUMN")
+        << "DbBinaryReader " << _name << " column " << _icolumn
+        << " has type " << std::hex << h.type << " and " << std::dec
+        << h.nbytes << " bytes, expected type " << std::hex << type
+        << std::dec << "\n";
+  }
+  if (valueSize == 0) {
+    // offsets must rise from 0 to the length of the characters
+    bool ordered = true;
+    uint64_t last = 0, offset;
+    for (std::size_t i = 0; i <= _nrow; i++) {
+      std::memcpy(&offset, values + i * sizeof(uint64_t), sizeof(offset));
+      if (offset < last || (i == 0 && offset != 0)) ordered = false;
+      last = offset;
+    }
+    if (!ordered || minBytes + last != h.nbytes) {
+      throw cet::exception("DBBINARY_BAD_COLUMN")
+          << "DbBinaryReader " << _name << " string column " << _icolumn
+          << " has inconsistent offsets\n";
+    }
+  }
+  _pos = padded(_pos + sizeof(h) + h.nbytes);
+  _icolumn++;
+  return values;
+}
@@ -0,0 +1,275 @@
+#include "Offline/DbTables/inc/DbNodeCache.hh"
+#include "cetlib_except/exception.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Includes from C ( needed for block IO ).
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace {
+const char nodeCacheMagic[8] = {'M', 'U', '2', 'E', 'D', 'B', 'T', 'C'};
+
+// FNV-1a, so the hash is the same in every process and every release
+void hashAppend(uint64_t& hash, std::string const& s) {
+  for (unsigned char c : s) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  hash ^= 0xff;  // separator, so "ab"+"c" differs from "a"+"bc"
+  hash *= 0x100000001b3ULL;
+}
+
+bool writeAll(int fd, const char* p, size_t nbytes) {
+  while (nbytes > 0) {
+    ssize_t s = ::write(fd, p, nbytes);
+    if (s < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += s;
+    nbytes -= s;
+  }
+  return true;
+}
+}  // namespace
+
+uint64_t mu2e::DbNodeCache::schema(DbTable const& table) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hashAppend(hash, table.name());
+  hashAppend(hash, table.dbname());
+  hashAppend(hash, table.query());
+  hashAppend(hash, table.orderBy());
+  hashAppend(hash, std::to_string(table.binaryVersion()));
+  return hash;
+}
+
+std::string mu2e::DbNodeCache::userDirectory() const {
+  return _directory + "/uid" + std::to_string(geteuid());
+}
+
+std::string mu2e::DbNodeCache::fileName(DbTable const& table, int cid) const {
+  std::ostringstream ss;
+  ss << userDirectory() << "/" << _dbName << "/" << table.name() << "_" << cid
+     << "_" << std::hex << std::setw(16) << std::setfill('0') << schema(table)
+     << ".tbl";
+  return ss.str();
+}
+
+bool mu2e::DbNodeCache::fill(DbTable& table, int cid, bool saveCsv) {
+  if (!enabled()) return false;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  std::string fn = fileName(table, cid);
+
+  // only our own directories and files are trusted: anything another
+  // user could have written is never read
+  std::string problem;
+  if (!checkDirectories(problem)) {
+    _nMiss++;
+    if (_verbose > 5)
+      std::cout << "DbNodeCache::fill miss, " << problem << std::endl;
+    return false;
+  }
+
+  int fd = open(fn.c_str(), O_RDONLY | O_NOFOLLOW);
+  if (fd < 0) {
+    _nMiss++;
+    if (_verbose > 5)
+      std::cout << "DbNodeCache::fill miss " << fn << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  void* addr = MAP_FAILED;
+  size_t size = 0;
+  if (fstat(fd, &info) != 0) {
+    problem = "could not be checked";
+  } else if (!ownedPrivate(info) || !S_ISREG(info.st_mode)) {
+    problem = "is not a private file of this user";
+  } else {
+    size = info.st_size;
+    if (size >= sizeof(DbNodeCacheHeader)) {
+      // read-only and shared: the pages are those of the file in the
+      // page cache (or tmpfs), shared with the other jobs of this user
+      addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+  }
+  close(fd);
+
+  if (!problem.empty()) {
+    // not mapped
+  } else if (size < sizeof(DbNodeCacheHeader)) {
+    problem = "is too short";
+  } else if (addr == MAP_FAILED) {
+    problem = "could not be mapped";
+  } else {
+    auto const& h = *static_cast<const DbNodeCacheHeader*>(addr);
+    const char* data = static_cast<const char*>(addr) + sizeof(h);
+    if (memcmp(h.magic, nodeCacheMagic, sizeof(nodeCacheMagic)) != 0 ||
+        h.endianTag != endianTagValue || h.version != currentVersion) {
+      problem = "is not a table cache file for this build";
+    } else if (h.schema != schema(table) || h.cid != cid ||
+               h.binaryVersion != table.binaryVersion()) {
+      problem = "holds a different table";
+    } else if (h.dataSize != size - sizeof(h)) {
+      problem = "has the wrong size";
+    } else {
+      try {
+        if (h.binaryVersion > 0) {
+          table.fillBinary(data, h.dataSize, saveCsv);
+        } else {
+          table.fill(std::string(data, h.dataSize), saveCsv);
+        }
+        if (table.nrow() != h.nrow) problem = "has the wrong number of rows";
+      } catch (cet::exception const& e) {
+        problem = std::string("could not be read: ") + e.what();
+      }
+    }
+    munmap(addr, size);
+  }
+
+  if (!problem.empty()) {
+    if (_verbose > 0)
+      std::cout << "DbNodeCache::fill ignoring " << fn << ", which "
+                << problem << std::endl;
+    table.clear();
+    _nFailed++;
+    _nMiss++;
+    return false;
+  }
+
+  _nHit++;
+  auto end_time = std::chrono::high_resolution_clock::now();
+  _readTime += std::chrono::duration_cast<std::chrono::microseconds>(
+      end_time - start_time);
+  if (_verbose > 5)
+    std::cout << "DbNodeCache::fill read " << table.name() << " cid " << cid
+              << " from " << fn << std::endl;
+  return true;
+}
+
+void mu2e::DbNodeCache::add(DbTable const& table, int cid,
+                            std::string const& csv) {
+  if (!enabled()) return;
+  if (!makeDirectory()) return;
+
+  // this replaces any damaged file that fill() refused
+  std::string fn = fileName(table, cid);
+
+  std::string buffer;
+  try {
+    if (table.binaryVersion() > 0) table.toBinary(buffer);
+  } catch (cet::exception const& e) {
+    if (_verbose > 0)
+      std::cout << "DbNodeCache::add could not convert " << table.name()
+                << ": " << e.what() << std::endl;
+    _nFailed++;
+    return;
+  }
+  std::string const& payload = table.binaryVersion() > 0 ? buffer : csv;
+
+  DbNodeCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, nodeCacheMagic, sizeof(nodeCacheMagic));
+  header.endianTag = endianTagValue;
+  header.version = currentVersion;
+  header.schema = schema(table);
+  header.cid = cid;
+  header.binaryVersion = table.binaryVersion();
+  header.nrow = table.nrow();
+  header.dataSize = payload.size();
+
+  // write to a name private to this process, then rename into place,
+  // so no reader ever sees a partial file
+  std::string tmp = fn + "." + std::to_string(getpid()) + ".tmp";
+  mode_t mode = S_IRUSR | S_IWUSR;
+  int errsave = 0;
+  int fd = open(tmp.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_EXCL, mode);
+  if (fd < 0) {
+    errsave = errno;
+  } else {
+    if (!writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !writeAll(fd, payload.data(), payload.size()))
+      errsave = errno;
+    if (close(fd) != 0 && errsave == 0) errsave = errno;
+    if (errsave == 0 && rename(tmp.c_str(), fn.c_str()) != 0) errsave = errno;
+    if (errsave != 0) unlink(tmp.c_str());
+  }
+
+  if (errsave != 0) {
+    if (_verbose > 0)
+      std::cout << "DbNodeCache::add could not write " << fn
+                << "  errno: " << errsave << " " << strerror(errsave)
+                << std::endl;
+    _nFailed++;
+    return;
+  }
+
+  _nWritten++;
+  if (_verbose > 5)
+    std::cout << "DbNodeCache::add wrote " << table.name() << " cid " << cid
+              << " to " << fn << std::endl;
+}
+
+bool mu2e::DbNodeCache::ownedPrivate(struct stat const& info) {
+  return info.st_uid == geteuid() &&
+         (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+bool mu2e::DbNodeCache::checkDirectories(std::string& problem) const {
+  // the files are only shared between the jobs of one user: each user has
+  // a directory of its own, mode 0700, in the configured directory
+  for (auto const& dir : {userDirectory(), userDirectory() + "/" + _dbName}) {
+    struct stat info;
+    if (lstat(dir.c_str(), &info) != 0) {
+      problem = dir + " does not exist";
+      return false;
+    }
+    if (!S_ISDIR(info.st_mode) || !ownedPrivate(info) ||
+        (info.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+      problem = dir + " is not a private directory of this user";
+      if (_verbose > 0)
+        std::cout << "DbNodeCache ignoring " << problem << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool mu2e::DbNodeCache::makeDirectory() const {
+  // the configured directory is shared by all users on the node, so it is
+  // created like /tmp, sticky and writeable by all; the directories under
+  // it belong to one user
+  if (mkdir(_directory.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) == 0)
+    chmod(_directory.c_str(), S_ISVTX | S_IRWXU | S_IRWXG | S_IRWXO);
+  for (auto const& dir : {userDirectory(), userDirectory() + "/" + _dbName}) {
+    if (mkdir(dir.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+      int errsave = errno;
+      if (_verbose > 0)
+        std::cout << "DbNodeCache could not create directory " << dir
+                  << "  errno: " << errsave << " " << strerror(errsave)
+                  << std::endl;
+      return false;
+    }
+  }
+  std::string problem;
+  return checkDirectories(problem);
+}
+
+void mu2e::DbNodeCache::printStats() const {
+  if (!enabled()) return;
+  std::cout << "    node cache dir     : " << _directory << "\n";
+  std::cout << "    node cache nHit    : " << _nHit << "\n";
+  std::cout << "    node cache nMiss   : " << _nMiss << "\n";
+  std::cout << "    node cache nWritten: " << _nWritten << "\n";
+  std::cout << "    node cache nFailed : " << _nFailed << "\n";
+  std::cout << "    node cache read time: " << _readTime.count() * 1.0e-6
+            << " s\n";
+}
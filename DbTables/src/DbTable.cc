@@ -38,10 +38,32 @@ int mu2e::DbTable::fill(const std::string& csv, bool saveCsv) {
   return 0;
 }
 
+int mu2e::DbTable::fillBinary(const char* data, std::size_t size,
+                              bool saveCsv) {
+  fromBinary(data, size);
+
+  // if this table has a fixed number of rows, check that
+  if (nrowFix() > 0 && nrow() != nrowFix()) {
+    throw cet::exception("DBTABLE_BAD_ROW_COUNT")
+        << "DbTable::fillBinary row count is " << std::to_string(nrow())
+        << " but " << std::to_string(nrowFix())
+        << " is required while filling " << name();
+  }
+
+  // there is no text, so make it from the rows
+  _csv.clear();
+  if (saveCsv) toCsv();
+
+  return 0;
+}
+
 int mu2e::DbTable::toCsv() {
   if (!_csv.empty()) return 0;
   std::ostringstream ss;
-  for (std::size_t i = 0; i < nrow(); i++) rowToCsv(ss, i);
+  for (std::size_t i = 0; i < nrow(); i++) {
+    rowToCsv(ss, i);
+    ss << "\n";
+  }
   _csv = ss.str();
   return 0;
 }
@@ -55,3 +77,13 @@ void mu2e::DbTable::rowToCsv(std::ostringstream& stream, size_t irow) const {
   throw cet::exception("DBTABLE_FUNCTION_NOT_IMPLEMENTED")
       << "DbTable::rowToCsv must be overridden ";
 }
+
+void mu2e::DbTable::toBinary(std::string& buffer) const {
+  throw cet::exception("DBTABLE_FUNCTION_NOT_IMPLEMENTED")
+      << "DbTable::toBinary is not implemented for " << name();
+}
+
+void mu2e::DbTable::fromBinary(const char* data, std::size_t size) {
+  throw cet::exception("DBTABLE_FUNCTION_NOT_IMPLEMENTED")
+      << "DbTable::fromBinary is not implemented for " << name();
+}
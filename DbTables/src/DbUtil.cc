@@ -3,6 +3,7 @@
 #include "Offline/DbTables/inc/DbTableFactory.hh"
 #include "cetlib_except/exception.h"
 #include <algorithm>
+#include <cstring>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -10,8 +11,68 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 
+namespace {
+// .dbbin file layout, numbers in the byte order of the writer:
+//   "MU2EDBBN", uint32 endian tag, uint32 version, uint32 ntable
+//   for each table: string name, uint32 niov, niov strings (DbIoV text),
+//                   int32 binaryVersion, uint64 nrow, string data
+//   where a string is a uint32 length followed by the characters, and
+//   data is the table's binary form, or csv text if binaryVersion is 0
+const char dbbinMagic[8] = {'M', 'U', '2', 'E', 'D', 'B', 'B', 'N'};
+const uint32_t dbbinEndianTag = 0x01020304;
+const uint32_t dbbinVersion = 1;
+
+template <class T>
+void putValue(std::string& buffer, T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+void putString(std::string& buffer, std::string const& s) {
+  putValue<uint32_t>(buffer, s.size());
+  buffer.append(s);
+}
+
+class BinaryInput {
+ public:
+  BinaryInput(std::string const& buffer, std::string const& fn) :
+      _buffer(buffer), _fn(fn), _pos(0) {}
+  const char* take(std::size_t n) {
+    if (_pos + n > _buffer.size()) {
+      throw cet::exception("DBFILE_BAD_BINARY")
+          << "DbUtil::readBinaryFile " << _fn << " ends unexpectedly\n";
+    }
+    const char* p = _buffer.data() + _pos;
+    _pos += n;
+    return p;
+  }
+  template <class T>
+  T value() {
+    T v;
+    std::memcpy(&v, take(sizeof(T)), sizeof(T));
+    return v;
+  }
+  std::string string() {
+    uint32_t n = value<uint32_t>();
+    return std::string(take(n), n);
+  }
+  bool done() const { return _pos == _buffer.size(); }
+
+ private:
+  std::string const& _buffer;
+  std::string const& _fn;
+  std::size_t _pos;
+};
+
+// tables read from files have no cid (-1), but share the table
+// object between the iovs of one TABLE line
+bool sameContent(mu2e::DbLiveTable const& a, mu2e::DbLiveTable const& b) {
+  if (a.cid() >= 0 || b.cid() >= 0) return a.cid() == b.cid();
+  return a.ptr() == b.ptr();
+}
+}  // namespace
+
 // ****************************************************************
 //   read a set of calibration tables from a file
 //   format:
@@ -22,12 +83,14 @@
 //   the table line may have IOV information (see wiki for formats):
 // TABLE tablename start_run:start_sr-end_run:end_sr
 // # can include comment lines with hash as first char
+// a file name ending in .dbbin is read by readBinaryFile instead
 mu2e::DbTableCollection mu2e::DbUtil::readFile(std::string const& fn,
                                                bool saveCsv) {
   if (fn.size() <= 0) {
     throw cet::exception("DBFILE_NO_FILE_NAME")
         << "DbUtil::read called with no file name\n";
   }
+  if (isBinaryFile(fn)) return readBinaryFile(fn, saveCsv);
   std::ifstream myfile;
   myfile.open(fn);
   if (!myfile.is_open()) {
@@ -134,6 +197,10 @@ void mu2e::DbUtil::writeFile(std::string const& fn,
   }
   // silently succeed if nothing to write
   if (coll.size() <= 0) return;
+  if (isBinaryFile(fn)) {
+    writeBinaryFile(fn, coll);
+    return;
+  }
 
   std::ofstream myfile;
   myfile.open(fn);
@@ -155,7 +222,7 @@ void mu2e::DbUtil::writeFile(std::string const& fn,
       // iov's for all occurances of the i'th cid
       for (size_t j = i; j < coll.size(); j++) {
         auto const& livetj = coll[j];
-        if (livetj.cid() == livet.cid()) {
+        if (sameContent(livetj, livet)) {
           myfile << " " << livetj.iov().to_string(true);
           dv[j] = true;
         }
@@ -174,6 +241,135 @@ void mu2e::DbUtil::writeFile(std::string const& fn,
   myfile.close();
 }
 
+// ****************************************************************
+// read a set of calibration tables from a binary file, made by
+// writeBinaryFile.  The rows of tables with a binary form are copied
+// from their columns, the others are parsed from csv as in readFile
+mu2e::DbTableCollection mu2e::DbUtil::readBinaryFile(std::string const& fn,
+                                                     bool saveCsv) {
+  std::ifstream myfile(fn, std::ios::binary);
+  if (!myfile.is_open()) {
+    throw cet::exception("DBFILE_OPEN_FAILED")
+        << "DbUtil::readBinaryFile failed to open " << fn << "\n";
+  }
+  std::string buffer((std::istreambuf_iterator<char>(myfile)),
+                     std::istreambuf_iterator<char>());
+  myfile.close();
+
+  BinaryInput in(buffer, fn);
+  if (std::memcmp(in.take(sizeof(dbbinMagic)), dbbinMagic,
+                  sizeof(dbbinMagic)) != 0 ||
+      in.value<uint32_t>() != dbbinEndianTag ||
+      in.value<uint32_t>() != dbbinVersion) {
+    throw cet::exception("DBFILE_BAD_BINARY")
+        << "DbUtil::readBinaryFile " << fn
+        << " is not a binary table file for this build\n";
+  }
+
+  mu2e::DbTableCollection coll;
+  uint32_t ntable = in.value<uint32_t>();
+  for (uint32_t itable = 0; itable < ntable; itable++) {
+    auto current = mu2e::DbTableFactory::newTable(in.string());
+    std::vector<mu2e::DbIoV> iovv(in.value<uint32_t>());
+    for (auto& iov : iovv) iov.setByString(in.string());
+    int32_t binaryVersion = in.value<int32_t>();
+    uint64_t nrow = in.value<uint64_t>();
+    uint32_t size = in.value<uint32_t>();
+    const char* data = in.take(size);
+
+    if (binaryVersion != current->binaryVersion()) {
+      throw cet::exception("DBFILE_BAD_BINARY_VERSION")
+          << "DbUtil::readBinaryFile " << fn << " holds table "
+          << current->name() << " in binary version " << binaryVersion
+          << ", this build reads version " << current->binaryVersion()
+          << " - remake the file from text\n";
+    }
+    if (binaryVersion > 0) {
+      current->fillBinary(data, size, saveCsv);
+    } else {
+      current->fill(std::string(data, size), saveCsv);
+    }
+    if (current->nrow() != nrow) {
+      throw cet::exception("DBFILE_BAD_BINARY")
+          << "DbUtil::readBinaryFile " << fn << " table " << current->name()
+          << " has " << current->nrow() << " rows, expected " << nrow << "\n";
+    }
+    for (auto const& ii : iovv) {
+      coll.emplace_back(ii, current, -1, -1);
+    }
+  }
+  if (!in.done()) {
+    throw cet::exception("DBFILE_BAD_BINARY")
+        << "DbUtil::readBinaryFile " << fn << " has extra bytes at the end\n";
+  }
+
+  return coll;
+}
+
+// ****************************************************************
+// write a set of calibration tables to a binary file,
+// grouping iovs that share content as in writeFile
+void mu2e::DbUtil::writeBinaryFile(std::string const& fn,
+                                   DbTableCollection const& coll) {
+  std::string buffer, tableData;
+  buffer.append(dbbinMagic, sizeof(dbbinMagic));
+  putValue<uint32_t>(buffer, dbbinEndianTag);
+  putValue<uint32_t>(buffer, dbbinVersion);
+  std::size_t ntablePos = buffer.size();
+  putValue<uint32_t>(buffer, 0);
+
+  uint32_t ntable = 0;
+  std::vector<bool> dv(coll.size(), false);
+  for (size_t i = 0; i < coll.size(); i++) {
+    if (dv[i]) continue;
+    auto const& livet = coll[i];
+    DbTable const& tt = livet.table();
+    putString(buffer, tt.name());
+    std::vector<std::string> iovs;
+    for (size_t j = i; j < coll.size(); j++) {
+      if (sameContent(coll[j], livet)) {
+        iovs.emplace_back(coll[j].iov().to_string(true));
+        dv[j] = true;
+      }
+    }
+    putValue<uint32_t>(buffer, iovs.size());
+    for (auto const& s : iovs) putString(buffer, s);
+    putValue<int32_t>(buffer, tt.binaryVersion());
+    putValue<uint64_t>(buffer, tt.nrow());
+    if (tt.binaryVersion() > 0) {
+      tt.toBinary(tableData);
+    } else {
+      if (tt.nrow() > 0 && tt.csv().size() == 0) {
+        throw cet::exception("DBWRITEFILE_NO_CONTENT")
+            << "DbUtil::writeBinaryFile no content in table " << tt.name()
+            << " with cid " << livet.cid() << "\n";
+      }
+      tableData = tt.csv();
+    }
+    putString(buffer, tableData);
+    ntable++;
+  }
+  std::memcpy(&buffer[ntablePos], &ntable, sizeof(ntable));
+
+  std::ofstream myfile(fn, std::ios::binary);
+  if (!myfile.is_open()) {
+    throw cet::exception("DBFILE_OPEN_FAILED")
+        << "DbUtil::writeBinaryFile failed to open " << fn << "\n";
+  }
+  myfile.write(buffer.data(), buffer.size());
+  myfile.close();
+  if (!myfile) {
+    throw cet::exception("DBFILE_WRITE_FAILED")
+        << "DbUtil::writeBinaryFile failed to write " << fn << "\n";
+  }
+}
+
+bool mu2e::DbUtil::isBinaryFile(std::string const& fn) {
+  std::string ext(".dbbin");
+  return fn.size() > ext.size() &&
+         fn.compare(fn.size() - ext.size(), ext.size(), ext) == 0;
+}
+
 // ****************************************************************
 // split a big string by its newlines
 // the database csv should have a newline at the end of the last line
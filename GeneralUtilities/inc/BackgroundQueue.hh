@@ -0,0 +1,50 @@
+#ifndef GeneralUtilities_BackgroundQueue_hh
+#define GeneralUtilities_BackgroundQueue_hh
+//
+// Run tasks, one at a time and in the order posted, on a thread of
+// its own, so the posting thread does not wait for them.  The thread
+// is started with the first task.  Tasks should handle their own
+// errors; an exception escaping a task is printed and dropped.
+//
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mu2e {
+
+class BackgroundQueue {
+ public:
+  explicit BackgroundQueue(std::string const& name) :
+      _name(name), _stopping(false), _nDone(0) {}
+  ~BackgroundQueue() { stop(); }
+
+  BackgroundQueue(BackgroundQueue const&) = delete;
+  BackgroundQueue& operator=(BackgroundQueue const&) = delete;
+
+  void post(std::function<void()> task);
+  // drop the tasks not yet started
+  void clearPending();
+  // let the running task finish, drop the rest and join the thread
+  void stop();
+
+  int nDone() const;
+
+ private:
+  void run();
+
+  std::string _name;
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<std::function<void()>> _tasks;
+  bool _stopping;
+  int _nDone;
+  std::thread _thread;
+};
+
+}  // namespace mu2e
+
+#endif
@@ -0,0 +1,50 @@
+#include "Offline/GeneralUtilities/inc/BackgroundQueue.hh"
+#include <exception>
+#include <iostream>
+
+void mu2e::BackgroundQueue::post(std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_stopping) return;
+  _tasks.emplace_back(std::move(task));
+  if (!_thread.joinable()) _thread = std::thread([this] { run(); });
+  _cv.notify_one();
+}
+
+void mu2e::BackgroundQueue::clearPending() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _tasks.clear();
+}
+
+void mu2e::BackgroundQueue::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+    _tasks.clear();
+  }
+  _cv.notify_one();
+  if (_thread.joinable()) _thread.join();
+}
+
+int mu2e::BackgroundQueue::nDone() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nDone;
+}
+
+void mu2e::BackgroundQueue::run() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _cv.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+    if (_stopping) return;
+    auto task = std::move(_tasks.front());
+    _tasks.pop_front();
+    lock.unlock();
+    try {
+      task();
+    } catch (std::exception const& e) {
+      std::cout << "BackgroundQueue " << _name << " task failed: " << e.what()
+                << std::endl;
+    }
+    lock.lock();
+    _nDone++;
+  }
+}
@@ -35,6 +35,16 @@ namespace mu2e {
         // Transfer ownership of the BFManager.
         std::unique_ptr<BFieldManager> getBFieldManager() { return std::move(_bfmgr); }
 
+        // Create and fill one grid map from a G4BL text (.txt, .gz, .bz2), G4BL binary
+        // (.header + .bin) or mappable binary (.bfmap) file.
+        static std::shared_ptr<BFGridMap> makeGridMap(const std::string& key,
+                                                      const std::string& resolvedFileName,
+                                                      double scaleFactor,
+                                                      BFInterpolationStyle style);
+
+        // Write an existing BFMap in the mappable binary format (see BFMapFile).
+        static void writeMappedMap(const BFGridMap& bf, const std::string& outputfile);
+
        private:
         // Helper object to turn filenames into full paths using MU2E_SEARCH_PATH.
         ConfigFileLookupPolicy _resolveFullPath;
@@ -62,17 +72,17 @@ namespace mu2e {
                       const BFieldConfig& config);
 
         // Read a G4BL text format map.
-        void readG4BLMap(const std::string& filename, BFGridMap& bfmap,
+        static void readG4BLMap(const std::string& filename, BFGridMap& bfmap,
                          CLHEP::Hep3Vector offset);
 
         // Read a G4BL map that was stored using writeG4BLBinary.
-        void readG4BLBinary(const std::string& headerFilename, BFGridMap& bfmap);
+        static void readG4BLBinary(const std::string& headerFilename, BFGridMap& bfmap);
 
         // Read a CSV with values for parametric map.
         void readParamFile(const std::string& filename, BFParamMap& bfmap);
 
         // Write an existing BFMap in binary format.
-        void writeG4BLBinary(const BFGridMap& bf, const std::string& outputfile);
+        static void writeG4BLBinary(const BFGridMap& bf, const std::string& outputfile);
         void flipMap(BFGridMap& bf);
 
     };  // end class BFieldManagerMaker
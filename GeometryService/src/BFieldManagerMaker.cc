@@ -30,6 +30,7 @@
 
 // Includes from Mu2e
 #include "Offline/BFieldGeom/inc/BFInterpolationStyle.hh"
+#include "Offline/BFieldGeom/inc/BFMapFile.hh"
 #include "Offline/BFieldGeom/inc/BFieldConfig.hh"
 #include "Offline/BFieldGeom/inc/BFieldManager.hh"
 #include "Offline/GeneralUtilities/inc/MinMax.hh"
@@ -148,6 +149,25 @@ namespace mu2e {
             }
         }
 
+        if (config.writeMappedMaps()) {
+          for (auto mapptr : allMaps) {
+                auto gridmap = std::dynamic_pointer_cast<const BFGridMap>(mapptr);
+                if (gridmap) {
+                    writeMappedMap(*gridmap, mapptr->getKey() + ".bfmap");
+                }
+            }
+        }
+
+        // Done writing; the compact maps can not be written out.
+        if (config.compactMaps()) {
+          for (auto mapptr : allMaps) {
+                auto gridmap = std::dynamic_pointer_cast<BFGridMap>(mapptr);
+                if (gridmap) {
+                    gridmap->makeCompact();
+                }
+            }
+        }
+
         // For debug purposes: print the field in the target region
         if (bfieldVerbosityLevel > 0) {
             CLHEP::Hep3Vector b = _bfmgr->getBField(CLHEP::Hep3Vector(3900.0, 0.0, -6550.0));
@@ -377,6 +397,37 @@ namespace mu2e {
                                       const std::string& resolvedFileName,
                                       const BFieldConfig& config) {
 
+        auto dsmap = makeGridMap(key, resolvedFileName, config.scaleFactor(),
+                                 config.interpolationStyle());
+
+        // A mapped map may have been written flipped already.
+        if(config.flipBFieldMaps() != dsmap->_flipped) flipMap(*dsmap);
+
+        mapContainer.emplace_back(dsmap);
+
+    }
+
+    std::shared_ptr<BFGridMap> BFieldManagerMaker::makeGridMap(const std::string& key,
+                                                               const std::string& resolvedFileName,
+                                                               double scaleFactor,
+                                                               BFInterpolationStyle style) {
+
+        // The mappable binary format is self describing and is read in place.
+        if (resolvedFileName.find(".bfmap") != string::npos) {
+            auto file = std::make_shared<const BFMapFile>(resolvedFileName);
+            BFMapFileHeader const& h = file->header();
+            auto dsmap = std::make_shared<BFGridMap>(key, h.nx, h.xmin, h.dx,
+                                                     h.ny, h.ymin, h.dy,
+                                                     h.nz, h.zmin, h.dz,
+                                                     BFMapType::G4BL,
+                                                     scaleFactor,
+                                                     style);
+            dsmap->_flipy = (h.flipy != 0);
+            dsmap->_flipped = (h.flipped != 0);
+            dsmap->attachFile(file);
+            return dsmap;
+        }
+
         // Extract information from the header.
         vector<double> X0;
         vector<int> dim;
@@ -390,9 +441,10 @@ namespace mu2e {
                                                  dim[1], X0[1], dX[1],
                                                  dim[2], X0[2], dX[2],
                                                  BFMapType::G4BL,
-                                                 config.scaleFactor(),
-                                                 config.interpolationStyle());
+                                                 scaleFactor,
+                                                 style);
         dsmap->_flipy = extendYFound;
+        dsmap->allocateField();
         // Fill the map from the disk file.
         if (resolvedFileName.find(".header") != string::npos) {
             readG4BLBinary(resolvedFileName, *dsmap);
@@ -400,10 +452,7 @@ namespace mu2e {
             readG4BLMap(resolvedFileName, *dsmap, G4BL_offset);
         }
 
-        if(config.flipBFieldMaps()) flipMap(*dsmap);
-
-        mapContainer.emplace_back(dsmap);
-
+        return dsmap;
     }
 
 
@@ -717,7 +766,7 @@ namespace mu2e {
         unsigned int deadbeef(0XDEADBEEF);
 
         // Address of the first element in the big array.
-        CLHEP::Hep3Vector const* fieldAddr = &bf._field.get(0, 0, 0);
+        CLHEP::Hep3Vector const* fieldAddr = bf._fieldData;
 
         // Open the output file.
         mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
@@ -762,8 +811,47 @@ namespace mu2e {
     }  // end BFieldManagerMaker::writeG4BLBinary
 
 
+    void BFieldManagerMaker::writeMappedMap(const BFGridMap& bf, const std::string& outputfile) {
+        if (bf.isCompact()) {
+            throw cet::exception("GEOM") << "BFieldManagerMaker:writeMappedMap map " << bf.getKey()
+                                         << " is compact and cannot be written to " << outputfile
+                                         << "\n";
+        }
+
+        // All points of a mappable map are defined.
+        for (size_t ix = 0; ix < bf.nx(); ++ix) {
+            for (size_t iy = 0; iy < bf.ny(); ++iy) {
+                for (size_t iz = 0; iz < bf.nz(); ++iz) {
+                    if (!bf.isDefined(ix, iy, iz)) {
+                        throw cet::exception("GEOM")
+                            << "BFieldManagerMaker:writeMappedMap map " << bf.getKey()
+                            << " has undefined grid points and cannot be written to "
+                            << outputfile << "\n";
+                    }
+                }
+            }
+        }
+
+        BFMapFileHeader header{};
+        header.nx = bf.nx();
+        header.ny = bf.ny();
+        header.nz = bf.nz();
+        header.flipy = bf._flipy;
+        header.flipped = bf._flipped;
+        header.xmin = bf.xmin();
+        header.ymin = bf.ymin();
+        header.zmin = bf.zmin();
+        header.dx = bf.dx();
+        header.dy = bf.dy();
+        header.dz = bf.dz();
+
+        BFMapFile::write(outputfile, header, bf._fieldData);
+
+    }  // end BFieldManagerMaker::writeMappedMap
+
     void BFieldManagerMaker::flipMap(BFGridMap& bf) {
         std::cout << "Flipping B field vector in map " << bf.getKey() << std::endl;
+        bf.makeFieldWritable();
         for (size_t ix = 0; ix < bf.nx(); ++ix) {
             for (size_t iy = 0; iy < bf.ny(); ++iy) {
                 for (size_t iz = 0; iz < bf.nz(); ++iz) {
@@ -771,5 +859,6 @@ namespace mu2e {
                 }
             }
         }
+        bf._flipped = !bf._flipped;
     }
 }  // end namespace mu2e
@@ -0,0 +1,108 @@
+//
+// Convert a G4BL magnetic field map, in text (.txt, .gz, .bz2) or binary
+// (.header + .bin) format, to the mappable binary format (.bfmap) read in
+// place by BFGridMap; see BFieldGeom/inc/BFMapFile.hh.
+//
+// With --bench, load an existing map in both formats and report the startup
+// time and resident memory of each, then check that both give the same field.
+//
+//   bfmapConvert input.header output.bfmap
+//   bfmapConvert --bench input.header output.bfmap [npoints]
+//
+
+#include "Offline/BFieldGeom/inc/BFGridMap.hh"
+#include "Offline/GeneralUtilities/inc/VMInfo.hh"
+#include "Offline/GeometryService/inc/BFieldManagerMaker.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+  void usage() {
+    std::cout << "Usage: bfmapConvert input(.txt|.gz|.bz2|.header) output.bfmap\n"
+              << "       bfmapConvert --bench input(.txt|.gz|.bz2|.header) input.bfmap [npoints]\n";
+  }
+
+  struct Load {
+    std::shared_ptr<mu2e::BFGridMap> map;
+    double seconds;
+    long rssKiB;
+  };
+
+  Load load(std::string const& filename) {
+    mu2e::VMInfo before;
+    auto start = std::chrono::steady_clock::now();
+    auto map = mu2e::BFieldManagerMaker::makeGridMap("bfmapConvert", filename, 1.0,
+        mu2e::BFInterpolationStyle(mu2e::BFInterpolationStyle::trilinear));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    mu2e::VMInfo after;
+    return Load{map, elapsed.count(), after.vmRSS - before.vmRSS};
+  }
+
+  int bench(std::string const& input, std::string const& mapped, unsigned npoints) {
+    // The mapped file first, so that the parse of the input does not warm anything it uses.
+    Load lm = load(mapped);
+    Load li = load(input);
+    std::cout << "Startup, " << input << ": " << li.seconds << " s, RSS +" << li.rssKiB << " KiB\n";
+    std::cout << "Startup, " << mapped << ": " << lm.seconds << " s, RSS +" << lm.rssKiB << " KiB\n";
+
+    mu2e::BFGridMap const& a = *li.map;
+    mu2e::BFGridMap const& b = *lm.map;
+    if (a.nx() != b.nx() || a.ny() != b.ny() || a.nz() != b.nz() || a.xmin() != b.xmin() ||
+        a.ymin() != b.ymin() || a.zmin() != b.zmin()) {
+      std::cout << "Grid mismatch between " << input << " and " << mapped << "\n";
+      return 1;
+    }
+
+    // Random lookups over the whole map touch every page of the mapping.
+    mu2e::VMInfo before;
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> ux(a.xmin(), a.xmax()), uy(a.ymin(), a.ymax()),
+        uz(a.zmin(), a.zmax());
+    unsigned nbad(0);
+    for (unsigned i = 0; i < npoints; ++i) {
+      CLHEP::Hep3Vector pos(ux(gen), uy(gen), uz(gen));
+      CLHEP::Hep3Vector ba, bb;
+      bool sa = a.getBFieldWithStatus(pos, ba);
+      bool sb = b.getBFieldWithStatus(pos, bb);
+      if (sa != sb || ba != bb)
+        ++nbad;
+    }
+    mu2e::VMInfo after;
+    std::cout << "After " << npoints << " lookups in each map: RSS +" << after.vmRSS - before.vmRSS
+              << " KiB (the mapped pages are file backed and shared between processes)\n";
+    std::cout << "Mismatched field values: " << nbad << "\n";
+    return nbad == 0 ? 0 : 1;
+  }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  try {
+    if (args.size() >= 3 && args[0] == "--bench") {
+      unsigned npoints = args.size() > 3 ? std::stoul(args[3]) : 10000000;
+      return bench(args[1], args[2], npoints);
+    }
+    if (args.size() != 2 || args[0].front() == '-') {
+      usage();
+      return 1;
+    }
+    Load li = load(args[0]);
+    std::cout << "Read " << args[0] << " in " << li.seconds << " s\n";
+    mu2e::BFieldManagerMaker::writeMappedMap(*li.map, args[1]);
+  } catch (cet::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
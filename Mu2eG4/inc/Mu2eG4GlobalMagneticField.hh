@@ -10,7 +10,7 @@
 
 #include <string>
 
-#include "Offline/BFieldGeom/inc/BFCacheManager.hh"
+#include "Offline/BFieldGeom/inc/BFieldManager.hh"
 
 #include "Geant4/G4MagneticField.hh"
 #include "Geant4/G4Types.hh"
@@ -18,9 +18,6 @@
 
 namespace mu2e {
 
-  // Forward references
-  class BFieldManager;
-
   class Mu2eG4GlobalMagneticField: public G4MagneticField {
 
   public:
@@ -44,8 +41,8 @@ namespace mu2e {
     // Non-owning pointer to the field map object (it is owned by the geometry service).
     const BFieldManager* _map;
 
-    // A copy of the bfield cache manager - must be thread local.
-    BFCacheManager _cm;
+    // Map-locality hint; this object is thread local, so is the cursor.
+    mutable BFieldManager::Cursor _cursor;
 
   };
 }
@@ -39,6 +39,7 @@ namespace mu2e {
     };
 
     ProditionsCache(std::string name, int verbose=0):
+      _lockWaitTime(0),_lockTime(0),
       _name(name),_verbose(verbose),_initialized(false) {}
     virtual ~ProditionsCache() {}
 
@@ -58,8 +59,9 @@ namespace mu2e {
     virtual ProditionsEntity::ptr makeEntity(art::EventID const& eid) =0;
 
     // this is the main call to the cache asking for an existing
-    // entity, creating and cacheing a new entity as needed
-    ret_t update(art::EventID const& eid) {
+    // entity, creating and cacheing a new entity as needed.
+    // A prefetch call is not counted in the lock times, nor printed
+    ret_t update(art::EventID const& eid, bool prefetching=false) {
       // do lazy initialization, don't bother with
       // read lock since a bool can't be partially constructed
       if(!_initialized) {
@@ -69,7 +71,7 @@ namespace mu2e {
         auto mtime = std::chrono::high_resolution_clock::now();
         auto dt = std::chrono::duration_cast<std::chrono::microseconds>
                                                ( mtime - stime );
-         _lockWaitTime += dt;
+         if(!prefetching) _lockWaitTime += dt;
         // check if another thread initialized while we were
         // waiting for write lock
         if(!_initialized) {
@@ -80,7 +82,7 @@ namespace mu2e {
         auto etime = std::chrono::high_resolution_clock::now();
         dt = std::chrono::duration_cast<std::chrono::microseconds>
                                                ( etime - mtime );
-        _lockTime += dt;  // time we spent write locked
+        if(!prefetching) _lockTime += dt;  // time we spent write locked
       } // end initialize, write lock out of scope, released
 
       // gain shared read lock to find what
@@ -103,7 +105,7 @@ namespace mu2e {
         auto mtime = std::chrono::high_resolution_clock::now();
         auto dt = std::chrono::duration_cast<std::chrono::microseconds>
                                                ( mtime - stime );
-         _lockWaitTime += dt;
+         if(!prefetching) _lockWaitTime += dt;
          // need to check again in case another thread made it
          // between read lock and write lock
          p = findByRun(eid,iov);
@@ -137,11 +139,11 @@ namespace mu2e {
          auto etime = std::chrono::high_resolution_clock::now();
          dt = std::chrono::duration_cast<std::chrono::microseconds>
                                                ( etime - mtime );
-        _lockTime += dt;  // time we spent write locked
+        if(!prefetching) _lockTime += dt;  // time we spent write locked
 
       } // endif not in cache, write lock now destroyed
 
-      if(_verbose>1) {
+      if(_verbose>1 && !prefetching) {
         if(made) {
           if(found) {
             std::cout<< "ProditionsCache::update made new iov for "
@@ -163,6 +165,40 @@ namespace mu2e {
 
     } // end update
 
+    // build ahead the entities for the IoV holding this event and the
+    // nIov IoVs after it, so update finds them in the cache.  This is
+    // only done for caches already in use, and is meant to be run on
+    // a background thread.  Failures are left for update to report.
+    void prefetch(art::EventID const& eid, int nIov) {
+      if(!_initialized) return;
+      uint32_t run = eid.run();
+      uint32_t subrun = eid.subRun();
+      for(int i=0; i<=nIov; i++) {
+        DbIoV iov;
+        try {
+          iov = std::get<1>(update(art::EventID(run,subrun,1),true));
+        } catch (std::exception const& e) {
+          if(_verbose>0) std::cout << "ProditionsCache::prefetch " << name()
+                                   << " failed for " << run << ":" << subrun
+                                   << " : " << e.what() << std::endl;
+          return;
+        }
+        // the start of the next IoV
+        if(iov.endRun()>=DbIoV::maxRun() && iov.endSubrun()>=DbIoV::maxSubrun()) return;
+        if(iov.endSubrun()>=DbIoV::maxSubrun()) {
+          run = iov.endRun()+1;
+          subrun = 0;
+        } else {
+          run = iov.endRun();
+          subrun = iov.endSubrun()+1;
+        }
+      }
+    }
+
+    // time spent by update waiting for the lock, and holding it
+    std::chrono::microseconds lockWaitTime() const { return _lockWaitTime; }
+    std::chrono::microseconds lockTime() const { return _lockTime; }
+
     // is there a cache entry covering this run/subrun?
     // return good pointer or null, and fill iov
     ProditionsEntity::ptr  findByRun(art::EventID eid, DbIoV& iov) {
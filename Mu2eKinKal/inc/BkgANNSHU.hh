@@ -8,16 +8,13 @@
 #include "Offline/Mu2eKinKal/inc/WHSMask.hh"
 #include "Offline/TrackerConditions/inc/DriftInfo.hh"
 #include "Offline/Mu2eKinKal/inc/StrawHitUpdaters.hh"
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
 #include <tuple>
 #include <string>
 #include <iostream>
 #include <cstddef>
 #include <memory>
 
-namespace TMVA_SOFIE_TrainBkg {
-  class Session;
-}
-
 namespace mu2e {
   class ComboHit;
   // Update based just on Bkg to the wire
@@ -28,7 +25,7 @@ namespace mu2e {
       BkgANNSHU(Config const& config);
       WireHitState wireHitState(WireHitState const& input, KinKal::ClosestApproachData const& tpdata, DriftInfo const& dinfo, ComboHit const& chit) const;
     private:
-      std::shared_ptr<TMVA_SOFIE_TrainBkg::Session> mva_;
+      std::shared_ptr<DenseANN> mva_;
       double mvacut_ =0; // cut value to decide if drift information is usable
       WHSMask freeze_; // states to freeze
       int diag_ =0; // diag print level
@@ -9,8 +9,7 @@
 #include "Offline/Mu2eKinKal/inc/KKSHFlag.hh"
 #include "Offline/TrackerConditions/inc/DriftInfo.hh"
 #include "Offline/Mu2eKinKal/inc/StrawHitUpdaters.hh"
-#include "Offline/Mu2eKinKal/inc/TrainSign.hxx"
-#include "Offline/Mu2eKinKal/inc/TrainCluster.hxx"
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
 #include <tuple>
 #include <string>
 #include <iostream>
@@ -27,8 +26,8 @@ namespace mu2e {
       WireHitState wireHitState(WireHitState const& input, KinKal::ClosestApproachData const& tpdata, DriftInfo const& dinfo, ComboHit const& chit) const;
       static std::string const& configDescription(); // description of the variables
     private:
-      std::shared_ptr<TMVA_SOFIE_TrainSign::Session> signmva_; // ANN for selecting correct sign LR ambiguity
-      std::shared_ptr<TMVA_SOFIE_TrainCluster::Session> clustermva_; // ANN for selecting good cluster behavior
+      std::shared_ptr<DenseANN> signmva_; // ANN for selecting correct sign LR ambiguity
+      std::shared_ptr<DenseANN> clustermva_; // ANN for selecting good cluster behavior
       double signmvacut_ =0; // cut value for sign MVA
       double clustermvacut_ =0; // cut value for cluster MVA
       double dtmvacut_ =0; // cut value for using dt constraint
@@ -8,6 +8,7 @@
 #include "Offline/GeometryService/inc/DetectorSystem.hh"
 // KinKal includes
 #include "KinKal/General/BFieldMap.hh"
+#include <vector>
 
 namespace mu2e
 {
@@ -15,13 +16,16 @@ namespace mu2e
   class KKBField : public KinKal::BFieldMap {
     public:
       using Grad = ROOT::Math::SMatrix<double,3>; // field gradient: ie dBi/d(x,y,z)
-      // construct from BField object and system translator.
-      // This should be a single BField map valid in the detector system, to avoid making continuous translations FIXME!
-      KKBField(BFieldManager const& bfmgr, DetectorSystem const& det) : bfmgr_(bfmgr), det_(det) {}
+      // construct from BField object and system translator.  Positions are in the detector system;
+      // the translation to the Mu2e system (where the maps are defined) is applied inline.
+      // numericalGradient selects the old finite-difference derivatives instead of the map gradient (for comparison)
+      KKBField(BFieldManager const& bfmgr, DetectorSystem const& det, bool numericalGradient=false);
       virtual ~KKBField() {}
       // KinKal BField interface
       // return value of the field at a poin
       VEC3 fieldVect(VEC3 const& position) const override;
+      // the same for n points, with one batch lookup in the Mu2e maps
+      void fieldVects(size_t n, VEC3 const* positions, VEC3* fields) const;
       // return BFieldMap gradient = dB_i/dx_j, at a given point
       Grad fieldGrad(VEC3 const& position) const override;
       // return the BFieldMap derivative at a given point along a given velocity, WRT time
@@ -30,8 +34,13 @@ namespace mu2e
       bool inRange(VEC3 const& position) const override;
       void print(std::ostream& os ) const override;
     private:
+      CLHEP::Hep3Vector toMu2e(VEC3 const& position) const {
+        return CLHEP::Hep3Vector(position.x()+origin_.x(),position.y()+origin_.y(),position.z()+origin_.z()); }
       BFieldManager const& bfmgr_;
-      DetectorSystem const& det_;
+      CLHEP::Hep3Vector origin_; // detector origin in the Mu2e system
+      struct Range { VEC3 lo_, hi_; };
+      std::vector<Range> ranges_; // inner map boundaries in the detector system
+      bool numgrad_;
   };
 }
 #endif
@@ -0,0 +1,47 @@
+#ifndef Mu2eKinKal_KKDetBField_hh
+#define Mu2eKinKal_KKDetBField_hh
+//
+//  Mu2e BField for KinKal resampled onto a single grid in the detector system.
+//  The grid is filled once (at beginRun) from the Mu2e maps; lookups inside it need no translation
+//  to the Mu2e system and no map search.  The last cell used on each thread is cached, so consecutive
+//  lookups along a trajectory reuse its corner values.  Points outside the grid are passed to KKBField.
+//
+// Mu2e includes
+#include "Offline/Mu2eKinKal/inc/KKBField.hh"
+#include <vector>
+
+namespace mu2e
+{
+  class KKDetBField : public KinKal::BFieldMap {
+    public:
+      using Grad = ROOT::Math::SMatrix<double,3>; // field gradient: ie dBi/d(x,y,z)
+      // grid corners and spacing, in the detector system (mm)
+      struct Grid {
+        Grid(std::vector<double> const& lo, std::vector<double> const& hi, std::vector<double> const& spacing);
+        VEC3 lo_, hi_, spacing_;
+      };
+      // If the spacing matches that of the Mu2e grid map at the center of the grid, the nodes are placed on its nodes
+      // (the low corner moves down by less than one spacing), so the resampling is exact there.
+      // numericalGradient is passed to the KKBField used outside the grid
+      KKDetBField(BFieldManager const& bfmgr, DetectorSystem const& det, Grid const& grid, bool numericalGradient=false);
+      virtual ~KKDetBField() {}
+      KKDetBField(KKDetBField const&) = delete;
+      KKDetBField& operator=(KKDetBField const&) = delete;
+      // KinKal BField interface
+      VEC3 fieldVect(VEC3 const& position) const override;
+      Grad fieldGrad(VEC3 const& position) const override;
+      VEC3 fieldDeriv(VEC3 const& position, VEC3 const& velocity) const override;
+      bool inRange(VEC3 const& position) const override;
+      void print(std::ostream& os ) const override;
+    private:
+      // trilinear interpolation in the grid; returns false outside it.  Either output may be null
+      bool interpolate(VEC3 const& position, VEC3* field, Grad* grad) const;
+      KKBField bfield_; // source of the samples, and used outside the grid
+      unsigned nx_, ny_, nz_; // number of nodes
+      double xmin_, ymin_, zmin_; // first node
+      double dx_, dy_, dz_; // spacing
+      std::vector<float> field_; // Bx,By,Bz at node (ix*ny_ + iy)*nz_ + iz
+      unsigned id_; // identifies this object in the per-thread cell cache
+  };
+}
+#endif
@@ -11,6 +11,7 @@
 #include "Offline/Mu2eKinKal/inc/KKCaloHit.hh"
 #include "Offline/Mu2eKinKal/inc/KKFitUtilities.hh"
 #include "Offline/Mu2eKinKal/inc/KKFitSettings.hh"
+#include "Offline/Mu2eKinKal/inc/KKHitIndex.hh"
 #include "Offline/Mu2eKinKal/inc/WireHitState.hh"
 // art includes
 #include "canvas/Persistency/Common/Ptr.h"
@@ -42,6 +43,8 @@
 #include <cmath>
 #include <limits>
 #include <algorithm>
+#include <numeric>
+#include <mutex>
 namespace mu2e {
   using KinKal::SensorLine;
   using KinKal::TimeRange;
@@ -91,7 +94,7 @@ namespace mu2e {
       bool makeCaloHit(CCPtr const& cluster, Calorimeter const& calo, PTRAJ const& pktraj, KKCALOHITCOL& hits) const;
       // extend a track with a new configuration, optionally searching for and adding hits and straw material
       void extendTrack(Config const& config, BFieldMap const& kkbf, Tracker const& tracker,
-          StrawResponse const& strawresponse, KKStrawMaterial const& smat, ComboHitCollection const& chcol,
+          StrawResponse const& strawresponse, KKStrawMaterial const& smat, KKHitIndex const& hitindex,
           Calorimeter const& calo, CCHandle const& cchandle,
           KKTRK& kktrk) const;
       // extend the fit to the surfaces specified in the config
@@ -103,12 +106,13 @@ namespace mu2e {
       bool correctMaterial() const { return matcorr_; }
       bool addMaterial() const { return addmat_; }
       bool addHits() const { return addhits_; }
+      double hitIndexTimeBin() const { return hitindextbin_; }
       auto const& strawHitClusterer() const { return shclusterer_; }
     private:
       void fillTrackerInfo(Tracker const& tracker) const;
       void addStrawHits(Tracker const& tracker,StrawResponse const& strawresponse, BFieldMap const& kkbf, KKStrawMaterial const& smat,
-          KKTRK const& kktrk, ComboHitCollection const& chcol, KKSTRAWHITCOL& hits) const;
-      void addStraws(Tracker const& tracker, KKStrawMaterial const& smat, KKTRK const& kktrk, KKSTRAWHITCOL const& addhits, KKSTRAWXINGCOL& addexings) const;
+          KKTRK const& kktrk, KKHitIndex const& hitindex, KKSTRAWHITCOL& hits) const;
+      void addStraws(Tracker const& tracker, KKStrawMaterial const& smat, KKHitIndex const& hitindex, KKTRK const& kktrk, KKSTRAWHITCOL const& addhits, KKSTRAWXINGCOL& addexings) const;
       void addCaloHit(Calorimeter const& calo, KKTRK& kktrk, CCHandle cchandle, KKCALOHITCOL& hits) const;
       void sampleFit(KKTRK const& kktrk,KalIntersectionCollection& inters) const; // sample fit at the surfaces specified in the config
       void extendFit(KKTRK& kktrk) const;
@@ -130,12 +134,15 @@ namespace mu2e {
       // parameters controlling adding hits
       float maxStrawHitDoca_, maxStrawHitDt_, maxStrawDoca_, maxStrawDocaCon_;
       int maxDStraw_; // maximum distance from the track a strawhit can be to consider it for adding.
-      // cached info computed from the tracker, used in hit adding; these must be lazy-evaluated as the tracker doesn't exist on construction
+      bool usehitindex_; // find hits to add through the hit index
+      double hitindextbin_; // hit index time bin width
+      // cached info computed from the tracker, used in hit adding; these must be lazy-evaluated as the tracker doesn't exist on construction.
+      // Fits of different tracks can run concurrently, so the evaluation is guarded by a once_flag
       mutable double strawradius_;
       mutable double ymin_, ymax_, umax_; // panel-level info
       mutable double rmin_, rmax_; // plane-level info
       mutable double spitch_;
-      mutable bool needstrackerinfo_ = true;
+      mutable std::once_flag trackerinfo_;
 
       SaveTraj savetraj_; // trajectory saving option
   };
@@ -162,7 +169,9 @@ namespace mu2e {
     maxStrawHitDt_(fitconfig.maxStrawHitDt()),
     maxStrawDoca_(fitconfig.maxStrawDOCA()),
     maxStrawDocaCon_(fitconfig.maxStrawDOCAConsistency()),
-    maxDStraw_(fitconfig.maxDStraw())
+    maxDStraw_(fitconfig.maxDStraw()),
+    usehitindex_(fitconfig.useHitIndex()),
+    hitindextbin_(fitconfig.hitIndexTimeBin())
   {
     if (fitconfig.saveTraj() == "T0") {
         savetraj_ = t0seg;
@@ -246,14 +255,14 @@ namespace mu2e {
   }
 
   template <class KTRAJ> void KKFit<KTRAJ>::extendTrack(Config const& exconfig, BFieldMap const& kkbf, Tracker const& tracker,
-      StrawResponse const& strawresponse, KKStrawMaterial const& smat, ComboHitCollection const& chcol,
+      StrawResponse const& strawresponse, KKStrawMaterial const& smat, KKHitIndex const& hitindex,
       Calorimeter const& calo, CCHandle const& cchandle,
       KKTRK& kktrk) const {
     KKSTRAWHITCOL addstrawhits;
     KKCALOHITCOL addcalohits;
     KKSTRAWXINGCOL addstrawxings;
-    if(addhits_)addStrawHits(tracker, strawresponse, kkbf, smat, kktrk, chcol, addstrawhits );
-    if(matcorr_ && addmat_)addStraws(tracker, smat, kktrk, addstrawhits, addstrawxings);
+    if(addhits_)addStrawHits(tracker, strawresponse, kkbf, smat, kktrk, hitindex, addstrawhits );
+    if(matcorr_ && addmat_)addStraws(tracker, smat, hitindex, kktrk, addstrawhits, addstrawxings);
     if(addhits_ && usecalo_ && kktrk.caloHits().size()==0)addCaloHit(calo, kktrk, cchandle, addcalohits);
     if(printLevel_ > 1){
       std::cout << "KKTrk extension adding "
@@ -265,12 +274,21 @@ namespace mu2e {
   }
 
   template <class KTRAJ> void KKFit<KTRAJ>::addStrawHits(Tracker const& tracker,StrawResponse const& strawresponse, BFieldMap const& kkbf, KKStrawMaterial const& smat,
-      KKTRK const& kktrk, ComboHitCollection const& chcol, KKSTRAWHITCOL& addhits) const {
+      KKTRK const& kktrk, KKHitIndex const& hitindex, KKSTRAWHITCOL& addhits) const {
     auto const& ftraj = kktrk.fitTraj();
+    auto const& chcol = hitindex.comboHits();
     // build the set of existing hits
     std::set<StrawHitIndex> oldhits;
     for(auto const& strawhit : kktrk.strawHits())oldhits.insert(strawhit->strawHitIndex());
-    for( size_t ich=0; ich < chcol.size();++ich){
+    // find the hits that can pass the time and DOCA cuts below; otherwise test them all
+    std::vector<size_t> testhits;
+    if(usehitindex_)
+      hitindex.candidates(ftraj,maxStrawHitDoca_,maxStrawHitDt_,testhits);
+    else {
+      testhits.resize(chcol.size());
+      std::iota(testhits.begin(),testhits.end(),0);
+    }
+    for(auto ich : testhits){
       if(oldhits.find(ich)==oldhits.end()){      // make sure this hit wasn't already found
         ComboHit const& strawhit = chcol[ich];
         if(strawhit.flag().hasAllProperties(addsel_) && (!strawhit.flag().hasAnyProperty(addrej_))){
@@ -292,14 +310,14 @@ namespace mu2e {
     }
   }
 
-  template <class KTRAJ> void KKFit<KTRAJ>::addStraws(Tracker const& tracker, KKStrawMaterial const& smat, KKTRK const& kktrk,
+  template <class KTRAJ> void KKFit<KTRAJ>::addStraws(Tracker const& tracker, KKStrawMaterial const& smat, KKHitIndex const& hitindex, KKTRK const& kktrk,
       KKSTRAWHITCOL const& addhits, KKSTRAWXINGCOL& addexings) const {
     // this algorithm assumes the track never hits the same straw twice.  That could be violated by reflecting tracks, and could be addressed
     // by including the time of the Xing as part of its identity.  That would slow things down so it remains to be proven it's a problem  TODO
     // build the set of existing straws
     auto const& ftraj = kktrk.fitTraj();
     // pre-compute some tracker info if needed
-    if(needstrackerinfo_)fillTrackerInfo(tracker);
+    std::call_once(trackerinfo_,[this,&tracker](){ fillTrackerInfo(tracker); });
     // list the IDs of existing straws: this speeds the search
     std::set<StrawId> oldstraws;
     for(auto const& strawxing : kktrk.strawXings())oldstraws.insert(strawxing->strawId());
@@ -313,23 +331,25 @@ namespace mu2e {
     // Go hierarchically through planes and panels to find new straws hit by this track.
     for(auto const& plane : tracker.planes()){
       if(tracker.planeExists(plane.id())) {
-        double plz = plane.origin().z();
+        double plz = hitindex.plane(plane.id()).z_;
         // find the track position in at this plane's central z.
         double zt = Mu2eKinKal::zTime(ftraj,plz,ftraj.range().begin());
         auto plpos = ftraj.position3(zt);
         // rough check on the point radius
         double rho = plpos.Rho();
         if(rho > rmin_ && rho < rmax_){
+          auto tdir = ftraj.direction(zt);
           // loop over panels in this plane
           for(auto panel_p : plane.panels()){
             auto const& panel = *panel_p;
+            // the panel transforms are cached in the hit index
+            auto const& pinfo = hitindex.panel(panel.id());
             // linearly correct position for the track direction due to difference in panel-plane Z position
-            auto tdir = ftraj.direction(zt);
-            double dz = panel.origin().z()-plz;
+            double dz = pinfo.z_-plz;
             auto papos = plpos + (dz/tdir.Z())*tdir;
             // convert this position into panel coordinates
             CLHEP::Hep3Vector cpos(papos.X(),papos.Y(),papos.Z()); // clumsy translation
-            auto pposv = panel.dsToPanel()*cpos;
+            auto pposv = pinfo.dsToPanel_*cpos;
             // translate the y position into a rough straw number
             int istraw = static_cast<int>(rint( (pposv.y()-ymin_)*spitch_));
             // require this be within the (integral) straw buffer.  This just reduces the number of calls to PCA
@@ -440,7 +460,6 @@ namespace mu2e {
     rmin_ = innerstraw_origin.y() - maxDStraw_*strawradius_;
     rmax_ = outerstraw.wireEnd(StrawEnd::cal).mag() + maxDStraw_*strawradius_;
     spitch_ = (StrawId::_nstraws-1)/(ymax_-ymin_);
-    needstrackerinfo_= false;
   }
 
 
@@ -6,6 +6,7 @@
 #include "fhiclcpp/types/Atom.h"
 #include "fhiclcpp/types/Sequence.h"
 #include "fhiclcpp/types/OptionalSequence.h"
+#include "fhiclcpp/types/OptionalTable.h"
 #include "fhiclcpp/types/Tuple.h"
 #include "KinKal/Fit/Config.hh"
 #include "canvas/Utilities/InputTag.h"
@@ -85,9 +86,17 @@ namespace mu2e {
       fhicl::Atom<int> maxDStraw { Name("MaxDStraw"), Comment("Maximum (integer) straw separation when adding straw hits") };
       fhicl::Atom<float> maxStrawDOCA { Name("MaxStrawDOCA"), Comment("Max DOCA to add straw material (mm)") };
       fhicl::Atom<float> maxStrawDOCAConsistency { Name("MaxStrawDOCAConsistency"), Comment("Max DOCA chi-consistency to add straw material") };
+      fhicl::Atom<bool> useHitIndex { Name("UseHitIndex"), Comment("Find hits to add through the event panel and time index instead of testing every hit"), true };
+      fhicl::Atom<float> hitIndexTimeBin { Name("HitIndexTimeBin"), Comment("Time bin width of the event hit index (ns)"), 20.0 };
       // extension and sampling
       fhicl::Atom<std::string> saveTraj { Name("SaveTrajectory"), Comment("How to save the trajectory in the KalSeed: None, Full, Detector, or T0 (1 segment containing t0)") };
     };
+    // struct for configuring the detector-system BField grid (see KKDetBField)
+    struct KKDetBFieldConfig {
+      fhicl::Sequence<double> lo { Name("Low"), Comment("Low corner of the grid in detector coordinates (mm)") };
+      fhicl::Sequence<double> hi { Name("High"), Comment("High corner of the grid in detector coordinates (mm)") };
+      fhicl::Sequence<double> spacing { Name("Spacing"), Comment("Grid spacing in x, y, z (mm)") };
+    };
     // struct for configuring a KinKal fit module
     struct KKModuleConfig {
       fhicl::Atom<int> fitParticle {  Name("FitParticle"), Comment("Particle type to fit: e-, e+, mu-, ...")};
@@ -97,6 +106,9 @@ namespace mu2e {
       fhicl::Atom<int> printLevel { Name("PrintLevel"), Comment("Diagnostic printout Level"), 0 };
       fhicl::Sequence<float> seederrors { Name("SeedErrors"), Comment("Initial value of seed parameter errors (rms, various units)") };
       fhicl::Atom<bool> saveAll { Name("SaveAllFits"), Comment("Save all fits, whether they suceed or not"),false };
+      fhicl::OptionalTable<KKDetBFieldConfig> detBField { Name("DetectorBFieldGrid"), Comment("If present, resample the BField at beginRun onto this grid in the detector system") };
+      fhicl::Atom<bool> numBGrad { Name("NumericalBFieldGradient"), Comment("Compute the BField gradient by finite differences instead of from the field maps (for comparison)"),false };
+      fhicl::Atom<bool> concurrentFits { Name("ConcurrentFits"), Comment("Fit the seeds of an event concurrently on the framework thread pool.  Ignored when PrintLevel > 0"),true };
     };
   }
 }
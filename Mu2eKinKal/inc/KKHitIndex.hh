@@ -0,0 +1,120 @@
+#ifndef Mu2eKinKal_KKHitIndex_hh
+#define Mu2eKinKal_KKHitIndex_hh
+//
+//  Per-event index of ComboHits by panel and time, with a table of the panel and plane geometry used to
+//  decide which panels a trajectory passes near.  It is built once per event and shared by all the fits
+//  of that event, to limit the hits and straws tested when extending a track.
+//  The panel serves as the phi sector of each plane.
+//
+#include "KinKal/Trajectory/ParticleTrajectory.hh"
+#include "KinKal/General/Vectors.hh"
+#include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/TrackerGeom/inc/Tracker.hh"
+#include "Offline/GeneralUtilities/inc/HepTransform.hh"
+#include "Offline/DataProducts/inc/StrawId.hh"
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace mu2e {
+  class KKHitIndex {
+    public:
+      // panel geometry, indexed by StrawId::uniquePanel
+      struct PanelInfo {
+        HepTransform dsToPanel_; // DS to panel (UVW) coordinate transform
+        KinKal::VEC3 origin_, vdir_; // origin and V (across the straws) direction in DS coordinates
+        double z_; // origin z
+        double vmin_, vmax_; // V range of the straw centers
+      };
+      // plane geometry, indexed by StrawId::plane
+      struct PlaneInfo {
+        double z_; // origin z
+        double zmin_, zmax_; // z range of the straws, including their radius
+        bool exists_;
+      };
+      // construct from the tracker and hits of this event; tbin is the width of the time bins (ns)
+      KKHitIndex(Tracker const& tracker, ComboHitCollection const& chcol, double tbin=20.0);
+      ComboHitCollection const& comboHits() const { return chcol_; }
+      PlaneInfo const& plane(StrawId const& sid) const { return planes_[sid.plane()]; }
+      PanelInfo const& panel(StrawId const& sid) const { return panels_[sid.uniquePanel()]; }
+      // append the indices of hits that can be within maxdoca (mm) of the trajectory and within maxdt (ns) of the time the
+      // trajectory crosses the hit z position.  The appended indices are sorted and unique
+      template <class KTRAJ> void candidates(KinKal::ParticleTrajectory<KTRAJ> const& ptraj,
+          double maxdoca, double maxdt, std::vector<size_t>& hits) const;
+    private:
+      // append the hits of a panel in the time bins overlapping [tmin,tmax]
+      void addHits(size_t upanel, double tmin, double tmax, std::vector<size_t>& hits) const;
+      ComboHitCollection const& chcol_;
+      std::array<PlaneInfo,StrawId::_nplanes> planes_;
+      std::array<PanelInfo,StrawId::_nupanels> panels_;
+      double tmin_, tbin_; // time binning
+      size_t ntbins_;
+      std::vector<size_t> offsets_; // start of each (panel, time bin) in hits_, ordered by panel then time bin
+      std::vector<size_t> hits_; // hit indices, ascending within each (panel, time bin)
+  };
+
+  template <class KTRAJ> void KKHitIndex::candidates(KinKal::ParticleTrajectory<KTRAJ> const& ptraj,
+      double maxdoca, double maxdt, std::vector<size_t>& hits) const {
+    if(hits_.empty())return;
+    static const double inf = std::numeric_limits<double>::infinity();
+    // no hit can match a trajectory time outside this range
+    double tlo = tmin_ - maxdt;
+    double thi = tmin_ + ntbins_*tbin_ + maxdt;
+    auto const& pieces = ptraj.pieces();
+    size_t nold = hits.size();
+    std::array<bool,StrawId::_npanels> accept;
+    std::vector<std::pair<double,double>> windows;
+    for(size_t iplane=0; iplane < StrawId::_nplanes; ++iplane){
+      auto const& plane = planes_[iplane];
+      if(!plane.exists_)continue;
+      accept.fill(false);
+      windows.clear();
+      double zlo = plane.zmin_ - maxdoca;
+      double zhi = plane.zmax_ + maxdoca;
+      for(size_t ipiece=0; ipiece < pieces.size(); ++ipiece){
+        auto const& piece = *pieces[ipiece];
+        // the first and last pieces are extrapolated, as in Mu2eKinKal::zTime
+        double t1 = ipiece == 0 ? -inf : piece.range().begin();
+        double t2 = ipiece+1 == pieces.size() ? inf : piece.range().end();
+        // z is linear in time on a piece: find when this piece is inside the (buffered) plane slab
+        double tref = piece.range().mid();
+        double zref = piece.position3(tref).Z();
+        double vz = piece.velocity(tref).Z();
+        if(vz != 0.0){
+          double ta = tref + (zlo-zref)/vz;
+          double tb = tref + (zhi-zref)/vz;
+          t1 = std::max(t1,std::min(ta,tb));
+          t2 = std::min(t2,std::max(ta,tb));
+        } else if(zref < zlo || zref > zhi)
+          continue;
+        if(t1 > t2)continue;
+        // any point of the piece in the slab is within half the path length of the window midpoint
+        if(std::isfinite(t1) && std::isfinite(t2)){
+          double tmid = 0.5*(t1+t2);
+          auto pmid = piece.position3(tmid);
+          double reach = maxdoca + 0.5*piece.speed(tmid)*(t2-t1);
+          for(size_t ipanel=0; ipanel < StrawId::_npanels; ++ipanel){
+            auto const& panel = panels_[iplane*StrawId::_npanels+ipanel];
+            double v = panel.vdir_.Dot(pmid-panel.origin_);
+            if(v > panel.vmin_ - reach && v < panel.vmax_ + reach)accept[ipanel] = true;
+          }
+        } else
+          accept.fill(true);
+        t1 = std::max(t1,tlo);
+        t2 = std::min(t2,thi);
+        if(t1 <= t2)windows.emplace_back(t1,t2);
+      }
+      for(size_t ipanel=0; ipanel < StrawId::_npanels; ++ipanel){
+        if(accept[ipanel]){
+          for(auto const& window : windows)addHits(iplane*StrawId::_npanels+ipanel,window.first-maxdt,window.second+maxdt,hits);
+        }
+      }
+    }
+    // restore the collection order, removing hits found through more than 1 window
+    std::sort(hits.begin()+nold,hits.end());
+    hits.erase(std::unique(hits.begin()+nold,hits.end()),hits.end());
+  }
+}
+#endif
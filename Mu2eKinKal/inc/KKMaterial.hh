@@ -12,6 +12,7 @@
 #include "Offline/Mu2eKinKal/inc/KKFileFinder.hh"
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace mu2e {
@@ -42,7 +43,8 @@ namespace mu2e {
       std::string wallmatname_, gasmatname_, wirematname_,ipamatname_, stmatname_;
       MatEnv::DetMaterial::energylossmode eloss_;
       mutable std::unique_ptr<MatDBInfo> matdbinfo_; // material database
-      mutable std::unique_ptr<KKStrawMaterial> smat_; // straw material
+      mutable std::unique_ptr<KKStrawMaterial> smat_; // straw material, created on first use
+      mutable std::once_flag smatflag_; // strawMaterial can be called from concurrent fits
   };
 }
 #endif
@@ -2,7 +2,7 @@
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
 #include "Offline/Mu2eKinKal/inc/StrawHitUpdaters.hh"
 #include "Offline/ConfigTools/inc/ConfigFileLookupPolicy.hh"
-#include "Offline/Mu2eKinKal/inc/TrainBkg.hxx"
+#include "cetlib_except/exception.h"
 #include <cmath>
 #include <array>
 
@@ -12,7 +12,9 @@ namespace mu2e {
   BkgANNSHU::BkgANNSHU(Config const& config) {
     ConfigFileLookupPolicy configFile;
     auto mvaWgtsFile = configFile(std::get<0>(config));
-    mva_ = std::make_shared<TMVA_SOFIE_TrainBkg::Session>(mvaWgtsFile);
+    mva_ = std::make_shared<DenseANN>(mvaWgtsFile,DenseANN::relu,DenseANN::sigmoid);
+    if(mva_->nInputs() != 6)
+      throw cet::exception("RECO")<<"mu2e::BkgANNSHU: unexpected ANN inputs " << mva_->nInputs() << std::endl;
     mvacut_ = std::get<1>(config);
     std::string freeze = std::get<2>(config);
     diag_ = std::get<3>(config);
@@ -35,7 +37,10 @@ namespace mu2e {
       double upos = -endsign*tpdata.sensorDirection().Dot(tpdata.sensorPoca().Vect() - chit.centerPos());
       pars[4] = fabs(chit.wireDist() - upos);
       pars[5] = tpdata.particlePoca().Vect().Rho();
-      auto mvaout = mva_->infer(pars.data());
+      // single-row inference, as KinKal updates hits one at a time.  Each thread (concurrent fit) has its own scratch space
+      static thread_local DenseANN::Workspace ws;
+      std::array<float,1> mvaout;
+      mvaout[0] = mva_->infer(pars.data(),ws);
       whstate.quality_[WireHitState::bkg] = mvaout[0];
       whstate.algo_  = StrawHitUpdaters::BkgANN;
       if(mvaout[0] < mvacut_){
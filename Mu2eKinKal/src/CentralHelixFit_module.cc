@@ -9,7 +9,7 @@
 #include "fhiclcpp/types/Table.h"
 #include "fhiclcpp/types/Tuple.h"
 #include "fhiclcpp/types/OptionalAtom.h"
-#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Run.h"
 #include "art/Framework/Principal/Handle.h"
@@ -58,6 +58,7 @@
 #include "Offline/Mu2eKinKal/inc/KKStrawXing.hh"
 #include "Offline/Mu2eKinKal/inc/KKCaloHit.hh"
 #include "Offline/Mu2eKinKal/inc/KKBField.hh"
+#include "Offline/Mu2eKinKal/inc/KKDetBField.hh"
 #include "Offline/Mu2eKinKal/inc/KKConstantBField.hh"
 #include "Offline/Mu2eKinKal/inc/KKFitUtilities.hh"
 // root
@@ -70,6 +71,8 @@
 #include <functional>
 #include <vector>
 #include <memory>
+// TBB
+#include "tbb/parallel_for.h"
 
 using KTRAJ= KinKal::CentralHelix; // this must come before HelixFit
 #include "Offline/TrkReco/inc/TrkUtilities.hh"
@@ -128,14 +131,18 @@ namespace mu2e {
 // helix module specific config
   };
 
-  class CentralHelixFit : public art::EDProducer {
+  class CentralHelixFit : public art::SharedProducer {
     public:
-      using Parameters = art::EDProducer::Table<GlobalConfig>;
-      explicit CentralHelixFit(const Parameters& settings);
+      using Parameters = art::SharedProducer::Table<GlobalConfig>;
+      explicit CentralHelixFit(const Parameters& settings, art::ProcessingFrame const& frame);
       virtual ~CentralHelixFit() {}
-      void beginRun(art::Run& run) override;
-      void produce(art::Event& event) override;
+      void beginRun(art::Run& run, art::ProcessingFrame const& frame) override;
+      void produce(art::Event& event, art::ProcessingFrame const& frame) override;
     protected:
+      // fit a single seed; this is called concurrently for the seeds of an event, so it may only use const module state.
+      // Returns null if the fit should not be saved
+      std::unique_ptr<KKTRK> fitSeed(CosmicTrackSeed const& cseed, Tracker const& tracker, StrawResponse const& strawresponse,
+          Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const;
       bool goodFit(KKTRK const& ktrk) const;
       void sampleFit(KKTRK const& kktrk,KalIntersectionCollection& inters) const;
       TrkFitFlag fitflag_;
@@ -146,6 +153,7 @@ namespace mu2e {
       std::vector<art::ProductToken<CosmicTrackSeedCollection>> cseedCols_;
       TrkFitFlag goodseed_;
       bool saveall_;
+      bool concurrent_; // fit seeds concurrently
       ProditionsHandle<StrawResponse> strawResponse_h_;
       ProditionsHandle<Tracker> alignedTracker_h_;
       int print_;
@@ -158,6 +166,8 @@ namespace mu2e {
       Config config_; // initial fit configuration object
       Config exconfig_; // extension configuration object
       bool fixedfield_; //
+      bool numgrad_; // finite-difference BField gradient
+      std::unique_ptr<KKDetBField::Grid> detgrid_; // optional detector-system BField grid
       double seedMom_;
       int seedCharge_;
       double sampletol_; // surface intersection tolerance (mm)
@@ -167,12 +177,13 @@ namespace mu2e {
       std::array<double,KinKal::NParams()> paramconstraints_;
     };
 
-  CentralHelixFit::CentralHelixFit(const Parameters& settings) : art::EDProducer{settings},
+  CentralHelixFit::CentralHelixFit(const Parameters& settings, art::ProcessingFrame const& frame) : art::SharedProducer{settings},
     fitflag_(TrkFitFlag::KKCentralHelix),
     chcol_T_(consumes<ComboHitCollection>(settings().modSettings().comboHitCollection())),
     cccol_T_(mayConsume<CaloClusterCollection>(settings().modSettings().caloClusterCollection())),
     goodseed_(settings().modSettings().seedFlags()),
     saveall_(settings().modSettings().saveAll()),
+    concurrent_(settings().modSettings().concurrentFits() && settings().modSettings().printLevel() == 0),
     print_(settings().modSettings().printLevel()),
     fpart_(static_cast<PDGCode::type>(settings().modSettings().fitParticle())),
     kkfit_(settings().kkfitSettings()),
@@ -180,6 +191,7 @@ namespace mu2e {
     config_(Mu2eKinKal::makeConfig(settings().fitSettings())),
     exconfig_(Mu2eKinKal::makeConfig(settings().extSettings())),
     fixedfield_(false),
+    numgrad_(settings().modSettings().numBGrad()),
     seedMom_(settings().modSettings().seedMom()),
     seedCharge_(settings().modSettings().seedCharge()),
     sampletol_(settings().modSettings().sampleTol()),
@@ -187,6 +199,9 @@ namespace mu2e {
     sampleinrange_(settings().modSettings().sampleInRange()),
     sampleinbounds_(settings().modSettings().sampleInBounds())
     {
+      // the proditions handles and per-run BField are module state, so events are processed one at a time.
+      // The seeds within an event are fit concurrently, see produce
+      serialize<art::InEvent>();
       // collection handling
       for(const auto& cseedtag : settings().modSettings().seedCollections()) { cseedCols_.emplace_back(consumes<CosmicTrackSeedCollection>(cseedtag)); }
       produces<KKTRKCOL>();
@@ -209,6 +224,10 @@ namespace mu2e {
         fixedfield_ = true;
         kkbf_ = std::move(std::make_unique<KKConstantBField>(VEC3(0.0,0.0,bz)));
       }
+      if(settings().modSettings().detBField()){
+        auto const& dbf = *settings().modSettings().detBField();
+        detgrid_ = std::make_unique<KKDetBField::Grid>(dbf.lo(),dbf.hi(),dbf.spacing());
+      }
       SurfaceIdCollection ssids;
       for(auto const& sidname : settings().modSettings().sampleSurfaces()) {
         ssids.push_back(SurfaceId(sidname,-1)); // match all elements
@@ -219,7 +238,7 @@ namespace mu2e {
       smap.surfaces(ssids,sample_);
     }
 
-  void CentralHelixFit::beginRun(art::Run& run) {
+  void CentralHelixFit::beginRun(art::Run& run, art::ProcessingFrame const& frame) {
     // setup things that rely on data related to beginRun
     auto const& ptable = GlobalConstantsHandle<ParticleDataList>();
     mass_ = ptable->particle(fpart_).mass();
@@ -227,12 +246,15 @@ namespace mu2e {
     if(!fixedfield_){
       GeomHandle<BFieldManager> bfmgr;
       GeomHandle<DetectorSystem> det;
-      kkbf_ = std::move(std::make_unique<KKBField>(*bfmgr,*det));
+      if(detgrid_)
+        kkbf_ = std::make_unique<KKDetBField>(*bfmgr,*det,*detgrid_,numgrad_);
+      else
+        kkbf_ = std::move(std::make_unique<KKBField>(*bfmgr,*det,numgrad_));
     }
     if(print_ > 0) kkbf_->print(std::cout);
   }
 
-  void CentralHelixFit::produce(art::Event& event ) {
+  void CentralHelixFit::produce(art::Event& event, art::ProcessingFrame const& frame) {
     GeomHandle<Calorimeter> calo_h;
     // find current proditions
     auto const& strawresponse = strawResponse_h_.getPtr(event.id());
@@ -241,111 +263,36 @@ namespace mu2e {
     auto ch_H = event.getValidHandle<ComboHitCollection>(chcol_T_);
     auto cc_H = event.getValidHandle<CaloClusterCollection>(cccol_T_);
     auto const& chcol = *ch_H;
+    // index the hits and panels once for all the fits of this event
+    KKHitIndex hitindex(*tracker,chcol,kkfit_.hitIndexTimeBin());
     // create output
     unique_ptr<KKTRKCOL> kktrkcol(new KKTRKCOL );
     unique_ptr<KalSeedCollection> kkseedcol(new KalSeedCollection );
-
+    // find the seeds to fit, in collection order
     unsigned nseed(0);
+    std::vector<CosmicTrackSeed const*> cseeds;
     for (auto const& cseedtag : cseedCols_) {
       auto const& cseedcol_h = event.getValidHandle<CosmicTrackSeedCollection>(cseedtag);
       auto const& cseedcol = *cseedcol_h;
       nseed += cseedcol.size();
-
-      for (size_t index=0;index<cseedcol.size();++index){
-        const auto& cseed = cseedcol[index];
-
-        auto trange = Mu2eKinKal::timeBounds(cseed.hits());
-        auto fitpart = fpart_;
-
-
-        XYZVectorF trackmid(0,0,0);
-        for (size_t i=0;i<cseed.hits().size();i++){
-          auto hiti = cseed.hits()[i];
-          trackmid += hiti.pos();
-        }
-        trackmid /= cseed.hits().size();
-
-        XYZVectorF trackpos = cseed.track().FitEquation.Pos;
-        XYZVectorF trackdir = cseed.track().FitEquation.Dir.Unit();
-        if (trackdir.y() > 0)
-          trackdir *= -1;
-
-        // put direction as tangent to circle at mid y position
-        double dist = 0;
-        if (fabs(trackdir.y()) > 0.01)
-          dist = (trackmid.y() - trackpos.y())/trackdir.y();
-        else if (fabs(trackdir.x()) > 0.01)
-          dist = (trackmid.x() - trackpos.x())/trackdir.x();
-        trackpos += dist * trackdir;
-        double t0 = cseed.t0().t0() + dist/299.9;
-
-        // take the magnetic field at track center as nominal
-        auto bnom = kkbf_->fieldVect(VEC3(trackpos.x(),trackpos.y(),trackpos.z()));
-
-        XYZVectorF trackmom = trackdir * seedMom_;
-
-        KinKal::Parameters kkpars;
-        try {
-          auto temptraj = KTRAJ(KinKal::VEC4(trackpos.x(),trackpos.y(),trackpos.z(),t0),KinKal::MOM4(trackmom.x(),trackmom.y(),trackmom.z(),mass_), seedCharge_, bnom.Z());
-          kkpars = KinKal::Parameters(temptraj.params().parameters(),seedcov_);
-        } catch (std::invalid_argument const& error) {
-          if(print_ > 0) std::cout << "CentralHelixFit Seed Error " << error.what() << std::endl;
-          continue;
-        }
-        auto seedtraj = KTRAJ(kkpars,mass_,seedCharge_,bnom.Z(),trange);
-
-        // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
-        PTRAJ pseedtraj(seedtraj);
-
-        // first, we need to unwind the combohits.  We use this also to find the time range
-        StrawHitIndexCollection strawHitIdxs;
-        auto chcolptr = cseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
-        if(chcolptr != &chcol)
-          throw cet::exception("RECO")<<"mu2e::KKCentralHelixFit: inconsistent ComboHitCollection" << std::endl;
-        // next, build straw hits and materials from these
-        KKSTRAWHITCOL strawhits;
-        strawhits.reserve(strawHitIdxs.size());
-        KKSTRAWXINGCOL strawxings;
-        strawxings.reserve(strawHitIdxs.size());
-        kkfit_.makeStrawHits(*tracker, *strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, chcol, strawHitIdxs, strawhits, strawxings);
-        // optionally (and if present) add the CaloCluster as a constraint
-        // verify the cluster looks physically reasonable before adding it TODO!  Or, let the KKCaloHit updater do it TODO
-        KKCALOHITCOL calohits;
-        //FIXME    if (kkfit_.useCalo() && hseed.caloCluster().isNonnull())kkfit_.makeCaloHit(hseed.caloCluster(),*calo_h, pseedtraj, calohits);
-        // extend the seed range given the hits and xings
-
-        try {
-          seedtraj.range() = kkfit_.range(strawhits,calohits,strawxings);
-
-          // create and fit the track
-          auto kktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fitpart,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits,paramconstraints_);
-          // Check the fit
-          auto goodfit = goodFit(*kktrk);
-          // if we have an extension schedule, extend.
-          if(goodfit && exconfig_.schedule().size() > 0) {
-            //  std::cout << "EXTENDING TRACK " << event.id() << " " << index << std::endl;
-            kkfit_.extendTrack(exconfig_,*kkbf_, *tracker,*strawresponse, kkmat_.strawMaterial(), chcol, *calo_h, cc_H, *kktrk );
-            goodfit = goodFit(*kktrk);
-          }
-
-          if(print_>1)kktrk->printFit(std::cout,print_);
-          if(goodfit || saveall_){
-            TrkFitFlag fitflag;//(hptr->status());
-            fitflag.merge(fitflag_);
-            if(goodfit)
-              fitflag.merge(TrkFitFlag::FitOK);
-            else
-              fitflag.clear(TrkFitFlag::FitOK);
-            auto kkseed = kkfit_.createSeed(*kktrk,fitflag,*calo_h);
-            sampleFit(*kktrk,kkseed._inters);
-            kkseedcol->push_back(kkseed);
-            // save (unpersistable) KKTrk in the event
-            kktrkcol->push_back(kktrk.release());
-          }
-
-        } catch (std::invalid_argument const& error) {
-          if(print_ > 0) std::cout << "CentralHelixFit Error " << error.what() << std::endl;
-        }
+      for (auto const& cseed : cseedcol) cseeds.push_back(&cseed);
+    }
+    // fit the seeds.  The fits are independent, so they can run concurrently; the results are indexed by seed
+    std::vector<std::unique_ptr<KKTRK>> kktrks(cseeds.size());
+    std::vector<KalSeed> kkseeds(cseeds.size());
+    auto fitone = [&](size_t iseed) {
+      kktrks[iseed] = fitSeed(*cseeds[iseed],*tracker,*strawresponse,*calo_h,hitindex,cc_H,kkseeds[iseed]);
+    };
+    if(concurrent_)
+      tbb::parallel_for(size_t(0),cseeds.size(),fitone);
+    else
+      for(size_t iseed=0; iseed < cseeds.size(); ++iseed)fitone(iseed);
+    // fill the output in seed order, so that it doesn't depend on the scheduling
+    for(size_t iseed=0; iseed < cseeds.size(); ++iseed) {
+      if(kktrks[iseed]){
+        kkseedcol->push_back(std::move(kkseeds[iseed]));
+        // save (unpersistable) KKTrk in the event
+        kktrkcol->push_back(kktrks[iseed].release());
       }
     }
     // put the output products into the event
@@ -354,6 +301,101 @@ namespace mu2e {
     event.put(move(kkseedcol));
   }
 
+  std::unique_ptr<KKTRK> CentralHelixFit::fitSeed(CosmicTrackSeed const& cseed, Tracker const& tracker, StrawResponse const& strawresponse,
+      Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const {
+    auto const& chcol = hitindex.comboHits();
+    auto trange = Mu2eKinKal::timeBounds(cseed.hits());
+    auto fitpart = fpart_;
+
+
+    XYZVectorF trackmid(0,0,0);
+    for (size_t i=0;i<cseed.hits().size();i++){
+      auto hiti = cseed.hits()[i];
+      trackmid += hiti.pos();
+    }
+    trackmid /= cseed.hits().size();
+
+    XYZVectorF trackpos = cseed.track().FitEquation.Pos;
+    XYZVectorF trackdir = cseed.track().FitEquation.Dir.Unit();
+    if (trackdir.y() > 0)
+      trackdir *= -1;
+
+    // put direction as tangent to circle at mid y position
+    double dist = 0;
+    if (fabs(trackdir.y()) > 0.01)
+      dist = (trackmid.y() - trackpos.y())/trackdir.y();
+    else if (fabs(trackdir.x()) > 0.01)
+      dist = (trackmid.x() - trackpos.x())/trackdir.x();
+    trackpos += dist * trackdir;
+    double t0 = cseed.t0().t0() + dist/299.9;
+
+    // take the magnetic field at track center as nominal
+    auto bnom = kkbf_->fieldVect(VEC3(trackpos.x(),trackpos.y(),trackpos.z()));
+
+    XYZVectorF trackmom = trackdir * seedMom_;
+
+    KinKal::Parameters kkpars;
+    try {
+      auto temptraj = KTRAJ(KinKal::VEC4(trackpos.x(),trackpos.y(),trackpos.z(),t0),KinKal::MOM4(trackmom.x(),trackmom.y(),trackmom.z(),mass_), seedCharge_, bnom.Z());
+      kkpars = KinKal::Parameters(temptraj.params().parameters(),seedcov_);
+    } catch (std::invalid_argument const& error) {
+      if(print_ > 0) std::cout << "CentralHelixFit Seed Error " << error.what() << std::endl;
+      return nullptr;
+    }
+    auto seedtraj = KTRAJ(kkpars,mass_,seedCharge_,bnom.Z(),trange);
+
+    // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
+    PTRAJ pseedtraj(seedtraj);
+
+    // first, we need to unwind the combohits.  We use this also to find the time range
+    StrawHitIndexCollection strawHitIdxs;
+    auto chcolptr = cseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
+    if(chcolptr != &chcol)
+      throw cet::exception("RECO")<<"mu2e::KKCentralHelixFit: inconsistent ComboHitCollection" << std::endl;
+    // next, build straw hits and materials from these
+    KKSTRAWHITCOL strawhits;
+    strawhits.reserve(strawHitIdxs.size());
+    KKSTRAWXINGCOL strawxings;
+    strawxings.reserve(strawHitIdxs.size());
+    kkfit_.makeStrawHits(tracker, strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, chcol, strawHitIdxs, strawhits, strawxings);
+    // optionally (and if present) add the CaloCluster as a constraint
+    // verify the cluster looks physically reasonable before adding it TODO!  Or, let the KKCaloHit updater do it TODO
+    KKCALOHITCOL calohits;
+    //FIXME    if (kkfit_.useCalo() && hseed.caloCluster().isNonnull())kkfit_.makeCaloHit(hseed.caloCluster(),calo, pseedtraj, calohits);
+    // extend the seed range given the hits and xings
+
+    try {
+      seedtraj.range() = kkfit_.range(strawhits,calohits,strawxings);
+
+      // create and fit the track
+      auto kktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fitpart,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits,paramconstraints_);
+      // Check the fit
+      auto goodfit = goodFit(*kktrk);
+      // if we have an extension schedule, extend.
+      if(goodfit && exconfig_.schedule().size() > 0) {
+        kkfit_.extendTrack(exconfig_,*kkbf_, tracker,strawresponse, kkmat_.strawMaterial(), hitindex, calo, cc_H, *kktrk );
+        goodfit = goodFit(*kktrk);
+      }
+
+      if(print_>1)kktrk->printFit(std::cout,print_);
+      if(goodfit || saveall_){
+        TrkFitFlag fitflag;//(hptr->status());
+        fitflag.merge(fitflag_);
+        if(goodfit)
+          fitflag.merge(TrkFitFlag::FitOK);
+        else
+          fitflag.clear(TrkFitFlag::FitOK);
+        kkseed = kkfit_.createSeed(*kktrk,fitflag,calo);
+        sampleFit(*kktrk,kkseed._inters);
+        return kktrk;
+      }
+
+    } catch (std::invalid_argument const& error) {
+      if(print_ > 0) std::cout << "CentralHelixFit Error " << error.what() << std::endl;
+    }
+    return nullptr;
+  }
+
   bool CentralHelixFit::goodFit(KKTRK const& ktrk) const {
     // require physical consistency: fit can succeed but the result can have changed charge or helicity
     bool retval = ktrk.fitStatus().usable();
@@ -1,6 +1,7 @@
 #include "Offline/Mu2eKinKal/inc/DriftANNSHU.hh"
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
 #include "Offline/ConfigTools/inc/ConfigFileLookupPolicy.hh"
+#include "cetlib_except/exception.h"
 #include <cmath>
 #include <array>
 
@@ -10,10 +11,12 @@ namespace mu2e {
   DriftANNSHU::DriftANNSHU(Config const& config) {
     ConfigFileLookupPolicy configFile;
     auto signmvaWgtsFile = configFile(std::get<0>(config));
-    signmva_ = std::make_shared<TMVA_SOFIE_TrainSign::Session>(signmvaWgtsFile);
+    signmva_ = std::make_shared<DenseANN>(signmvaWgtsFile,DenseANN::relu,DenseANN::sigmoid);
     signmvacut_ = std::get<1>(config);
     auto clustermvaWgtsFile = configFile(std::get<2>(config));
-    clustermva_ = std::make_shared<TMVA_SOFIE_TrainCluster::Session>(clustermvaWgtsFile);
+    clustermva_ = std::make_shared<DenseANN>(clustermvaWgtsFile,DenseANN::relu,DenseANN::sigmoid);
+    if(signmva_->nInputs() != 5 || clustermva_->nInputs() != 4)
+      throw cet::exception("RECO")<<"mu2e::DriftANNSHU: unexpected ANN inputs " << signmva_->nInputs() << " " << clustermva_->nInputs() << std::endl;
     clustermvacut_ = std::get<3>(config);
     dtmvacut_ = std::get<4>(config);
     std::string freeze = std::get<5>(config);
@@ -47,14 +50,17 @@ namespace mu2e {
       // For sign, noralize only to the crossing angle, as there it serves as an estimate of the drift radius
       double sint = sqrt(1.0-tpdata.dirDot()*tpdata.dirDot());
       spars[4] = chit.energyDep()*sint;
-      auto signmvaout = signmva_->infer(spars.data());
       cpars[0] = fabs(tpdata.doca());
       cpars[1] = dinfo.cDrift_;
       cpars[2] = chit.driftTime();
       // For drift quality, normalize to the estimated path length through the straw, as that measures the clustering effects
       double plen = sqrt(std::max(0.25, 6.25-dinfo.rDrift_*dinfo.rDrift_))/sint;
       cpars[3] = chit.energyDep()/plen;
-      auto clustermvaout = clustermva_->infer(cpars.data());
+      // KinKal updates hits one at a time, so these are single-row inferences.  Each thread (concurrent fit) has its own scratch space
+      static thread_local DenseANN::Workspace ws;
+      std::array<float,1> signmvaout, clustermvaout;
+      signmvaout[0] = signmva_->infer(spars.data(),ws);
+      clustermvaout[0] = clustermva_->infer(cpars.data(),ws);
       if(diag_ > 2)std::cout << std::setw(8) << std::setprecision(5)
         << "Drift ANN inputs: doca, cdrift, sigdoca, TOTdrift, EDep "
           << spars[0] << " , "
@@ -1,16 +1,22 @@
 #include "Offline/Mu2eKinKal/inc/KKBField.hh"
 #include "cetlib_except/exception.h"
+#include <memory>
 namespace mu2e {
   using Grad = ROOT::Math::SMatrix<double,3>;
   using SVEC3 = KinKal::SVEC3;
 
+  KKBField::KKBField(BFieldManager const& bfmgr, DetectorSystem const& det, bool numericalGradient) :
+    bfmgr_(bfmgr), origin_(det.getOrigin()), numgrad_(numericalGradient) {
+      for(auto const& bfmap : bfmgr_.getInnerMaps()){
+        ranges_.push_back(Range{
+            VEC3(bfmap->xmin()-origin_.x(),bfmap->ymin()-origin_.y(),bfmap->zmin()-origin_.z()),
+            VEC3(bfmap->xmax()-origin_.x(),bfmap->ymax()-origin_.y(),bfmap->zmax()-origin_.z())});
+      }
+    }
+
   VEC3 KKBField::fieldVect(VEC3 const& position) const {
-    // change coordinates to mu2e; the map should be native in detector coordinates FIXME!
-    CLHEP::Hep3Vector vpoint(position.x(),position.y(),position.z());
-    CLHEP::Hep3Vector vpoint_mu2e = det_.toMu2e(vpoint);
     CLHEP::Hep3Vector field;
-    //    = bfmgr_.getBField(vpoint_mu2e);
-    if(bfmgr_.getBFieldWithStatus(vpoint_mu2e,field))
+    if(bfmgr_.getBFieldWithStatus(toMu2e(position),field))
       return VEC3(field);
 // see if there's no maps; that says this is the no-field case
 // FIXME need to deal with case when outside all maps
@@ -18,44 +24,68 @@ namespace mu2e {
     return nullfield;
   }
 
+  void KKBField::fieldVects(size_t n, VEC3 const* positions, VEC3* fields) const {
+    std::vector<CLHEP::Hep3Vector> points(n), bfs(n);
+    std::unique_ptr<bool[]> status(new bool[n]);
+    for(size_t ip=0; ip < n; ++ip) points[ip] = toMu2e(positions[ip]);
+    // points outside all maps get the null field, as in fieldVect
+    bfmgr_.getBFieldsWithStatus(n,points.data(),bfs.data(),status.get());
+    for(size_t ip=0; ip < n; ++ip) fields[ip] = VEC3(bfs[ip]);
+  }
+
   Grad KKBField::fieldGrad(VEC3 const& position) const {
     Grad retval;
-    auto dBdx = fieldDeriv(position,VEC3(1.0,0.0,0.0));
-    auto dBdy = fieldDeriv(position,VEC3(0.0,1.0,0.0));
-    auto dBdz = fieldDeriv(position,VEC3(0.0,0.0,1.0));
-    SVEC3 dBdxv(dBdx.X(),dBdx.Y(), dBdx.Z());
-    SVEC3 dBdyv(dBdy.X(),dBdy.Y(), dBdy.Z());
-    SVEC3 dBdzv(dBdz.X(),dBdz.Y(), dBdz.Z());
-    retval.Place_in_row(dBdxv,0,0);
-    retval.Place_in_row(dBdyv,1,0);
-    retval.Place_in_row(dBdzv,2,0);
+    if(numgrad_){
+      auto dBdx = fieldDeriv(position,VEC3(1.0,0.0,0.0));
+      auto dBdy = fieldDeriv(position,VEC3(0.0,1.0,0.0));
+      auto dBdz = fieldDeriv(position,VEC3(0.0,0.0,1.0));
+      SVEC3 dBdxv(dBdx.X(),dBdx.Y(), dBdx.Z());
+      SVEC3 dBdyv(dBdy.X(),dBdy.Y(), dBdy.Z());
+      SVEC3 dBdzv(dBdz.X(),dBdz.Y(), dBdz.Z());
+      retval.Place_in_row(dBdxv,0,0);
+      retval.Place_in_row(dBdyv,1,0);
+      retval.Place_in_row(dBdzv,2,0);
+    } else {
+      if(!inRange(position))throw std::runtime_error("position out or range");
+      // field and gradient from a single map evaluation; translations don't change the gradient
+      CLHEP::Hep3Vector field;
+      BFMap::Gradient grad;
+      bfmgr_.getBFieldAndGradient(toMu2e(position),field,grad);
+      for(size_t irow=0; irow < 3; ++irow){
+        retval.Place_in_row(SVEC3(grad[irow].x(),grad[irow].y(),grad[irow].z()),irow,0);
+      }
+    }
     return retval;
   }
-  // numerical derivatives for now: TODO!
+
   VEC3 KKBField::fieldDeriv(VEC3 const& position, VEC3 const& velocity) const {
-    static double dt(0.1); // 100 psec, ~3cm.  this is arbitrary and should be set according to the field sampling TODO
     if(!inRange(position))throw std::runtime_error("position out or range");
-    VEC3 start = fieldVect(position);
-    VEC3 end = fieldVect(position + velocity*dt);
-    return (end-start)/dt;
+    if(numgrad_){
+      static double dt(0.1); // 100 psec, ~3cm.  this is arbitrary
+      VEC3 start = fieldVect(position);
+      VEC3 end = fieldVect(position + velocity*dt);
+      return (end-start)/dt;
+    }
+    // chain rule: dB/dt = sum_i v_i dB/dx_i
+    CLHEP::Hep3Vector field;
+    BFMap::Gradient grad;
+    bfmgr_.getBFieldAndGradient(toMu2e(position),field,grad);
+    return VEC3(grad[0]*velocity.x() + grad[1]*velocity.y() + grad[2]*velocity.z());
   }
+
   bool KKBField::inRange(VEC3 const& position) const {
-    // clumsy conversion to CLHEP
-    CLHEP::Hep3Vector vpoint(position.x(),position.y(),position.z());
-    CLHEP::Hep3Vector vpoint_mu2e = det_.toMu2e(vpoint);
-    bool retval (false);
-    for(auto const& bfmap : bfmgr_.getInnerMaps()){
-      retval |=
-        vpoint_mu2e.x() > bfmap->xmin() && vpoint_mu2e.x() < bfmap->xmax() &&
-        vpoint_mu2e.y() > bfmap->ymin() && vpoint_mu2e.y() < bfmap->ymax() &&
-        vpoint_mu2e.z() > bfmap->zmin() && vpoint_mu2e.z() < bfmap->zmax();
+    for(auto const& range : ranges_){
+      if(position.x() > range.lo_.x() && position.x() < range.hi_.x() &&
+          position.y() > range.lo_.y() && position.y() < range.hi_.y() &&
+          position.z() > range.lo_.z() && position.z() < range.hi_.z()) return true;
     }
-    return retval;
+    return false;
   }
 
   void KKBField::print(std::ostream& os) const {
     os << "KKBField based on ";
     bfmgr_.print(os);
+    os << "KKBField gradient from " << (numgrad_ ? "finite differences" : "the field maps") << std::endl;
   }
 
 }
@@ -0,0 +1,155 @@
+#include "Offline/Mu2eKinKal/inc/KKDetBField.hh"
+#include "Offline/BFieldGeom/inc/BFGridMap.hh"
+#include "cetlib_except/exception.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+namespace mu2e {
+  using Grad = ROOT::Math::SMatrix<double,3>;
+  using SVEC3 = KinKal::SVEC3;
+
+  namespace {
+    // field values at the 8 corners of the last cell used on this thread
+    struct CellCache {
+      unsigned id_ = 0; // KKDetBField the values came from; 0 = none
+      size_t index_ = 0; // index of the low corner
+      double corner_[8][3];
+    };
+    thread_local CellCache cellCache;
+    std::atomic<unsigned> nextId{1};
+  }
+
+  KKDetBField::Grid::Grid(std::vector<double> const& lo, std::vector<double> const& hi, std::vector<double> const& spacing) {
+    if(lo.size() != 3 || hi.size() != 3 || spacing.size() != 3)
+      throw cet::exception("RECO")<<"mu2e::KKDetBField: grid corners and spacing must have 3 components" << std::endl;
+    lo_ = VEC3(lo[0],lo[1],lo[2]);
+    hi_ = VEC3(hi[0],hi[1],hi[2]);
+    spacing_ = VEC3(spacing[0],spacing[1],spacing[2]);
+    if(spacing_.x() <= 0.0 || spacing_.y() <= 0.0 || spacing_.z() <= 0.0 ||
+        hi_.x() <= lo_.x() || hi_.y() <= lo_.y() || hi_.z() <= lo_.z())
+      throw cet::exception("RECO")<<"mu2e::KKDetBField: empty grid " << lo_ << " to " << hi_ << " spacing " << spacing_ << std::endl;
+  }
+
+  KKDetBField::KKDetBField(BFieldManager const& bfmgr, DetectorSystem const& det, Grid const& grid, bool numericalGradient) :
+    bfield_(bfmgr,det,numericalGradient),
+    dx_(grid.spacing_.x()), dy_(grid.spacing_.y()), dz_(grid.spacing_.z()),
+    id_(nextId++) {
+      auto const& origin = det.getOrigin();
+      double lo[3] = {grid.lo_.x(), grid.lo_.y(), grid.lo_.z()};
+      // align with the nodes of the source map, if it is a grid with the same spacing
+      CLHEP::Hep3Vector center = det.toMu2e(CLHEP::Hep3Vector(0.5*(grid.lo_.x()+grid.hi_.x()),0.5*(grid.lo_.y()+grid.hi_.y()),0.5*(grid.lo_.z()+grid.hi_.z())));
+      auto gmap = std::dynamic_pointer_cast<const BFGridMap>(bfmgr.cacheManager().findMap(center));
+      if(gmap && std::abs(gmap->dx()-dx_) < 1e-6 && std::abs(gmap->dy()-dy_) < 1e-6 && std::abs(gmap->dz()-dz_) < 1e-6){
+        double mlo[3] = {gmap->xmin()-origin.x(), gmap->ymin()-origin.y(), gmap->zmin()-origin.z()};
+        double sp[3] = {dx_, dy_, dz_};
+        for(int idim=0; idim < 3; ++idim) lo[idim] = mlo[idim] + std::floor((lo[idim]-mlo[idim])/sp[idim])*sp[idim];
+      }
+      xmin_ = lo[0]; ymin_ = lo[1]; zmin_ = lo[2];
+      nx_ = std::max(2, int(std::ceil((grid.hi_.x()-xmin_)/dx_ - 1e-9)) + 1);
+      ny_ = std::max(2, int(std::ceil((grid.hi_.y()-ymin_)/dy_ - 1e-9)) + 1);
+      nz_ = std::max(2, int(std::ceil((grid.hi_.z()-zmin_)/dz_ - 1e-9)) + 1);
+      // sample the Mu2e maps at the nodes
+      field_.resize(size_t(nx_)*ny_*nz_*3);
+      // one batch lookup per line of nodes along z
+      BFieldManager::Cursor cursor;
+      std::vector<CLHEP::Hep3Vector> points(nz_), bfs(nz_);
+      std::unique_ptr<bool[]> status(new bool[nz_]);
+      size_t ival(0);
+      for(unsigned ix=0; ix < nx_; ++ix){
+        for(unsigned iy=0; iy < ny_; ++iy){
+          for(unsigned iz=0; iz < nz_; ++iz)
+            points[iz] = CLHEP::Hep3Vector(xmin_+ix*dx_+origin.x(), ymin_+iy*dy_+origin.y(), zmin_+iz*dz_+origin.z());
+          bfmgr.getBFieldsWithStatus(nz_,points.data(),cursor,bfs.data(),status.get());
+          for(unsigned iz=0; iz < nz_; ++iz){
+            if(!status[iz])
+              throw cet::exception("RECO")<<"mu2e::KKDetBField: grid point " << det.toDetector(points[iz]) << " (detector system) is outside the BField maps" << std::endl;
+            field_[ival++] = bfs[iz].x();
+            field_[ival++] = bfs[iz].y();
+            field_[ival++] = bfs[iz].z();
+          }
+        }
+      }
+    }
+
+  bool KKDetBField::interpolate(VEC3 const& position, VEC3* field, Grad* grad) const {
+    double ux = (position.x()-xmin_)/dx_;
+    double uy = (position.y()-ymin_)/dy_;
+    double uz = (position.z()-zmin_)/dz_;
+    if(!(ux >= 0.0 && ux <= nx_-1 && uy >= 0.0 && uy <= ny_-1 && uz >= 0.0 && uz <= nz_-1))return false;
+    // points on the upper faces belong to the last cell
+    unsigned ix = std::min(unsigned(ux),nx_-2);
+    unsigned iy = std::min(unsigned(uy),ny_-2);
+    unsigned iz = std::min(unsigned(uz),nz_-2);
+    double fx = ux - ix, fy = uy - iy, fz = uz - iz;
+    size_t index = (size_t(ix)*ny_ + iy)*nz_ + iz;
+    auto& cache = cellCache;
+    if(cache.id_ != id_ || cache.index_ != index){
+      size_t sx = size_t(ny_)*nz_, sy = nz_;
+      for(int icorner=0; icorner < 8; ++icorner){
+        float const* val = field_.data() + 3*(index + (icorner&1)*sx + ((icorner>>1)&1)*sy + ((icorner>>2)&1));
+        for(int icomp=0; icomp < 3; ++icomp) cache.corner_[icorner][icomp] = val[icomp];
+      }
+      cache.id_ = id_;
+      cache.index_ = index;
+    }
+    // corner n has offsets (n&1, (n>>1)&1, (n>>2)&1)
+    double wx[2] = {1.0-fx, fx}, wy[2] = {1.0-fy, fy}, wz[2] = {1.0-fz, fz};
+    double dwx[2] = {-1.0/dx_, 1.0/dx_}, dwy[2] = {-1.0/dy_, 1.0/dy_}, dwz[2] = {-1.0/dz_, 1.0/dz_};
+    double bf[3] = {0.0,0.0,0.0};
+    double gr[3][3] = {{0.0,0.0,0.0},{0.0,0.0,0.0},{0.0,0.0,0.0}};
+    for(int icorner=0; icorner < 8; ++icorner){
+      int a = icorner&1, b = (icorner>>1)&1, c = (icorner>>2)&1;
+      double w = wx[a]*wy[b]*wz[c];
+      double gwx = dwx[a]*wy[b]*wz[c], gwy = wx[a]*dwy[b]*wz[c], gwz = wx[a]*wy[b]*dwz[c];
+      for(int icomp=0; icomp < 3; ++icomp){
+        double val = cache.corner_[icorner][icomp];
+        bf[icomp] += w*val;
+        gr[0][icomp] += gwx*val;
+        gr[1][icomp] += gwy*val;
+        gr[2][icomp] += gwz*val;
+      }
+    }
+    if(field) *field = VEC3(bf[0],bf[1],bf[2]);
+    if(grad){
+      for(size_t irow=0; irow < 3; ++irow) grad->Place_in_row(SVEC3(gr[irow][0],gr[irow][1],gr[irow][2]),irow,0);
+    }
+    return true;
+  }
+
+  VEC3 KKDetBField::fieldVect(VEC3 const& position) const {
+    VEC3 field;
+    if(interpolate(position,&field,0)) return field;
+    return bfield_.fieldVect(position);
+  }
+
+  Grad KKDetBField::fieldGrad(VEC3 const& position) const {
+    Grad grad;
+    if(interpolate(position,0,&grad)) return grad;
+    return bfield_.fieldGrad(position);
+  }
+
+  VEC3 KKDetBField::fieldDeriv(VEC3 const& position, VEC3 const& velocity) const {
+    Grad grad;
+    if(!interpolate(position,0,&grad)) return bfield_.fieldDeriv(position,velocity);
+    // chain rule: dB/dt = sum_i v_i dB/dx_i
+    double deriv[3];
+    for(size_t icomp=0; icomp < 3; ++icomp)
+      deriv[icomp] = grad(0,icomp)*velocity.x() + grad(1,icomp)*velocity.y() + grad(2,icomp)*velocity.z();
+    return VEC3(deriv[0],deriv[1],deriv[2]);
+  }
+
+  bool KKDetBField::inRange(VEC3 const& position) const {
+    return (position.x() >= xmin_ && position.x() <= xmin_ + (nx_-1)*dx_ &&
+        position.y() >= ymin_ && position.y() <= ymin_ + (ny_-1)*dy_ &&
+        position.z() >= zmin_ && position.z() <= zmin_ + (nz_-1)*dz_) || bfield_.inRange(position);
+  }
+
+  void KKDetBField::print(std::ostream& os) const {
+    os << "KKDetBField detector-system grid " << nx_ << " x " << ny_ << " x " << nz_
+      << " from (" << xmin_ << "," << ymin_ << "," << zmin_ << ") spacing (" << dx_ << "," << dy_ << "," << dz_ << ") mm" << std::endl;
+    os << "Outside the grid: ";
+    bfield_.print(os);
+  }
+
+}
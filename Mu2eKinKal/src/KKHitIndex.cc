@@ -0,0 +1,69 @@
+#include "Offline/Mu2eKinKal/inc/KKHitIndex.hh"
+#include "cetlib_except/exception.h"
+
+namespace mu2e {
+
+  KKHitIndex::KKHitIndex(Tracker const& tracker, ComboHitCollection const& chcol, double tbin) :
+    chcol_(chcol), tmin_(0.0), tbin_(tbin), ntbins_(0) {
+      if(tbin_ <= 0.0) throw cet::exception("RECO")<<"mu2e::KKHitIndex: illegal time bin width " << tbin_ << std::endl;
+      // panel and plane geometry
+      double srad = tracker.strawOuterRadius();
+      for(auto const& plane : tracker.planes()){
+        auto& plinfo = planes_[plane.id().plane()];
+        plinfo.z_ = plane.origin().z();
+        plinfo.zmin_ = std::numeric_limits<double>::max();
+        plinfo.zmax_ = -plinfo.zmin_;
+        plinfo.exists_ = tracker.planeExists(plane.id());
+        for(auto panel_p : plane.panels()){
+          auto const& panel = *panel_p;
+          auto& pinfo = panels_[panel.id().uniquePanel()];
+          pinfo.dsToPanel_ = panel.dsToPanel();
+          pinfo.origin_ = KinKal::VEC3(panel.origin());
+          pinfo.vdir_ = KinKal::VEC3(panel.vDirection());
+          pinfo.z_ = panel.origin().z();
+          pinfo.vmin_ = std::numeric_limits<double>::max();
+          pinfo.vmax_ = -pinfo.vmin_;
+          for(size_t istr=0; istr < panel.nStraws(); ++istr){
+            auto const& straw = panel.getStraw(istr);
+            double v = pinfo.vdir_.Dot(KinKal::VEC3(straw.origin())-pinfo.origin_);
+            pinfo.vmin_ = std::min(pinfo.vmin_,v);
+            pinfo.vmax_ = std::max(pinfo.vmax_,v);
+            plinfo.zmin_ = std::min(plinfo.zmin_,straw.origin().z()-srad);
+            plinfo.zmax_ = std::max(plinfo.zmax_,straw.origin().z()+srad);
+          }
+        }
+      }
+      offsets_.assign(1,0);
+      if(chcol_.empty())return;
+      // time binning covering all the hits
+      tmin_ = std::numeric_limits<double>::max();
+      double tmax = -tmin_;
+      for(auto const& ch : chcol_){
+        tmin_ = std::min(tmin_,double(ch.correctedTime()));
+        tmax = std::max(tmax,double(ch.correctedTime()));
+      }
+      ntbins_ = static_cast<size_t>(std::floor((tmax-tmin_)/tbin_)) + 1;
+      // counting sort of the hits by (panel, time bin).  Filling in collection order keeps each bin ascending
+      size_t nkeys = StrawId::_nupanels*ntbins_;
+      offsets_.assign(nkeys+1,0);
+      std::vector<size_t> keys(chcol_.size());
+      for(size_t ich=0; ich < chcol_.size(); ++ich){
+        auto const& ch = chcol_[ich];
+        size_t ibin = std::min(static_cast<size_t>((ch.correctedTime()-tmin_)/tbin_),ntbins_-1);
+        keys[ich] = ch.strawId().uniquePanel()*ntbins_ + ibin;
+        ++offsets_[keys[ich]+1];
+      }
+      for(size_t ikey=0; ikey < nkeys; ++ikey)offsets_[ikey+1] += offsets_[ikey];
+      hits_.resize(chcol_.size());
+      std::vector<size_t> next(offsets_.begin(),offsets_.end()-1);
+      for(size_t ich=0; ich < chcol_.size(); ++ich)hits_[next[keys[ich]]++] = ich;
+    }
+
+  void KKHitIndex::addHits(size_t upanel, double tmin, double tmax, std::vector<size_t>& hits) const {
+    if(tmax < tmin_ || tmin >= tmin_ + ntbins_*tbin_)return;
+    size_t ibmin = tmin > tmin_ ? static_cast<size_t>((tmin-tmin_)/tbin_) : 0;
+    size_t ibmax = std::min(static_cast<size_t>((tmax-tmin_)/tbin_),ntbins_-1);
+    size_t ikey = upanel*ntbins_;
+    hits.insert(hits.end(),hits_.begin()+offsets_[ikey+ibmin],hits_.begin()+offsets_[ikey+ibmax+1]);
+  }
+}
@@ -27,7 +27,7 @@ namespace mu2e {
     }
 
   KKStrawMaterial const& KKMaterial::strawMaterial() const {
-    if(smat_ == nullptr){
+    std::call_once(smatflag_,[this](){
       Tracker const & tracker = *(GeomHandle<Tracker>());
       auto const& sprop = tracker.strawProperties();
       smat_ = std::make_unique<KKStrawMaterial>(
@@ -35,7 +35,7 @@ namespace mu2e {
           matdbinfo_->findDetMaterial(wallmatname_),
           matdbinfo_->findDetMaterial(gasmatname_),
           matdbinfo_->findDetMaterial(wirematname_));
-    }
+    });
     return *smat_;
   }
 }
@@ -0,0 +1,95 @@
+//
+// Require 2 KalSeed collections fit from the same seeds to be identical, entry by entry, for instance
+// the output of a KinKal fit module with concurrent seed fits on and off.  The fit status, chisquared,
+// hits and the states of all the segments are compared exactly; the first difference throws.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/RecoDataProducts/inc/KalSeed.hh"
+
+#include <iostream>
+
+namespace mu2e {
+
+  class KalSeedCompare : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<art::InputTag> reference{Name("Reference"), Comment("Reference KalSeed producer")};
+        fhicl::Atom<art::InputTag> test{Name("Test"), Comment("KalSeed producer which must give the same collection")};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit KalSeedCompare(const Parameters& conf);
+
+      void analyze(const art::Event& event) override;
+      void endJob() override;
+
+    private:
+      // name of the first differing quantity, or null if the seeds are identical
+      static const char* difference(KalSeed const& ref, KalSeed const& test);
+
+      art::InputTag ref_, test_;
+      size_t nevents_ = 0;
+      size_t nseeds_ = 0;
+  };
+
+  KalSeedCompare::KalSeedCompare(const Parameters& conf) :
+    art::EDAnalyzer(conf),
+    ref_(conf().reference()),
+    test_(conf().test()) {
+      consumes<KalSeedCollection>(ref_);
+      consumes<KalSeedCollection>(test_);
+    }
+
+  const char* KalSeedCompare::difference(KalSeed const& ref, KalSeed const& test) {
+    if(ref.particle() != test.particle()) return "particle";
+    if(!(ref.status() == test.status())) return "status";
+    if(ref.chisquared() != test.chisquared() || ref.nDOF() != test.nDOF() || ref.fitConsistency() != test.fitConsistency()) return "chisquared";
+    if(ref.hits().size() != test.hits().size()) return "number of hits";
+    for(size_t ihit=0; ihit < ref.hits().size(); ++ihit){
+      auto const& rhit = ref.hits()[ihit];
+      auto const& thit = test.hits()[ihit];
+      if(rhit.index() != thit.index() || !(rhit.flag() == thit.flag()) || rhit.ambig() != thit.ambig()) return "hit";
+    }
+    if(ref.straws().size() != test.straws().size()) return "number of straws";
+    if(ref.intersections().size() != test.intersections().size()) return "number of intersections";
+    if(ref.segments().size() != test.segments().size()) return "number of segments";
+    for(size_t iseg=0; iseg < ref.segments().size(); ++iseg){
+      auto const& rseg = ref.segments()[iseg];
+      auto const& tseg = test.segments()[iseg];
+      if(rseg.tmin() != tseg.tmin() || rseg.tmax() != tseg.tmax()) return "segment time range";
+      if(rseg.position3() != tseg.position3() || rseg.momentum3() != tseg.momentum3()) return "segment state";
+    }
+    return nullptr;
+  }
+
+  void KalSeedCompare::analyze(const art::Event& event) {
+    auto const& refseeds = *event.getValidHandle<KalSeedCollection>(ref_);
+    auto const& testseeds = *event.getValidHandle<KalSeedCollection>(test_);
+    if(refseeds.size() != testseeds.size())
+      throw cet::exception("RECO")<<"mu2e::KalSeedCompare: event " << event.id() << ": " << refseeds.size() << " "
+        << ref_ << " seeds, " << testseeds.size() << " " << test_ << " seeds" << std::endl;
+    for(size_t iseed=0; iseed < refseeds.size(); ++iseed){
+      auto diff = difference(refseeds[iseed],testseeds[iseed]);
+      if(diff != nullptr)
+        throw cet::exception("RECO")<<"mu2e::KalSeedCompare: event " << event.id() << " seed " << iseed
+          << ": different " << diff << std::endl;
+    }
+    ++nevents_;
+    nseeds_ += refseeds.size();
+  }
+
+  void KalSeedCompare::endJob() {
+    std::cout << "KalSeedCompare: " << nevents_ << " events, " << nseeds_ << " identical "
+      << ref_ << " and " << test_ << " seeds" << std::endl;
+  }
+}
+
+using mu2e::KalSeedCompare;
+DEFINE_ART_MODULE(KalSeedCompare)
@@ -9,7 +9,7 @@
 #include "fhiclcpp/types/Table.h"
 #include "fhiclcpp/types/OptionalTable.h"
 #include "fhiclcpp/types/Tuple.h"
-#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Run.h"
 #include "art/Framework/Principal/Handle.h"
@@ -50,6 +50,7 @@
 #include "Offline/Mu2eKinKal/inc/KKMaterial.hh"
 #include "Offline/Mu2eKinKal/inc/KKStrawHit.hh"
 #include "Offline/Mu2eKinKal/inc/KKBField.hh"
+#include "Offline/Mu2eKinKal/inc/KKDetBField.hh"
 #include "Offline/Mu2eKinKal/inc/KKFitUtilities.hh"
 #include "Offline/Mu2eKinKal/inc/ExtrapolateTCRV.hh"
 // root
@@ -62,6 +63,8 @@
 #include <functional>
 #include <vector>
 #include <memory>
+// TBB
+#include "tbb/parallel_for.h"
 using namespace std;
 //using namespace KinKal;
 namespace mu2e {
@@ -104,7 +107,7 @@ namespace mu2e {
   using KKModuleConfig = Mu2eKinKal::KKModuleConfig;
   using KKMaterialConfig = KKMaterial::Config;
 
-  class KinematicLineFit : public art::EDProducer {
+  class KinematicLineFit : public art::SharedProducer {
     using Name    = fhicl::Name;
     using Comment = fhicl::Comment;
   // extend the generic module configuration as needed
@@ -138,12 +141,16 @@ namespace mu2e {
     };
 
     public:
-    using Parameters = art::EDProducer::Table<GlobalConfig>;
-    explicit KinematicLineFit(const Parameters& settings);
+    using Parameters = art::SharedProducer::Table<GlobalConfig>;
+    explicit KinematicLineFit(const Parameters& settings, art::ProcessingFrame const& frame);
     virtual ~KinematicLineFit();
-    void beginRun(art::Run& run) override;
-    void produce(art::Event& event) override;
+    void beginRun(art::Run& run, art::ProcessingFrame const& frame) override;
+    void produce(art::Event& event, art::ProcessingFrame const& frame) override;
     private:
+    // fit a single seed; this is called concurrently for the seeds of an event, so it may only use const module state.
+    // Returns null if the fit should not be saved
+    std::unique_ptr<KKTRK> fitSeed(CosmicTrackSeed const& hseed, Tracker const& tracker, StrawResponse const& strawresponse,
+        Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const;
     // utility functions
     KTRAJ makeSeedTraj(CosmicTrackSeed const& hseed) const;
     bool goodFit(KKTRK const& ktrk) const;
@@ -155,6 +162,7 @@ namespace mu2e {
     art::ProductToken<CaloClusterCollection> cccol_T_;
     TrkFitFlag goodline_;
     bool saveall_;
+    bool concurrent_; // fit seeds concurrently
     ProditionsHandle<StrawResponse> strawResponse_h_;
     ProditionsHandle<Tracker> alignedTracker_h_;
     int print_;
@@ -166,28 +174,32 @@ namespace mu2e {
     std::array<double,KinKal::NParams()> paramconstraints_;
     double mass_; // particle mass
     int charge_; // particle charge
-    std::unique_ptr<KKBField> kkbf_;
+    std::unique_ptr<KinKal::BFieldMap> kkbf_;
+    bool numgrad_; // finite-difference BField gradient
+    std::unique_ptr<KKDetBField::Grid> detgrid_; // optional detector-system BField grid
     double sampletol_; // surface intersection tolerance (mm)
     double sampletbuff_; // simple time buffer; replace this with extrapolation TODO
     bool sampleinrange_, sampleinbounds_; // require samples to be in range or on surface
     SurfaceMap::SurfacePairCollection sample_; // surfaces to sample the fit
     bool extrapolate_, toCRV_;
-    ExtrapolateTCRV TCRV_; // extrapolation predicate based on Z values
+    ExtrapolateTCRV TCRV_; // extrapolation predicate based on Z values; copied for each track as it caches the last intersection
     double tcrvthick_ = 0.1056; // st foil thickness: should come from geometry service TODO
     Config config_; // initial fit configuration object
     Config exconfig_; // extension configuration object
   };
 
-  KinematicLineFit::KinematicLineFit(const Parameters& settings) : art::EDProducer{settings},
+  KinematicLineFit::KinematicLineFit(const Parameters& settings, art::ProcessingFrame const& frame) : art::SharedProducer{settings},
     chcol_T_(consumes<ComboHitCollection>(settings().modSettings().comboHitCollection())),
     cccol_T_(mayConsume<CaloClusterCollection>(settings().modSettings().caloClusterCollection())),
     goodline_(settings().modSettings().seedFlags()),
     saveall_(settings().modSettings().saveAll()),
+    concurrent_(settings().modSettings().concurrentFits() && settings().modSettings().printLevel() == 0),
     print_(settings().modSettings().printLevel()),
     seedmom_(settings().modSettings().seedmom()),
     fpart_(static_cast<PDGCode::type>(settings().modSettings().fitParticle())),
     kkfit_(settings().mu2eSettings()),
     kkmat_(settings().matSettings()),
+    numgrad_(settings().modSettings().numBGrad()),
     sampletol_(settings().modSettings().sampleTol()),
     sampletbuff_(settings().modSettings().sampleTBuff()),
     sampleinrange_(settings().modSettings().sampleInRange()),
@@ -196,6 +208,9 @@ namespace mu2e {
     config_(Mu2eKinKal::makeConfig(settings().fitSettings())),
     exconfig_(Mu2eKinKal::makeConfig(settings().extSettings()))
     {
+      // the proditions handles and per-run BField are module state, so events are processed one at a time.
+      // The seeds within an event are fit concurrently, see produce
+      serialize<art::InEvent>();
       // collection handling
       for(const auto& seedtag : settings().modSettings().seedCollections()) { seedCols_.emplace_back(consumes<CosmicTrackSeedCollection>(seedtag)); }
       produces<KKTRKCOL>();
@@ -218,6 +233,10 @@ namespace mu2e {
       }else{
         throw cet::exception("RECO")<<"mu2e::KinematicLineFit: Parameter constraint configuration error"<< endl;
       }
+      if(settings().modSettings().detBField()){
+        auto const& dbf = *settings().modSettings().detBField();
+        detgrid_ = std::make_unique<KKDetBField::Grid>(dbf.lo(),dbf.hi(),dbf.spacing());
+      }
       SurfaceIdCollection ssids;
       for(auto const& sidname : settings().modSettings().sampleSurfaces()) {
         ssids.push_back(SurfaceId(sidname,-1)); // match all elements
@@ -246,7 +265,7 @@ namespace mu2e {
 
   KinematicLineFit::~KinematicLineFit(){}
 
-  void KinematicLineFit::beginRun(art::Run& run) {
+  void KinematicLineFit::beginRun(art::Run& run, art::ProcessingFrame const& frame) {
     // setup particle parameters
     auto const& ptable = GlobalConstantsHandle<ParticleDataList>();
     mass_ = ptable->particle(fpart_).mass();
@@ -254,10 +273,13 @@ namespace mu2e {
     // create KKBField
     GeomHandle<BFieldManager> bfmgr;
     GeomHandle<DetectorSystem> det;
-    kkbf_ = std::make_unique<KKBField>(*bfmgr,*det);
+    if(detgrid_)
+      kkbf_ = std::make_unique<KKDetBField>(*bfmgr,*det,*detgrid_,numgrad_);
+    else
+      kkbf_ = std::make_unique<KKBField>(*bfmgr,*det,numgrad_);
   }
 
-  void KinematicLineFit::produce(art::Event& event ) {
+  void KinematicLineFit::produce(art::Event& event, art::ProcessingFrame const& frame) {
     GeomHandle<mu2e::Calorimeter> calo_h;
     // find current proditions
     auto const& strawresponse = strawResponse_h_.getPtr(event.id());
@@ -266,80 +288,45 @@ namespace mu2e {
     auto ch_H = event.getValidHandle<ComboHitCollection>(chcol_T_);
     auto cc_H = event.getValidHandle<CaloClusterCollection>(cccol_T_);
     auto const& chcol = *ch_H;
+    // index the hits and panels once for all the fits of this event
+    KKHitIndex hitindex(*tracker,chcol,kkfit_.hitIndexTimeBin());
     // create output
     unique_ptr<KKTRKCOL> kktrkcol(new KKTRKCOL );
     unique_ptr<KalSeedCollection> kkseedcol(new KalSeedCollection ); //Needs to return a KalSeed
     unique_ptr<KalLineAssns> kkseedassns(new KalLineAssns());
     auto KalSeedCollectionPID = event.getProductID<KalSeedCollection>();
     auto KalSeedCollectionGetter = event.productGetter(KalSeedCollectionPID);
-    // find the track seed collections
+    // find the track seeds to fit, in collection order
     unsigned nseed(0);
+    std::vector<HPtr> hptrs;
     for (auto const& hseedtag : seedCols_) {
       auto const& hseedcol_h = event.getValidHandle<CosmicTrackSeedCollection>(hseedtag);
       auto const& hseedcol = *hseedcol_h;
       nseed += hseedcol.size();
-      // loop over the seeds
       for(size_t iseed=0; iseed < hseedcol.size(); ++iseed) {
-        auto const& hseed = hseedcol[iseed];
-        auto hptr = HPtr(hseedcol_h,iseed);
         // check helicity.  The test on the charge and helicity
-        if(hseed.status().hasAllProperties(goodline_) ){
-          // construt the seed trajectory
-          KTRAJ seedtraj = makeSeedTraj(hseed);
-          // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
-          PTRAJ pseedtraj(seedtraj);
-          // first, we need to unwind the combohits.  We use this also to find the time range
-          StrawHitIndexCollection strawHitIdxs;
-          auto chcolptr = hseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
-//          if(chcolptr != &chcol)
-//            throw cet::exception("RECO")<<"mu2e::KinematicLineFit: inconsistent ComboHitCollection" << std::endl;
-          // next, build straw hits and materials from these
-          KKSTRAWHITCOL strawhits;
-          KKSTRAWXINGCOL strawxings;
-          strawhits.reserve(strawHitIdxs.size());
-          strawxings.reserve(strawHitIdxs.size());
-          kkfit_.makeStrawHits(*tracker, *strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, *chcolptr, strawHitIdxs, strawhits, strawxings);
-
-          //here
-          KKCALOHITCOL calohits;
-          //if (kkfit_.useCalo()) kkfit_.makeCaloHit(hptr->caloCluster(),*calo_h, pseedtraj, calohits); --> CosmicTrackSeed has no CaloClusters....
-
-          if(print_ > 2){
-            for(auto const& strawhit : strawhits) strawhit->print(std::cout,2);
-            for(auto const& calohit : calohits) calohit->print(std::cout,2);
-            for(auto const& strawxing :strawxings) strawxing->print(std::cout,2);
-          }
-          // set the seed range given the hit TPOCA values
-          seedtraj.range() = kkfit_.range(strawhits,calohits, strawxings);
-          if(print_ > 0){
-            //std::cout << "Seed line parameters " << hseed.track() << std::endl;
-            seedtraj.print(std::cout,print_);
-          }
-          // create and fit the track
-          auto kktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fpart_,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits,paramconstraints_);
-          auto goodfit = goodFit(*kktrk);
-          if(goodfit && exconfig_.schedule().size() > 0){
-            kkfit_.extendTrack(exconfig_,*kkbf_, *tracker,*strawresponse, kkmat_.strawMaterial(), chcol, *calo_h, cc_H, *kktrk );
-          }
-          goodfit = goodFit(*kktrk);
-          // extrapolate as required
-          if(goodfit && extrapolate_) extrapolate(*kktrk);
-          bool save = goodFit(*kktrk);
-          if(save || saveall_){
-            TrkFitFlag fitflag(hptr->status());
-            fitflag.merge(TrkFitFlag::KKLine);
-            auto kkseed = kkfit_.createSeed(*kktrk,fitflag,*calo_h);
-            sampleFit(*kktrk,kkseed._inters);
-            kkseedcol->push_back(kkseed);
-            kkseedcol->back()._status.merge(TrkFitFlag::KKLine);
-            // fill assns with the cosmic seed
-            auto hptr = art::Ptr<CosmicTrackSeed>(hseedcol_h,iseed);
-            auto kseedptr = art::Ptr<KalSeed>(KalSeedCollectionPID,kkseedcol->size()-1,KalSeedCollectionGetter);
-            kkseedassns->addSingle(kseedptr,hptr);
-            // save (unpersistable) KKTrk in the event
-            kktrkcol->push_back(kktrk.release());
-          }
-        }
+        if(hseedcol[iseed].status().hasAllProperties(goodline_) )hptrs.push_back(HPtr(hseedcol_h,iseed));
+      }
+    }
+    // fit the seeds.  The fits are independent, so they can run concurrently; the results are indexed by seed
+    std::vector<std::unique_ptr<KKTRK>> kktrks(hptrs.size());
+    std::vector<KalSeed> kkseeds(hptrs.size());
+    auto fitone = [&](size_t iseed) {
+      kktrks[iseed] = fitSeed(*hptrs[iseed],*tracker,*strawresponse,*calo_h,hitindex,cc_H,kkseeds[iseed]);
+    };
+    if(concurrent_)
+      tbb::parallel_for(size_t(0),hptrs.size(),fitone);
+    else
+      for(size_t iseed=0; iseed < hptrs.size(); ++iseed)fitone(iseed);
+    // fill the output in seed order, so that it doesn't depend on the scheduling
+    for(size_t iseed=0; iseed < hptrs.size(); ++iseed) {
+      if(kktrks[iseed]){
+        kkseedcol->push_back(std::move(kkseeds[iseed]));
+        // fill assns with the cosmic seed
+        auto kseedptr = art::Ptr<KalSeed>(KalSeedCollectionPID,kkseedcol->size()-1,KalSeedCollectionGetter);
+        kkseedassns->addSingle(kseedptr,hptrs[iseed]);
+        // save (unpersistable) KKTrk in the event
+        kktrkcol->push_back(kktrks[iseed].release());
       }
     }
     // put the output products into the event
@@ -349,6 +336,58 @@ namespace mu2e {
     event.put(move(kkseedassns));
   }
 
+  std::unique_ptr<KKTRK> KinematicLineFit::fitSeed(CosmicTrackSeed const& hseed, Tracker const& tracker, StrawResponse const& strawresponse,
+      Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const {
+    // construt the seed trajectory
+    KTRAJ seedtraj = makeSeedTraj(hseed);
+    // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
+    PTRAJ pseedtraj(seedtraj);
+    // first, we need to unwind the combohits.  We use this also to find the time range
+    StrawHitIndexCollection strawHitIdxs;
+    auto chcolptr = hseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
+//    if(chcolptr != &chcol)
+//      throw cet::exception("RECO")<<"mu2e::KinematicLineFit: inconsistent ComboHitCollection" << std::endl;
+    // next, build straw hits and materials from these
+    KKSTRAWHITCOL strawhits;
+    KKSTRAWXINGCOL strawxings;
+    strawhits.reserve(strawHitIdxs.size());
+    strawxings.reserve(strawHitIdxs.size());
+    kkfit_.makeStrawHits(tracker, strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, *chcolptr, strawHitIdxs, strawhits, strawxings);
+
+    //here
+    KKCALOHITCOL calohits;
+    //if (kkfit_.useCalo()) kkfit_.makeCaloHit(hptr->caloCluster(),calo, pseedtraj, calohits); --> CosmicTrackSeed has no CaloClusters....
+
+    if(print_ > 2){
+      for(auto const& strawhit : strawhits) strawhit->print(std::cout,2);
+      for(auto const& calohit : calohits) calohit->print(std::cout,2);
+      for(auto const& strawxing :strawxings) strawxing->print(std::cout,2);
+    }
+    // set the seed range given the hit TPOCA values
+    seedtraj.range() = kkfit_.range(strawhits,calohits, strawxings);
+    if(print_ > 0){
+      //std::cout << "Seed line parameters " << hseed.track() << std::endl;
+      seedtraj.print(std::cout,print_);
+    }
+    // create and fit the track
+    auto kktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fpart_,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits,paramconstraints_);
+    auto goodfit = goodFit(*kktrk);
+    if(goodfit && exconfig_.schedule().size() > 0){
+      kkfit_.extendTrack(exconfig_,*kkbf_, tracker,strawresponse, kkmat_.strawMaterial(), hitindex, calo, cc_H, *kktrk );
+    }
+    goodfit = goodFit(*kktrk);
+    // extrapolate as required
+    if(goodfit && extrapolate_) extrapolate(*kktrk);
+    bool save = goodFit(*kktrk);
+    if(!(save || saveall_)) return nullptr;
+    TrkFitFlag fitflag(hseed.status());
+    fitflag.merge(TrkFitFlag::KKLine);
+    kkseed = kkfit_.createSeed(*kktrk,fitflag,calo);
+    sampleFit(*kktrk,kkseed._inters);
+    kkseed._status.merge(TrkFitFlag::KKLine);
+    return kktrk;
+  }
+
   KTRAJ KinematicLineFit::makeSeedTraj(CosmicTrackSeed const& hseed) const {
     //exctract CosmicTrack (contains parameters)
     VEC3 bnom(0.0,0.0,0.0);
@@ -406,6 +445,8 @@ namespace mu2e {
   }
 
   void KinematicLineFit::extrapolate(KKTRK& ktrk) const {
+    // the predicate caches its last intersection, so use a copy: tracks can be extrapolated concurrently
+    ExtrapolateTCRV TCRV(TCRV_);
     auto const& ftraj = ktrk.fitTraj();
     static const SurfaceId TCRVSID("TCRV");
     auto dir0 = ftraj.direction(ftraj.t0());
@@ -416,18 +457,18 @@ namespace mu2e {
       // iterate until the extrapolation condition is met
       double time = starttime;
       double tstart = time;
-      while(fabs(time-tstart) < TCRV_.maxDt() && TCRV_.needsExtrapolation(ftraj,tdir) ){
-        TimeRange range = tdir == TimeDir::forwards ? TimeRange(time,time+TCRV_.step()) : TimeRange(time-TCRV_.step(),time);
+      while(fabs(time-tstart) < TCRV.maxDt() && TCRV.needsExtrapolation(ftraj,tdir) ){
+        TimeRange range = tdir == TimeDir::forwards ? TimeRange(time,time+TCRV.step()) : TimeRange(time-TCRV.step(),time);
         ktrk.extendTraj(range);
         time = tdir == TimeDir::forwards ? range.end() : range.begin();
       }
       hadintersection = false;
-      if (TCRV_.intersection().onsurface_ && TCRV_.intersection().inbounds_){
+      if (TCRV.intersection().onsurface_ && TCRV.intersection().inbounds_){
         hadintersection = true;
         // we have a good intersection. Use this to create a Shell material Xing
         auto const& reftrajptr = tdir == TimeDir::backwards ? ftraj.frontPtr() : ftraj.backPtr();
         // FIXME material?
-        KKCRVXINGPTR crvxingptr = std::make_shared<KKCRVXING>(TCRV_.module(), TCRVSID, *kkmat_.STMaterial(),TCRV_.intersection(),reftrajptr,tcrvthick_,TCRV_.tolerance());
+        KKCRVXINGPTR crvxingptr = std::make_shared<KKCRVXING>(TCRV.module(), TCRVSID, *kkmat_.STMaterial(),TCRV.intersection(),reftrajptr,tcrvthick_,TCRV.tolerance());
         ktrk.addTCRVXing(crvxingptr,tdir);
       }
     } while(hadintersection);
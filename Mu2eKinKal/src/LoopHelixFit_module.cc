@@ -10,7 +10,7 @@
 #include "fhiclcpp/types/OptionalTable.h"
 #include "fhiclcpp/types/Tuple.h"
 #include "fhiclcpp/types/OptionalAtom.h"
-#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Run.h"
 #include "art/Framework/Principal/Handle.h"
@@ -61,6 +61,7 @@
 #include "Offline/Mu2eKinKal/inc/KKStrawXing.hh"
 #include "Offline/Mu2eKinKal/inc/KKCaloHit.hh"
 #include "Offline/Mu2eKinKal/inc/KKBField.hh"
+#include "Offline/Mu2eKinKal/inc/KKDetBField.hh"
 #include "Offline/Mu2eKinKal/inc/KKConstantBField.hh"
 #include "Offline/Mu2eKinKal/inc/KKFitUtilities.hh"
 #include "Offline/Mu2eKinKal/inc/ExtrapolateToZ.hh"
@@ -73,6 +74,8 @@
 #include <functional>
 #include <vector>
 #include <memory>
+// TBB
+#include "tbb/parallel_for.h"
 //
 // Original author D. Brown (LBNL) 11/18/20
 //
@@ -159,14 +162,18 @@ namespace mu2e {
     fhicl::Atom<bool> pdgCharge { Name("UsePDGCharge"), Comment("Use particle charge from fitParticle")};
   };
 
-  class LoopHelixFit : public art::EDProducer {
+  class LoopHelixFit : public art::SharedProducer {
     public:
-      using Parameters = art::EDProducer::Table<LoopHelixFitConfig>;
-      explicit LoopHelixFit(const Parameters& settings);
-      void beginRun(art::Run& run) override;
-      void produce(art::Event& event) override;
+      using Parameters = art::SharedProducer::Table<LoopHelixFitConfig>;
+      explicit LoopHelixFit(const Parameters& settings, art::ProcessingFrame const& frame);
+      void beginRun(art::Run& run, art::ProcessingFrame const& frame) override;
+      void produce(art::Event& event, art::ProcessingFrame const& frame) override;
     private:
       TrkFitFlag fitflag_;
+      // fit a single seed; this is called concurrently for the seeds of an event, so it may only use const module state.
+      // Returns null if the fit should not be saved
+      std::unique_ptr<KKTRK> fitSeed(HelixSeed const& hseed, Tracker const& tracker, StrawResponse const& strawresponse,
+          Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const;
       // parameter-specific functions that need to be overridden in subclasses
       KTRAJ makeSeedTraj(HelixSeed const& hseed,TimeRange const& trange,VEC3 const& bnom, int charge) const;
       bool goodFit(KKTRK const& ktrk) const;
@@ -185,6 +192,7 @@ namespace mu2e {
       art::ProductToken<CaloClusterCollection> cccol_T_;
       TrkFitFlag goodseed_;
       bool saveall_;
+      bool concurrent_; // fit seeds concurrently
       ProditionsHandle<StrawResponse> strawResponse_h_;
       ProditionsHandle<Tracker> alignedTracker_h_;
       int print_;
@@ -203,25 +211,28 @@ namespace mu2e {
       double sampletol_; // surface intersection tolerance (mm)
       bool sampleinrange_, sampleinbounds_; // require samples to be in range or on surface
       bool fixedfield_; // special case usage for seed fits, if no BField corrections are needed
+      bool numgrad_; // finite-difference BField gradient
+      std::unique_ptr<KKDetBField::Grid> detgrid_; // optional detector-system BField grid
       SurfaceMap smap_;
       AnnPtr tsdaptr_;
       DiskPtr trkfrontptr_, trkmidptr_, trkbackptr_;
       FruPtr opaptr_;
       bool extrapolate_, backToTracker_, toOPA_, toTrackerEnds_, upstream_;
       ExtrapolateToZ TSDA_, trackerFront_, trackerBack_; // extrapolation predicate based on Z values
-      ExtrapolateIPA extrapIPA_; // extrapolation to intersections with the IPA
-      ExtrapolateST extrapST_; // extrapolation to intersections with the ST
+      ExtrapolateIPA extrapIPA_; // extrapolation to intersections with the IPA; copied for each track as it caches the last intersection
+      ExtrapolateST extrapST_; // extrapolation to intersections with the ST; copied for each track as it caches the last intersection
       double ipathick_ = 0.511; // ipa thickness: should come from geometry service TODO
       double stthick_ = 0.1056; // st foil thickness: should come from geometry service TODO
       SurfaceMap::SurfacePairCollection sample_; // surfaces to sample the fit
   };
 
-  LoopHelixFit::LoopHelixFit(const Parameters& settings) :  art::EDProducer{settings},
+  LoopHelixFit::LoopHelixFit(const Parameters& settings, art::ProcessingFrame const& frame) :  art::SharedProducer{settings},
     fitflag_(TrkFitFlag::KKLoopHelix) ,
     chcol_T_(consumes<ComboHitCollection>(settings().modSettings().comboHitCollection())),
     cccol_T_(mayConsume<CaloClusterCollection>(settings().modSettings().caloClusterCollection())),
     goodseed_(settings().modSettings().seedFlags()),
     saveall_(settings().modSettings().saveAll()),
+    concurrent_(settings().modSettings().concurrentFits() && settings().modSettings().printLevel() == 0),
     print_(settings().modSettings().printLevel()),
     fpart_(static_cast<PDGCode::type>(settings().modSettings().fitParticle())),
     fdir_(static_cast<TrkFitDirection::FitDirection>(settings().fitDirection())),
@@ -233,8 +244,11 @@ namespace mu2e {
     sampletol_(settings().modSettings().sampleTol()),
     sampleinrange_(settings().modSettings().sampleInRange()),
     sampleinbounds_(settings().modSettings().sampleInBounds()),
-    fixedfield_(false), extrapolate_(false), backToTracker_(false), toOPA_(false)
+    fixedfield_(false), numgrad_(settings().modSettings().numBGrad()), extrapolate_(false), backToTracker_(false), toOPA_(false)
     {
+      // the proditions handles and per-run BField are module state, so events are processed one at a time.
+      // The seeds within an event are fit concurrently, see produce
+      serialize<art::InEvent>();
       // collection handling
       for(const auto& hseedtag : settings().modSettings().seedCollections()) { hseedCols_.emplace_back(consumes<HelixSeedCollection>(hseedtag)); }
       produces<KKTRKCOL>();
@@ -253,6 +267,10 @@ namespace mu2e {
         fixedfield_ = true;
         kkbf_ = std::move(std::make_unique<KKConstantBField>(VEC3(0.0,0.0,bz)));
       }
+      if(settings().modSettings().detBField()){
+        auto const& dbf = *settings().modSettings().detBField();
+        detgrid_ = std::make_unique<KKDetBField::Grid>(dbf.lo(),dbf.hi(),dbf.spacing());
+      }
       // setup optional fit finalization; this just updates the internals, not the fit result itself
       if(settings().finalSettings()){
         if(exconfig_.schedule_.size() > 0)
@@ -306,7 +324,7 @@ namespace mu2e {
       smap.surfaces(ssids,sample_);
     }
 
-  void LoopHelixFit::beginRun(art::Run& run) {
+  void LoopHelixFit::beginRun(art::Run& run, art::ProcessingFrame const& frame) {
     // setup things that rely on data related to beginRun
     auto const& ptable = GlobalConstantsHandle<ParticleDataList>();
     mass_ = ptable->particle(fpart_).mass();
@@ -315,15 +333,15 @@ namespace mu2e {
     if(!fixedfield_){
       GeomHandle<BFieldManager> bfmgr;
       GeomHandle<DetectorSystem> det;
-      kkbf_ = std::move(std::make_unique<KKBField>(*bfmgr,*det));
+      if(detgrid_)
+        kkbf_ = std::make_unique<KKDetBField>(*bfmgr,*det,*detgrid_,numgrad_);
+      else
+        kkbf_ = std::move(std::make_unique<KKBField>(*bfmgr,*det,numgrad_));
     }
     if(print_ > 0) kkbf_->print(std::cout);
   }
 
-  void LoopHelixFit::produce(art::Event& event ) {
-    // empty collections
-    static MEASCOL nohits; // empty
-    static EXINGCOL noexings; // empty
+  void LoopHelixFit::produce(art::Event& event, art::ProcessingFrame const& frame) {
     // calo geom
     GeomHandle<Calorimeter> calo_h;
     // find current proditions
@@ -333,100 +351,45 @@ namespace mu2e {
     auto ch_H = event.getValidHandle<ComboHitCollection>(chcol_T_);
     auto cc_H = event.getValidHandle<CaloClusterCollection>(cccol_T_);
     auto const& chcol = *ch_H;
+    // index the hits and panels once for all the fits of this event
+    KKHitIndex hitindex(*tracker,chcol,kkfit_.hitIndexTimeBin());
     // create output
     unique_ptr<KKTRKCOL> ktrkcol(new KKTRKCOL );
     unique_ptr<KalSeedCollection> kkseedcol(new KalSeedCollection );
     unique_ptr<KalHelixAssns> kkseedassns(new KalHelixAssns());
     auto KalSeedCollectionPID = event.getProductID<KalSeedCollection>();
     auto KalSeedCollectionGetter = event.productGetter(KalSeedCollectionPID);
-    // find the helix seed collections
+    // find the helix seeds to fit, in collection order
     unsigned nseed(0);
+    std::vector<HPtr> hptrs;
     for (auto const& hseedtag : hseedCols_) {
       auto const& hseedcol_h = event.getValidHandle<HelixSeedCollection>(hseedtag);
       auto const& hseedcol = *hseedcol_h;
       nseed += hseedcol.size();
-      // loop over the seeds
       for(size_t iseed=0; iseed < hseedcol.size(); ++iseed) {
-        auto const& hseed = hseedcol[iseed];
-        auto hptr = HPtr(hseedcol_h,iseed);
         // check helicity.  The test on the charge and helicity
-        if(hseed.status().hasAllProperties(goodseed_) ){
-          // test helix
-          auto const& helix = hseed.helix();
-          if(helix.radius() == 0.0 || helix.lambda() == 0.0 )
-            throw cet::exception("RECO")<<"mu2e::HelixFit: degenerate seed parameters" << endl;
-          auto zcent = Mu2eKinKal::zMid(hseed.hits());
-          // take the magnetic field at the helix center as nominal
-          VEC3 center(helix.centerx(), helix.centery(),zcent);
-          auto bnom = kkbf_->fieldVect(center);
-          // compute the charge from the helicity, fit direction, and BField direction
-          double bz = bnom.Z();
-          int charge = static_cast<int>(copysign(PDGcharge_,(-1)*helix.helicity().value()*fdir_.dzdt()*bz));
-          // test consistency.  Modify this later when the HelixSeed knows which direction it's going TODO
-          auto fitpart = fpart_;
-          if(charge*PDGcharge_ < 0){
-            if(usePDGCharge_)throw cet::exception("RECO")<<"mu2e::HelixFit: inconsistent charge" << endl;
-            fitpart = static_cast<PDGCode::type>(-1*fitpart); // reverse sign
-          }
-          // time range of the hits
-          auto trange = Mu2eKinKal::timeBounds(hseed.hits());
-          // construt the seed trajectory
-          KTRAJ seedtraj = makeSeedTraj(hseed,trange,bnom,charge);
-          // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
-          PTRAJ pseedtraj(seedtraj);
-          // first, we need to unwind the combohits.  We use this also to find the time range
-          StrawHitIndexCollection strawHitIdxs;
-          auto chcolptr = hseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
-          if(chcolptr != &chcol)
-            throw cet::exception("RECO")<<"mu2e::KKHelixFit: inconsistent ComboHitCollection" << std::endl;
-          // next, build straw hits and materials from these
-          KKSTRAWHITCOL strawhits;
-          strawhits.reserve(strawHitIdxs.size());
-          KKSTRAWXINGCOL strawxings;
-          strawxings.reserve(strawHitIdxs.size());
-          if(kkfit_.makeStrawHits(*tracker, *strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, chcol, strawHitIdxs, strawhits, strawxings)){
-            // optionally (and if present) add the CaloCluster as a constraint
-            // verify the cluster looks physically reasonable before adding it TODO!  Or, let the KKCaloHit updater do it TODO
-            KKCALOHITCOL calohits;
-            if (kkfit_.useCalo() && hseed.caloCluster().isNonnull())kkfit_.makeCaloHit(hseed.caloCluster(),*calo_h, pseedtraj, calohits);
-            // set the seed range given the hits and xings
-            seedtraj.range() = kkfit_.range(strawhits,calohits,strawxings);
-            // create and fit the track
-            auto ktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fitpart,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits);
-            // Check the fit
-            auto goodfit = goodFit(*ktrk);
-            // if we have an extension schedule, extend.
-            if(goodfit && exconfig_.schedule().size() > 0) {
-              kkfit_.extendTrack(exconfig_,*kkbf_, *tracker,*strawresponse, kkmat_.strawMaterial(), chcol, *calo_h, cc_H, *ktrk );
-              goodfit = goodFit(*ktrk);
-              // if finaling, apply that now.
-              if(goodfit && fconfig_.schedule().size() > 0){
-                ktrk->extend(fconfig_,nohits,noexings);
-                goodfit = goodFit(*ktrk);
-              }
-            }
-            // extrapolate as required
-            if(goodfit && extrapolate_) extrapolate(*ktrk);
-            if(print_>0)ktrk->printFit(std::cout,print_);
-            if(goodfit || saveall_){
-              TrkFitFlag fitflag(hptr->status());
-              fitflag.merge(fitflag_);
-              if(goodfit)
-                fitflag.merge(TrkFitFlag::FitOK);
-              else
-                fitflag.clear(TrkFitFlag::FitOK);
-              auto kkseed = kkfit_.createSeed(*ktrk,fitflag,*calo_h);
-              sampleFit(*ktrk,kkseed._inters);
-              kkseedcol->push_back(kkseed);
-              // fill assns with the helix seed
-              auto hptr = art::Ptr<HelixSeed>(hseedcol_h,iseed);
-              auto kseedptr = art::Ptr<KalSeed>(KalSeedCollectionPID,kkseedcol->size()-1,KalSeedCollectionGetter);
-              kkseedassns->addSingle(kseedptr,hptr);
-              // save (unpersistable) KKTrk in the event
-              ktrkcol->push_back(ktrk.release());
-            }
-          }
-        }
+        if(hseedcol[iseed].status().hasAllProperties(goodseed_) )hptrs.push_back(HPtr(hseedcol_h,iseed));
+      }
+    }
+    // fit the seeds.  The fits are independent, so they can run concurrently; the results are indexed by seed
+    std::vector<std::unique_ptr<KKTRK>> ktrks(hptrs.size());
+    std::vector<KalSeed> kkseeds(hptrs.size());
+    auto fitone = [&](size_t iseed) {
+      ktrks[iseed] = fitSeed(*hptrs[iseed],*tracker,*strawresponse,*calo_h,hitindex,cc_H,kkseeds[iseed]);
+    };
+    if(concurrent_)
+      tbb::parallel_for(size_t(0),hptrs.size(),fitone);
+    else
+      for(size_t iseed=0; iseed < hptrs.size(); ++iseed)fitone(iseed);
+    // fill the output in seed order, so that it doesn't depend on the scheduling
+    for(size_t iseed=0; iseed < hptrs.size(); ++iseed) {
+      if(ktrks[iseed]){
+        kkseedcol->push_back(std::move(kkseeds[iseed]));
+        // fill assns with the helix seed
+        auto kseedptr = art::Ptr<KalSeed>(KalSeedCollectionPID,kkseedcol->size()-1,KalSeedCollectionGetter);
+        kkseedassns->addSingle(kseedptr,hptrs[iseed]);
+        // save (unpersistable) KKTrk in the event
+        ktrkcol->push_back(ktrks[iseed].release());
       }
     }
     // put the output products into the event
@@ -436,6 +399,82 @@ namespace mu2e {
     event.put(move(kkseedassns));
   }
 
+  std::unique_ptr<KKTRK> LoopHelixFit::fitSeed(HelixSeed const& hseed, Tracker const& tracker, StrawResponse const& strawresponse,
+      Calorimeter const& calo, KKHitIndex const& hitindex, CCHandle const& cc_H, KalSeed& kkseed) const {
+    auto const& chcol = hitindex.comboHits();
+    // empty collections
+    static const MEASCOL nohits; // empty
+    static const EXINGCOL noexings; // empty
+    // test helix
+    auto const& helix = hseed.helix();
+    if(helix.radius() == 0.0 || helix.lambda() == 0.0 )
+      throw cet::exception("RECO")<<"mu2e::HelixFit: degenerate seed parameters" << endl;
+    auto zcent = Mu2eKinKal::zMid(hseed.hits());
+    // take the magnetic field at the helix center as nominal
+    VEC3 center(helix.centerx(), helix.centery(),zcent);
+    auto bnom = kkbf_->fieldVect(center);
+    // compute the charge from the helicity, fit direction, and BField direction
+    double bz = bnom.Z();
+    int charge = static_cast<int>(copysign(PDGcharge_,(-1)*helix.helicity().value()*fdir_.dzdt()*bz));
+    // test consistency.  Modify this later when the HelixSeed knows which direction it's going TODO
+    auto fitpart = fpart_;
+    if(charge*PDGcharge_ < 0){
+      if(usePDGCharge_)throw cet::exception("RECO")<<"mu2e::HelixFit: inconsistent charge" << endl;
+      fitpart = static_cast<PDGCode::type>(-1*fitpart); // reverse sign
+    }
+    // time range of the hits
+    auto trange = Mu2eKinKal::timeBounds(hseed.hits());
+    // construt the seed trajectory
+    KTRAJ seedtraj = makeSeedTraj(hseed,trange,bnom,charge);
+    // wrap the seed traj in a Piecewise traj: needed to satisfy PTOCA interface
+    PTRAJ pseedtraj(seedtraj);
+    // first, we need to unwind the combohits.  We use this also to find the time range
+    StrawHitIndexCollection strawHitIdxs;
+    auto chcolptr = hseed.hits().fillStrawHitIndices(strawHitIdxs, StrawIdMask::uniquestraw);
+    if(chcolptr != &chcol)
+      throw cet::exception("RECO")<<"mu2e::KKHelixFit: inconsistent ComboHitCollection" << std::endl;
+    // next, build straw hits and materials from these
+    KKSTRAWHITCOL strawhits;
+    strawhits.reserve(strawHitIdxs.size());
+    KKSTRAWXINGCOL strawxings;
+    strawxings.reserve(strawHitIdxs.size());
+    if(!kkfit_.makeStrawHits(tracker, strawresponse, *kkbf_, kkmat_.strawMaterial(), pseedtraj, chcol, strawHitIdxs, strawhits, strawxings))
+      return nullptr;
+    // optionally (and if present) add the CaloCluster as a constraint
+    // verify the cluster looks physically reasonable before adding it TODO!  Or, let the KKCaloHit updater do it TODO
+    KKCALOHITCOL calohits;
+    if (kkfit_.useCalo() && hseed.caloCluster().isNonnull())kkfit_.makeCaloHit(hseed.caloCluster(),calo, pseedtraj, calohits);
+    // set the seed range given the hits and xings
+    seedtraj.range() = kkfit_.range(strawhits,calohits,strawxings);
+    // create and fit the track
+    auto ktrk = make_unique<KKTRK>(config_,*kkbf_,seedtraj,fitpart,kkfit_.strawHitClusterer(),strawhits,strawxings,calohits);
+    // Check the fit
+    auto goodfit = goodFit(*ktrk);
+    // if we have an extension schedule, extend.
+    if(goodfit && exconfig_.schedule().size() > 0) {
+      kkfit_.extendTrack(exconfig_,*kkbf_, tracker,strawresponse, kkmat_.strawMaterial(), hitindex, calo, cc_H, *ktrk );
+      goodfit = goodFit(*ktrk);
+      // if finaling, apply that now.
+      if(goodfit && fconfig_.schedule().size() > 0){
+        ktrk->extend(fconfig_,nohits,noexings);
+        goodfit = goodFit(*ktrk);
+      }
+    }
+    // extrapolate as required
+    if(goodfit && extrapolate_) extrapolate(*ktrk);
+    if(print_>0)ktrk->printFit(std::cout,print_);
+    if(!(goodfit || saveall_)) return nullptr;
+    TrkFitFlag fitflag(hseed.status());
+    fitflag.merge(fitflag_);
+    if(goodfit)
+      fitflag.merge(TrkFitFlag::FitOK);
+    else
+      fitflag.clear(TrkFitFlag::FitOK);
+    kkseed = kkfit_.createSeed(*ktrk,fitflag,calo);
+    sampleFit(*ktrk,kkseed._inters);
+    return ktrk;
+  }
+
   KTRAJ LoopHelixFit::makeSeedTraj(HelixSeed const& hseed,TimeRange const& trange,VEC3 const& bnom, int charge) const {
     auto const& helix = hseed.helix();
     DVEC pars;
@@ -476,7 +515,7 @@ namespace mu2e {
     }
     // test that the trajectory is inside the DS
     if(retval){
-      static unsigned ntimes(100);
+      static const unsigned ntimes(100);
       double dt = ktrk.fitTraj().range().range()/(ntimes-1);
       for(unsigned it=0;it< ntimes; ++it) {
         double ttest = ktrk.fitTraj().range().begin() + it*dt;
@@ -548,34 +587,35 @@ namespace mu2e {
   }
 
   bool LoopHelixFit::extrapolateIPA(KKTRK& ktrk,TimeDir tdir) const {
-    if(extrapIPA_.debug() > 0)std::cout << "extrapolating to IPA " << std::endl;
+    // the predicate caches its last intersection, so use a copy: tracks can be extrapolated concurrently
+    ExtrapolateIPA extrapIPA(extrapIPA_);
+    if(extrapIPA.debug() > 0)std::cout << "extrapolating to IPA " << std::endl;
     // extraplate the fit through the IPA. This will add material effects for each intersection. It will continue till the
     // track exits the IPA
-    extrapIPA_.reset();
     auto const& ftraj = ktrk.fitTraj();
     static const SurfaceId IPASID("IPA");
     double starttime = tdir == TimeDir::forwards ? ftraj.range().end() : ftraj.range().begin();
     auto startdir = ftraj.direction(starttime);
     do {
-      ktrk.extrapolate(tdir,extrapIPA_);
-      if(extrapIPA_.intersection().onsurface_ && extrapIPA_.intersection().inbounds_){
+      ktrk.extrapolate(tdir,extrapIPA);
+      if(extrapIPA.intersection().onsurface_ && extrapIPA.intersection().inbounds_){
         // we have a good intersection. Use this to create a Shell material Xing
         auto const& reftrajptr = tdir == TimeDir::backwards ? ftraj.frontPtr() : ftraj.backPtr();
         auto const& IPA = smap_.DS().innerProtonAbsorberPtr();
-        KKIPAXINGPTR ipaxingptr = std::make_shared<KKIPAXING>(IPA,IPASID,*kkmat_.IPAMaterial(),extrapIPA_.intersection(),reftrajptr,ipathick_,extrapIPA_.tolerance());
-        if(extrapIPA_.debug() > 0){
+        KKIPAXINGPTR ipaxingptr = std::make_shared<KKIPAXING>(IPA,IPASID,*kkmat_.IPAMaterial(),extrapIPA.intersection(),reftrajptr,ipathick_,extrapIPA.tolerance());
+        if(extrapIPA.debug() > 0){
           double dmom, paramomvar, perpmomvar;
           ipaxingptr->materialEffects(dmom,paramomvar,perpmomvar);
           std::cout << "IPA Xing dmom " << dmom << " para momsig " << sqrt(paramomvar) << " perp momsig " << sqrt(perpmomvar) << std::endl;
           std::cout << " before append mom = " << reftrajptr->momentum();
         }
         ktrk.addIPAXing(ipaxingptr,tdir);
-        if(extrapIPA_.debug() > 0){
+        if(extrapIPA.debug() > 0){
           auto const& newtrajptr = tdir == TimeDir::backwards ? ftraj.frontPtr() : ftraj.backPtr();
           std::cout << " after append mom = " << newtrajptr->momentum() << std::endl;
         }
       }
-    } while(extrapIPA_.intersection().onsurface_ && extrapIPA_.intersection().inbounds_);
+    } while(extrapIPA.intersection().onsurface_ && extrapIPA.intersection().inbounds_);
     // check if the particle exited in the same physical direction or not (reflection)
     double endtime = tdir == TimeDir::forwards ? ftraj.range().end() : ftraj.range().begin();
     auto enddir = ftraj.direction(endtime);
@@ -586,32 +626,33 @@ namespace mu2e {
   }
 
   bool LoopHelixFit::extrapolateST(KKTRK& ktrk,TimeDir tdir) const {
+    // the predicate caches its last intersection, so use a copy: tracks can be extrapolated concurrently
+    ExtrapolateST extrapST(extrapST_);
     // extraplate the fit through the ST. This will add material effects for each foil intersection. It will continue till the
     // track exits the ST in Z
-    extrapST_.reset();
     auto const& ftraj = ktrk.fitTraj();
     double starttime = tdir == TimeDir::forwards ? ftraj.range().end() : ftraj.range().begin();
     auto startdir = ftraj.direction(starttime);
-    if(extrapST_.debug() > 0)std::cout << "extrapolating to ST " << std::endl;
+    if(extrapST.debug() > 0)std::cout << "extrapolating to ST " << std::endl;
     do {
-      ktrk.extrapolate(tdir,extrapST_);
-      if(extrapST_.intersection().onsurface_ && extrapST_.intersection().inbounds_){
+      ktrk.extrapolate(tdir,extrapST);
+      if(extrapST.intersection().onsurface_ && extrapST.intersection().inbounds_){
         // we have a good intersection. Use this to create a Shell material Xing
         auto const& reftrajptr = tdir == TimeDir::backwards ? ftraj.frontPtr() : ftraj.backPtr();
-        KKSTXINGPTR stxingptr = std::make_shared<KKSTXING>(extrapST_.foil(),extrapST_.foilId(),*kkmat_.STMaterial(),extrapST_.intersection(),reftrajptr,stthick_,extrapST_.tolerance());
-        if(extrapST_.debug() > 0){
+        KKSTXINGPTR stxingptr = std::make_shared<KKSTXING>(extrapST.foil(),extrapST.foilId(),*kkmat_.STMaterial(),extrapST.intersection(),reftrajptr,stthick_,extrapST.tolerance());
+        if(extrapST.debug() > 0){
           double dmom, paramomvar, perpmomvar;
           stxingptr->materialEffects(dmom,paramomvar,perpmomvar);
           std::cout << "ST Xing dmom " << dmom << " para momsig " << sqrt(paramomvar) << " perp momsig " << sqrt(perpmomvar) << std::endl;
           std::cout << " before append mom = " << reftrajptr->momentum();
         }
         ktrk.addSTXing(stxingptr,tdir);
-        if(extrapST_.debug() > 0){
+        if(extrapST.debug() > 0){
           auto const& newtrajptr = tdir == TimeDir::backwards ? ftraj.frontPtr() : ftraj.backPtr();
           std::cout << " after append mom = " << newtrajptr->momentum() << std::endl;
         }
       }
-    } while(extrapST_.intersection().onsurface_ && extrapST_.intersection().inbounds_);
+    } while(extrapST.intersection().onsurface_ && extrapST.intersection().inbounds_);
     // check if the particle exited in the same physical direction or not (reflection)
     double endtime = tdir == TimeDir::forwards ? ftraj.range().end() : ftraj.range().begin();
     auto enddir = ftraj.direction(endtime);
@@ -0,0 +1,53 @@
+#ifndef Mu2eUtilities_DenseANN_hh
+#define Mu2eUtilities_DenseANN_hh
+//
+// Inference for fully-connected (dense) networks, such as the Keras models exported as TMVA SOFIE weight files.
+// A batch of candidates is a row-major (nrows x nInputs) matrix; each layer is evaluated for the whole batch
+// with 1 matrix product followed by the activation.  All intermediate results are kept in a Workspace owned by
+// the caller, so a DenseANN can be shared between threads.  The sigmoid and tanh activations use a vectorizable
+// exp and are within 2e-7 of the library functions, so results are not bit-for-bit those of a scalar loop.
+//
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace mu2e {
+  class DenseANN {
+    public:
+      enum Activation {linear=0, relu, sigmoid, tanh, tmvatanh}; // tmvatanh is the rational approximation used by TMVA
+      struct Layer {
+        size_t nin_, nout_;
+        std::vector<float> kernel_; // (nin x nout), row-major
+        std::vector<float> bias_; // nout
+        Activation act_;
+      };
+      // scratch space for the layer outputs of a batch.  Each thread must use its own
+      class Workspace {
+        public:
+          Workspace() = default;
+        private:
+          friend class DenseANN;
+          std::vector<float> a_, b_;
+      };
+      DenseANN() = default;
+      // read a SOFIE weight file.  Layers are the tensor_<layer>kernel0 (nin x nout) and tensor_<layer>bias0 (nout) pairs,
+      // ordered by layer name (dense, dense1, dense2, ...), as written by Keras
+      DenseANN(std::string const& weightfile, Activation hidden=relu, Activation output=sigmoid);
+      // append a layer; nin must match the previous layer output
+      void addLayer(size_t nin, size_t nout, std::vector<float> kernel, std::vector<float> bias, Activation act);
+      size_t nInputs() const { return layers_.empty() ? 0 : layers_.front().nin_; }
+      size_t nOutputs() const { return layers_.empty() ? 0 : layers_.back().nout_; }
+      auto const& layers() const { return layers_; }
+      // evaluate nrows candidates: input is (nrows x nInputs), output (nrows x nOutputs), both row-major
+      void infer(float const* input, size_t nrows, float* output, Workspace& ws) const;
+      // evaluate a single candidate of a network with 1 output
+      float infer(float const* input, Workspace& ws) const;
+      // apply an activation function in place
+      static void activate(Activation act, float* x, size_t n);
+      static Activation activation(std::string const& name);
+    private:
+      std::vector<Layer> layers_;
+      size_t maxWidth_ = 0; // widest layer output
+  };
+}
+#endif
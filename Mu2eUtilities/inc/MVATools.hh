@@ -27,11 +27,21 @@ namespace mu2e
        explicit MVATools(const Config& conf);
        explicit MVATools(const std::string& xmlfilename);
 
+       // scratch space for evaluation, owned by the caller.  Each thread must use its own
+       struct Workspace
+       {
+          std::vector<float>  x_;   // inputs of the current layer
+          std::vector<float>  y_;   // outputs of the current layer
+       };
+
        virtual ~MVATools();
        xercesc::DOMDocument* getXmlDoc();
        void     initMVA();
        float    evalMVA(const std::vector<float>&,  const MVAMask& vmask=0xffffffff) const;
        float    evalMVA(const std::vector<double>&, const MVAMask& vmask=0xffffffff) const;
+       float    evalMVA(const std::vector<float>&, Workspace& ws, const MVAMask& vmask=0xffffffff) const;
+       // evaluate nrows candidates with nvars variables each, stored row-major in v
+       void     evalMVA(const float* v, size_t nrows, size_t nvars, float* out, Workspace& ws, const MVAMask& vmask=0xffffffff) const;
        void     showMVA() const;
 
        const std::vector<std::string>& titles() const { return title_;}
@@ -46,10 +56,8 @@ namespace mu2e
        void   getNorm(xercesc::DOMDocument* xmlDoc);
        void   getWgts(xercesc::DOMDocument* xmlDoc);
        float  activation(float arg) const;
+       float  feedForward(const float* v, size_t nvars, Workspace& ws, const MVAMask& vmask) const;
 
-       mutable std::vector<float> x_;
-       mutable std::vector<float> y_;
-       mutable std::vector<float> fv_;
        std::vector<float>         wgts_;
        std::vector<unsigned>      links_;
        unsigned                   maxNeurons_;
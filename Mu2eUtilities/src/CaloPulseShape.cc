@@ -74,6 +74,20 @@ namespace mu2e {
        return (pulseVec_[ibin+1]-pulseVec_[ibin])/digiStep_*(t-t0bin)+pulseVec_[ibin];
    }
 
+   //----------------------------------------------------------------------------
+   // same as above, also returning the derivative with respect to the time difference
+   double CaloPulseShape::evaluate(double tDifference, double& slope) const
+   {
+       double t = tDifference+deltaT_;
+       int ibin = nSteps_ + int(t*nSteps_/digiStep_/nSteps_);
+
+       slope = 0.0;
+       if (ibin < 0 || ibin >= int(pulseVec_.size()-1)) return 0.0;
+       double t0bin = (ibin-nSteps_)*digiStep_; //t0 is located at nSteps_
+       slope = (pulseVec_[ibin+1]-pulseVec_[ibin])/digiStep_;
+       return slope*(t-t0bin)+pulseVec_[ibin];
+   }
+
    //----------------------------------------------------------------------------
    double CaloPulseShape::fromPeakToT0(double timePeak) const
    {
@@ -0,0 +1,197 @@
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
+#include "cetlib_except/exception.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <utility>
+
+namespace {
+  // Fortran BLAS, as called by the SOFIE generated code
+  extern "C" void sgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+      const float* alpha, const float* A, const int* lda, const float* B, const int* ldb,
+      const float* beta, float* C, const int* ldc);
+
+  // below this many rows the BLAS call overhead exceeds the product itself
+  constexpr size_t minBlasRows = 8;
+
+  // exp without branches or library calls, so that loops over it vectorize (Cephes expf, within 2 ulp).
+  // The argument must be within [-87,88]: the clamping is done in a separate loop, as GCC doesn't if-convert it here
+  inline float vexp(float x) {
+    // round to nearest by adding and subtracting 1.5*2^23; the integer then sits in the low mantissa bits
+    float t = x*1.44269504088896341f + 12582912.0f;
+    float fn = t - 12582912.0f;
+    float r = x - fn*0.693359375f + fn*2.12194440e-4f;
+    float p = 1.9875691500e-4f;
+    p = p*r + 1.3981999507e-3f;
+    p = p*r + 8.3334519073e-3f;
+    p = p*r + 4.1665795894e-2f;
+    p = p*r + 1.6666665459e-1f;
+    p = p*r + 5.0000001201e-1f;
+    p = p*r*r + r + 1.0f;
+    int32_t ibits;
+    std::memcpy(&ibits,&t,sizeof(ibits));
+    ibits = (ibits - 0x4B400000 + 127) << 23;
+    float scale;
+    std::memcpy(&scale,&ibits,sizeof(scale));
+    return p*scale;
+  }
+
+  inline void clamp(float* x, size_t n, float xmin, float xmax) {
+    for(size_t i=0; i < n; ++i) x[i] = std::min(std::max(x[i],xmin),xmax);
+  }
+}
+
+namespace mu2e {
+
+  DenseANN::DenseANN(std::string const& weightfile, Activation hidden, Activation output) {
+    std::ifstream f(weightfile);
+    if(!f.is_open())
+      throw cet::exception("RECO")<<"mu2e::DenseANN: can't open weight file " << weightfile << std::endl;
+    // group the tensors by layer name
+    struct Tensors { std::vector<float> kernel, bias; };
+    std::map<std::pair<std::string,int>,Tensors> tensors;
+    static const std::string prefix("tensor_"), kname("kernel0"), bname("bias0");
+    std::string name;
+    size_t length;
+    while(f >> name >> length){
+      std::vector<float> values(length);
+      for(auto& value : values) f >> value;
+      if(!f)
+        throw cet::exception("RECO")<<"mu2e::DenseANN: truncated tensor " << name << " in " << weightfile << std::endl;
+      bool iskernel = name.size() > kname.size() && name.compare(name.size()-kname.size(),kname.size(),kname) == 0;
+      bool isbias = name.size() > bname.size() && name.compare(name.size()-bname.size(),bname.size(),bname) == 0;
+      if(name.compare(0,prefix.size(),prefix) != 0 || !(iskernel || isbias))
+        throw cet::exception("RECO")<<"mu2e::DenseANN: unexpected tensor " << name << " in " << weightfile << std::endl;
+      std::string layer = name.substr(prefix.size(),name.size()-prefix.size()-(iskernel ? kname.size() : bname.size()));
+      // split the layer name into base and number, so that dense10 follows dense9
+      size_t idigit = layer.find_last_not_of("0123456789")+1;
+      int ilayer = idigit < layer.size() ? std::stoi(layer.substr(idigit)) : 0;
+      auto& lt = tensors[std::make_pair(layer.substr(0,idigit),ilayer)];
+      (iskernel ? lt.kernel : lt.bias) = std::move(values);
+    }
+    size_t ilayer(0);
+    for(auto& lt : tensors){
+      auto& kernel = lt.second.kernel;
+      auto& bias = lt.second.bias;
+      if(bias.empty() || kernel.empty() || kernel.size()%bias.size() != 0)
+        throw cet::exception("RECO")<<"mu2e::DenseANN: inconsistent tensors for layer " << lt.first.first << lt.first.second << " in " << weightfile << std::endl;
+      size_t nout = bias.size();
+      size_t nin = kernel.size()/nout;
+      addLayer(nin,nout,std::move(kernel),std::move(bias), ++ilayer == tensors.size() ? output : hidden);
+    }
+    if(layers_.empty())
+      throw cet::exception("RECO")<<"mu2e::DenseANN: no layers in " << weightfile << std::endl;
+  }
+
+  void DenseANN::addLayer(size_t nin, size_t nout, std::vector<float> kernel, std::vector<float> bias, Activation act) {
+    if(kernel.size() != nin*nout || bias.size() != nout || (!layers_.empty() && nin != layers_.back().nout_))
+      throw cet::exception("RECO")<<"mu2e::DenseANN: inconsistent layer dimensions " << nin << " x " << nout << std::endl;
+    layers_.push_back(Layer{nin,nout,std::move(kernel),std::move(bias),act});
+    maxWidth_ = std::max(maxWidth_,nout);
+  }
+
+  void DenseANN::infer(float const* input, size_t nrows, float* output, Workspace& ws) const {
+    if(nrows == 0)return;
+    size_t nmax = nrows*maxWidth_;
+    if(ws.a_.size() < nmax){
+      ws.a_.resize(nmax);
+      ws.b_.resize(nmax);
+    }
+    float const* x = input;
+    for(size_t ilayer=0; ilayer < layers_.size(); ++ilayer){
+      auto const& layer = layers_[ilayer];
+      float* y = ilayer+1 == layers_.size() ? output : (ilayer%2 == 0 ? ws.a_.data() : ws.b_.data());
+      size_t nin = layer.nin_;
+      size_t nout = layer.nout_;
+      float const* kernel = layer.kernel_.data();
+      if(nrows >= minBlasRows){
+        for(size_t irow=0; irow < nrows; ++irow)
+          std::copy(layer.bias_.begin(),layer.bias_.end(),y+irow*nout);
+        // y(nout x nrows) += kernel(nout x nin) * x(nin x nrows), in column-major (BLAS) terms
+        static const char trans('n');
+        static const float one(1.0);
+        int m = nout, n = nrows, k = nin;
+        sgemm_(&trans,&trans,&m,&n,&k,&one,kernel,&m,x,&k,&one,y,&m);
+      } else {
+        // accumulate blocks of outputs in registers
+        static constexpr size_t nblock = 8;
+        float const* bias = layer.bias_.data();
+        for(size_t irow=0; irow < nrows; ++irow){
+          float const* xrow = x + irow*nin;
+          float* yrow = y + irow*nout;
+          size_t iout = 0;
+          for(; iout+nblock <= nout; iout += nblock){
+            float acc[nblock];
+            for(size_t ib=0; ib < nblock; ++ib) acc[ib] = bias[iout+ib];
+            for(size_t iin=0; iin < nin; ++iin){
+              float xi = xrow[iin];
+              float const* krow = kernel + iin*nout + iout;
+              for(size_t ib=0; ib < nblock; ++ib) acc[ib] += xi*krow[ib];
+            }
+            for(size_t ib=0; ib < nblock; ++ib) yrow[iout+ib] = acc[ib];
+          }
+          for(; iout < nout; ++iout){
+            float acc = bias[iout];
+            for(size_t iin=0; iin < nin; ++iin) acc += xrow[iin]*kernel[iin*nout + iout];
+            yrow[iout] = acc;
+          }
+        }
+      }
+      activate(layer.act_,y,nrows*nout);
+      x = y;
+    }
+  }
+
+  float DenseANN::infer(float const* input, Workspace& ws) const {
+    if(nOutputs() != 1)
+      throw cet::exception("RECO")<<"mu2e::DenseANN: single-value inference of a network with " << nOutputs() << " outputs" << std::endl;
+    float retval;
+    infer(input,1,&retval,ws);
+    return retval;
+  }
+
+  void DenseANN::activate(Activation act, float* x, size_t n) {
+    switch(act) {
+      case linear:
+        break;
+      case relu:
+        for(size_t i=0; i < n; ++i) x[i] = x[i] > 0.0f ? x[i] : 0.0f;
+        break;
+      case sigmoid:
+        clamp(x,n,-87.0f,87.0f);
+        for(size_t i=0; i < n; ++i) x[i] = 1.0f/(1.0f + vexp(-x[i]));
+        break;
+      case tanh:
+        clamp(x,n,-10.0f,10.0f); // tanh is 1 to float precision beyond
+        for(size_t i=0; i < n; ++i) x[i] = 1.0f - 2.0f/(vexp(2.0f*x[i]) + 1.0f);
+        break;
+      case tmvatanh:
+        {
+          // the approximation is replaced by +-1 beyond +-4.97, where it is monotonic
+          static const float amax = 4.97f;
+          auto approx = [](float arg) {
+            float arg2 = arg*arg;
+            float a = arg*(135135.0f + arg2*(17325.0f + arg2*(378.0f + arg2)));
+            float b = 135135.0f + arg2*(62370.0f + arg2*(3150.0f + arg2*28.0f));
+            return a/b; };
+          static const float vmax = approx(amax);
+          clamp(x,n,-amax,amax);
+          for(size_t i=0; i < n; ++i) x[i] = approx(x[i]);
+          for(size_t i=0; i < n; ++i) x[i] = x[i] >= vmax ? 1.0f : x[i];
+          for(size_t i=0; i < n; ++i) x[i] = x[i] <= -vmax ? -1.0f : x[i];
+        }
+        break;
+    }
+  }
+
+  DenseANN::Activation DenseANN::activation(std::string const& name) {
+    static const std::map<std::string,Activation> names = { {"linear",linear}, {"relu",relu}, {"sigmoid",sigmoid}, {"tanh",tanh}, {"tmvatanh",tmvatanh} };
+    auto iname = names.find(name);
+    if(iname == names.end())
+      throw cet::exception("RECO")<<"mu2e::DenseANN: unknown activation " << name << std::endl;
+    return iname->second;
+  }
+}
@@ -38,9 +38,6 @@ namespace mu2e
 {
 
   MVATools::MVATools(const Config& config) :
-    x_(),
-    y_(),
-    fv_(),
     wgts_(),
     maxNeurons_(0),
     activeType_(aType::null),
@@ -59,9 +56,6 @@ namespace mu2e
   }
 
   MVATools::MVATools(fhicl::ParameterSet const& pset) :
-    x_(),
-    y_(),
-    fv_(),
     wgts_(),
     maxNeurons_(0),
     activeType_(aType::null),
@@ -80,9 +74,6 @@ namespace mu2e
   }
 
   MVATools::MVATools(const std::string& xmlfilename) :
-    x_(),
-    y_(),
-    fv_(),
     wgts_(),
     maxNeurons_(0),
     activeType_(aType::null),
@@ -376,8 +367,6 @@ namespace mu2e
       }
 
       maxNeurons_ = *std::max_element(links_.begin(),links_.end());
-      x_ = std::vector<float>(maxNeurons_,0.0f);
-      y_ = std::vector<float>(maxNeurons_,0.0f);
 
       XMLString::release(&ATT_INDEX);
       XMLString::release(&ATT_NSYNAPSES);
@@ -432,24 +421,48 @@ namespace mu2e
 
   float MVATools::evalMVA(const std::vector<double >& v, const MVAMask& mask) const
   {
-     for (size_t i=0;i<v.size();++i)  fv_[i] = static_cast<float>(v[i]);
-     return evalMVA(fv_,mask);
+     static thread_local Workspace ws;
+     std::vector<float> fv(v.begin(),v.end());
+     return evalMVA(fv,ws,mask);
   }
 
   float MVATools::evalMVA(const std::vector<float>& v, const MVAMask& mask) const
   {
+     static thread_local Workspace ws;
+     return evalMVA(v,ws,mask);
+  }
+
+  float MVATools::evalMVA(const std::vector<float>& v, Workspace& ws, const MVAMask& mask) const
+  {
+     return feedForward(v.data(),v.size(),ws,mask);
+  }
+
+  void MVATools::evalMVA(const float* v, size_t nrows, size_t nvars, float* out, Workspace& ws, const MVAMask& mask) const
+  {
+     for (size_t irow=0; irow < nrows; ++irow) out[irow] = feedForward(v + irow*nvars,nvars,ws,mask);
+  }
+
+
+  float MVATools::feedForward(const float* v, size_t nvars, Workspace& ws, const MVAMask& mask) const
+  {
+      ws.x_.resize(maxNeurons_);
+      ws.y_.resize(maxNeurons_);
+      auto& x = ws.x_;
+      auto& y = ws.y_;
 
       // Normalize the input data and add the bias node, skip masked values
       size_t ival(0);
-      for (size_t ivar=0; ivar < v.size(); ivar++)
+      for (size_t ivar=0; ivar < nvars; ivar++)
       {
          if ( mask & (1<<ivar) )
          {
-            x_[ival]= isNorm_ ? (v[ivar]-voffset_[ival])*vscale_[ival] - 1.0 : v[ivar];
+            if (ival+1 >= links_[0])
+              throw cet::exception("RECO")<<"mu2e::MVATools: more inputs than the network architecture (links_[0]-1 = " << links_[0]-1 << ")" << std::endl;
+            x[ival]= isNorm_ ? (v[ivar]-voffset_[ival])*vscale_[ival] - 1.0 : v[ivar];
             ++ival;
          }
       }
-      x_[ival] = 1.0;
+      x[ival] = 1.0;
 
       if (ival != links_[0]-1)
         throw cet::exception("RECO")<<"mu2e::MVATools: mismatch input dimension (ival = " << ival << ") and network architecture (links_[0]-1 = " << links_[0]-1 << ")" << std::endl;
@@ -462,18 +475,18 @@ namespace mu2e
           //the number of synpases is given by the number of neurons in the next layer -1 (do not count bias neuron!)
           for (unsigned j=0;j<links_[k+1]-1;++j)
           {
-             y_[j]=0.0f;
-             for (unsigned i=0;i<links_[k];++i) y_[j] += wgts_[i+idxWeight]*x_[i];
-             y_[j] = activation(y_[j]);
+             y[j]=0.0f;
+             for (unsigned i=0;i<links_[k];++i) y[j] += wgts_[i+idxWeight]*x[i];
+             y[j] = activation(y[j]);
              idxWeight += links_[k];
           }
-          x_.swap(y_);
-          x_[links_[k+1]-1] = 1.0f; //add bias neuron
+          x.swap(y);
+          x[links_[k+1]-1] = 1.0f; //add bias neuron
       }
 
       //calculate output neuron value
       float yf(0.0);
-      for (unsigned i=0;i<links_.back();++i) yf += wgts_[i+idxWeight]*x_[i];
+      for (unsigned i=0;i<links_.back();++i) yf += wgts_[i+idxWeight]*x[i];
 
       if (oldMVA_) return yf;
       return  1.0/(1.0+expf(-yf));
@@ -30,6 +30,7 @@
 #include "Offline/AnalysisConfig/inc/MVACatalogConfig.hh"
 #include "Offline/SimulationConfig/inc/SimBookkeeperConfig.hh"
 #include "Offline/CaloConfig/inc/CalCalibConfig.hh"
+#include "Offline/GeneralUtilities/inc/BackgroundQueue.hh"
 
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
@@ -42,6 +43,9 @@
 #include "fhiclcpp/types/Table.h"
 #include <string>
 
+namespace art {
+class SubRun;
+}
 
 namespace mu2e {
 
@@ -51,6 +55,10 @@ class ProditionsService {
     using Name = fhicl::Name;
     using Comment = fhicl::Comment;
     fhicl::Atom<int> verbose{Name("verbose"), Comment("verbosity 0 or 1"), 0};
+    fhicl::OptionalAtom<int> prefetchIovs{
+        Name("prefetchIovs"),
+        Comment("if >=0, at each new subrun build the conditions in use "
+                "for it and this many following IoVs on a background thread")};
     fhicl::Table<CRVOrdinalConfig> crvOrdinal{
         Name("crvOrdinal"),
         Comment("CRV online-offline numbering configuration")};
@@ -111,6 +119,8 @@ class ProditionsService {
   }
 
   // void postBeginJob();
+  void preBeginSubRun(art::SubRun const& subrun);
+  void postEndJob();
 
  private:
   // This is not copyable or assignable - private and unimplemented.
@@ -119,6 +129,8 @@ class ProditionsService {
 
   Config _config;
   std::map<std::string, ProditionsCache::ptr> _caches;
+  int _prefetchIovs;
+  BackgroundQueue _prefetcher;
 };
 
 }  // namespace mu2e
@@ -33,7 +33,9 @@
 #include "Offline/AnalysisConditions/inc/TrkQualCatalogCache.hh"
 #include "Offline/SimulationConditions/inc/SimBookkeeperCache.hh"
 
+#include "art/Framework/Principal/SubRun.h"
 #include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include <iomanip>
 #include <iostream>
 #include <typeinfo>
 
@@ -43,12 +45,21 @@ namespace mu2e {
 
 ProditionsService::ProditionsService(Parameters const& sTable,
                                      art::ActivityRegistry& iRegistry) :
-    _config(sTable()) {
+    _config(sTable()), _prefetchIovs(-1), _prefetcher("ProditionsService") {
   // create this here to force DbService to be active before Proditions
   art::ServiceHandle<DbService> d;
+  // the prefetch reads through the DbService engine, so it has to be
+  // joined before DbService shuts the engine down
+  d->addEndJobStop([this]() { _prefetcher.stop(); });
   // and then Geometry
   art::ServiceHandle<GeometryService> g;
 
+  iRegistry.sPostEndJob.watch(this, &ProditionsService::postEndJob);
+  _config.prefetchIovs(_prefetchIovs);
+  if (_prefetchIovs >= 0) {
+    iRegistry.sPreBeginSubRun.watch(this, &ProditionsService::preBeginSubRun);
+  }
+
   auto cor = std::make_shared<mu2e::CRVOrdinalCache>(_config.crvOrdinal());
   _caches[cor->name()] = cor;
   auto csy = std::make_shared<mu2e::CRVPhotonYieldCache>(_config.crvPhotonYield());
@@ -109,4 +120,27 @@ ProditionsService::ProditionsService(Parameters const& sTable,
   }
 }
 
+void ProditionsService::preBeginSubRun(art::SubRun const& subrun) {
+  // anything still queued for the previous subrun is now less urgent
+  _prefetcher.clearPending();
+  art::EventID eid(subrun.run(), subrun.subRun(), 1);
+  int nIov = _prefetchIovs;
+  _prefetcher.post([this, eid, nIov]() {
+    for (auto const& cc : _caches) cc.second->prefetch(eid, nIov);
+  });
+}
+
+void ProditionsService::postEndJob() {
+  _prefetcher.stop();
+  if (_config.verbose() > 0) {
+    cout << "Proditions lock times (s), waiting and locked:" << endl;
+    for (auto const& cc : _caches) {
+      cout << "  " << std::left << std::setw(24) << cc.first << std::right
+           << std::setw(12) << cc.second->lockWaitTime().count() * 1.0e-6
+           << std::setw(12) << cc.second->lockTime().count() * 1.0e-6
+           << endl;
+    }
+  }
+}
+
 }  // namespace mu2e
@@ -0,0 +1,98 @@
+#ifndef RecoDataProducts_ComboHitStore_hh
+#define RecoDataProducts_ComboHitStore_hh
+//
+// Read-only, structure-of-arrays copy of the ComboHitCollection used by pattern recognition, built once
+// per event so that the finders don't each sort the hits again.  The hits are stored in
+// (station, face, panel, time) order, where faces and panels are numbered in increasing z within the
+// station as in CalPatRec ChannelID::orderID.  Each panel is a contiguous range of store positions, and
+// so is each face.  For time-window searches every face also has its hits listed in time order, binned
+// with fixed-width time bins.
+//
+// A position in the store is not a ComboHit index: index(ipos) gives the ComboHit of a store position and
+// position(index) the store position of a ComboHit.  Flags and other ComboHit content are not copied, and
+// can be taken from any collection with the same hits in the same order: the collection the store was made
+// from, or an unfiltered hit-by-hit copy of it, for instance the output of DeltaFinder when it doesn't
+// filter.  Consumers check this with matches(), and build their own store with fill() when the event has
+// no matching one.
+//
+#include "Offline/DataProducts/inc/StrawId.hh"
+#include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include <cstdint>
+#include <vector>
+
+namespace mu2e {
+
+  class ComboHitStore {
+    public:
+      constexpr static unsigned _nfacesperstation = 2*StrawId::_nfaces;
+      constexpr static unsigned _npanelsperface = StrawId::_npanels/StrawId::_nfaces;
+      constexpr static unsigned _nofaces = StrawId::_nstations*_nfacesperstation;
+      constexpr static unsigned _nopanels = _nofaces*_npanelsperface;
+      // a range of store positions, or of entries of the face time order
+      struct Range {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        size_t size() const { return end - begin; }
+        bool empty() const { return end == begin; }
+      };
+
+      ComboHitStore() = default;
+      // chcolId is the ProductID of chcol
+      ComboHitStore(ComboHitCollection const& chcol, art::ProductID const& chcolId, float timebin);
+      // refill from another collection, reusing the memory of the arrays
+      void fill(ComboHitCollection const& chcol, art::ProductID const& chcolId, float timebin);
+
+      // z-ordered face (0-3 in the station) and panel (0-2 in the face) of a straw
+      static unsigned orderedFace(StrawId const& sid);
+      static unsigned orderedPanel(StrawId const& sid) { return sid.panel()/2; }
+      // z-ordered face and panel slot in the tracker
+      static unsigned faceSlot(unsigned station, unsigned oface) { return station*_nfacesperstation + oface; }
+      static unsigned panelSlot(unsigned station, unsigned oface, unsigned opanel) { return faceSlot(station,oface)*_npanelsperface + opanel; }
+      static unsigned panelSlot(StrawId const& sid) { return panelSlot(sid.station(),orderedFace(sid),orderedPanel(sid)); }
+
+      // ProductID of the collection the store was made from, and of that collection's parent
+      art::ProductID const& collectionId() const { return _chcolId; }
+      art::ProductID const& parentId() const { return _parentId; }
+      // true if chcol, with ProductID chcolId, has the hits of the store in the same order: it is the collection
+      // the store was made from, or a copy of it with the same parent and number of hits in which every hit has
+      // the time and panel of the store entry indexing it
+      bool matches(ComboHitCollection const& chcol, art::ProductID const& chcolId) const;
+
+      size_t size() const { return _index.size(); }
+      // ComboHit index of a store position and store position of a ComboHit index
+      uint32_t index(size_t ipos) const { return _index[ipos]; }
+      uint32_t position(size_t chindex) const { return _position[chindex]; }
+      float time(size_t ipos) const { return _time[ipos]; }
+      float x(size_t ipos) const { return _x[ipos]; }
+      float y(size_t ipos) const { return _y[ipos]; }
+      float z(size_t ipos) const { return _z[ipos]; }
+      float uDirX(size_t ipos) const { return _ux[ipos]; }
+      float uDirY(size_t ipos) const { return _uy[ipos]; }
+      XYZVectorF pos(size_t ipos) const { return XYZVectorF(_x[ipos],_y[ipos],_z[ipos]); }
+
+      // store positions of the hits of a z-ordered panel or face, in time order within a panel
+      Range panelHits(unsigned station, unsigned oface, unsigned opanel) const;
+      Range faceHits(unsigned station, unsigned oface) const;
+      // store position of entry itime of the face time order.  The entries of a face are those of faceHits
+      uint32_t timeOrdered(size_t itime) const { return _timeorder[itime]; }
+      // entries of the face time order in time bin 'bin'.  Hits with negative time are in bin 0, and
+      // bins past nTimeBins() are empty
+      Range faceTimeBin(unsigned station, unsigned oface, unsigned bin) const;
+      float timeBin() const { return _timebin; }
+      unsigned nTimeBins() const { return _ntimebins; }
+      unsigned timeBinOf(float time) const { return time > 0.0 ? unsigned(time/_timebin) : 0; }
+
+    private:
+      art::ProductID _chcolId, _parentId;
+      std::vector<uint32_t> _index; // ComboHit index, by store position
+      std::vector<uint32_t> _position; // store position, by ComboHit index
+      std::vector<float> _time, _x, _y, _z, _ux, _uy; // by store position
+      std::vector<uint32_t> _panelOffsets; // first store position of each panel slot, and the end
+      std::vector<uint32_t> _timeorder; // store positions of each face's hits in time order
+      std::vector<uint32_t> _binOffsets; // for each face, first time order entry of each bin, and the end
+      float _timebin = 0.0;
+      unsigned _ntimebins = 0;
+  };
+}
+#endif
@@ -0,0 +1,149 @@
+//
+// Structure-of-arrays, z- and time-ordered copy of a ComboHitCollection
+//
+// Mu2e includes
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
+// art includes
+#include "cetlib_except/exception.h"
+// c++ includes
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mu2e {
+
+  unsigned ComboHitStore::orderedFace(StrawId const& sid) {
+    unsigned face = sid.panel()%2;
+    if(sid.station()%2 == 0)
+      return sid.plane()%2 == 0 ? 1 - face : face + 2;
+    else
+      return sid.plane()%2 == 0 ? face : 3 - face;
+  }
+
+  ComboHitStore::ComboHitStore(ComboHitCollection const& chcol, art::ProductID const& chcolId, float timebin) {
+    fill(chcol,chcolId,timebin);
+  }
+
+  namespace {
+    // unsigned key with the order of a float time; both zeros have the key of +0
+    inline uint32_t timeKey(float time) {
+      uint32_t bits(0);
+      if(time != 0.0f) std::memcpy(&bits,&time,sizeof(bits));
+      return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+  }
+
+  void ComboHitStore::fill(ComboHitCollection const& chcol, art::ProductID const& chcolId, float timebin) {
+    _chcolId = chcolId;
+    _parentId = chcol.parent().refCore().id();
+    _timebin = timebin;
+    if(_timebin <= 0.0)throw cet::exception("RECO")<<"mu2e::ComboHitStore: time bin must be positive" << std::endl;
+    size_t nch = chcol.size();
+    if(nch > std::numeric_limits<uint32_t>::max())
+      throw cet::exception("RECO")<<"mu2e::ComboHitStore: too many ComboHits " << nch << std::endl;
+    // one pass over the collection: the content is copied in ComboHit order, and moved to the store order once
+    // that is known.  _position holds the panel slot of each hit until then
+    _position.resize(nch);
+    _panelOffsets.assign(_nopanels+1,0);
+    _time.resize(nch); _x.resize(nch); _y.resize(nch); _z.resize(nch); _ux.resize(nch); _uy.resize(nch);
+    std::vector<std::pair<uint32_t,uint32_t>> tsort(nch), tbuf(nch);
+    float tmax(0.0);
+    for(size_t ich=0;ich < nch; ++ich){
+      ComboHit const& ch = chcol[ich];
+      _position[ich] = panelSlot(ch.strawId());
+      ++_panelOffsets[_position[ich]+1];
+      tsort[ich] = std::make_pair(timeKey(ch.time()),uint32_t(ich));
+      _time[ich] = ch.time();
+      _x[ich] = ch.pos().x();
+      _y[ich] = ch.pos().y();
+      _z[ich] = ch.pos().z();
+      _ux[ich] = ch.uDir2D().x();
+      _uy[ich] = ch.uDir2D().y();
+      tmax = std::max(tmax,ch.time());
+    }
+    // order the hits by time with a 3-pass radix sort of their (time key, index) pairs.  It is stable, so equal
+    // times stay in index order
+    constexpr unsigned nbits(11), nradix(1u<<nbits);
+    std::vector<uint32_t> count(nradix);
+    for(unsigned shift=0;shift < 32; shift += nbits){
+      std::fill(count.begin(),count.end(),0);
+      for(auto const& ts : tsort) ++count[(ts.first>>shift)&(nradix-1)];
+      uint32_t sum(0);
+      for(auto& c : count){ uint32_t n = c; c = sum; sum += n; }
+      for(auto const& ts : tsort) tbuf[count[(ts.first>>shift)&(nradix-1)]++] = ts;
+      tsort.swap(tbuf);
+    }
+    // counting sort of the time-ordered hits into panel slots, which keeps them in time order within a panel.
+    // _binOffsets holds the next position of each panel until the time bins are made
+    for(unsigned ipan=0;ipan < _nopanels; ++ipan) _panelOffsets[ipan+1] += _panelOffsets[ipan];
+    _binOffsets.assign(_panelOffsets.begin(),_panelOffsets.end()-1);
+    _index.resize(nch);
+    for(auto const& ts : tsort) _index[_binOffsets[_position[ts.second]]++] = ts.second;
+    for(size_t ipos=0;ipos < nch; ++ipos) _position[_index[ipos]] = ipos;
+    // move the content to the store order
+    std::vector<float> buf(nch);
+    for(auto array : {&_time, &_x, &_y, &_z, &_ux, &_uy}){
+      for(size_t ipos=0;ipos < nch; ++ipos) buf[ipos] = (*array)[_index[ipos]];
+      array->swap(buf);
+    }
+    // face time order: merge the time-ordered panels of each face.  On equal times the hit of the earlier
+    // panel comes first
+    auto tcomp = [this](uint32_t a, uint32_t b){ return _time[a] < _time[b]; };
+    _timeorder.resize(nch);
+    for(uint32_t ipos=0;ipos < nch; ++ipos) _timeorder[ipos] = ipos;
+    std::vector<uint32_t>& merged = _binOffsets;
+    merged.resize(nch);
+    for(unsigned iface=0;iface < _nofaces; ++iface){
+      auto first = _timeorder.begin() + _panelOffsets[iface*_npanelsperface];
+      for(unsigned ipan=1;ipan < _npanelsperface; ++ipan){
+        auto mid = _timeorder.begin() + _panelOffsets[iface*_npanelsperface+ipan];
+        auto last = _timeorder.begin() + _panelOffsets[iface*_npanelsperface+ipan+1];
+        auto out = std::merge(first,mid,mid,last,merged.begin(),tcomp);
+        std::copy(merged.begin(),out,first);
+      }
+    }
+    // time bin offsets of each face
+    _ntimebins = nch > 0 ? timeBinOf(tmax)+1 : 0;
+    _binOffsets.resize(_nofaces*(_ntimebins+1));
+    for(unsigned iface=0;iface < _nofaces; ++iface){
+      uint32_t itime = _panelOffsets[iface*_npanelsperface];
+      uint32_t end = _panelOffsets[(iface+1)*_npanelsperface];
+      for(unsigned ibin=0;ibin <= _ntimebins; ++ibin){
+        while(itime < end && timeBinOf(_time[_timeorder[itime]]) < ibin) ++itime;
+        _binOffsets[iface*(_ntimebins+1)+ibin] = itime;
+      }
+    }
+  }
+
+  bool ComboHitStore::matches(ComboHitCollection const& chcol, art::ProductID const& chcolId) const {
+    if(chcolId == _chcolId)return true;
+    // a copy keeps the parent of the original; a filtered copy has fewer hits
+    if(!_parentId.isValid() || !(chcol.parent().refCore().id() == _parentId) || chcol.size() != size())return false;
+    // and a reordered copy puts other hits at the indices of the store
+    for(size_t ipos=0;ipos < size(); ++ipos){
+      ComboHit const& ch = chcol[_index[ipos]];
+      unsigned ipan = panelSlot(ch.strawId());
+      if(ch.time() != _time[ipos] || ipos < _panelOffsets[ipan] || ipos >= _panelOffsets[ipan+1])return false;
+    }
+    return true;
+  }
+
+  ComboHitStore::Range ComboHitStore::panelHits(unsigned station, unsigned oface, unsigned opanel) const {
+    unsigned ipan = panelSlot(station,oface,opanel);
+    return Range{_panelOffsets[ipan],_panelOffsets[ipan+1]};
+  }
+
+  ComboHitStore::Range ComboHitStore::faceHits(unsigned station, unsigned oface) const {
+    unsigned iface = faceSlot(station,oface);
+    return Range{_panelOffsets[iface*_npanelsperface],_panelOffsets[(iface+1)*_npanelsperface]};
+  }
+
+  ComboHitStore::Range ComboHitStore::faceTimeBin(unsigned station, unsigned oface, unsigned bin) const {
+    if(bin >= _ntimebins){
+      uint32_t end = faceHits(station,oface).end;
+      return Range{end,end};
+    }
+    unsigned ioff = faceSlot(station,oface)*(_ntimebins+1) + bin;
+    return Range{_binOffsets[ioff],_binOffsets[ioff+1]};
+  }
+}
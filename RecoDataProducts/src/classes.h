@@ -28,6 +28,7 @@
 #include "Offline/RecoDataProducts/inc/StrawDigi.hh"
 #include "Offline/RecoDataProducts/inc/StrawDigiFlag.hh"
 #include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
 
 // tracking intermediate products
 #include "Offline/RecoDataProducts/inc/HelixHit.hh"
@@ -51,6 +51,13 @@ namespace mu2e {
       double D2T(double dist, double phi) const;
       double T2D(double time, double phi, bool nonnegative=true) const;
 
+      // the model grid, for tables built on the same nodes
+      size_t phiBins() const { return _phiBins; }
+      double deltaD() const { return _deltaD; }
+      size_t distanceBins() const { return _distances_dbins.size(); }
+      double deltaT() const { return _deltaT; }
+      size_t timeBins() const { return _times_tbins.size(); }
+
       void print(std::ostream& os) const;
 
     private:
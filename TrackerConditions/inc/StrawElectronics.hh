@@ -108,11 +108,33 @@ namespace mu2e {
       // linear response to a charge pulse.  This does NOT include saturation effects,
       // since those are cumulative and cannot be computed for individual charges
       double linearResponse(Straw const& straw, Path ipath, double time, double charge, double distance, bool forsaturation=false) const; // mvolts per pCoulomb
+      // the terms of the linear response depending only on the charge and its distance to the straw end,
+      // computed once to evaluate the response of a charge at many times
+      struct ChargeResponse {
+        double _charge;
+        double _distFrac; // interpolation weight of the lower wire distance point
+        double _reflectionTime;
+        double _reflectionScale;
+        int _distIndex; // lower wire distance point
+      };
+      void chargeResponse(Straw const& straw, double charge, double distance, ChargeResponse& cresp) const;
+      // same value as the linearResponse above
+      double linearResponse(Straw const& straw, Path ipath, double time, ChargeResponse const& cresp, bool forsaturation=false) const;
+      // add the linear response of a charge arriving at tcharge to resp[i] for each of the ntimes times[i] > tmin.
+      // Each sum is the same as adding the linearResponse above.  The loop over times is branch-free so it vectorizes
+      void addLinearResponse(Straw const& straw, Path ipath, ChargeResponse const& cresp, double tcharge, double tmin,
+          double const* times, size_t ntimes, double* resp) const;
+      // time after the charge arrival from which its linear response is constant (the truncated tail)
+      double responseTailTime(ChargeResponse const& cresp) const;
       double adcImpulseResponse(StrawId sid, double time, double charge) const;
       // Given a (linear) total voltage, compute the saturated voltage
       double saturatedResponse(double lineearresponse) const;
       // relative time when linear response is maximal
       double maxResponseTime(StrawId id, Path ipath,double distance) const;
+      // linear response of a path to a unit charge at a given distance, without the reflection and the
+      // channel gain, tabulated in steps of responseTimeStep().  Returns the time of shape[0] WRT the charge
+      double responseShape(Path ipath, double distance, std::vector<double>& shape) const;
+      double responseTimeStep() const { return 1.0/_sampleRate; }
       // digization
       TrkTypes::ADCValue adcResponse(StrawId id, double mvolts) const; // ADC response to analog inputs
       TrkTypes::TDCValue tdcResponse(double time) const; // TDC response to a signal input to electronics at a given time (in ns since eventWindowMarker)
@@ -249,6 +271,7 @@ namespace mu2e {
       // but an actual TDC value that will be compared against
       // helper functions
       static inline double mypow(double,unsigned);
+      std::vector<double> const& responseTable(WireDistancePoint const& wpoint, Path ipath, bool forsaturation) const;
 
       int _responseBins;
       double _sampleRate;
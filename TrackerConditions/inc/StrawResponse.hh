@@ -15,6 +15,7 @@
 #include "Offline/TrackerConditions/inc/StrawElectronics.hh"
 #include "Offline/TrackerConditions/inc/StrawPhysics.hh"
 #include "Offline/TrackerConditions/inc/DriftInfo.hh"
+#include "Offline/TrackerConditions/inc/StrawResponseLookup.hh"
 #include "Offline/GeneralUtilities/inc/SplineInterpolation.hh"
 #include "Offline/Mu2eInterfaces/inc/ProditionsEntity.hh"
 
@@ -83,7 +84,8 @@ namespace mu2e {
         _dVdI(dVdI), _vsat(vsat), _ADCped(ADCped),
         _pmpEnergyScaleAvg(pmpEnergyScaleAvg),
         _strawHalfvp(strawHalfvp),
-        _driftIgnorePhi(driftIgnorePhi){ }
+        _driftIgnorePhi(driftIgnorePhi),
+        _useLookup(false) { }
 
       virtual ~StrawResponse() {}
 
@@ -108,6 +110,14 @@ namespace mu2e {
         _timeOffsetStrawCal = timeOffsetStrawCal;
       }
 
+      // fill the lookup tables used by the drift, error and wire distance
+      // functions in place of the model and calibration vectors.  With
+      // polyOrder > 0 drift distance and time are Chebyshev series in each
+      // phi bin instead of tables.  clearLookup returns to the vectors.
+      void buildLookup(int polyOrder);
+      void clearLookup() { _useLookup = false; _lookup = StrawResponseLookup(); }
+      bool useLookup() const { return _useLookup; }
+
       DriftInfo driftInfo(StrawId strawId, double dtime, double phi) const;
 
       double driftTimeToDistance(StrawId strawId, double dtime, double phi) const;
@@ -142,6 +152,8 @@ namespace mu2e {
       inline double totLSB() const { return _strawElectronics->totLSB(); }
       inline double adcPeriod() const { return _strawElectronics->adcPeriod(); }
       inline uint16_t maxADC() const { return _strawElectronics->maxADC(); }
+      inline double responseShape(StrawElectronics::Path ipath, double distance, std::vector<double>& shape) const { return _strawElectronics->responseShape(ipath,distance,shape); }
+      inline double responseTimeStep() const { return _strawElectronics->responseTimeStep(); }
       // StrawPhysics functions we are allowed to use
       inline double ionizationEnergy(double q) const { return _strawPhysics->ionizationEnergy(q); }
 
@@ -223,6 +235,8 @@ namespace mu2e {
       std::array<double, StrawId::_nustraws> _strawHalfvp;
 
       bool _driftIgnorePhi;
+      bool _useLookup;
+      StrawResponseLookup _lookup;
       static double rstraw_; // straw radius, = maximum drift distance
   };
 }
@@ -0,0 +1,133 @@
+#ifndef TrackerConditions_StrawResponseLookup_hh
+#define TrackerConditions_StrawResponseLookup_hh
+//
+// Dense float tables of the drift and calibration functions used by
+// StrawResponse for every hit.  They are filled once per conditions
+// update (StrawResponseMaker), on uniform bins, so a call is a direct
+// index and a few multiply-adds: no search, no refit, no allocation.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace mu2e {
+
+  // y(x) on uniform bins, each bin a line given by its value at the low
+  // edge and its slope.  Beyond the range the first or last line is used.
+  class LinearLookup {
+    public:
+      LinearLookup() : _xmin(0.0), _dx(1.0), _invdx(1.0), _imax(0) {}
+      LinearLookup(double xmin, double dx, size_t nbins);
+
+      void setBin(size_t ibin, double y0, double slope);
+      size_t nBins() const { return _bins.size(); }
+      double binLow(size_t ibin) const { return _xmin + ibin*_dx; }
+
+      float value(float x) const {
+        float slope;
+        return value(x,slope);
+      }
+      float value(float x, float& slope) const {
+        float u = std::min(std::max((x - _xmin)*_invdx,0.0f),_imax);
+        size_t ibin = static_cast<size_t>(u);
+        Bin const& bin = _bins[ibin];
+        slope = bin.slope;
+        return bin.y0 + bin.slope*(x - _xmin - ibin*_dx);
+      }
+
+    private:
+      struct Bin { float y0, slope; };
+      float _xmin, _dx, _invdx, _imax;
+      std::vector<Bin> _bins;
+  };
+
+  // z(x,phi) of the drift model: linear in x between uniform nodes and
+  // linear in phi between nPhi nodes spanning [0,pi/2], with phi folded
+  // into that quadrant.  Optionally each phi node is instead a Chebyshev
+  // series in x fit to the node values, which is smaller and has no
+  // table to walk; beyond the fit range it continues with the end slope.
+  class DriftLookup {
+    public:
+      DriftLookup() : _nphi(0), _xmin(0.0), _dx(1.0), _invdx(1.0), _imax(0),
+      _invdphi(0.0), _order(0), _xscale(0.0), _xoffset(0.0) {}
+      // values are indexed [ix*nphi + iphi]
+      DriftLookup(double xmin, double dx, size_t nx, size_t nphi,
+          std::vector<float> const& values);
+
+      // replace the table by a series of this order in each phi bin;
+      // returns the largest difference from the node values
+      double fitPolynomials(int order);
+      int polynomialOrder() const { return _order; }
+
+      static float foldPhi(float phi) {
+        phi = std::fabs(phi);
+        phi -= float(M_PI)*std::floor(phi*float(M_1_PI));
+        return std::min(phi,float(M_PI)-phi);
+      }
+
+      float value(float x, float phi) const {
+        float p = std::min(foldPhi(phi)*_invdphi,float(_nphi-1));
+        size_t iphi = std::min(static_cast<size_t>(p),_nphi-2);
+        float w = p - iphi;
+        float z0, z1;
+        if (_order > 0) {
+          float s = x*_xscale + _xoffset;
+          float sc = std::min(std::max(s,-1.0f),1.0f);
+          z0 = series(iphi,sc,s-sc);
+          z1 = series(iphi+1,sc,s-sc);
+        } else {
+          float u = (x - _xmin)*_invdx;
+          size_t ix = static_cast<size_t>(std::min(std::max(u,0.0f),_imax));
+          float f = u - ix;
+          float const* lo = &_values[ix*_nphi + iphi];
+          float const* hi = lo + _nphi;
+          z0 = lo[0] + f*(hi[0] - lo[0]);
+          z1 = lo[1] + f*(hi[1] - lo[1]);
+        }
+        return z0 + w*(z1 - z0);
+      }
+
+    private:
+      // Clenshaw sum of the series for one phi node at sc in [-1,1],
+      // continued linearly by ds past the ends
+      float series(size_t iphi, float sc, float ds) const {
+        float const* c = &_coef[iphi*(_order+1)];
+        float b1(0.0), b2(0.0);
+        for (int k=_order;k>0;--k){
+          float b0 = 2.0f*sc*b1 - b2 + c[k];
+          b2 = b1;
+          b1 = b0;
+        }
+        float endSlope = ds < 0.0f ? _lowSlope[iphi] : _highSlope[iphi];
+        return sc*b1 - b2 + c[0] + ds*endSlope;
+      }
+
+      size_t _nphi;
+      float _xmin, _dx, _invdx, _imax;
+      float _invdphi;
+      std::vector<float> _values;
+      int _order;
+      float _xscale, _xoffset; // x to the series variable in [-1,1]
+      std::vector<float> _coef;
+      std::vector<float> _lowSlope, _highSlope; // d/ds at s = -1 and 1
+  };
+
+  // the tables used by StrawResponse
+  struct StrawResponseLookup {
+    DriftLookup t2d; // drift distance vs drift time and phi
+    DriftLookup d2t; // drift time vs drift distance and phi
+    LinearLookup instantSpeed; // vs drift distance, at phi=0
+    LinearLookup driftOffset; // calibration offset vs uncalibrated distance
+    LinearLookup signedDriftRMS; // vs calibrated distance
+    LinearLookup unsignedDriftRMS;
+    LinearLookup llDriftTimeOffset; // vs drift distance
+    LinearLookup llDriftTimeRMS;
+    LinearLookup halfvpScale; // vs edep in KeV
+    LinearLookup centralRes;
+    LinearLookup resSlope;
+  };
+
+}
+#endif
@@ -68,43 +68,76 @@ namespace mu2e {
   }
 
   double StrawElectronics::linearResponse(Straw const& straw, Path ipath, double time, double charge, double distance, bool forsaturation) const {
+    ChargeResponse cresp;
+    chargeResponse(straw,charge,distance,cresp);
+    return linearResponse(straw,ipath,time,cresp,forsaturation);
+  }
+
+  void StrawElectronics::chargeResponse(Straw const& straw, double charge, double distance, ChargeResponse& cresp) const {
+    double straw_length = 2*straw.halfLength();
+    cresp._charge = charge;
+    cresp._reflectionTime = _reflectionTimeShift + (2*straw_length-2*distance)/_reflectionVelocity;
+    cresp._reflectionScale = _reflectionFrac * exp(-(2*straw_length-2*distance)/_reflectionALength);
+
+    int  distIndex = 0;
+    for (size_t i=1;i<_wPoints.size()-1;i++){
+      if (distance < _wPoints[i]._distance)
+        break;
+      distIndex = i;
+    }
+    cresp._distIndex = distIndex;
+    cresp._distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
+  }
+
+  std::vector<double> const& StrawElectronics::responseTable(WireDistancePoint const& wpoint, Path ipath, bool forsaturation) const {
+    if (ipath == thresh)
+      return forsaturation ? wpoint._preampToAdc1Response : wpoint._preampResponse;
+    return wpoint._adcResponse;
+  }
+
+  double StrawElectronics::linearResponse(Straw const& straw, Path ipath, double time, ChargeResponse const& cresp, bool forsaturation) const {
     int index = time*_sampleRate + _responseBins/2.;
     if ( index >= _responseBins)
       index = _responseBins-1;
     if (index < 0)
       index = 0;
 
-    double straw_length = 2*straw.halfLength();
-    double reflection_time = _reflectionTimeShift + (2*straw_length-2*distance)/_reflectionVelocity;
-    int index_refl = (time - reflection_time)*_sampleRate + _responseBins/2.;
+    int index_refl = (time - cresp._reflectionTime)*_sampleRate + _responseBins/2.;
     if (index_refl >= _responseBins)
       index_refl = _responseBins-1;
     if (index_refl < 0)
       index_refl = 0;
 
-    double reflection_scale = _reflectionFrac * exp(-(2*straw_length-2*distance)/_reflectionALength);
+    auto const& r0 = responseTable(_wPoints[cresp._distIndex],ipath,forsaturation);
+    auto const& r1 = responseTable(_wPoints[cresp._distIndex + 1],ipath,forsaturation);
+    double p0 = r0[index] + r0[index_refl]*cresp._reflectionScale;
+    double p1 = r1[index] + r1[index_refl]*cresp._reflectionScale;
+    return cresp._charge * ( p0 * cresp._distFrac + p1 * (1 - cresp._distFrac)) * _dVdI[ipath][straw.id().uniqueStraw()];
+  }
 
-    int  distIndex = 0;
-    for (size_t i=1;i<_wPoints.size()-1;i++){
-      if (distance < _wPoints[i]._distance)
-        break;
-      distIndex = i;
+  void StrawElectronics::addLinearResponse(Straw const& straw, Path ipath, ChargeResponse const& cresp, double tcharge, double tmin,
+      double const* times, size_t ntimes, double* resp) const {
+    double const* r0 = responseTable(_wPoints[cresp._distIndex],ipath,false).data();
+    double const* r1 = responseTable(_wPoints[cresp._distIndex + 1],ipath,false).data();
+    double dVdI = _dVdI[ipath][straw.id().uniqueStraw()];
+    int maxIndex = _responseBins-1;
+    for (size_t i=0;i<ntimes;i++){
+      double time = times[i] - tcharge;
+      int index = time*_sampleRate + _responseBins/2.;
+      index = std::min(std::max(index,0),maxIndex);
+      int index_refl = (time - cresp._reflectionTime)*_sampleRate + _responseBins/2.;
+      index_refl = std::min(std::max(index_refl,0),maxIndex);
+      double p0 = r0[index] + r0[index_refl]*cresp._reflectionScale;
+      double p1 = r1[index] + r1[index_refl]*cresp._reflectionScale;
+      double val = cresp._charge * ( p0 * cresp._distFrac + p1 * (1 - cresp._distFrac)) * dVdI;
+      // adding 0 leaves the sum unchanged
+      resp[i] += static_cast<double>(times[i] > tmin)*val;
     }
-    double distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
-    double p0, p1;
-    if (ipath == thresh){
-      if (forsaturation){
-        p0 = _wPoints[distIndex]._preampToAdc1Response[index]      + _wPoints[distIndex]._preampToAdc1Response[index_refl]*reflection_scale;
-        p1 = _wPoints[distIndex + 1]._preampToAdc1Response[index]  + _wPoints[distIndex + 1]._preampToAdc1Response[index_refl]*reflection_scale;
-      }else{
-        p0 = _wPoints[distIndex]._preampResponse[index]      + _wPoints[distIndex]._preampResponse[index_refl]*reflection_scale;
-        p1 = _wPoints[distIndex + 1]._preampResponse[index]  + _wPoints[distIndex + 1]._preampResponse[index_refl]*reflection_scale;
-      }
-    }else{
-      p0 = _wPoints[distIndex]._adcResponse[index]      + _wPoints[distIndex]._adcResponse[index_refl]*reflection_scale;
-      p1 = _wPoints[distIndex + 1]._adcResponse[index]  + _wPoints[distIndex + 1]._adcResponse[index_refl]*reflection_scale;
-    }
-    return charge * ( p0 * distFrac + p1 * (1 - distFrac)) * _dVdI[ipath][straw.id().uniqueStraw()];
+  }
+
+  double StrawElectronics::responseTailTime(ChargeResponse const& cresp) const {
+    // 1 bin beyond the last response bin of both the direct and reflected signal
+    return (_responseBins/2 + 1)/_sampleRate + std::max(cresp._reflectionTime,0.0);
   }
 
   double StrawElectronics::adcImpulseResponse(StrawId sid, double time, double charge) const {
@@ -137,6 +170,22 @@ namespace mu2e {
     return p0 * distFrac + p1 * (1 - distFrac);
   }
 
+  double StrawElectronics::responseShape(Path ipath, double distance, std::vector<double>& shape) const {
+    int  distIndex = 0;
+    for (size_t i=1;i<_wPoints.size()-1;i++){
+      if (distance < _wPoints[i]._distance)
+        break;
+      distIndex = i;
+    }
+    double distFrac = 1 - (distance - _wPoints[distIndex]._distance)/(_wPoints[distIndex+1]._distance - _wPoints[distIndex]._distance);
+    auto const& r0 = responseTable(_wPoints[distIndex],ipath,false);
+    auto const& r1 = responseTable(_wPoints[distIndex + 1],ipath,false);
+    shape.resize(_responseBins);
+    for (int i=0;i<_responseBins;i++)
+      shape[i] = r0[i] * distFrac + r1[i] * (1 - distFrac);
+    return -(_responseBins/2)/_sampleRate;
+  }
+
   double StrawElectronics::maxLinearResponse(StrawId sid, Path ipath,double distance,double charge) const {
     int  distIndex = 0;
     for (size_t i=1;i<_wPoints.size()-1;i++){
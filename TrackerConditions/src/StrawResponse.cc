@@ -7,6 +7,19 @@
 
 using namespace std;
 
+namespace {
+  // bins either side of the calibration fits, should be a parameter TODO
+  const int calibHalfRange(2);
+
+  // the piecewise line through yvals at xmin, xmin+xbin, ... as a lookup
+  mu2e::LinearLookup pieceLineLookup(double xmin, double xbin, std::vector<double> const& yvals) {
+    mu2e::LinearLookup lut(xmin,xbin,yvals.size()-1);
+    for(size_t ibin=0;ibin<lut.nBins();++ibin)
+      lut.setBin(ibin,yvals[ibin],(yvals[ibin+1]-yvals[ibin])/xbin);
+    return lut;
+  }
+}
+
 namespace mu2e {
   double StrawResponse::rstraw_(2.5);  // should come from geometry, TODO
 
@@ -68,12 +81,78 @@ namespace mu2e {
     return phi;
   }
 
+  void StrawResponse::buildLookup(int polyOrder) {
+    StrawResponseLookup lut;
+    // sample the drift model at its own nodes, so the tables interpolate
+    // exactly as StrawDrift does
+    auto const& sd = *_strawDrift;
+    size_t nphi = sd.phiBins();
+    double dphi = M_PI_2/(nphi-1);
+    size_t nt = sd.timeBins();
+    std::vector<float> values(nt*nphi);
+    for(size_t it=0;it<nt;++it)
+      for(size_t iphi=0;iphi<nphi;++iphi)
+        values[it*nphi+iphi] = sd.T2D(it*sd.deltaT(),iphi*dphi,false);
+    lut.t2d = DriftLookup(0.0,sd.deltaT(),nt,nphi,values);
+    size_t nd = sd.distanceBins();
+    values.resize(nd*nphi);
+    std::vector<double> speed(nd);
+    for(size_t id=0;id<nd;++id){
+      for(size_t iphi=0;iphi<nphi;++iphi)
+        values[id*nphi+iphi] = sd.D2T(id*sd.deltaD(),iphi*dphi);
+      speed[id] = sd.GetInstantSpeedFromD(id*sd.deltaD());
+    }
+    lut.d2t = DriftLookup(0.0,sd.deltaD(),nd,nphi,values);
+    lut.instantSpeed = pieceLineLookup(0.0,sd.deltaD(),speed);
+    if(polyOrder > 0){
+      lut.t2d.fitPolynomials(polyOrder);
+      lut.d2t.fitPolynomials(polyOrder);
+    }
+
+    // the calibration fits are one line per bin
+    auto calibLookup = [](std::vector<double> const& bins, std::vector<double> const& yvals) {
+      double xbin = (bins[1]-bins[0])/yvals.size();
+      LinearLookup calib(bins[0],xbin,yvals.size());
+      for(size_t ibin=0;ibin<calib.nBins();++ibin){
+        double value, slope;
+        interpolateCalib(bins,yvals,calib.binLow(ibin)+0.5*xbin,calibHalfRange,value,slope);
+        calib.setBin(ibin,value-0.5*xbin*slope,slope);
+      }
+      return calib;
+    };
+    lut.driftOffset = calibLookup(_driftOffBins,_driftOffset);
+    lut.signedDriftRMS = calibLookup(_driftRMSBins,_signedDriftRMS);
+    lut.unsignedDriftRMS = calibLookup(_driftRMSBins,_unsignedDriftRMS);
+
+    // as PieceLineDrift and PieceLine
+    lut.llDriftTimeOffset = pieceLineLookup(_llDriftTimeOffBins[0],
+        (_llDriftTimeOffBins[1]-_llDriftTimeOffBins[0])/_llDriftTimeOffset.size(),_llDriftTimeOffset);
+    lut.llDriftTimeRMS = pieceLineLookup(_llDriftTimeRMSBins[0],
+        (_llDriftTimeRMSBins[1]-_llDriftTimeRMSBins[0])/_llDriftTimeRMS.size(),_llDriftTimeRMS);
+    double ebin = (_edep.back()-_edep.front())/(_edep.size()-1);
+    lut.halfvpScale = pieceLineLookup(_edep.front(),ebin,_halfvpscale);
+    lut.centralRes = pieceLineLookup(_edep.front(),ebin,_centres);
+    lut.resSlope = pieceLineLookup(_edep.front(),ebin,_resslope);
+
+    _lookup = std::move(lut);
+    _useLookup = true;
+  }
+
   DriftInfo StrawResponse::driftInfo(StrawId strawId, double dtime, double phi) const {
     if (_driftIgnorePhi) phi = 0;
     DriftInfo dinfo;
     dinfo.LorentzAngle_ = phi;
+    if(_useLookup){
+      float dcorrslope;
+      dinfo.cDrift_ = _lookup.t2d.value(dtime,phi);
+      dinfo.rDrift_ = dinfo.cDrift_ - _lookup.driftOffset.value(dinfo.cDrift_,dcorrslope);
+      dinfo.driftVelocity_ = _lookup.instantSpeed.value(dinfo.cDrift_)*(1.0 - dcorrslope)*_dRdTScale;
+      dinfo.signedDriftError_ = _lookup.signedDriftRMS.value(dinfo.rDrift_);
+      dinfo.unsignedDriftError_ = _lookup.unsignedDriftRMS.value(dinfo.rDrift_);
+      return dinfo;
+    }
     dinfo.cDrift_ = _strawDrift->T2D(dtime,phi,false); // allow values outside the physical range at this point
-    int halfrange(2); // should be a parameter TODO
+    int halfrange(calibHalfRange);
     double dcorr, dcorrslope;
     interpolateCalib(_driftOffBins,_driftOffset, dinfo.cDrift_, halfrange, dcorr, dcorrslope);
     dinfo.rDrift_ = dinfo.cDrift_ -dcorr;
@@ -89,6 +168,7 @@ namespace mu2e {
     if (_driftIgnorePhi)
       phi = 0;
     if(_usenonlindrift){
+      if(_useLookup) return _lookup.d2t.value(ddist,phi);
       return  _strawDrift->D2T(ddist,phi);
     }else{
       return ddist/_lindriftvel; //or return t assuming a constant drift speed of 0.06 mm/ns (for diagnosis)
@@ -96,16 +176,19 @@ namespace mu2e {
   }
 
   double StrawResponse::driftTimeOffset(StrawId strawId, double ddist, double phi) const {
+    if(_useLookup) return _lookup.llDriftTimeOffset.value(ddist);
     return PieceLineDrift(_llDriftTimeOffBins,_llDriftTimeOffset, ddist);
   }
 
   double StrawResponse::driftTimeError(StrawId strawId, double ddist, double phi) const {
     ddist = std::max(0.0,std::min(rstraw_,ddist));
+    if(_useLookup) return _lookup.llDriftTimeRMS.value(ddist);
     return PieceLineDrift(_llDriftTimeRMSBins, _llDriftTimeRMS, ddist);
   }
 
   double StrawResponse::driftInstantSpeed(StrawId strawId, double ddist, double) const {
     if(_usenonlindrift){
+      if(_useLookup) return _lookup.instantSpeed.value(ddist);
       return _strawDrift->GetInstantSpeedFromD(ddist);
     }else{
       return _lindriftvel;
@@ -116,6 +199,7 @@ namespace mu2e {
     if (_driftIgnorePhi)
       phi = 0;
     if(_usenonlindrift){
+      if(_useLookup) return _lookup.t2d.value(dtime,phi);
       return _strawDrift->T2D(dtime,phi,false);
     }
     else{
@@ -145,21 +229,21 @@ namespace mu2e {
 
   double StrawResponse::halfPropV(StrawId strawId, double kedep) const {
     double mean_prop_v = _strawHalfvp[strawId.uniqueStraw()];
+    if(_useLookup) return _lookup.halfvpScale.value(kedep)*mean_prop_v;
     return PieceLine(_edep,_halfvpscale,kedep)*mean_prop_v;
   }
 
   double StrawResponse::wpRes(double kedep,double wlen) const {
     // central resolution depends on edep
-    double tdres = PieceLine(_edep,_centres,kedep);
+    double tdres = _useLookup ? _lookup.centralRes.value(kedep) : PieceLine(_edep,_centres,kedep);
+    double wslope = _useLookup ? _lookup.resSlope.value(kedep) : PieceLine(_edep,_resslope,kedep);
     if (_rmsLongErrors){
       if( wlen > _central){
         // outside the central region the resolution depends linearly on the distance
         // along the wire.  The slope of that also depends on edep
-        double wslope = PieceLine(_edep,_resslope,kedep);
         tdres += (wlen-_central)*wslope;
       }
     }else{
-      double wslope = PieceLine(_edep,_resslope,kedep);
       tdres += wslope*wlen*wlen;
     }
     // insure a minimum value
@@ -0,0 +1,111 @@
+#include "Offline/TrackerConditions/inc/StrawResponseLookup.hh"
+#include "cetlib_except/exception.h"
+
+using namespace std;
+
+namespace mu2e {
+
+  LinearLookup::LinearLookup(double xmin, double dx, size_t nbins) :
+    _xmin(xmin), _dx(dx), _invdx(1.0/dx), _imax(nbins-1), _bins(nbins,Bin{0.0,0.0}) {
+      if(nbins == 0 || !(dx > 0.0))
+        throw cet::exception("BADCONFIG")
+          << "LinearLookup needs bins, got " << nbins << " of width " << dx << "\n";
+    }
+
+  void LinearLookup::setBin(size_t ibin, double y0, double slope) {
+    _bins.at(ibin) = Bin{float(y0),float(slope)};
+  }
+
+  DriftLookup::DriftLookup(double xmin, double dx, size_t nx, size_t nphi,
+      std::vector<float> const& values) :
+    _nphi(nphi), _xmin(xmin), _dx(dx), _invdx(1.0/dx), _imax(nx-2),
+    _invdphi((nphi-1)/M_PI_2), _values(values), _order(0), _xscale(0.0), _xoffset(0.0) {
+      if(nx < 2 || nphi < 2 || !(dx > 0.0) || values.size() != nx*nphi)
+        throw cet::exception("BADCONFIG")
+          << "DriftLookup needs at least 2x2 nodes, got " << nx << "x" << nphi
+          << " with " << values.size() << " values\n";
+    }
+
+  double DriftLookup::fitPolynomials(int order) {
+    size_t nx = _values.size()/_nphi;
+    if(order < 1 || size_t(order) >= nx)
+      throw cet::exception("BADCONFIG")
+        << "DriftLookup polynomial order " << order << " for " << nx << " nodes\n";
+    size_t ncoef = order+1;
+    // nodes span [xmin, xmin+(nx-1)dx], mapped onto [-1,1]
+    double xmax = _xmin + (nx-1)*double(_dx);
+    double xscale = 2.0/(xmax - _xmin);
+    double xoffset = -1.0 - _xmin*xscale;
+
+    // the normal equations are the same for every phi node
+    vector<double> basis(nx*ncoef);
+    for(size_t ix=0;ix<nx;++ix){
+      double s = (_xmin + ix*double(_dx))*xscale + xoffset;
+      double* t = &basis[ix*ncoef];
+      t[0] = 1.0;
+      t[1] = s;
+      for(size_t k=2;k<ncoef;++k) t[k] = 2.0*s*t[k-1] - t[k-2];
+    }
+    vector<double> ata(ncoef*ncoef,0.0);
+    for(size_t ix=0;ix<nx;++ix){
+      double const* t = &basis[ix*ncoef];
+      for(size_t i=0;i<ncoef;++i)
+        for(size_t j=0;j<ncoef;++j)
+          ata[i*ncoef+j] += t[i]*t[j];
+    }
+
+    vector<float> coef(_nphi*ncoef), lowSlope(_nphi), highSlope(_nphi);
+    double maxdiff(0.0);
+    for(size_t iphi=0;iphi<_nphi;++iphi){
+      vector<double> a(ata), b(ncoef,0.0);
+      for(size_t ix=0;ix<nx;++ix)
+        for(size_t i=0;i<ncoef;++i)
+          b[i] += basis[ix*ncoef+i]*_values[ix*_nphi+iphi];
+      // Gaussian elimination with partial pivoting
+      for(size_t i=0;i<ncoef;++i){
+        size_t ipiv = i;
+        for(size_t r=i+1;r<ncoef;++r)
+          if(fabs(a[r*ncoef+i]) > fabs(a[ipiv*ncoef+i])) ipiv = r;
+        if(ipiv != i){
+          for(size_t j=0;j<ncoef;++j) swap(a[i*ncoef+j],a[ipiv*ncoef+j]);
+          swap(b[i],b[ipiv]);
+        }
+        for(size_t r=i+1;r<ncoef;++r){
+          double f = a[r*ncoef+i]/a[i*ncoef+i];
+          for(size_t j=i;j<ncoef;++j) a[r*ncoef+j] -= f*a[i*ncoef+j];
+          b[r] -= f*b[i];
+        }
+      }
+      for(size_t i=ncoef;i-- > 0;){
+        double sum = b[i];
+        for(size_t j=i+1;j<ncoef;++j) sum -= a[i*ncoef+j]*b[j];
+        b[i] = sum/a[i*ncoef+i];
+      }
+      // T_k'(1) = k^2, T_k'(-1) = (-1)^(k+1) k^2
+      double lslope(0.0), hslope(0.0);
+      for(size_t k=0;k<ncoef;++k){
+        coef[iphi*ncoef+k] = b[k];
+        hslope += b[k]*k*k;
+        lslope += (k%2 == 1 ? 1.0 : -1.0)*b[k]*k*k;
+      }
+      lowSlope[iphi] = lslope;
+      highSlope[iphi] = hslope;
+      for(size_t ix=0;ix<nx;++ix){
+        double fit(0.0);
+        for(size_t k=0;k<ncoef;++k) fit += b[k]*basis[ix*ncoef+k];
+        maxdiff = max(maxdiff,fabs(fit - _values[ix*_nphi+iphi]));
+      }
+    }
+
+    _order = order;
+    _xscale = xscale;
+    _xoffset = xoffset;
+    _coef.swap(coef);
+    _lowSlope.swap(lowSlope);
+    _highSlope.swap(highSlope);
+    // the node table is no longer used
+    vector<float>().swap(_values);
+    return maxdiff;
+  }
+
+}
@@ -142,6 +142,8 @@ namespace mu2e {
         timeOffsetStrawHV,
         timeOffsetStrawCal );
 
+    if(_config.useLookup()) ptr->buildLookup(_config.lookupPolynomialOrder());
+
     return ptr;
   }
 
@@ -72,6 +72,10 @@ namespace mu2e {
 
     fhicl::Atom<bool> driftIgnorePhi {
       Name("driftIgnorePhi"), Comment("Ignore phi for no field reco")};
+    fhicl::Atom<bool> useLookup {
+      Name("useLookup"), Comment("Evaluate drift and calibration functions from float tables built per run")};
+    fhicl::Atom<int> lookupPolynomialOrder {
+      Name("lookupPolynomialOrder"), Comment("If > 0, order of the Chebyshev series replacing the drift tables in each phi bin")};
 
     fhicl::Atom<double> wireLengthBuffer {
       Name("wireLengthBuffer"), Comment(" wireLengthBuffer ")};
@@ -26,6 +26,7 @@
 #include "Offline/TrackerGeom/inc/Panel.hh"
 #include "Offline/TrackerGeom/inc/StrawProperties.hh"
 #include "Offline/TrackerGeom/inc/TrackerG4Info.hh"
+#include "Offline/TrackerGeom/inc/TrackerTopology.hh"
 
 namespace mu2e {
   class Tracker : public Detector, public ProditionsEntity {
@@ -65,6 +66,9 @@ namespace mu2e {
     const Panel& panel( const StrawId& id ) const{ return _panels.at(id.uniquePanel()); }
     const Straw& straw( const StrawId& id) const{ return _straws[id.uniqueStraw()]; }
 
+    // neighbor and overlap tables
+    TrackerTopology const& topology() const { return _topology; }
+
     // access the TrackerG4Info
     TrackerG4Info const* g4Tracker() const { return _g4tracker.get(); }
     TrackerG4Info* g4Tracker() { return _g4tracker.get(); }
@@ -100,6 +104,8 @@ namespace mu2e {
     PanelCollection _panels;
     // fundamental geometric content is in the following
     StrawCollection _straws;
+    // relations between elements, computed at construction
+    TrackerTopology _topology;
     // plane existence: use cases of this should switch to using TrackerStatus and this should be removed FIXME!!
     PEType _planeExists;
     // g4 content
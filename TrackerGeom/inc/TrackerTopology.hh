@@ -0,0 +1,77 @@
+#ifndef TrackerGeom_TrackerTopology_hh
+#define TrackerGeom_TrackerTopology_hh
+//
+// Precomputed relations between tracker elements, built once with the Tracker so that
+// per-event code doesn't have to search for them:
+//  - the straws electronically coupled to a straw: its nearest neighbors and the other straws on its preamp
+//  - the panels whose straws overlap a panel's in phi, ie that can form stereo pairs with it.  These are
+//    listed for every plane, in unique panel order; adjacent faces are those with uniqueFace 1 apart
+//  - the looser overlap used by delta-ray finding: panels of the same station whose directions are less
+//    than 120 degrees apart
+//  - the position in z of each panel's face within its station
+// Each list is a contiguous range of StrawIds.  Panels are represented by their straw 0.
+//
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Offline/DataProducts/inc/StrawId.hh"
+#include "Offline/TrackerGeom/inc/Panel.hh"
+#include "Offline/TrackerGeom/inc/Straw.hh"
+
+namespace mu2e {
+  class TrackerTopology {
+    public:
+      using TrackerStrawCollection = std::array<Straw,StrawId::_nustraws>;
+      using TrackerPanelCollection = std::array<Panel,StrawId::_nupanels>;
+      // read-only view of one list
+      class IdRange {
+        public:
+          IdRange(StrawId const* begin, StrawId const* end) : _begin(begin), _end(end) {}
+          StrawId const* begin() const { return _begin; }
+          StrawId const* end() const { return _end; }
+          size_t size() const { return _end - _begin; }
+          bool empty() const { return _begin == _end; }
+          StrawId const& operator [](size_t index) const { return _begin[index]; }
+        private:
+          StrawId const* _begin;
+          StrawId const* _end;
+      };
+
+      TrackerTopology() = default; // non-functional, as for the default Tracker
+      TrackerTopology(TrackerStrawCollection const& straws, TrackerPanelCollection const& panels);
+
+      // straws in the same panel next to this one
+      IdRange nearestNeighbors(StrawId const& sid) const { return _nearest.row(sid.uniqueStraw()); }
+      // other straws read out through the same preamp
+      IdRange preampNeighbors(StrawId const& sid) const { return _preamp.row(sid.uniqueStraw()); }
+      // panels (excluding this one) whose phi range overlaps this panel's
+      IdRange overlappingPanels(StrawId const& sid) const { return _overlap.row(sid.uniquePanel()); }
+      // angular width of a panel, from the longest straw
+      float panelPhiWidth() const { return _phiwidth; }
+      // do 2 panels of the same station point less than 120 degrees apart?
+      bool looseOverlap(StrawId const& sid, StrawId const& osid) const {
+        return (_looseOverlap[sid.uniquePanel()] >> stationPanel(osid)) & 1; }
+      // position of the panel's face in z within its station (0-3), as in CalPatRec ChannelID::orderID
+      unsigned orderedFace(StrawId const& sid) const { return _oface[sid.uniquePanel()]; }
+
+    private:
+      // compressed rows: row irow is _ids[_offsets[irow]] to _ids[_offsets[irow+1]]
+      struct Table {
+        std::vector<uint32_t> _offsets{0};
+        std::vector<StrawId> _ids;
+        void endRow() { _offsets.push_back(_ids.size()); }
+        IdRange row(size_t irow) const { return IdRange(_ids.data()+_offsets[irow],_ids.data()+_offsets[irow+1]); }
+      };
+      // index of a panel within its station
+      static unsigned stationPanel(StrawId const& sid) { return (sid.plane()%2)*StrawId::_npanels + sid.panel(); }
+      Table _nearest;
+      Table _preamp;
+      Table _overlap;
+      float _phiwidth = 0.0;
+      // per unique panel: bit stationPanel() of each loosely overlapping panel, and the ordered face
+      std::vector<uint16_t> _looseOverlap;
+      std::vector<uint8_t> _oface;
+  };
+}
+#endif
@@ -29,6 +29,7 @@ namespace mu2e {
         StrawId sid(plane,0,0);
         _planes[sid.plane()] = Plane(sid, _panels);
       }
+      _topology = TrackerTopology(_straws, _panels);
 
     }
 
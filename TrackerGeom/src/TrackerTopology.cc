@@ -0,0 +1,78 @@
+//
+// Precomputed relations between tracker elements
+//
+#include "Offline/TrackerGeom/inc/TrackerTopology.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace mu2e {
+
+  TrackerTopology::TrackerTopology(TrackerStrawCollection const& straws, TrackerPanelCollection const& panels) {
+    // straw relations, in unique straw order.  These are the same in every panel
+    for(uint16_t plane=0; plane < StrawId::_nplanes; plane++){
+      for(uint16_t panel = 0;panel < StrawId::_npanels; panel++){
+        for(uint16_t istraw=0; istraw < StrawId::_nstraws; istraw++){
+          StrawId sid(plane,panel,istraw);
+          for(uint16_t jstraw=0; jstraw < StrawId::_nstraws; jstraw++){
+            StrawId nid(plane,panel,jstraw);
+            if(nid != sid && sid.nearestNeighbor(nid)) _nearest._ids.push_back(nid);
+            if(nid != sid && sid.samePreamp(nid)) _preamp._ids.push_back(nid);
+          }
+          _nearest.endRow();
+          _preamp.endRow();
+        }
+      }
+    }
+    // panel phi overlaps.  Establish the extent of a panel using the longest straw (0)
+    Straw const& straw = straws[StrawId(0,0,0).uniqueStraw()];
+    float phi0 = (straw.getMidPoint()-straw.halfLength()*straw.getDirection()).phi();
+    float phi1 = (straw.getMidPoint()+straw.halfLength()*straw.getDirection()).phi();
+    _phiwidth = std::max(phi0,phi1) - std::min(phi0,phi1);
+    if (_phiwidth>M_PI) _phiwidth = 2*M_PI-_phiwidth;
+    for(uint16_t ipla = 0;ipla < StrawId::_nplanes; ++ipla) {
+      for(uint16_t ipan=0;ipan<StrawId::_npanels;++ipan){
+        StrawId sid(ipla,ipan,0);
+        float phi = straws[sid.uniqueStraw()].getMidPoint().phi();
+        for(uint16_t jpla = 0;jpla < StrawId::_nplanes; ++jpla) {
+          for(uint16_t jpan=0;jpan<StrawId::_npanels;++jpan){
+            StrawId osid(jpla,jpan,0);
+            if(osid == sid)continue;
+            float dphi = fabs(fmod(phi - straws[osid.uniqueStraw()].getMidPoint().phi(),2*M_PI));
+            if (dphi > M_PI) dphi = 2*M_PI-dphi;
+            if (dphi < _phiwidth) _overlap._ids.push_back(osid);
+          }
+        }
+        _overlap.endRow();
+      }
+    }
+    // loose panel overlaps within a station: the normals to the wires, n1.n2 >= cos(120 deg).  Panels exactly
+    // 120 deg apart are included whatever the rounding
+    _looseOverlap.assign(StrawId::_nupanels,0);
+    for(uint16_t ipla = 0;ipla < StrawId::_nplanes; ++ipla) {
+      for(uint16_t ipan=0;ipan<StrawId::_npanels;++ipan){
+        StrawId sid(ipla,ipan,0);
+        double phi = panels[sid.uniquePanel()].origin().phi();
+        uint16_t fpla = ipla - ipla%2; // first plane of the station
+        for(uint16_t jpla = fpla;jpla < fpla+2; ++jpla) {
+          for(uint16_t jpan=0;jpan<StrawId::_npanels;++jpan){
+            StrawId osid(jpla,jpan,0);
+            double ophi = panels[osid.uniquePanel()].origin().phi();
+            if(cos(phi-ophi) >= -0.5-1.e-6) _looseOverlap[sid.uniquePanel()] |= 1 << stationPanel(osid);
+          }
+        }
+      }
+    }
+    // ordered faces: in even stations the faces of plane 0 are reversed, in odd stations those of plane 1
+    _oface.resize(StrawId::_nupanels);
+    for(uint16_t ipla = 0;ipla < StrawId::_nplanes; ++ipla) {
+      for(uint16_t ipan=0;ipan<StrawId::_npanels;++ipan){
+        StrawId sid(ipla,ipan,0);
+        unsigned face = ipan%2;
+        if(sid.station()%2 == 0)
+          _oface[sid.uniquePanel()] = ipla%2 == 0 ? 1 - face : face + 2;
+        else
+          _oface[sid.uniquePanel()] = ipla%2 == 0 ? face : 3 - face;
+      }
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef TrackerMC_StrawClusterArena_hh
+#define TrackerMC_StrawClusterArena_hh
+//
+// StrawClusterArena holds the memory of the clust sequences of one event.  Allocation takes the next
+// free bytes of a large block and deallocation does nothing; reset() makes all the memory available
+// again once the event's sequences are destroyed.  The blocks are kept from one event to the next, so
+// once the arena has grown to the size of the largest event it no longer allocates from the heap.
+// An arena is not thread-safe: concurrent tasks need their own.
+//
+
+// C++ includes
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace mu2e {
+  namespace TrackerMC {
+    class StrawClusterArena : public std::pmr::memory_resource {
+      public:
+        explicit StrawClusterArena(size_t blocksize = 1 << 16);
+        StrawClusterArena(StrawClusterArena const&) = delete;
+        StrawClusterArena& operator =(StrawClusterArena const&) = delete;
+        // make all the blocks available again.  Everything allocated from the arena must have been destroyed
+        void reset();
+        // statistics since construction
+        size_t nAllocations() const { return _nalloc; } // allocation requests
+        size_t nBlocks() const { return _blocks.size(); } // heap allocations
+        size_t capacity() const { return _capacity; } // bytes held
+      private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+        struct Block {
+          std::unique_ptr<std::byte[]> _data;
+          size_t _size;
+        };
+        size_t _blocksize; // minimum block size
+        std::vector<Block> _blocks;
+        size_t _iblock; // block being filled
+        size_t _used; // bytes used in that block
+        size_t _nalloc;
+        size_t _capacity;
+    };
+  }
+}
+#endif
@@ -1,39 +1,51 @@
 #ifndef TrackerMC_StrawClusterSequence_hh
 #define TrackerMC_StrawClusterSequence_hh
 //
-// StrawClusterSequence is a time-ordered sequence of StrawClusters
+// StrawClusterSequence is a time-ordered sequence of StrawClusters, stored contiguously.
+// The storage comes from a memory resource, by default the heap; an event's sequences can share
+// a StrawClusterArena.  Clusts can be inserted in time order one by one, or appended in any order
+// and sorted once when the sequence is complete.
 //
 // Original author David Brown, LBNL
 //
 
 // C++ includes
 #include <iostream>
-#include <list>
+#include <memory_resource>
+#include <vector>
 // Mu2e includes
 #include "Offline/TrackerMC/inc/StrawCluster.hh"
 #include "Offline/DataProducts/inc/StrawId.hh"
 
 namespace mu2e {
   namespace TrackerMC {
-    typedef std::list<StrawCluster> StrawClusterList;
+    typedef std::pmr::vector<StrawCluster> StrawClusterList;
     class StrawClusterSequence {
       public:
         // constructors
         StrawClusterSequence();
         StrawClusterSequence(StrawCluster const& clust);
-        StrawClusterSequence(StrawId const& sid, StrawEnd end);
+        StrawClusterSequence(StrawId const& sid, StrawEnd end, std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+        // copies use the default resource
         StrawClusterSequence(StrawClusterSequence const& other);
         StrawClusterSequence& operator =(StrawClusterSequence const& other);
         // accessors: just hand over the list!
         StrawClusterList const& clustList() const { return _clist; }
-        // insert a new clust, in time order.
+        // insert a new clust, in time order.  This invalidates iterators to the sequence
         StrawClusterList::iterator insert(StrawCluster const& clust);
+        // append a new clust, ignoring the time order.  The sequence must be sorted before use
+        void append(StrawCluster const& clust);
+        // sort the appended clusts in time.  Equal times are placed as insert would have: the latest first
+        void sort();
+        bool sorted() const { return _nsorted == _clist.size(); }
         StrawId const& strawId() const { return _strawId; }
         StrawEnd const& strawEnd() const { return _end; }
       private:
+        void check(StrawCluster const& clust);
         StrawId _strawId;
         StrawEnd _end;
         StrawClusterList _clist; // time-ordered sequence of clusts
+        size_t _nsorted; // number of clusts in time order, the rest were appended since
     };
   }
 }
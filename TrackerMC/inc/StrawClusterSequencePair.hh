@@ -11,12 +11,14 @@ namespace mu2e {
       public:
         typedef StrawCluster StrawClusterPair[2];
         StrawClusterSequencePair();
-        StrawClusterSequencePair(StrawId sid);
+        StrawClusterSequencePair(StrawId sid, std::pmr::memory_resource* mr = std::pmr::get_default_resource());
         StrawClusterSequencePair(StrawClusterSequencePair const& other);
         StrawClusterSequencePair& operator =(StrawClusterSequencePair const& other);
         StrawClusterSequence& clustSequence(StrawEnd end) { return _scseq[end]; }
         StrawClusterSequence const& clustSequence(StrawEnd end) const { return _scseq[end]; }
         void insert(StrawClusterPair const& hpair);
+        // sort the clusts appended to either end
+        void sort();
         StrawId strawId() const { return _scseq[0].strawId(); }
       private:
         StrawClusterSequence _scseq[2];
@@ -5,6 +5,11 @@
 // a straw, over the time period of 1 microbunch.  It includes all physical and electronics
 // effects prior to digitization.
 //
+// The response of a clust is constant past the truncation of the electronics response, so the
+// constant parts are summed once at construction and a sample only evaluates the clusts inside
+// the shaping window.  The sums are done in clust order, so the voltages are identical to
+// summing the response of every clust.
+//
 // Original author David Brown, LBNL
 //
 
@@ -40,8 +45,9 @@ namespace mu2e {
     struct WFX;
     class StrawWaveform{
       public:
-        // construct from a clust sequence and response object.  Scale affects the voltage
-        StrawWaveform(Straw const& straw, StrawClusterSequence const& hseqq, XTalk const& xtalk);
+        // construct from a clust sequence and response object.  Scale affects the voltage.
+        // The electronics must be the same as used to sample the waveform
+        StrawWaveform(Straw const& straw, StrawClusterSequence const& hseqq, XTalk const& xtalk, StrawElectronics const& strawele);
         // disallow copy and assignment
         StrawWaveform() = delete; // don't allow default constructor, references can't be assigned empty
         StrawWaveform(StrawWaveform const& other);
@@ -51,6 +57,8 @@ namespace mu2e {
         bool crossesThreshold(StrawElectronics const& strawele, double threshold,WFX& wfx) const;
         // sample the waveform at a given time, no saturation included.  Return value is in units of volts
         double sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time) const;
+        // same, for ntimes times in increasing order
+        void sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double const* times, size_t ntimes, double* volts) const;
         // sample the waveform at a series of points allowing saturation to occur after preamp stage
         // FIXME no cross talk yet
         void sampleADCWaveform(StrawElectronics const& strawele,TrkTypes::ADCTimes const& times,TrkTypes::ADCVoltages& volts) const;
@@ -61,15 +69,30 @@ namespace mu2e {
         StrawEnd const& strawEnd() const { return _cseq.strawEnd(); }
         Straw const& straw() const { return _straw;}
       private:
+        // clust terms which don't depend on the sampling time
+        struct ClustTerms {
+          StrawElectronics::ChargeResponse _cresp;
+          double _tstart; // time from which the clust contributes
+          double _ttail; // time from which the response of this and all earlier clusts is constant
+          double _tmax; // time of the maximum threshold response, relative to the clust
+          double _linmax; // maximum threshold response, including x-talk
+        };
         // clust sequence used in this waveform
         StrawClusterSequence const& _cseq;
         XTalk _xtalk; // X-talk applied to all voltages
         Straw const& _straw;
+        std::vector<ClustTerms> _terms; // in clust order
+        std::array<std::vector<double>,StrawElectronics::npaths> _tailsum; // sum of the constant responses of the first n clusts
+        double _maxresp; // sum of the maximum responses of all clusts
         // helper functions
         void returnCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const;
         bool roughCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const;
         bool fineCrossing(StrawElectronics const& strawele, double threshold, double vmax, WFX& wfx) const;
-        double maxLinearResponse(StrawElectronics const& strawele,StrawClusterList::const_iterator const& iclust) const;
+        ClustTerms const& terms(StrawClusterList::const_iterator const& iclust) const { return _terms[iclust-_cseq.clustList().begin()]; }
+        // number of leading clusts with constant response at this time
+        size_t nTail(double time) const;
+        // number of leading clusts contributing at this time
+        size_t nActive(double time) const;
     };
 
     struct WFX { // waveform crossing
@@ -0,0 +1,43 @@
+//
+// StrawClusterArena: block memory of the clust sequences of one event
+//
+// mu2e includes
+#include "Offline/TrackerMC/inc/StrawClusterArena.hh"
+#include <algorithm>
+
+namespace mu2e {
+  namespace TrackerMC {
+    StrawClusterArena::StrawClusterArena(size_t blocksize) :
+      _blocksize(blocksize), _iblock(0), _used(0), _nalloc(0), _capacity(0)
+    {}
+
+    void StrawClusterArena::reset() {
+      _iblock = 0;
+      _used = 0;
+    }
+
+    void* StrawClusterArena::do_allocate(size_t bytes, size_t alignment) {
+      ++_nalloc;
+      // take the space from the first block, starting from the current one, that has enough left
+      for(;_iblock < _blocks.size(); ++_iblock, _used = 0){
+        Block& block = _blocks[_iblock];
+        void* ptr = block._data.get() + _used;
+        size_t space = block._size - _used;
+        if(std::align(alignment,bytes,ptr,space) != nullptr){
+          _used = block._size - space + bytes;
+          return ptr;
+        }
+      }
+      // none left: add a block, large enough for this request whatever its alignment
+      size_t size = std::max(_blocksize,bytes+alignment);
+      _blocks.push_back(Block{std::make_unique<std::byte[]>(size),size});
+      _capacity += size;
+      _iblock = _blocks.size()-1;
+      void* ptr = _blocks.back()._data.get();
+      size_t space = size;
+      std::align(alignment,bytes,ptr,space);
+      _used = size - space + bytes;
+      return ptr;
+    }
+  }
+}
@@ -6,43 +6,44 @@
 // mu2e includes
 #include "Offline/TrackerMC/inc/StrawClusterSequence.hh"
 #include "cetlib_except/exception.h"
+#include <algorithm>
+#include <utility>
 
 using namespace std;
 
 namespace mu2e {
   namespace TrackerMC {
-    StrawClusterSequence::StrawClusterSequence() : _strawId(0), _end(StrawEnd::cal)
+    StrawClusterSequence::StrawClusterSequence() : _strawId(0), _end(StrawEnd::cal), _nsorted(0)
     {}
 
     StrawClusterSequence::StrawClusterSequence(StrawCluster const& clust) :
-      _strawId(clust.strawId()), _end(clust.strawEnd())
+      _strawId(clust.strawId()), _end(clust.strawEnd()), _nsorted(0)
     {
       insert(clust);
     }
 
-    StrawClusterSequence::StrawClusterSequence(StrawId const& sid, StrawEnd end) :
-      _strawId(sid), _end(end)
+    StrawClusterSequence::StrawClusterSequence(StrawId const& sid, StrawEnd end, std::pmr::memory_resource* mr) :
+      _strawId(sid), _end(end), _clist(mr), _nsorted(0)
     {}
 
     StrawClusterSequence::StrawClusterSequence(StrawClusterSequence const& other) :
-      _strawId(other._strawId), _end(other._end), _clist(other._clist) {}
+      _strawId(other._strawId), _end(other._end), _clist(other._clist), _nsorted(other._nsorted) {}
 
     StrawClusterSequence& StrawClusterSequence::operator =(StrawClusterSequence const& other) {
       if(&other != this){
         _strawId = other._strawId;
         _end = other._end;
         _clist = other._clist;
+        _nsorted = other._nsorted;
       }
       return *this;
     }
-    // insert a new clust.  This is the only non-trivial function
-    StrawClusterList::iterator StrawClusterSequence::insert(StrawCluster const& clust) {
-      StrawClusterList::iterator retval = _clist.end();
+
+    void StrawClusterSequence::check(StrawCluster const& clust) {
       if(clust.type() == StrawCluster::unknown){
         throw cet::exception("SIM")
           << "mu2e::StrawClusterSequence: tried to add unknown clust type"
           << endl;
-        return retval;
       }
       // make sure the straw and end are the same
       if(!_clist.empty() && (clust.strawId() != strawId()
@@ -50,21 +51,50 @@ namespace mu2e {
         throw cet::exception("SIM")
           << "mu2e::StrawClusterSequence: tried to add clust from a different straw/end to a sequence"
           << endl;
-        return retval;
       }
       if(_clist.empty()){
-        _clist.push_front(clust);
         _strawId = clust.strawId();
         _end = clust.strawEnd();
-        retval = _clist.begin();
-      } else {
-        // loop over the contents and insert in the correct place
-        StrawClusterList::iterator ibefore = _clist.begin();
-        while(ibefore != _clist.end() && ibefore->time() < clust.time())
-          ++ibefore;
-        retval = _clist.insert(ibefore,clust);
       }
+    }
+
+    // insert a new clust.  This is the only non-trivial function
+    StrawClusterList::iterator StrawClusterSequence::insert(StrawCluster const& clust) {
+      check(clust);
+      sort();
+      // insert before the first clust which is not earlier
+      StrawClusterList::iterator ibefore = std::lower_bound(_clist.begin(),_clist.end(),clust,
+          [](StrawCluster const& a, StrawCluster const& b){ return a.time() < b.time(); });
+      auto retval = _clist.insert(ibefore,clust);
+      _nsorted = _clist.size();
       return retval;
     }
+
+    void StrawClusterSequence::append(StrawCluster const& clust) {
+      check(clust);
+      _clist.push_back(clust);
+    }
+
+    void StrawClusterSequence::sort() {
+      size_t nclust = _clist.size();
+      if(_nsorted == nclust)return;
+      // sort on (time, rank).  The rank orders equal times as insert would have: the appended clusts
+      // latest first, then the clusts already in sequence
+      size_t nappend = nclust - _nsorted;
+      std::pmr::polymorphic_allocator<std::byte> alloc(_clist.get_allocator());
+      std::pmr::vector<std::pair<float,size_t>> keys(alloc);
+      keys.reserve(nclust);
+      for(size_t iclust=0; iclust < nclust; ++iclust){
+        size_t rank = iclust < _nsorted ? nappend + iclust : nclust - 1 - iclust;
+        keys.emplace_back(static_cast<float>(_clist[iclust].time()),rank);
+      }
+      std::sort(keys.begin(),keys.end());
+      StrawClusterList sorted(alloc);
+      sorted.reserve(nclust);
+      for(auto const& key : keys)
+        sorted.push_back(_clist[key.second < nappend ? nclust - 1 - key.second : key.second - nappend]);
+      _clist.swap(sorted);
+      _nsorted = nclust;
+    }
   }
 }
@@ -10,8 +10,8 @@
 namespace mu2e {
   namespace TrackerMC {
     StrawClusterSequencePair::StrawClusterSequencePair() {}
-    StrawClusterSequencePair::StrawClusterSequencePair(StrawId sid) :
-      _scseq{StrawClusterSequence(sid,StrawEnd::cal),StrawClusterSequence(sid,StrawEnd::hv)}
+    StrawClusterSequencePair::StrawClusterSequencePair(StrawId sid, std::pmr::memory_resource* mr) :
+      _scseq{StrawClusterSequence(sid,StrawEnd::cal,mr),StrawClusterSequence(sid,StrawEnd::hv,mr)}
     {}
 
     StrawClusterSequencePair::StrawClusterSequencePair(StrawClusterSequencePair const& other)
@@ -40,5 +40,10 @@ namespace mu2e {
       _scseq[StrawEnd::cal].insert(hpair[StrawEnd::cal]);
       _scseq[StrawEnd::hv].insert(hpair[StrawEnd::hv]);
     }
+
+    void StrawClusterSequencePair::sort() {
+      _scseq[StrawEnd::cal].sort();
+      _scseq[StrawEnd::hv].sort();
+    }
   }
 }
@@ -0,0 +1,90 @@
+//
+// Compare the StrawDigis, ADC waveforms and StrawDigiMCs of 2 digitizations of the same events, for instance
+// StrawDigisFromStrawGasSteps with concurrent and serial panel digitization.  The job fails on the first difference.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/MCDataProducts/inc/StrawDigiMC.hh"
+#include "Offline/RecoDataProducts/inc/StrawDigi.hh"
+
+#include <iostream>
+
+namespace mu2e {
+  namespace TrackerMC {
+
+    class StrawDigiCompare : public art::EDAnalyzer {
+      public:
+        struct Config {
+          using Name = fhicl::Name;
+          using Comment = fhicl::Comment;
+          fhicl::Atom<art::InputTag> reference{Name("Reference"), Comment("Reference StrawDigi producer")};
+          fhicl::Atom<art::InputTag> test{Name("Test"), Comment("StrawDigi producer compared to the reference")};
+        };
+        typedef art::EDAnalyzer::Table<Config> Parameters;
+
+        explicit StrawDigiCompare(const Parameters& conf);
+
+        void analyze(const art::Event& event) override;
+        void endJob() override;
+
+      private:
+        art::InputTag ref_, test_;
+        size_t nevents_ = 0;
+        size_t ndigis_ = 0;
+    };
+
+    StrawDigiCompare::StrawDigiCompare(const Parameters& conf) :
+      art::EDAnalyzer(conf),
+      ref_(conf().reference()),
+      test_(conf().test()) {
+        consumes<StrawDigiCollection>(ref_);
+        consumes<StrawDigiADCWaveformCollection>(ref_);
+        consumes<StrawDigiMCCollection>(ref_);
+        consumes<StrawDigiCollection>(test_);
+        consumes<StrawDigiADCWaveformCollection>(test_);
+        consumes<StrawDigiMCCollection>(test_);
+      }
+
+    void StrawDigiCompare::analyze(const art::Event& event) {
+      auto const& digis = *event.getValidHandle<StrawDigiCollection>(ref_);
+      auto const& adcs = *event.getValidHandle<StrawDigiADCWaveformCollection>(ref_);
+      auto const& mcdigis = *event.getValidHandle<StrawDigiMCCollection>(ref_);
+      auto const& tdigis = *event.getValidHandle<StrawDigiCollection>(test_);
+      auto const& tadcs = *event.getValidHandle<StrawDigiADCWaveformCollection>(test_);
+      auto const& tmcdigis = *event.getValidHandle<StrawDigiMCCollection>(test_);
+      if(digis.size() != tdigis.size() || adcs.size() != tadcs.size() || mcdigis.size() != tmcdigis.size())
+        throw cet::exception("StrawDigiCompare") << event.id() << ": " << ref_ << " has " << digis.size() << " digis, "
+          << test_ << " has " << tdigis.size() << std::endl;
+      for(size_t idigi=0; idigi < digis.size(); ++idigi){
+        auto const& digi = digis[idigi];
+        auto const& tdigi = tdigis[idigi];
+        auto const& mc = mcdigis[idigi];
+        auto const& tmc = tmcdigis[idigi];
+        bool same = digi.strawId() == tdigi.strawId() && digi.TDC() == tdigi.TDC() && digi.TOT() == tdigi.TOT()
+          && digi.PMP() == tdigi.PMP() && adcs[idigi].samples() == tadcs[idigi].samples()
+          && mc.strawId() == tmc.strawId() && mc.strawGasSteps() == tmc.strawGasSteps();
+        for(size_t iend=0; iend < StrawEnd::nends; ++iend){
+          StrawEnd end(static_cast<StrawEnd::End>(iend));
+          same &= mc.wireEndTime(end) == tmc.wireEndTime(end) && mc.clusterTime(end) == tmc.clusterTime(end);
+        }
+        if(!same)
+          throw cet::exception("StrawDigiCompare") << event.id() << ": digi " << idigi << " on straw " << digi.strawId()
+            << " differs between " << ref_ << " and " << test_ << std::endl;
+      }
+      ++nevents_;
+      ndigis_ += digis.size();
+    }
+
+    void StrawDigiCompare::endJob() {
+      std::cout << "StrawDigiCompare: " << ref_ << " and " << test_ << " agree on " << ndigis_ << " digis in "
+        << nevents_ << " events" << std::endl;
+    }
+  }
+}
+
+using mu2e::TrackerMC::StrawDigiCompare;
+DEFINE_ART_MODULE(StrawDigiCompare)
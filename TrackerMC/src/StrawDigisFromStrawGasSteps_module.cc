@@ -1,6 +1,9 @@
 //
 // module to convert G4 steps into straw digis.
 // It also builds the truth match
+// The panels of an event are digitized independently, each with its own random engine seeded
+// from the event and panel IDs, so they can be digitized concurrently.  The clusts of a panel are
+// kept in an arena which is reused from one event to the next.
 //
 // Original author David Brown, LBNL
 //
@@ -40,6 +43,7 @@
 #include "Offline/MCDataProducts/inc/StrawDigiMC.hh"
 #include "Offline/MCDataProducts/inc/SimParticle.hh"
 // temporary MC structures
+#include "Offline/TrackerMC/inc/StrawClusterArena.hh"
 #include "Offline/TrackerMC/inc/StrawClusterSequencePair.hh"
 #include "Offline/TrackerMC/inc/StrawWaveform.hh"
 #include "Offline/TrackerMC/inc/IonCluster.hh"
@@ -47,9 +51,9 @@
 #include <Offline/TrackerMC/inc/StrawDigiBundle.hh>
 #include <Offline/TrackerMC/inc/StrawDigiBundleCollection.hh>
 //CLHEP
+#include "CLHEP/Random/MixMaxRng.h"
 #include "CLHEP/Random/RandGaussQ.h"
 #include "CLHEP/Random/RandFlat.h"
-#include "CLHEP/Random/RandExponential.h"
 #include "CLHEP/Random/RandPoisson.h"
 #include "CLHEP/Vector/LorentzVector.h"
 // root
@@ -59,12 +63,16 @@
 #include "TGraph.h"
 #include "TMarker.h"
 #include "TTree.h"
+// TBB
+#include "tbb/parallel_for.h"
 // C++
 #include <map>
 #include <algorithm>
 #include <array>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <memory_resource>
 using namespace std;
 using CLHEP::Hep3Vector;
 using EventIDCollection = std::vector<art::EventID>;
@@ -122,16 +130,40 @@ namespace mu2e {
           fhicl::Atom<art::InputTag> mixedDigisTag { Name("MixedDigisTag"), Comment("Source of digis to overlay event onto"), ""};
           fhicl::Atom<bool> mixDigiMCs { Name("MixDigiMCs"), Comment("Propagate mixed StrawDigiMCs through module"), false};
           fhicl::Atom<bool> allowEmptySteps { Name("AllowEmptyStrawGasSteps"), Comment("Allow digitization to proceed even without any valid straw gas step collections"), false};
+          fhicl::Atom<bool> concurrentPanels { Name("ConcurrentPanels"), Comment("Digitize the panels of an event concurrently.  Always serial when diagLevel > 0"), true};
         };
 
         typedef art::Ptr<StrawGasStep> SGSPtr;
         typedef art::Ptr<SimParticle> SPPtr;
-        typedef map<StrawId,StrawClusterSequencePair> StrawClusterMap;  // clusts by straw
+        typedef std::pmr::map<StrawId,StrawClusterSequencePair> StrawClusterMap;  // clusts by straw
         // work with pairs of waveforms, one for each straw end
         typedef std::array<StrawWaveform,2> SWFP;
         typedef std::array<WFX,2> WFXP;
         typedef list<WFXP> WFXPList;
         typedef WFXPList::const_iterator WFXPI;
+        typedef array<vector<SGSPtr>,StrawId::_nupanels> PanelSteps; // steps by unique panel
+
+        // digitization state of 1 panel.  Each panel draws from its own engine, seeded from the event ID,
+        // the module seed and the panel, so the digis don't depend on the order panels are digitized in.
+        // The clusts and the clust map are allocated from the panel's arena, reset after each event
+        struct PanelTask {
+          explicit PanelTask(uint16_t panel);
+          // prepare for a new event
+          void reset(art::EventID const& eid, SeedService::seed_t seed);
+          uint16_t _panel;
+          CLHEP::MixMaxRng _engine;
+          CLHEP::RandGaussQ _randgauss;
+          CLHEP::RandFlat _randflat;
+          CLHEP::RandPoisson _randP;
+          double _ewMarkerROCdt; // event window marker jitter of this panel's ROC
+          vector<IonCluster> _clusters; // scratch space for dividing steps
+          StrawClusterArena _arena;
+          StrawClusterMap _hmap; // clusts by straw, in the arena
+          // output
+          StrawDigiCollection _digis;
+          StrawDigiADCWaveformCollection _digiadcs;
+          StrawDigiMCCollection _mcdigis;
+        };
 
         using Parameters = art::EDProducer::Table<Config>;
         explicit StrawDigisFromStrawGasSteps(const Parameters& config);
@@ -142,6 +174,7 @@ namespace mu2e {
         void beginJob() override;
         void beginRun(art::Run& run) override;
         void produce(art::Event& e) override;
+        void endJob() override;
 
         // Diagnostics
         int _debug, _diag, _printLevel;
@@ -168,16 +201,15 @@ namespace mu2e {
         unsigned _maxnclu;
         StrawElectronics::Path _diagpath;
         bool _usestatus;
-        // Random number distributions
-        art::RandomNumberGenerator::base_engine_t& _engine;
-        CLHEP::RandGaussQ _randgauss;
-        CLHEP::RandFlat _randflat;
-        CLHEP::RandExponential _randexp;
-        CLHEP::RandPoisson _randP;
+        bool _concurrentPanels;
+        // salt of the panel random engines
+        SeedService::seed_t _seed;
+        array<unique_ptr<PanelTask>,StrawId::_nupanels> _panelTasks;
         // A category for the error logger.
         const string _messageCategory;
         // Give some informationation messages only on the first event.
         bool _firstEvent;
+        unsigned _nevents = 0;
         // digi mixing
         const art::InputTag _mixedDigisTag;
         const bool _mixDigiMCs;
@@ -225,50 +257,55 @@ namespace mu2e {
         Int_t _nclust, _netot, _partPDG, _stype;
         vector<IonCluster> _clusters;
         Float_t _pbtimemc;
-        array<Float_t, StrawId::_nupanels> _ewMarkerROCdt;
         double _eventWindowLength;
         TDCValue _eventWindowEndTDC;
         bool _onSpill;
         double _digitizationEndFromMarker;
 
-        //  helper functions
-        void fillClusterMap(StrawPhysics const& strawphys,
+        //  helper functions.  Those taking a PanelTask are called concurrently for different panels:
+        //  they must only change module members when _diag > 0, which forces serial digitization
+        void collectSteps(art::Event const& event, PanelSteps& panelsteps);
+        void digitizePanel(PanelTask& task,
+            StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
-            art::Event const& event, StrawClusterMap & hmap);
-        void addStep(StrawPhysics const& strawphys,
+            vector<SGSPtr> const& steps);
+        void addStep(PanelTask& task,
+            StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
             Straw const& straw,
             SGSPtr const& sgsptr,
             StrawClusterSequencePair& shsp);
-        void divideStep(StrawPhysics const& strawphys,
+        void divideStep(PanelTask& task,
+            StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
             Straw const& straw,
             StrawGasStep const& step,
             vector<IonCluster>& clusters);
-        void driftCluster(StrawPhysics const& strawphys, Straw const& straw,
+        void driftCluster(PanelTask& task,
+            StrawPhysics const& strawphys, Straw const& straw,
             IonCluster const& cluster, WireCharge& wireq);
         void propagateCharge(StrawPhysics const& strawphys, Straw const& straw,
             WireCharge const& wireq, StrawEnd end, WireEndCharge& weq);
         double microbunchTime(StrawElectronics const& strawele, double globaltime) const;
         void addGhosts(StrawElectronics const& strawele, StrawCluster const& clust,StrawClusterSequence& shs);
         void addNoise(StrawClusterMap& hmap);
-        void findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings);
-        void createDigis(StrawPhysics const& strawphys,
+        void findThresholdCrossings(PanelTask& task, StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings);
+        void createDigis(PanelTask& task,
+            StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
             Straw const& straw,
             StrawClusterSequencePair const& hsp,
-            XTalk const& xtalk,
-            StrawDigiCollection* digis, StrawDigiADCWaveformCollection* digiadcs, StrawDigiMCCollection* mcdigis);
-        void fillDigis(StrawPhysics const& strawphys,
+            XTalk const& xtalk);
+        void fillDigis(PanelTask& task,
+            StrawPhysics const& strawphys,
             StrawElectronics const& strawele,
-            WFXPList const& xings,SWFP const& swfp , StrawId sid,
-            StrawDigiCollection* digis, StrawDigiADCWaveformCollection* digiadcs, StrawDigiMCCollection* mcdigis);
-        bool createDigi(StrawElectronics const& strawele,WFXP const& xpair, SWFP const& wf, StrawId sid, StrawDigiCollection* digis,
-            StrawDigiADCWaveformCollection* digiadcs, double &digitization_ready_time);
+            WFXPList const& xings,SWFP const& swfp , StrawId sid);
+        bool createDigi(PanelTask& task, StrawElectronics const& strawele,WFXP const& xpair, SWFP const& wf, StrawId sid,
+            double &digitization_ready_time);
         void findCrossTalkStraws(Straw const& straw,vector<XTalk>& xtalk);
-        void fillClusterNe(StrawPhysics const& strawphys,std::vector<unsigned>& me);
-        void fillClusterPositions(StrawGasStep const& step, Straw const& straw, std::vector<StrawCoordinates>& cpos);
-        void fillClusterMinion(StrawPhysics const& strawphys, StrawGasStep const& step, std::vector<unsigned>& me, std::vector<float>& cen);
+        void fillClusterNe(PanelTask& task, StrawPhysics const& strawphys,std::vector<unsigned>& me);
+        void fillClusterPositions(PanelTask& task, StrawGasStep const& step, Straw const& straw, std::vector<StrawCoordinates>& cpos);
+        void fillClusterMinion(PanelTask& task, StrawPhysics const& strawphys, StrawGasStep const& step, std::vector<unsigned>& me, std::vector<float>& cen);
         bool readAll(StrawId const& sid) const;
         // diagnostic functions
         void waveformHist(StrawElectronics const& strawele,
@@ -276,7 +313,7 @@ namespace mu2e {
         void waveformDiag(StrawElectronics const& strawele,
             SWFP const& wf, WFXPList const& xings);
         void digiDiag(StrawPhysics const& strawphys, SWFP const& wf, WFXP const& xpair, StrawDigi const& digi, StrawDigiADCWaveform const& digiadc, StrawDigiMC const& mcdigi);
-        void stepDiag(StrawPhysics const& strawphys, StrawElectronics const& strawele, StrawGasStep const& sgs);
+        void stepDiag(StrawPhysics const& strawphys, StrawElectronics const& strawele, StrawGasStep const& sgs, vector<IonCluster> const& clusters);
         StrawCoordinates strawCoordinates(XYZVectorF const& cpos, Straw const& straw) const;
         XYZVectorF strawCoordinatesToXYZ(StrawCoordinates const& cpos, Straw const& straw) const;
     };
@@ -309,12 +346,8 @@ namespace mu2e {
       _maxnclu(config().maxnclu()),
       _diagpath(static_cast<StrawElectronics::Path>(config().diagpath())),
       _usestatus(config().usestatus()),
-      // Random number distributions
-      _engine(createEngine( art::ServiceHandle<SeedService>()->getSeed())),
-      _randgauss( _engine ),
-      _randflat( _engine ),
-      _randexp( _engine),
-      _randP( _engine),
+      _concurrentPanels(config().concurrentPanels()),
+      _seed(art::ServiceHandle<SeedService>()->getSeed()),
       _messageCategory("HITS"),
       _firstEvent(true),      // Control some information messages.
       _mixedDigisTag(config().mixedDigisTag()),
@@ -337,8 +370,37 @@ namespace mu2e {
         produces<StrawDigiCollection>();
         produces<StrawDigiADCWaveformCollection>();
         produces<StrawDigiMCCollection>();
+        for(uint16_t ipanel=0;ipanel < StrawId::_nupanels; ++ipanel)
+          _panelTasks[ipanel] = make_unique<PanelTask>(ipanel);
       }
 
+    StrawDigisFromStrawGasSteps::PanelTask::PanelTask(uint16_t panel) :
+      _panel(panel),
+      _randgauss(_engine),
+      _randflat(_engine),
+      _randP(_engine),
+      _ewMarkerROCdt(0.0),
+      _hmap(&_arena)
+    {}
+
+    void StrawDigisFromStrawGasSteps::PanelTask::reset(art::EventID const& eid, SeedService::seed_t seed) {
+      // MixMaxRng takes at most 4 (32-bit) seeds, so the panel shares one with the module seed.  They are combined
+      // with the murmur3 finalizer, a bijection of 32-bit values: for a given module seed each panel gets its own
+      // stream, and nearby module seeds don't give overlapping sets of panel seeds
+      uint32_t pseed = static_cast<uint32_t>(seed) + 0x9e3779b9u*(uint32_t(_panel)+1);
+      pseed ^= pseed >> 16;
+      pseed *= 0x85ebca6bu;
+      pseed ^= pseed >> 13;
+      pseed *= 0xc2b2ae35u;
+      pseed ^= pseed >> 16;
+      const std::array<long,4> seeds{ static_cast<long>(eid.run()), static_cast<long>(eid.subRun()),
+        static_cast<long>(eid.event()), static_cast<long>(pseed)};
+      _engine.setSeeds(seeds.data(),seeds.size());
+      _digis.clear();
+      _digiadcs.clear();
+      _mcdigis.clear();
+    }
+
     void StrawDigisFromStrawGasSteps::beginJob(){
 
       if(_diag > 0){
@@ -444,6 +506,21 @@ namespace mu2e {
       }
     }
 
+    void StrawDigisFromStrawGasSteps::endJob(){
+      if ( _printLevel > 0 ) {
+        // heap use of the clust storage: the arenas only allocate while they grow to the largest event
+        size_t nalloc(0), nblocks(0), capacity(0);
+        for(auto const& task : _panelTasks){
+          if(!task)continue;
+          nalloc += task->_arena.nAllocations();
+          nblocks += task->_arena.nBlocks();
+          capacity += task->_arena.capacity();
+        }
+        cout << "StrawDigisFromStrawGasSteps: " << _nevents << " events, " << nalloc << " clust allocations from the panel arenas, "
+          << nblocks << " heap allocations, " << capacity/1024 << " kB held" << endl;
+      }
+    }
+
     void StrawDigisFromStrawGasSteps::beginRun( art::Run& run ){
       const Tracker& tracker = *GeomHandle<Tracker>();
       _rstraw = tracker.strawProperties()._strawInnerRadius;
@@ -457,6 +534,7 @@ namespace mu2e {
       if ( _printLevel > 1 ) cout << "StrawDigisFromStrawGasSteps: produce() begin; event " << event.id().event() << endl;
       static int ncalls(0);
       ++ncalls;
+      ++_nevents;
 
       // initialize "global" collection of digis
       StrawDigiBundleCollection bundles;
@@ -511,31 +589,84 @@ namespace mu2e {
       event.getByLabel(_pbtmcTag, pbtmcHandle);
       const ProtonBunchTimeMC& pbtmc(*pbtmcHandle);
       _pbtimemc = pbtmc.pbtime_;
-      // calculate event window marker jitter for this microbunch for each panel
-      for (size_t i=0;i<StrawId::_nupanels;i++){
-        _ewMarkerROCdt.at(i) = _randgauss.fire(0,strawele.eventWindowMarkerROCJitter());
-      }
       // make the microbunch buffer long enough to get the full waveform
       _mbbuffer = (strawele.nADCSamples() - strawele.nADCPreSamples())*strawele.adcPeriod();
       _adcbuffer = 0.01*strawele.adcPeriod();
-      // Containers to hold the output information.
+      // sort the steps from the event by panel
+      PanelSteps panelsteps;
+      collectSteps(event,panelsteps);
+      vector<uint16_t> panels;
+      for(uint16_t ipanel=0;ipanel < StrawId::_nupanels; ++ipanel)
+        if(!panelsteps[ipanel].empty())panels.push_back(ipanel);
+      // digitize each panel with steps.  Cross-talk stays within a panel, so the panels are independent
+      art::EventID const& eid = event.id();
+      auto digitizeone = [&](size_t itask) {
+        PanelTask& task = *_panelTasks[panels[itask]];
+        task.reset(eid,_seed);
+        digitizePanel(task,strawphys,strawele,panelsteps[panels[itask]]);
+      };
+      // the diagnostics fill module members, so need serial digitization
+      if(_concurrentPanels && _diag == 0)
+        tbb::parallel_for(size_t(0),panels.size(),digitizeone);
+      else
+        for(size_t itask=0;itask < panels.size(); ++itask)digitizeone(itask);
+      // Containers to hold the output information, filled in panel (and so straw) order.
       unique_ptr<StrawDigiCollection> digis(new StrawDigiCollection);
       unique_ptr<StrawDigiADCWaveformCollection> digiadcs(new StrawDigiADCWaveformCollection);
       unique_ptr<StrawDigiMCCollection> mcdigis(new StrawDigiMCCollection);
-      // create the StrawCluster map
+      for(auto ipanel : panels){
+        PanelTask const& task = *_panelTasks[ipanel];
+        digis->insert(digis->end(),task._digis.begin(),task._digis.end());
+        digiadcs->insert(digiadcs->end(),task._digiadcs.begin(),task._digiadcs.end());
+        mcdigis->insert(mcdigis->end(),task._mcdigis.begin(),task._mcdigis.end());
+      }
+      // bundle up new digis in global collection
+      bundles.Append(*digis, *digiadcs, *mcdigis);
+
+      // resolve collisions between any preexisting and new digis
+      StrawDigiBundleCollection resolved;
+      bundles.ResolveCollisions(strawele, resolved);
+      digis = resolved.GetStrawDigiPtrs();
+      digiadcs = resolved.GetStrawDigiADCWaveformPtrs();
+      mcdigis = resolved.GetStrawDigiMCPtrs();
+
+      // store the digis in the event
+      event.put(move(digis));
+      event.put(move(digiadcs));
+      // store MC truth match
+      event.put(move(mcdigis));
+      if ( _printLevel > 1 ) cout << "StrawDigisFromStrawGasSteps: produce() end" << endl;
+      // Done with the first event; disable some messages.
+      _firstEvent = false;
+
+    } // end produce
+
+    void StrawDigisFromStrawGasSteps::digitizePanel(PanelTask& task,
+        StrawPhysics const& strawphys,
+        StrawElectronics const& strawele,
+        vector<SGSPtr> const& steps) {
+      // calculate event window marker jitter for this microbunch for this panel
+      task._ewMarkerROCdt = task._randgauss.fire(0,strawele.eventWindowMarkerROCJitter());
+      // create the StrawCluster map of this panel
       // this is a map from straw ids to a list of all clusters on that straw from this event
-      StrawClusterMap hmap;
-      // fill this from the event
-      fillClusterMap(strawphys,strawele,event,hmap);
+      for(auto const& sgsptr : steps){
+        StrawId const& sid = sgsptr->strawId();
+        Straw const& straw = _tracker->getStraw(sid);
+        // create a clust from this step, and add it to the clust map
+        auto ihsp = task._hmap.try_emplace(sid,sid,&task._arena).first;
+        addStep(task,strawphys,strawele,straw,sgsptr,ihsp->second);
+      }
       // add noise clusts
-      if(_addNoise)addNoise(hmap);
+      if(_addNoise)addNoise(task._hmap);
+      // the clusts were appended: put them in time order
+      for(auto& ihsp : task._hmap) ihsp.second.sort();
       // loop over the clust sequences (i.e. loop over straws, and for each get their list of clusters)
-      for(auto ihsp=hmap.begin();ihsp!= hmap.end();++ihsp){
+      for(auto ihsp=task._hmap.begin();ihsp!= task._hmap.end();++ihsp){
         StrawClusterSequencePair const& hsp = ihsp->second;
         Straw const& straw = _tracker->getStraw(hsp.strawId());
         // create primary digis from this clust sequence
         XTalk self(hsp.strawId()); // this object represents the straws coupling to itself, ie 100%
-        createDigis(strawphys,strawele,straw,hsp,self,digis.get(),digiadcs.get(),mcdigis.get());
+        createDigis(task,strawphys,strawele,straw,hsp,self);
         // if we're applying x-talk, look for nearby coupled straws
         if(_addXtalk) {
           // only apply if the charge is above a threshold
@@ -547,54 +678,34 @@ namespace mu2e {
             vector<XTalk> xtalk;
             findCrossTalkStraws(straw,xtalk);
             for(auto ixtalk=xtalk.begin();ixtalk!=xtalk.end();++ixtalk){
-              createDigis(strawphys,strawele,straw,hsp,*ixtalk,digis.get(),digiadcs.get(),mcdigis.get());
+              createDigis(task,strawphys,strawele,straw,hsp,*ixtalk);
             }
           }
         }
       }
-      // bundle up new digis in global collection
-      bundles.Append(*digis, *digiadcs, *mcdigis);
-
-      // resolve collisions between any preexisting and new digis
-      StrawDigiBundleCollection resolved;
-      bundles.ResolveCollisions(strawele, resolved);
-      digis = resolved.GetStrawDigiPtrs();
-      digiadcs = resolved.GetStrawDigiADCWaveformPtrs();
-      mcdigis = resolved.GetStrawDigiMCPtrs();
-
-      // store the digis in the event
-      event.put(move(digis));
-      event.put(move(digiadcs));
-      // store MC truth match
-      event.put(move(mcdigis));
-      if ( _printLevel > 1 ) cout << "StrawDigisFromStrawGasSteps: produce() end" << endl;
-      // Done with the first event; disable some messages.
-      _firstEvent = false;
-
-    } // end produce
+      // the clusts are no longer needed: release them all at once
+      task._hmap.clear();
+      task._arena.reset();
+    }
 
-    void StrawDigisFromStrawGasSteps::createDigis(
+    void StrawDigisFromStrawGasSteps::createDigis(PanelTask& task,
         StrawPhysics const& strawphys,
         StrawElectronics const& strawele,
         Straw const& straw,
         StrawClusterSequencePair const& hsp,
-        XTalk const& xtalk,
-        StrawDigiCollection* digis, StrawDigiADCWaveformCollection* digiadcs,
-        StrawDigiMCCollection* mcdigis) {
+        XTalk const& xtalk) {
       // instantiate waveforms for both ends of this straw
-      SWFP waveforms  ={ StrawWaveform(straw,hsp.clustSequence(StrawEnd::cal),xtalk),
-        StrawWaveform(straw,hsp.clustSequence(StrawEnd::hv),xtalk) };
+      SWFP waveforms  ={ StrawWaveform(straw,hsp.clustSequence(StrawEnd::cal),xtalk,strawele),
+        StrawWaveform(straw,hsp.clustSequence(StrawEnd::hv),xtalk,strawele) };
       // find the threshold crossing points for these waveforms
       WFXPList xings;
       // find the threshold crossings
-      findThresholdCrossings(strawele,waveforms,xings);
-      // convert the crossing points into digis, and add them to the event data
-      fillDigis(strawphys,strawele,xings,waveforms,xtalk._dest,digis,digiadcs,mcdigis);
+      findThresholdCrossings(task,strawele,waveforms,xings);
+      // convert the crossing points into digis, and add them to the panel output
+      fillDigis(task,strawphys,strawele,xings,waveforms,xtalk._dest);
     }
 
-    void StrawDigisFromStrawGasSteps::fillClusterMap(StrawPhysics const& strawphys,
-        StrawElectronics const& strawele,
-        art::Event const& event, StrawClusterMap & hmap){
+    void StrawDigisFromStrawGasSteps::collectSteps(art::Event const& event, PanelSteps& panelsteps){
 // get status if needed
       std::shared_ptr<const TrackerStatus> trackerStatus;
       if(_usestatus) {
@@ -606,7 +717,7 @@ namespace mu2e {
       // Informational message on the first event.
       if ( _firstEvent ) {
         mf::LogInfo log(_messageCategory);
-        log << "StrawDigisFromStrawGasSteps::fillHitMap will use StrawGasSteps from: \n";
+        log << "StrawDigisFromStrawGasSteps::collectSteps will use StrawGasSteps from: \n";
         for ( HandleVector::const_iterator i=stepsHandles.begin(), e=stepsHandles.end();
             i != e; ++i ){
           art::Provenance const& prov(*(i->provenance()));
@@ -623,13 +734,9 @@ namespace mu2e {
         // Loop over the StrawGasSteps in this collection
         for(size_t isgs = 0; isgs < steps.size(); isgs++){
           auto const& sgs = steps[isgs];
-          // lookup straw here, to avoid having to find the tracker for every step
           StrawId const & sid = sgs.strawId();
           if ( ((!_usestatus) || (!trackerStatus->noSignal(sid))) && sgs.ionizingEdep() > _minstepE){
-            Straw const& straw = _tracker->getStraw(sid);
-            auto sgsptr = SGSPtr(sgsch,isgs);
-            // create a clust from this step, and add it to the clust map
-            addStep(strawphys,strawele,straw,sgsptr,hmap[sid]);
+            panelsteps[sid.uniquePanel()].push_back(SGSPtr(sgsch,isgs));
           } else if(_debug > 0) {
             StrawStatus stat;
             if(_usestatus) stat = trackerStatus->strawStatus(sid);
@@ -639,7 +746,8 @@ namespace mu2e {
       }
     }
 
-    void StrawDigisFromStrawGasSteps::addStep(StrawPhysics const& strawphys,
+    void StrawDigisFromStrawGasSteps::addStep(PanelTask& task,
+        StrawPhysics const& strawphys,
         StrawElectronics const& strawele,
         Straw const& straw,
         SGSPtr const& sgsptr,
@@ -652,13 +760,13 @@ namespace mu2e {
       if( (ctime > strawele.digitizationStartFromMarker() - strawele.electronicsTimeDelay() - _steptimebuf
             && ctime <  max(_mbtime,_digitizationEndFromMarker) - strawele.electronicsTimeDelay() + _steptimebuf) || readAll(sid)) {
         // Subdivide the StrawGasStep into ionization clusters
-        _clusters.clear();
-        divideStep(strawphys,strawele,straw,sgs,_clusters);
+        task._clusters.clear();
+        divideStep(task,strawphys,strawele,straw,sgs,task._clusters);
         // check
         // drift these clusters to the wire, and record the charge at the wire
-        for(auto iclu = _clusters.begin(); iclu != _clusters.end(); ++iclu){
+        for(auto iclu = task._clusters.begin(); iclu != task._clusters.end(); ++iclu){
           WireCharge wireq;
-          driftCluster(strawphys,straw,*iclu,wireq);
+          driftCluster(task,strawphys,straw,*iclu,wireq);
           // propagate this charge to each end of the wire
           for(size_t iend=0;iend<2;++iend){
             StrawEnd end(static_cast<StrawEnd::End>(iend));
@@ -670,18 +778,19 @@ namespace mu2e {
             double gtime = ctime + wireq._time + weq._time;
             // create the clust
             StrawCluster clust(StrawCluster::primary,sid,end,(float)gtime,weq._charge,weq._wdist,wireq._pos,(float)wireq._time,(float)weq._time,sgsptr,(float)ctime);
-            // add the clusts to the appropriate sequence.
-            shsp.clustSequence(end).insert(clust);
+            // add the clusts to the appropriate sequence.  They are sorted once the panel is complete
+            shsp.clustSequence(end).append(clust);
             // if required, add a 'ghost' copy of this clust
             if (_onSpill)
               addGhosts(strawele,clust,shsp.clustSequence(end));
           }
         }
-        if(_diag > 0) stepDiag(strawphys, strawele, sgs);
+        if(_diag > 0) stepDiag(strawphys, strawele, sgs, task._clusters);
       }
     }
 
-    void StrawDigisFromStrawGasSteps::divideStep(StrawPhysics const& strawphys,
+    void StrawDigisFromStrawGasSteps::divideStep(PanelTask& task,
+        StrawPhysics const& strawphys,
         StrawElectronics const& strawele,
         Straw const& straw,
         StrawGasStep const& sgs,
@@ -690,7 +799,7 @@ namespace mu2e {
       if (sgs.stepType().shape() == StrawGasStep::StepType::point || sgs.stepLength() < strawphys.meanFreePath()){
         float cen = sgs.ionizingEdep();
         float fne = cen/strawphys.meanElectronEnergy();
-        unsigned ne = std::max( static_cast<unsigned>(_randP(fne)),(unsigned)1);
+        unsigned ne = std::max( static_cast<unsigned>(task._randP(fne)),(unsigned)1);
         auto spos = strawCoordinates(sgs.startPosition(),straw);
         if(_drift1e){
           for (size_t i=0;i<ne;i++){
@@ -705,7 +814,7 @@ namespace mu2e {
         // compute the number of clusters for this step from the mean free path
         double fnc = sgs.stepLength()/strawphys.meanFreePath();
         // use a truncated Poisson distribution; this keeps both the mean and variance physical
-        unsigned nc = std::max(static_cast<unsigned>(_randP.fire(fnc)),(unsigned)1);
+        unsigned nc = std::max(static_cast<unsigned>(task._randP.fire(fnc)),(unsigned)1);
         // if not minion, limit the number of steps geometrically
         bool minion = (sgs.stepType().ionization()==StrawGasStep::StepType::minion);
         if(!minion )nc = std::min(nc,_maxnclu);
@@ -714,17 +823,17 @@ namespace mu2e {
         if(nc>0){
           // generate random positions for the clusters
           std::vector<StrawCoordinates> cposv(nc);
-          fillClusterPositions(sgs,straw,cposv);
+          fillClusterPositions(task,sgs,straw,cposv);
           // generate electron counts and energies for these clusters: minion model is more detailed
           std::vector<unsigned> ne(nc);
           std::vector<float> cen(nc);
           if(minion){
-            fillClusterMinion(strawphys,sgs,ne,cen);
+            fillClusterMinion(task,strawphys,sgs,ne,cen);
           } else {
             // get Poisson distribution of # of electrons for the average energy
             double fne = sgs.ionizingEdep()/(nc*strawphys.meanElectronEnergy()); // average # of electrons/cluster for non-minion clusters
             for(unsigned ic=0;ic<nc;++ic){
-              ne[ic] = static_cast<unsigned>(std::max(_randP.fire(fne),(long)1));
+              ne[ic] = static_cast<unsigned>(std::max(task._randP.fire(fne),(long)1));
               cen[ic] = ne[ic]*strawphys.meanElectronEnergy(); // average energy per electron, works for large numbers of electrons
             }
           }
@@ -747,16 +856,16 @@ namespace mu2e {
       }
     }
 
-    void StrawDigisFromStrawGasSteps::driftCluster(
+    void StrawDigisFromStrawGasSteps::driftCluster(PanelTask& task,
         StrawPhysics const& strawphys,Straw const& straw,
         IonCluster const& cluster, WireCharge& wireq ) {
       // sample the gain for this cluster
-      double gain = strawphys.clusterGain(_randgauss, _randflat, cluster._ne);
+      double gain = strawphys.clusterGain(task._randgauss, task._randflat, cluster._ne);
       wireq._charge = cluster._charge*(gain);
       // compute drift time for this cluster
       double dt = strawphys.driftDistanceToTime(cluster._pos._wirePosition.Rho(),cluster._pos._wirePosition.Phi()); // this is now from the lorentz corrected r-component of the drift
       wireq._pos = cluster._pos;
-      wireq._time = _randgauss.fire(dt,strawphys.driftTimeSpread(cluster._pos._wirePosition.Rho()));
+      wireq._time = task._randgauss.fire(dt,strawphys.driftTimeSpread(cluster._pos._wirePosition.Rho()));
     }
 
     void StrawDigisFromStrawGasSteps::propagateCharge(
@@ -791,19 +900,19 @@ namespace mu2e {
       // at this point cluster times are relative to marker and wrapped at 1695 (if onspill)
       // wrap from beginning of microbunch to times > 1695 to digitize ADCs for hits near end of event window
       if(clust.time() < _mbbuffer)
-        shs.insert(StrawCluster(clust,_mbtime));
+        shs.append(StrawCluster(clust,_mbtime));
       // wrap from end of microbunch to negative time to digitize ADCs for hits at tdc time=0
-      if(clust.time() > _mbtime - _mbbuffer) shs.insert(StrawCluster(clust,-_mbtime));
+      if(clust.time() > _mbtime - _mbbuffer) shs.append(StrawCluster(clust,-_mbtime));
     }
 
-    void StrawDigisFromStrawGasSteps::findThresholdCrossings(StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings){
+    void StrawDigisFromStrawGasSteps::findThresholdCrossings(PanelTask& task, StrawElectronics const& strawele, SWFP const& swfp, WFXPList& xings){
       //randomize the threshold to account for electronics noise; this includes parts that are coherent
       // for both ends (coming from the straw itself)
       // Keep track of crossings on each end to keep them in sequence
-      double strawnoise = _randgauss.fire(0,strawele.strawNoise());
+      double strawnoise = task._randgauss.fire(0,strawele.strawNoise());
       // add specifics for each end
-      double thresh[2] = {_randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(0))+strawnoise,strawele.analogNoise(StrawElectronics::thresh)),
-        _randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(1))+strawnoise,strawele.analogNoise(StrawElectronics::thresh))};
+      double thresh[2] = {task._randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(0))+strawnoise,strawele.analogNoise(StrawElectronics::thresh)),
+        task._randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(1))+strawnoise,strawele.analogNoise(StrawElectronics::thresh))};
       // Initialize search when the electronics becomes enabled:
       double tstart =strawele.digitizationStartFromMarker() - _flashbuffer;
       // for reading all hits, make sure we start looking for clusters at the minimum possible cluster time
@@ -826,14 +935,14 @@ namespace mu2e {
           if(std::min(wfx[0]._time,wfx[1]._time) > 0.0 )xings.push_back(wfx);
           // search for next crossing:
           // update threshold for straw noise
-          strawnoise = _randgauss.fire(0,strawele.strawNoise());
+          strawnoise = task._randgauss.fire(0,strawele.strawNoise());
           for(unsigned iend=0;iend<2;++iend){
             // insure a minimum time buffer between crossings
             wfx[iend]._time += strawele.deadTimeAnalog();
             // skip to the next clust
             ++(wfx[iend]._iclust);
             // update threshold for incoherent noise
-            thresh[iend] = _randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(iend)),strawele.analogNoise(StrawElectronics::thresh));
+            thresh[iend] = task._randgauss.fire(strawele.threshold(swfp[0].straw().id(),static_cast<StrawEnd::End>(iend)),strawele.analogNoise(StrawElectronics::thresh));
             // find next crossing
             crosses[iend] = swfp[iend].crossesThreshold(strawele,thresh[iend],wfx[iend]);
           }
@@ -847,12 +956,11 @@ namespace mu2e {
       }
     }
 
-    void StrawDigisFromStrawGasSteps::fillDigis(StrawPhysics const& strawphys,
+    void StrawDigisFromStrawGasSteps::fillDigis(PanelTask& task,
+        StrawPhysics const& strawphys,
         StrawElectronics const& strawele,
         WFXPList const& xings, SWFP const& wf,
-        StrawId sid,
-        StrawDigiCollection* digis, StrawDigiADCWaveformCollection* digiadcs,
-        StrawDigiMCCollection* mcdigis ) {
+        StrawId sid) {
       //
       Straw const& straw = _tracker->getStraw(sid);
       double digitization_ready_time = -9e9; //FIXME no deadtime for first hit of a microbunch
@@ -860,7 +968,7 @@ namespace mu2e {
       for(auto xpair : xings) {
         // create a digi from this pair.  This also performs a finial test
         // on whether the pair should make a digi
-        if(createDigi(strawele,xpair,wf,sid,digis,digiadcs,digitization_ready_time)){
+        if(createDigi(task,strawele,xpair,wf,sid,digitization_ready_time)){
           // fill associated MC truth matching. Only count the same step once
           StrawDigiMC::SGSPA sgspa;
           StrawDigiMC::PA cpos;
@@ -879,9 +987,9 @@ namespace mu2e {
           }
           // subtract a small buffer
           ptime -= _adcbuffer;
-          mcdigis->push_back(StrawDigiMC(sid,cpos,ctime,wetime,sgspa,DigiProvenance::Simulation));
+          task._mcdigis.push_back(StrawDigiMC(sid,cpos,ctime,wetime,sgspa,DigiProvenance::Simulation));
           if(_diag > 1){
-            digiDiag(strawphys,wf,xpair,digis->back(),digiadcs->back(),mcdigis->back());
+            digiDiag(strawphys,wf,xpair,task._digis.back(),task._digiadcs.back(),task._mcdigis.back());
           }
         }
       }
@@ -889,13 +997,13 @@ namespace mu2e {
       if ( _diag > 1 && (wf[0].clusts().clustList().size() > 0 ||
             wf[1].clusts().clustList().size() > 0 ) ) {
         // waveform xing diagnostics
-        _ndigi = digis->size();
+        _ndigi = task._digis.size();
         waveformDiag(strawele,wf,xings);
       }
     }
 
-    bool StrawDigisFromStrawGasSteps::createDigi(StrawElectronics const& strawele, WFXP const& xpair, SWFP const& waveform,
-        StrawId sid, StrawDigiCollection* digis, StrawDigiADCWaveformCollection* digiadcs, double &digitization_ready_time){
+    bool StrawDigisFromStrawGasSteps::createDigi(PanelTask& task, StrawElectronics const& strawele, WFXP const& xpair, SWFP const& waveform,
+        StrawId sid, double &digitization_ready_time){
       // initialize the float variables that we later digitize
       TDCTimes xtimes = {0.0,0.0};
       TrkTypes::TOTValues tot;
@@ -906,16 +1014,16 @@ namespace mu2e {
       //  sums voltages from both waveforms for ADC
       ADCVoltages wf[2];
       // add the jitter in the EventWindowMarker time for this Panel (constant for a whole microbunch, same for both sides)
-      double dt = _ewMarkerROCdt[sid.uniquePanel()];
+      double dt = task._ewMarkerROCdt;
       // loop over the associated crossings
       for(size_t iend = 0;iend<2; ++iend){
         WFX const& wfx = xpair[iend];
         // record the crossing time for this end, including clock jitter  These already include noise effects
         // add noise for TDC on each side
-        double tdc_jitter = _randgauss.fire(0.0,strawele.TDCResolution());
+        double tdc_jitter = task._randgauss.fire(0.0,strawele.TDCResolution());
         xtimes[iend] = wfx._time+dt+tdc_jitter;
         // randomize threshold using the incoherent noise
-        double threshold = _randgauss.fire(wfx._vcross,strawele.analogNoise(StrawElectronics::thresh));
+        double threshold = task._randgauss.fire(wfx._vcross,strawele.analogNoise(StrawElectronics::thresh));
         // find TOT
         tot[iend] = waveform[iend].digitizeTOT(strawele,threshold,wfx._time + dt);
         // sample ADC
@@ -930,7 +1038,7 @@ namespace mu2e {
       // add ends and add noise
       ADCVoltages wfsum; wfsum.reserve(adctimes.size());
       for(unsigned isamp=0;isamp<adctimes.size();++isamp){
-        wfsum.push_back(wf[0][isamp]+wf[1][isamp]+_randgauss.fire(0.0,strawele.analogNoise(StrawElectronics::adc)));
+        wfsum.push_back(wf[0][isamp]+wf[1][isamp]+task._randgauss.fire(0.0,strawele.analogNoise(StrawElectronics::adc)));
       }
       // digitize, and make final test.  This call includes the clock error WRT the proton pulse
       TrkTypes::TDCValues tdcs;
@@ -945,8 +1053,8 @@ namespace mu2e {
         TrkTypes::ADCValue pmp;
         strawele.digitizeWaveform(sid,wfsum,adc,pmp);
         // create the digi from this
-        digis->push_back(StrawDigi(sid,tdcs,tot,pmp));
-        digiadcs->push_back(StrawDigiADCWaveform(adc));
+        task._digis.push_back(StrawDigi(sid,tdcs,tot,pmp));
+        task._digiadcs.push_back(StrawDigiADCWaveform(adc));
         // update digital deadtime for this channel
         digitization_ready_time = digitize_time + strawele.deadTimeDigital();
       }
@@ -959,21 +1067,14 @@ namespace mu2e {
     void StrawDigisFromStrawGasSteps::findCrossTalkStraws(Straw const& straw, vector<XTalk>& xtalk) {
       StrawId selfid = straw.id();
       xtalk.clear();
-      // find straws sensitive to straw-to-straw cross talk
-      vector<StrawId> strawNeighbors;
-      vector<StrawId> preampNeighbors;
-      for(uint16_t istraw=0; istraw < StrawId::_nstraws; istraw++){
-        StrawId nid(selfid.plane(),selfid.panel(),istraw);
-        if(nid != selfid && selfid.nearestNeighbor(nid)) strawNeighbors.push_back(nid);
-        if(nid != selfid && selfid.samePreamp(nid)) preampNeighbors.push_back(nid);
-      }
-      // find straws sensitive to electronics cross talk
+      // straws sensitive to straw-to-straw and to electronics cross talk come from the tracker topology
+      TrackerTopology const& topology = _tracker->topology();
       // convert these to cross-talk
-      for(auto isid=strawNeighbors.begin();isid!=strawNeighbors.end();++isid){
-        xtalk.push_back(XTalk(selfid,*isid,_preampxtalk,0));
+      for(auto const& nid : topology.nearestNeighbors(selfid)){
+        xtalk.push_back(XTalk(selfid,nid,_preampxtalk,0));
       }
-      for(auto isid=preampNeighbors.begin();isid!=preampNeighbors.end();++isid){
-        xtalk.push_back(XTalk(selfid,*isid,0,_postampxtalk));
+      for(auto const& nid : topology.preampNeighbors(selfid)){
+        xtalk.push_back(XTalk(selfid,nid,0,_postampxtalk));
       }
     }
 
@@ -983,24 +1084,24 @@ namespace mu2e {
       // create random noise clusts and add them to the sequences of random straws.
     }
 
-    void StrawDigisFromStrawGasSteps::fillClusterPositions(StrawGasStep const& sgs, Straw const& straw, std::vector<StrawCoordinates>& cposv) {
+    void StrawDigisFromStrawGasSteps::fillClusterPositions(PanelTask& task, StrawGasStep const& sgs, Straw const& straw, std::vector<StrawCoordinates>& cposv) {
       // generate a random position between the start and end points.
       XYZVectorF path = sgs.endPosition() - sgs.startPosition();
       for(auto& cpos : cposv) {
-        XYZVectorF pos = sgs.startPosition() + _randflat.fire(1.0)*path;
+        XYZVectorF pos = sgs.startPosition() + task._randflat.fire(1.0)*path;
         // randomize the position by width.  This needs to be 2-d to avoid problems at the origin
         if(_randrad){
           XYZVectorF sdir = XYZVectorF(straw.getDirection());
           XYZVectorF p1 = path.Cross(sdir).Unit();
           XYZVectorF p2 = path.Cross(p1).Unit();
-          pos += p1*_randgauss.fire()*sgs.width();
-          pos += p2*_randgauss.fire()*sgs.width();
+          pos += p1*task._randgauss.fire()*sgs.width();
+          pos += p2*task._randgauss.fire()*sgs.width();
         }
         cpos = strawCoordinates(pos,straw);
       }
     }
 
-    void StrawDigisFromStrawGasSteps::fillClusterMinion(StrawPhysics const& strawphys, StrawGasStep const& step, std::vector<unsigned>& ne, std::vector<float>& cen) {
+    void StrawDigisFromStrawGasSteps::fillClusterMinion(PanelTask& task, StrawPhysics const& strawphys, StrawGasStep const& step, std::vector<unsigned>& ne, std::vector<float>& cen) {
       // Loop until we've assigned energy + electrons to every cluster
       unsigned mc(0);
       double esum(0.0);
@@ -1009,7 +1110,7 @@ namespace mu2e {
       while(mc < nc){
         std::vector<unsigned> me(nc);
         // fill an array of random# of electrons according to the measured distribution.
-        fillClusterNe(strawphys,me);
+        fillClusterNe(task,strawphys,me);
         // loop through these as long as there's enough energy to have at least 1 electron in each cluster.  If not, re-throw the # of electrons/cluster for the remainder
         for(auto ie : me) {
           double emax = etot - esum - (nc -mc -1)*strawphys.ionizationEnergy((unsigned)1);
@@ -1027,12 +1128,12 @@ namespace mu2e {
       // distribute any residual energy randomly to these clusters.  This models delta rays
       unsigned ns;
       do{
-        unsigned me = strawphys.nePerIon(_randflat.fire());
+        unsigned me = strawphys.nePerIon(task._randflat.fire());
         double emax = etot - esum;
         double eele = strawphys.ionizationEnergy(me);
         if(eele < emax){
           // choose a random cluster to assign this energy to
-          unsigned mc = std::min(nc-1,static_cast<unsigned>(floor(_randflat.fire(nc))));
+          unsigned mc = std::min(nc-1,static_cast<unsigned>(floor(task._randflat.fire(nc))));
           ne[mc] += me;
           cen[mc] += eele;
           esum += eele;
@@ -1042,9 +1143,9 @@ namespace mu2e {
       } while(ns > 0);
     }
 
-    void StrawDigisFromStrawGasSteps::fillClusterNe(StrawPhysics const& strawphys,std::vector<unsigned>& me) {
+    void StrawDigisFromStrawGasSteps::fillClusterNe(PanelTask& task, StrawPhysics const& strawphys,std::vector<unsigned>& me) {
       for(size_t ie=0;ie < me.size(); ++ie){
-        me[ie] = strawphys.nePerIon(_randflat.fire());
+        me[ie] = strawphys.nePerIon(task._randflat.fire());
       }
     }
 
@@ -1286,7 +1387,8 @@ namespace mu2e {
     }//End of digiDiag
 
     void StrawDigisFromStrawGasSteps::stepDiag( StrawPhysics const& strawphys, StrawElectronics const& strawele,
-        StrawGasStep const& sgs) {
+        StrawGasStep const& sgs, vector<IonCluster> const& clusters) {
+      _clusters = clusters; // the clusters branch reads this member
       _steplen = sgs.stepLength();
       _stepE = sgs.ionizingEdep();
       _steptime = microbunchTime(strawele,sgs.time());
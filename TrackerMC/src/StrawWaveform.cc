@@ -6,6 +6,8 @@
 // Original author David Brown, LBNL
 //
 #include "Offline/TrackerMC/inc/StrawWaveform.hh"
+#include "cetlib_except/exception.h"
+#include <algorithm>
 #include <cmath>
 #include <boost/math/special_functions/binomial.hpp>
 
@@ -13,14 +15,53 @@ using namespace std;
 namespace mu2e {
   using namespace TrkTypes;
   namespace TrackerMC {
-    StrawWaveform::StrawWaveform(Straw const& straw, StrawClusterSequence const& hseq, XTalk const& xtalk) :
-      _cseq(hseq), _xtalk(xtalk), _straw(straw)
-    {}
+    StrawWaveform::StrawWaveform(Straw const& straw, StrawClusterSequence const& hseq, XTalk const& xtalk, StrawElectronics const& strawele) :
+      _cseq(hseq), _xtalk(xtalk), _straw(straw), _maxresp(0.0)
+    {
+      if(!_cseq.sorted())
+        throw cet::exception("SIM") << "mu2e::StrawWaveform: clust sequence of straw " << _cseq.strawId() << " is not sorted" << std::endl;
+      StrawClusterList const& hlist = _cseq.clustList();
+      _terms.resize(hlist.size());
+      for(auto& tailsum : _tailsum){
+        tailsum.resize(hlist.size()+1);
+        tailsum[0] = 0.0;
+      }
+      double ttail(-1.0e10);
+      for(size_t iclust=0;iclust < hlist.size();++iclust){
+        StrawCluster const& clust = hlist[iclust];
+        ClustTerms& terms = _terms[iclust];
+        strawele.chargeResponse(_straw,clust.charge(),clust.wireDistance(),terms._cresp);
+        terms._tstart = clust.time()-strawele.clusterLookbackTime();
+        double tconst = strawele.responseTailTime(terms._cresp);
+        ttail = std::max(ttail,clust.time()+tconst);
+        terms._ttail = ttail;
+        terms._tmax = strawele.maxResponseTime(_straw.id(),StrawElectronics::thresh,clust.wireDistance());
+        terms._linmax = strawele.maxLinearResponse(_straw.id(),StrawElectronics::thresh,clust.wireDistance(),clust.charge());
+        terms._linmax *= (_xtalk._preamp + _xtalk._postamp);
+        _maxresp += terms._linmax;
+        // the constant response, summed in clust order as in a full sample
+        for(size_t ipath=0;ipath < StrawElectronics::npaths;++ipath){
+          auto path = static_cast<StrawElectronics::Path>(ipath);
+          _tailsum[ipath][iclust+1] = _tailsum[ipath][iclust] + strawele.linearResponse(_straw,path,tconst,terms._cresp);
+        }
+      }
+    }
 
     StrawWaveform::StrawWaveform(StrawWaveform const& other) : _cseq(other._cseq),
-    _xtalk(other._xtalk), _straw(other._straw)
+    _xtalk(other._xtalk), _straw(other._straw), _terms(other._terms), _tailsum(other._tailsum),
+    _maxresp(other._maxresp)
     {}
 
+    size_t StrawWaveform::nTail(double time) const {
+      return std::partition_point(_terms.begin(),_terms.end(),
+          [time](ClustTerms const& terms){ return terms._ttail <= time; }) - _terms.begin();
+    }
+
+    size_t StrawWaveform::nActive(double time) const {
+      return std::partition_point(_terms.begin(),_terms.end(),
+          [time](ClustTerms const& terms){ return terms._tstart < time; }) - _terms.begin();
+    }
+
     bool StrawWaveform::crossesThreshold(StrawElectronics const& strawele,double threshold,WFX& wfx) const {
       bool retval(false);
       // make sure we start past the input time
@@ -43,7 +84,7 @@ namespace mu2e {
             //// check if this clust could cross threshold
             //if(wfx._vstart + maxLinearResponse(wfx._iclust) > threshold){
             // check the actual response
-            double maxtime = wfx._iclust->time()+strawele.maxResponseTime(_straw.id(),StrawElectronics::thresh,wfx._iclust->wireDistance());
+            double maxtime = wfx._iclust->time()+terms(wfx._iclust)._tmax;
             double maxresp = sampleWaveform(strawele,StrawElectronics::thresh,maxtime);
             if(maxresp > threshold){
               // interpolate to find the precise crossing
@@ -64,7 +105,7 @@ namespace mu2e {
     void StrawWaveform::returnCrossing(StrawElectronics const& strawele, double threshold, WFX& wfx) const {
       while(wfx._iclust != _cseq.clustList().end() && wfx._vstart > threshold) {
         // move forward in time at least as twice the time to the maxium for this clust
-        double time = wfx._iclust->time()+strawele.clusterLookbackTime() + 2*strawele.maxResponseTime(_straw.id(),StrawElectronics::thresh,wfx._iclust->wireDistance());
+        double time = wfx._iclust->time()+strawele.clusterLookbackTime() + 2*terms(wfx._iclust)._tmax;
         while(wfx._iclust != _cseq.clustList().end() &&
             wfx._iclust->time()-strawele.clusterLookbackTime() < time){
           ++(wfx._iclust);
@@ -81,7 +122,7 @@ namespace mu2e {
       // for actually crossing threshold
       double resp = wfx._vstart;
       while(wfx._iclust != _cseq.clustList().end()){
-        resp += maxLinearResponse(strawele,wfx._iclust);
+        resp += terms(wfx._iclust)._linmax;
         if(resp > threshold)break;
         ++(wfx._iclust);
       }
@@ -95,7 +136,7 @@ namespace mu2e {
     bool StrawWaveform::fineCrossing(StrawElectronics const& strawele, double threshold,double maxresp, WFX& wfx) const {
       static double timestep(0.020); // interpolation minimum to use linear threshold crossing calculation
       double pretime = wfx._iclust->time()-strawele.clusterLookbackTime();
-      double posttime = pretime + strawele.clusterLookbackTime() + strawele.maxResponseTime(_straw.id(),StrawElectronics::thresh,wfx._iclust->wireDistance());
+      double posttime = pretime + strawele.clusterLookbackTime() + terms(wfx._iclust)._tmax;
       double presample = wfx._vstart;
       double postsample = maxresp;
       static const unsigned maxstep(10); // 10 steps max
@@ -139,23 +180,15 @@ namespace mu2e {
       return dt < timestep;
     }
 
-    double StrawWaveform::maxLinearResponse(StrawElectronics const& strawele,StrawClusterList::const_iterator const& iclust) const {
-      // ignore saturation effects
-      double linresp = strawele.maxLinearResponse(_straw.id(),StrawElectronics::thresh,iclust->wireDistance(),iclust->charge());
-      linresp *= (_xtalk._preamp + _xtalk._postamp);
-      return linresp;
-    }
-
     double StrawWaveform::sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double time) const {
-      // loop over all clusts and add their response at this time
+      // start from the constant response of the early clusts, then add the response of the clusts in the shaping window
       StrawClusterList const& hlist = _cseq.clustList();
-      double linresp(0.0);
-      auto iclust = hlist.begin();
-      while(iclust != hlist.end() && iclust->time()-strawele.clusterLookbackTime() < time){
+      size_t itail = nTail(time);
+      size_t iend = nActive(time);
+      double linresp = _tailsum[ipath][itail];
+      for(size_t iclust=itail;iclust < iend;++iclust){
         // compute the linear straw electronics response to this charge.  This is pre-saturation
-        linresp += strawele.linearResponse(_straw,ipath,time-iclust->time(),iclust->charge(),iclust->wireDistance());
-        // move to next clust
-        ++iclust;
+        linresp += strawele.linearResponse(_straw,ipath,time-hlist[iclust].time(),_terms[iclust]._cresp);
       }
       double totresp = linresp * _xtalk._postamp;
       if(_xtalk._preamp>0.0)
@@ -163,6 +196,24 @@ namespace mu2e {
       return totresp;
     }
 
+    void StrawWaveform::sampleWaveform(StrawElectronics const& strawele,StrawElectronics::Path ipath,double const* times, size_t ntimes, double* volts) const {
+      if(ntimes == 0)return;
+      // clusts which are constant at the first time or don't contribute at the last are skipped.  The others
+      // are added at each time where they contribute, in clust order
+      StrawClusterList const& hlist = _cseq.clustList();
+      size_t itail = nTail(times[0]);
+      size_t iend = nActive(times[ntimes-1]);
+      std::fill(volts,volts+ntimes,_tailsum[ipath][itail]);
+      for(size_t iclust=itail;iclust < iend;++iclust)
+        strawele.addLinearResponse(_straw,ipath,_terms[iclust]._cresp,hlist[iclust].time(),_terms[iclust]._tstart,times,ntimes,volts);
+      for(size_t itime=0;itime < ntimes;++itime){
+        double linresp = volts[itime];
+        volts[itime] = linresp * _xtalk._postamp;
+        if(_xtalk._preamp>0.0)
+          volts[itime] += _xtalk._preamp*linresp;
+      }
+    }
+
     void StrawWaveform::sampleADCWaveform(StrawElectronics const& strawele,ADCTimes const& times,ADCVoltages& volts) const {
       volts.clear();
       volts.reserve(times.size());
@@ -175,19 +226,17 @@ namespace mu2e {
       }
 
       // check if going to be saturated
-      double max_possible_voltage = 0;
-      for (auto iclust = _cseq.clustList().begin();iclust != _cseq.clustList().end();++iclust){
-        max_possible_voltage += maxLinearResponse(strawele,iclust);
-      }
+      StrawClusterList const& hlist = _cseq.clustList();
+      double max_possible_voltage = _maxresp;
       if (max_possible_voltage > strawele.saturationVoltage()){
         // create waveform of threshold circuit output
         // step along waveform and apply saturation
         // for each time, get contribution from each step in waveform using impulse response
 
         // skip to the first cluster that matters for the first adc time
-        auto iclust = _cseq.clustList().begin();
-        while (iclust != _cseq.clustList().end()){
-          double time = iclust->time()-strawele.clusterLookbackTime();
+        size_t iclust = 0;
+        while (iclust < hlist.size()){
+          double time = hlist[iclust].time()-strawele.clusterLookbackTime();
           if (time + strawele.truncationTime(StrawElectronics::thresh) > times[0])
             break;
           else
@@ -198,16 +247,25 @@ namespace mu2e {
         for (size_t j=0;j<times.size();j++){
           volts.push_back(0);
         }
+        if (iclust == hlist.size())
+          return;
 
-        int num_steps = (int)ceil((times[times.size()-1]-iclust->time()-strawele.clusterLookbackTime())/strawele.saturationTimeStep());
+        int num_steps = (int)ceil((times[times.size()-1]-hlist[iclust].time()-strawele.clusterLookbackTime())/strawele.saturationTimeStep());
 
+        // the steps are in time order, so the clusts with constant response only ever grow
+        size_t itail = iclust;
+        double tailresp = 0;
         for (int i=0;i<num_steps;i++){
-          double time = iclust->time()-strawele.clusterLookbackTime() + i*strawele.saturationTimeStep();
+          double time = hlist[iclust].time()-strawele.clusterLookbackTime() + i*strawele.saturationTimeStep();
+          while (itail < hlist.size() && _terms[itail]._ttail <= time){
+            tailresp += strawele.linearResponse(_straw,StrawElectronics::thresh,_terms[itail]._ttail-hlist[itail].time(),_terms[itail]._cresp,true);
+            ++itail;
+          }
           // sum up the preamp response at this step
-          double response = 0;
-          auto jclust = iclust;
-          while(jclust != _cseq.clustList().end() && jclust->time()-strawele.clusterLookbackTime() < time){
-            response += strawele.linearResponse(_straw,StrawElectronics::thresh,time-jclust->time(),jclust->charge(),jclust->wireDistance(),true);
+          double response = tailresp;
+          size_t jclust = itail;
+          while(jclust < hlist.size() && _terms[jclust]._tstart < time){
+            response += strawele.linearResponse(_straw,StrawElectronics::thresh,time-hlist[jclust].time(),_terms[jclust]._cresp,true);
             ++jclust;
           }
           // now saturate it
@@ -219,16 +277,31 @@ namespace mu2e {
           }
         }
       }else{
-        for(auto itime=times.begin();itime!=times.end();++itime){
-          volts.push_back(sampleWaveform(strawele,StrawElectronics::adc,*itime));
+        // sample in blocks of times
+        constexpr size_t nblock(16);
+        double btimes[nblock], bvolts[nblock];
+        for(size_t itime=0;itime < times.size();itime += nblock){
+          size_t ntimes = std::min(nblock,times.size()-itime);
+          std::copy(times.begin()+itime,times.begin()+itime+ntimes,btimes);
+          sampleWaveform(strawele,StrawElectronics::adc,btimes,ntimes,bvolts);
+          volts.insert(volts.end(),bvolts,bvolts+ntimes);
         }
       }
     }
 
     unsigned short StrawWaveform::digitizeTOT(StrawElectronics const& strawele, double threshold, double time) const {
-      for (size_t i=1;i<strawele.maxTOT();i++){
-        if (sampleWaveform(strawele,StrawElectronics::thresh,time + i*strawele.totLSB()) < threshold - strawele.triggerHysteresis())
-          return static_cast<unsigned short>(i);
+      // sample the TOT clock ticks in blocks, stopping at the first block which falls below threshold
+      constexpr size_t nblock(8);
+      double btimes[nblock], bvolts[nblock];
+      for (size_t i=1;i<strawele.maxTOT();i+=nblock){
+        size_t ntimes = std::min(nblock,strawele.maxTOT()-i);
+        for (size_t itime=0;itime<ntimes;itime++)
+          btimes[itime] = time + (i+itime)*strawele.totLSB();
+        sampleWaveform(strawele,StrawElectronics::thresh,btimes,ntimes,bvolts);
+        for (size_t itime=0;itime<ntimes;itime++){
+          if (bvolts[itime] < threshold - strawele.triggerHysteresis())
+            return static_cast<unsigned short>(i+itime);
+        }
       }
       return static_cast<unsigned short>(strawele.maxTOT());
     }
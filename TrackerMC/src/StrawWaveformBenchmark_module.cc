@@ -0,0 +1,284 @@
+//
+// Throughput of the StrawClusterSequence building and of the StrawWaveform threshold crossing
+// search and digitization on generated clusts, at several multiples of a nominal hit rate.
+//
+// For each intensity, clusts are generated on randomly chosen straws: a Poisson number of hits
+// per straw end spread over the microbunch, each hit a burst of ionization clusts.  The clusts of
+// all the straw ends, an 'event', are then put in time order 3 ways: by a linear scan insert into
+// a list, as StrawClusterSequence did originally, by StrawClusterSequence::insert on the heap, and
+// by append and sort in a StrawClusterArena, as in StrawDigisFromStrawGasSteps.  The arena event
+// is built twice, the second time in the blocks of the first.  The time and the number of heap
+// allocations of each are printed, and the job fails if the arena sequences differ from the lists.
+// Each waveform is searched for threshold crossings as in StrawDigisFromStrawGasSteps, and every
+// crossing is digitized (TOT and ADC samples).  The time per straw end is printed, with the time
+// per waveform sample of the windowed sum and of a sum over every clust.  The job fails if the
+// 2 sums are not identical.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Sequence.h"
+
+#include "Offline/GlobalConstantsService/inc/GlobalConstantsHandle.hh"
+#include "Offline/GlobalConstantsService/inc/PhysicsParams.hh"
+#include "Offline/ProditionsService/inc/ProditionsHandle.hh"
+#include "Offline/TrackerConditions/inc/StrawElectronics.hh"
+#include "Offline/TrackerGeom/inc/Tracker.hh"
+#include "Offline/TrackerMC/inc/StrawClusterArena.hh"
+#include "Offline/TrackerMC/inc/StrawClusterSequence.hh"
+#include "Offline/TrackerMC/inc/StrawWaveform.hh"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+namespace mu2e {
+  namespace TrackerMC {
+
+    class StrawWaveformBenchmark : public art::EDAnalyzer {
+      public:
+        struct Config {
+          using Name = fhicl::Name;
+          using Comment = fhicl::Comment;
+          fhicl::Sequence<double> intensities{Name("intensities"), Comment("Multiples of the nominal hit rate to run"), std::vector<double>{1.0,2.0}};
+          fhicl::Atom<double> hitsPerStrawEnd{Name("hitsPerStrawEnd"), Comment("Mean number of hits per straw end and microbunch at nominal intensity")};
+          fhicl::Atom<unsigned> clustsPerHit{Name("clustsPerHit"), Comment("Mean number of ionization clusts per hit"), 20};
+          fhicl::Atom<double> clustCharge{Name("clustCharge"), Comment("Mean charge of a clust at the wire end (pC)")};
+          fhicl::Atom<double> driftTime{Name("driftTime"), Comment("Largest drift time of a clust in a hit (ns)"), 40.0};
+          fhicl::Atom<double> propVelocity{Name("propVelocity"), Comment("Signal propagation velocity along the wire (mm/ns)"), 273.0};
+          fhicl::Atom<unsigned> nStraws{Name("nStraws"), Comment("Number of straws per intensity"), 2000};
+          fhicl::Atom<unsigned> nCheck{Name("nCheck"), Comment("Number of samples per waveform checked against the sum over every clust"), 20};
+          fhicl::Atom<unsigned> seed{Name("seed"), Comment("Seed for the clust generator"), 12345};
+        };
+        typedef art::EDAnalyzer::Table<Config> Parameters;
+
+        explicit StrawWaveformBenchmark(const Parameters& conf) : art::EDAnalyzer(conf), conf_(conf()) {}
+
+        void analyze(const art::Event& event) override;
+
+      private:
+        Config conf_;
+        bool done_ = false;
+        ProditionsHandle<StrawElectronics> strawele_h_;
+        ProditionsHandle<Tracker> tracker_h_{"Sim"};
+    };
+
+    namespace {
+      // heap memory, counting the allocations
+      class CountingResource : public std::pmr::memory_resource {
+        public:
+          size_t nAllocations() const { return _nalloc; }
+        private:
+          void* do_allocate(size_t bytes, size_t alignment) override {
+            ++_nalloc;
+            return std::pmr::new_delete_resource()->allocate(bytes,alignment);
+          }
+          void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(ptr,bytes,alignment);
+          }
+          bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+          size_t _nalloc = 0;
+      };
+
+      // the generated clusts of 1 straw end, in generation order
+      struct StrawEndClusts {
+        Straw const* _straw;
+        StrawEnd _end;
+        std::vector<StrawCluster> _clusts;
+      };
+
+      typedef std::pmr::list<StrawCluster> ClustList;
+
+      // the original StrawClusterSequence insert: scan the list from the start
+      void listInsert(ClustList& clist, StrawCluster const& clust) {
+        auto ibefore = clist.begin();
+        while(ibefore != clist.end() && ibefore->time() < clust.time())
+          ++ibefore;
+        clist.insert(ibefore,clust);
+      }
+
+      bool sameClusts(StrawClusterSequence const& cseq, ClustList const& clist) {
+        if(cseq.clustList().size() != clist.size())return false;
+        auto ilist = clist.begin();
+        for(auto const& clust : cseq.clustList()){
+          if(clust.time() != ilist->time() || clust.charge() != ilist->charge()
+              || clust.wireDistance() != ilist->wireDistance())return false;
+          ++ilist;
+        }
+        return true;
+      }
+
+      // sample a waveform by summing the response of every clust, as StrawWaveform did before windowing
+      double sampleAll(StrawElectronics const& strawele, Straw const& straw, StrawClusterSequence const& cseq,
+          StrawElectronics::Path ipath, double time) {
+        double linresp(0.0);
+        for(auto const& clust : cseq.clustList()){
+          if(clust.time()-strawele.clusterLookbackTime() >= time)break;
+          linresp += strawele.linearResponse(straw,ipath,time-clust.time(),clust.charge(),clust.wireDistance());
+        }
+        return linresp;
+      }
+    }
+
+    void StrawWaveformBenchmark::analyze(const art::Event& event) {
+      if(done_)return;
+      done_ = true;
+      StrawElectronics const& strawele = strawele_h_.get(event.id());
+      Tracker const& tracker = tracker_h_.get(event.id());
+      double mbtime = GlobalConstantsHandle<PhysicsParams>()->getNominalDRPeriod();
+
+      std::mt19937 gen(conf_.seed());
+      std::uniform_real_distribution<double> flat(0.0,1.0);
+      std::exponential_distribution<double> charge(1.0/conf_.clustCharge());
+      std::uniform_int_distribution<size_t> pickStraw(0,tracker.nStraws()-1);
+
+      for(double intensity : conf_.intensities()){
+        std::poisson_distribution<unsigned> nhits(intensity*conf_.hitsPerStrawEnd());
+        std::uniform_int_distribution<unsigned> nclusts(1,2*conf_.clustsPerHit()-1);
+        double twaveform(0.0), twindow(0.0), tall(0.0);
+        size_t nclust(0), nxing(0), nsample(0);
+        std::vector<StrawEndClusts> ends;
+        ends.reserve(2*conf_.nStraws());
+        for(unsigned istraw=0; istraw < conf_.nStraws(); ++istraw){
+          Straw const& straw = tracker.getStraws()[pickStraw(gen)];
+          double length = 2*straw.halfLength();
+          for(size_t iend=0; iend < 2; ++iend){
+            StrawEnd end(static_cast<StrawEnd::End>(iend));
+            ends.push_back(StrawEndClusts{&straw,end,{}});
+            unsigned nhit = nhits(gen);
+            for(unsigned ihit=0; ihit < nhit; ++ihit){
+              double thit = flat(gen)*mbtime;
+              double wdist = flat(gen)*length;
+              unsigned nc = nclusts(gen);
+              for(unsigned ic=0; ic < nc; ++ic){
+                double dtime = flat(gen)*conf_.driftTime();
+                double ptime = wdist/conf_.propVelocity();
+                ends.back()._clusts.emplace_back(StrawCluster::primary,straw.id(),end,thit+dtime+ptime,charge(gen),wdist,
+                    StrawCoordinates(),dtime,ptime,art::Ptr<StrawGasStep>(),thit);
+              }
+            }
+            nclust += ends.back()._clusts.size();
+          }
+        }
+
+        // build the event: lists
+        CountingResource listres;
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<ClustList> lists;
+        lists.reserve(ends.size());
+        for(auto const& sec : ends){
+          lists.emplace_back(&listres);
+          for(auto const& clust : sec._clusts) listInsert(lists.back(),clust);
+        }
+        std::chrono::duration<double,std::milli> tlist = std::chrono::steady_clock::now() - t0;
+
+        // sequences on the heap.  Copying a sequence loses its resource, so construct them in place
+        CountingResource seqres;
+        t0 = std::chrono::steady_clock::now();
+        {
+          std::vector<StrawClusterSequence> seqs;
+          seqs.reserve(ends.size());
+          for(auto const& sec : ends){
+            seqs.emplace_back(sec._straw->id(),sec._end,&seqres);
+            for(auto const& clust : sec._clusts) seqs.back().insert(clust);
+          }
+        }
+        std::chrono::duration<double,std::milli> tinsert = std::chrono::steady_clock::now() - t0;
+
+        // sequences in the arena, twice
+        StrawClusterArena arena;
+        std::vector<StrawClusterSequence> cseqs;
+        cseqs.reserve(ends.size());
+        std::array<double,2> tarena;
+        std::array<size_t,2> narena;
+        for(size_t ipass=0; ipass < 2; ++ipass){
+          cseqs.clear();
+          arena.reset();
+          size_t nblocks = arena.nBlocks();
+          t0 = std::chrono::steady_clock::now();
+          for(auto const& sec : ends){
+            cseqs.emplace_back(sec._straw->id(),sec._end,&arena);
+            for(auto const& clust : sec._clusts) cseqs.back().append(clust);
+            cseqs.back().sort();
+          }
+          tarena[ipass] = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - t0).count();
+          narena[ipass] = arena.nBlocks() - nblocks;
+        }
+        for(size_t iseq=0; iseq < cseqs.size(); ++iseq){
+          if(!sameClusts(cseqs[iseq],lists[iseq]))
+            throw cet::exception("StrawWaveformBenchmark") << "straw " << ends[iseq]._straw->id()
+              << " arena clust sequence differs from the list" << std::endl;
+        }
+        t0 = std::chrono::steady_clock::now();
+        lists.clear();
+        tlist += std::chrono::steady_clock::now() - t0;
+        std::cout << "StrawWaveformBenchmark intensity " << std::setprecision(3) << intensity
+          << ": event of " << nclust << " clusts, ms (heap allocations) list " << std::setprecision(4) << tlist.count()
+          << " (" << listres.nAllocations() << "), insert " << tinsert.count() << " (" << seqres.nAllocations()
+          << "), arena " << tarena[0] << " (" << narena[0] << "), reused arena " << tarena[1] << " (" << narena[1]
+          << "); arena " << arena.nAllocations() << " allocations in " << arena.capacity() << " bytes" << std::endl;
+
+        for(size_t iseq=0; iseq < cseqs.size(); ++iseq){
+          Straw const& straw = *ends[iseq]._straw;
+          StrawClusterSequence const& cseq = cseqs[iseq];
+          auto iend = ends[iseq]._end.end();
+          double threshold = strawele.threshold(straw.id(),iend);
+
+          // crossing search and digitization, as in StrawDigisFromStrawGasSteps
+          auto start = std::chrono::steady_clock::now();
+          StrawWaveform wf(straw,cseq,XTalk(straw.id()),strawele);
+          WFX wfx(wf,strawele.digitizationStartFromMarker());
+          TrkTypes::ADCTimes adctimes;
+          TrkTypes::ADCVoltages volts;
+          while(wf.crossesThreshold(strawele,threshold,wfx) && wfx._time < mbtime){
+            ++nxing;
+            wf.digitizeTOT(strawele,threshold,wfx._time);
+            strawele.adcTimes(wfx._time,adctimes);
+            wf.sampleADCWaveform(strawele,adctimes,volts);
+            wfx._time += strawele.deadTimeAnalog();
+            ++(wfx._iclust);
+          }
+          std::chrono::duration<double,std::micro> elapsed = std::chrono::steady_clock::now() - start;
+          twaveform += elapsed.count();
+
+          // windowed samples against the sum over every clust
+          for(unsigned icheck=0; icheck < conf_.nCheck(); ++icheck){
+            double time = flat(gen)*mbtime;
+            for(size_t ipath=0; ipath < StrawElectronics::npaths; ++ipath){
+              auto path = static_cast<StrawElectronics::Path>(ipath);
+              auto ts0 = std::chrono::steady_clock::now();
+              double vwindow = wf.sampleWaveform(strawele,path,time);
+              auto ts1 = std::chrono::steady_clock::now();
+              double vall = sampleAll(strawele,straw,cseq,path,time);
+              auto ts2 = std::chrono::steady_clock::now();
+              twindow += std::chrono::duration<double,std::nano>(ts1-ts0).count();
+              tall += std::chrono::duration<double,std::nano>(ts2-ts1).count();
+              ++nsample;
+              if(std::memcmp(&vwindow,&vall,sizeof(double)) != 0)
+                throw cet::exception("StrawWaveformBenchmark") << "straw " << straw.id() << " sample at " << time
+                  << " differs from the sum over every clust: " << vwindow << " " << vall << std::endl;
+            }
+          }
+        }
+        size_t nwf = std::max(2*conf_.nStraws(),1u);
+        std::cout << "StrawWaveformBenchmark intensity " << std::setprecision(3) << intensity
+          << ": " << double(nclust)/nwf << " clusts and " << double(nxing)/nwf << " crossings per straw end, "
+          << "us/straw end " << std::setprecision(4) << twaveform/nwf
+          << ", ns/sample windowed " << twindow/std::max(nsample,size_t(1)) << " all clusts " << tall/std::max(nsample,size_t(1))
+          << std::endl;
+      }
+    }
+  }
+}
+
+using mu2e::TrackerMC::StrawWaveformBenchmark;
+DEFINE_ART_MODULE(StrawWaveformBenchmark)
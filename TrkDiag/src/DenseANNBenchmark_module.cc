@@ -0,0 +1,125 @@
+//
+// Per-hit latency and accuracy of DenseANN against the TMVA SOFIE generated sessions
+// it replaces.
+//
+// Each network is read from its weight file both by the SOFIE session and by DenseANN.
+// Random inputs are then evaluated with the session (1 call per hit), with the DenseANN
+// single-row path (as used by the KinKal hit updaters) and with the DenseANN batch path
+// (as used by FlagBkgHits and TrackQuality).  The time per hit and the largest deviation
+// from the session are printed; the job fails if a deviation is larger than the tolerance.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/ConfigTools/inc/ConfigFileLookupPolicy.hh"
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
+#include "Offline/Mu2eKinKal/inc/TrainSign.hxx"
+#include "Offline/Mu2eKinKal/inc/TrainCluster.hxx"
+#include "Offline/TrkHitReco/inc/TrainBkgDiag.hxx"
+#include "Offline/TrkHitReco/inc/TrainBkgDiagStationChi2SLine.hxx"
+#include "Offline/TrkDiag/inc/TrkQual_ANN1.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mu2e {
+
+  class DenseANNBenchmark : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<unsigned> nHits{Name("nHits"), Comment("Number of random hits per network"), 200000};
+        fhicl::Atom<unsigned> batchSize{Name("batchSize"), Comment("Number of hits per batch inference"), 256};
+        fhicl::Atom<double> inputSigma{Name("inputSigma"), Comment("Width of the gaussian input distribution"), 2.0};
+        fhicl::Atom<double> tolerance{Name("tolerance"), Comment("Largest allowed deviation from the SOFIE output"), 1.e-4};
+        fhicl::Atom<unsigned> seed{Name("seed"), Comment("Seed for the input generator"), 12345};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit DenseANNBenchmark(const Parameters& conf) : art::EDAnalyzer(conf), conf_(conf()) {}
+
+      void beginJob() override;
+      void analyze(const art::Event&) override {};
+
+    private:
+      template <class SESSION> void run(std::string const& name, std::string const& filename,
+          DenseANN::Activation hidden, DenseANN::Activation output) const;
+
+      Config conf_;
+  };
+
+  namespace {
+    template <typename F> double nsPerHit(size_t nhits, F const& f) {
+      auto start = std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double,std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count()/nhits;
+    }
+
+    double maxDeviation(std::vector<float> const& a, std::vector<float> const& b) {
+      double dmax(0.);
+      for(size_t i=0; i < a.size(); ++i) dmax = std::max(dmax, (double)std::abs(a[i]-b[i]));
+      return dmax;
+    }
+  }
+
+  template <class SESSION> void DenseANNBenchmark::run(std::string const& name, std::string const& filename,
+      DenseANN::Activation hidden, DenseANN::Activation output) const {
+    ConfigFileLookupPolicy resolve;
+    std::string path = resolve(filename);
+    SESSION session(path);
+    DenseANN ann(path,hidden,output);
+    DenseANN::Workspace ws;
+
+    size_t nhits = conf_.nHits();
+    size_t nbatch = std::max(1u,conf_.batchSize());
+    size_t nin = ann.nInputs();
+    std::mt19937 gen(conf_.seed());
+    std::normal_distribution<float> gaus(0.,conf_.inputSigma());
+    std::vector<float> input(nhits*nin);
+    for(auto& x : input) x = gaus(gen);
+
+    std::vector<float> sofie(nhits), single(nhits), batch(nhits);
+    double tsofie = nsPerHit(nhits,[&](){
+        for(size_t ihit=0; ihit < nhits; ++ihit) sofie[ihit] = session.infer(input.data()+ihit*nin)[0]; });
+    double tsingle = nsPerHit(nhits,[&](){
+        for(size_t ihit=0; ihit < nhits; ++ihit) single[ihit] = ann.infer(input.data()+ihit*nin,ws); });
+    double tbatch = nsPerHit(nhits,[&](){
+        for(size_t ihit=0; ihit < nhits; ihit += nbatch)
+          ann.infer(input.data()+ihit*nin,std::min(nbatch,nhits-ihit),batch.data()+ihit,ws); });
+    double dsingle = maxDeviation(sofie,single);
+    double dbatch = maxDeviation(sofie,batch);
+
+    std::cout << "DenseANNBenchmark " << std::setw(30) << std::left << name << std::right
+      << " " << nin << " inputs, ns/hit: SOFIE " << std::setprecision(4) << tsofie
+      << " single " << tsingle << " batch(" << nbatch << ") " << tbatch
+      << "  max deviation single " << std::setprecision(2) << dsingle << " batch " << dbatch << std::endl;
+    if(dsingle > conf_.tolerance() || dbatch > conf_.tolerance())
+      throw cet::exception("DenseANNBenchmark") << name << " deviates from SOFIE by more than " << conf_.tolerance() << std::endl;
+  }
+
+  void DenseANNBenchmark::beginJob() {
+    run<TMVA_SOFIE_TrainSign::Session>("TrainSign_Stage1","Offline/Mu2eKinKal/data/TrainSign_Stage1.dat",
+        DenseANN::relu,DenseANN::sigmoid);
+    run<TMVA_SOFIE_TrainCluster::Session>("TrainCluster_Stage1","Offline/Mu2eKinKal/data/TrainCluster_Stage1.dat",
+        DenseANN::relu,DenseANN::sigmoid);
+    run<TMVA_SOFIE_TrainBkgDiag::Session>("TrainBkgDiagStationSpatial","Offline/TrkHitReco/data/TrainBkgDiagStationSpatial.dat",
+        DenseANN::relu,DenseANN::sigmoid);
+    run<TMVA_SOFIE_TrainBkgDiagStationChi2SLine::Session>("TrainBkgDiagStationChi2SLine","Offline/TrkHitReco/data/TrainBkgDiagStationChi2SLine.dat",
+        DenseANN::relu,DenseANN::sigmoid);
+    run<TMVA_SOFIE_TrkQual_ANN1::Session>("TrkQual_ANN1","Offline/TrkDiag/data/TrkQual_ANN1_v1.dat",
+        DenseANN::sigmoid,DenseANN::sigmoid);
+  }
+}
+
+DEFINE_ART_MODULE(mu2e::DenseANNBenchmark)
@@ -13,7 +13,10 @@
 #include "TTree.h"
 #include "TGraph.h"
 #include "TCanvas.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <random>
 
 namespace mu2e {
 
@@ -29,6 +32,8 @@ namespace mu2e {
         fhicl::Atom<int> nbins{ Name("nBins"), Comment("Number of bins for TGraph objects" ),200 };
         fhicl::Atom<double> tmin{ Name("tmin"), Comment("Minimum time to test" ),-5.0 };
         fhicl::Atom<double> tmax{ Name("tmax"), Comment("Maximum time to test" ),45.0 };
+        fhicl::Atom<int> nBench{ Name("nBench"), Comment("If > 0, number of random calls to time and compare with and without lookup tables" ),0 };
+        fhicl::Atom<int> benchPolyOrder{ Name("benchPolyOrder"), Comment("Polynomial order of the lookup to benchmark, 0 for tables" ),0 };
       };
       using Parameters = art::EDAnalyzer::Table<Config>;
       explicit StrawResponseTest(Parameters const& config);
@@ -37,6 +42,7 @@ namespace mu2e {
       void beginJob ( ) override;
       void endJob ( ) override;
     private:
+      void benchmark(StrawResponse const& sresponse) const;
       ProditionsHandle<Tracker> _alignedTracker_h;
       TTree*  srtest_;
       TCanvas* srtcan_;
@@ -47,6 +53,7 @@ namespace mu2e {
       int print_, diag_;
       int nbins_;
       double tmin_, tmax_;
+      int nbench_, benchorder_;
       bool first_;
       ProditionsHandle<StrawResponse> strawResponse_h_;
   };
@@ -58,6 +65,8 @@ namespace mu2e {
   nbins_(config().nbins()),
   tmin_(config().tmin()),
   tmax_(config().tmax()),
+  nbench_(config().nBench()),
+  benchorder_(config().benchPolyOrder()),
   first_(true) {}
 
   StrawResponseTest::~StrawResponseTest() {}
@@ -118,6 +127,61 @@ namespace mu2e {
         t2nerr_->SetPoint(ibin,dtime_,rnerr_);
         t2v_->SetPoint(ibin,dtime_,vinst_);
       }
+      if(nbench_ > 0)benchmark(*sresponse);
+      first_ = false;
+    }
+  }
+
+  // time the per-hit functions with and without the lookup tables, on the
+  // same random inputs, and report the largest differences between them
+  void StrawResponseTest::benchmark(StrawResponse const& sresponse) const {
+    StrawResponse exact(sresponse), lookup(sresponse);
+    exact.clearLookup();
+    lookup.buildLookup(benchorder_);
+    StrawId sid(0,0,0);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> utime(tmin_,tmax_), udist(0.0,2.5),
+      uphi(-M_PI,M_PI), ukedep(0.0,6.0), uwire(-600.0,600.0);
+    std::vector<double> dtime(nbench_), ddist(nbench_), phi(nbench_), kedep(nbench_), wdist(nbench_);
+    for(int i=0;i<nbench_;++i){
+      dtime[i] = utime(gen); ddist[i] = udist(gen); phi[i] = uphi(gen);
+      kedep[i] = ukedep(gen); wdist[i] = fabs(uwire(gen));
+    }
+
+    double drdrift(0.0), dvel(0.0), dderr(0.0), dd2t(0.0), dterr(0.0), dwres(0.0), dhalfv(0.0);
+    for(int i=0;i<nbench_;++i){
+      auto ei = exact.driftInfo(sid,dtime[i],phi[i]);
+      auto li = lookup.driftInfo(sid,dtime[i],phi[i]);
+      drdrift = std::max(drdrift,fabs(ei.rDrift_-li.rDrift_));
+      dvel = std::max(dvel,fabs(ei.driftVelocity_-li.driftVelocity_)/ei.driftVelocity_);
+      dderr = std::max(dderr,fabs(ei.signedDriftError_-li.signedDriftError_));
+      dd2t = std::max(dd2t,fabs(exact.driftDistanceToTime(sid,ddist[i],phi[i])-lookup.driftDistanceToTime(sid,ddist[i],phi[i])));
+      dterr = std::max(dterr,fabs(exact.driftTimeError(sid,ddist[i],0.0)-lookup.driftTimeError(sid,ddist[i],0.0)));
+      dwres = std::max(dwres,fabs(exact.wpRes(kedep[i],wdist[i])-lookup.wpRes(kedep[i],wdist[i])));
+      dhalfv = std::max(dhalfv,fabs(exact.halfPropV(sid,kedep[i])-lookup.halfPropV(sid,kedep[i]))/exact.halfPropV(sid,kedep[i]));
+    }
+    std::cout << "StrawResponse lookup (order " << benchorder_ << ") largest differences over "
+      << nbench_ << " calls:" << std::endl
+      << "  driftInfo rDrift " << drdrift << " mm, dR/dt " << dvel << " relative, signed error " << dderr << " mm" << std::endl
+      << "  driftDistanceToTime " << dd2t << " ns, driftTimeError " << dterr << " ns" << std::endl
+      << "  wpRes " << dwres << " mm, halfPropV " << dhalfv << " relative" << std::endl;
+
+    for(auto const* sr : {&exact,&lookup}){
+      double sum(0.0);
+      auto t0 = std::chrono::steady_clock::now();
+      for(int i=0;i<nbench_;++i) sum += sr->driftInfo(sid,dtime[i],phi[i]).rDrift_;
+      auto t1 = std::chrono::steady_clock::now();
+      for(int i=0;i<nbench_;++i) sum += sr->driftDistanceToTime(sid,ddist[i],phi[i]);
+      auto t2 = std::chrono::steady_clock::now();
+      for(int i=0;i<nbench_;++i) sum += sr->driftTimeError(sid,ddist[i],0.0);
+      auto t3 = std::chrono::steady_clock::now();
+      for(int i=0;i<nbench_;++i) sum += sr->wpRes(kedep[i],wdist[i]) + sr->halfPropV(sid,kedep[i]);
+      auto t4 = std::chrono::steady_clock::now();
+      auto rate = [this](auto start, auto end) {
+        return 1.0e-6*nbench_/std::chrono::duration<double>(end-start).count(); };
+      std::cout << (sr == &exact ? "  model " : "  lookup") << " million calls/s: driftInfo " << rate(t0,t1)
+        << ", driftDistanceToTime " << rate(t1,t2) << ", driftTimeError " << rate(t2,t3)
+        << ", wpRes+halfPropV " << rate(t3,t4) << " (" << sum << ")" << std::endl;
     }
   }
   void StrawResponseTest::endJob(){
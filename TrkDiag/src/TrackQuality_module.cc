@@ -1,6 +1,6 @@
 //
 // Create a TrkQual object
-// using TMVA::SOFIE
+// using a Keras ANN exported with TMVA::SOFIE
 //
 // Original author A. Edmonds
 //
@@ -15,13 +15,13 @@
 // utilities
 #include "Offline/ProditionsService/inc/ProditionsHandle.hh"
 #include "Offline/Mu2eUtilities/inc/MVATools.hh"
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
 #include "Offline/GlobalConstantsService/inc/GlobalConstantsHandle.hh"
 #include "Offline/GlobalConstantsService/inc/ParticleDataList.hh"
 #include "Offline/ConfigTools/inc/ConfigFileLookupPolicy.hh"
 // data
 #include "Offline/RecoDataProducts/inc/KalSeed.hh"
 #include "Offline/RecoDataProducts/inc/MVAResult.hh"
-#include "Offline/TrkDiag/inc/TrkQual_ANN1.hxx"
 // C++
 #include <iostream>
 #include <fstream>
@@ -33,9 +33,6 @@ using namespace std;
 using CLHEP::Hep3Vector;
 using CLHEP::HepVector;
 
-namespace TMVA_SOFIE_TrkQual_ANN1 {
-  class Session;
-}
 namespace mu2e
 {
 
@@ -61,7 +58,8 @@ namespace mu2e
       art::InputTag _kalSeedPtrTag;
       bool _printMVA;
 
-    std::shared_ptr<TMVA_SOFIE_TrkQual_ANN1::Session> mva_;
+    DenseANN mva_;
+    static constexpr size_t nfeatures_ = 7; // the features we trained on
 
   };
 
@@ -73,7 +71,10 @@ namespace mu2e
       produces<MVAResultCollection>();
 
       ConfigFileLookupPolicy configFile;
-      mva_ = std::make_shared<TMVA_SOFIE_TrkQual_ANN1::Session>(configFile(conf().datFilename()));
+      mva_ = DenseANN(configFile(conf().datFilename()),DenseANN::sigmoid,DenseANN::sigmoid);
+      if (mva_.nInputs() != nfeatures_) {
+        throw cet::exception("TrackQuality") << "ANN has " << mva_.nInputs() << " inputs, expected " << nfeatures_;
+      }
     }
 
   void TrackQuality::produce(art::Event& event ) {
@@ -85,10 +86,11 @@ namespace mu2e
     event.getByLabel(_kalSeedPtrTag, kalSeedPtrHandle);
     const auto& kalSeedPtrs = *kalSeedPtrHandle;
 
-    // Go through the tracks and calculate their track qualities
-    for (const auto& kalSeedPtr : kalSeedPtrs) {
-      const auto& kalSeed = *kalSeedPtr;
-      std::array<float,7> features; // the features we trained on
+    // Go through the tracks and fill their features; the track qualities are then calculated together
+    std::vector<float> allfeatures(kalSeedPtrs.size()*nfeatures_,0.0);
+    for (size_t itrk = 0; itrk < kalSeedPtrs.size(); ++itrk) {
+      const auto& kalSeed = *kalSeedPtrs[itrk];
+      float* features = allfeatures.data() + itrk*nfeatures_;
 
       // fill the hit count variables
       int nhits = 0; int nactive = 0; int ndouble = 0; int ndactive = 0; int nnullambig = 0;
@@ -138,10 +140,13 @@ namespace mu2e
           break;
         }
       }
+    }
 
-      auto mvaout = mva_->infer(features.data());
-
-      mvacol->push_back(MVAResult(mvaout[0]));
+    std::vector<float> mvaout(kalSeedPtrs.size());
+    DenseANN::Workspace ws;
+    mva_.infer(allfeatures.data(),kalSeedPtrs.size(),mvaout.data(),ws);
+    for (auto value : mvaout) {
+      mvacol->push_back(MVAResult(value));
     }
 
     if ( (mvacol->size() != kalSeedPtrs.size()) ) {
@@ -11,7 +11,7 @@ namespace mu2e {
   namespace TrkHitReco {
 
 
-    enum FitType {peakminuspedavg=1,peakminusped=2,combopeakfit=3,peakfit=4,firmwarepmp=5};
+    enum FitType {peakminuspedavg=1,peakminusped=2,combopeakfit=3,peakfit=4,firmwarepmp=5,gnpeakfit=6};
 
     class PeakFit {
 
@@ -28,6 +28,7 @@ namespace mu2e {
         void initializeFit(TrkTypes::ADCWaveform const& adcData, PeakFitParams & fit) const;
 
         PeakFit(const StrawResponse& srep, const fhicl::ParameterSet& pset);
+        PeakFit(const StrawResponse& srep, TrkHitReco::FitType fittype) : _srep(srep), _fittype(fittype) {}
         virtual ~PeakFit(){}
 
 
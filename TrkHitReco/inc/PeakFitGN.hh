@@ -0,0 +1,71 @@
+#ifndef TrkHitReco_PeakFitGN_hh
+#define TrkHitReco_PeakFitGN_hh
+//
+// Fit ADC waveforms to the shaping of the straw electronics ADC path without ROOT:
+//   adc(t) = pedestal + A*g(t-t0),
+// where g is the StrawElectronics response to a charge arriving at t0, tabulated once and normalized
+// to a peak of 1, so that A is the peak height (ADC counts).  g is that of a charge in the middle of the
+// longest straws (responseDistance from the end).  The pedestal and A are linear parameters; t0 is
+// found by a fixed number of Gauss-Newton iterations started from the largest sample and from the samples
+// next to it, keeping the lowest chi2.  The charge is that of the fitted shape at the largest sample,
+// as for peak-minus-pedestal.  Waveforms are fit in blocks of nLanes, stored (sample x waveform).  g and
+// its derivative are interpolated linearly in the table at all samples first, so that the sums of the
+// normal equations are vectorized across waveforms.
+//
+#include "Offline/TrkHitReco/inc/PeakFit.hh"
+#include <algorithm>
+#include <vector>
+
+namespace mu2e {
+
+  namespace TrkHitReco {
+
+    class PeakFitGN : public PeakFit
+    {
+      public:
+        static constexpr size_t nLanes = 8; // waveforms fit together
+        static constexpr double responseDistance = 600.0; // distance of the charge to the straw end (mm)
+
+        PeakFitGN(const StrawResponse& srep, const fhicl::ParameterSet& pset);
+        PeakFitGN(const StrawResponse& srep, bool floatPedestal, bool truncateADC, unsigned maxFitIter);
+        virtual ~PeakFitGN(){}
+
+        // fit a single waveform
+        virtual void process(TrkTypes::ADCWaveform const& adcData, PeakFitParams & fit) const;
+        // fit many waveforms in 1 call; fits is resized to match
+        void process(std::vector<TrkTypes::ADCWaveform const*> const& adcData, std::vector<PeakFitParams>& fits) const;
+
+        // equivalent of peak-minus-pedestal (ADC counts), the fitted shape at the largest sample after the
+        // presamples less the pedestal, and time of the peak of a fit from this class
+        double peakMinusPedEquivalent(PeakFitParams const& fit) const;
+        double peakTime(PeakFitParams const& fit) const { return fit._time + _tpeak; }
+
+      protected:
+        bool     _floatPedestal;   // float pedestal in fit, otherwise fixed to the StrawResponse value
+        bool     _truncateADC;     // ignore samples at the ADC maximum
+        unsigned _maxFitIter;      // number of Gauss-Newton iterations
+        float    _chargeScale;     // pC per ADC count of peak height, as in PeakFit::peakMinusPed
+        std::vector<float> _shape;  // response to a charge, normalized to a peak of 1
+        std::vector<float> _dshape; // its time derivative (1/ns)
+        float    _tstart;          // time of _shape[0] WRT the charge (ns)
+        float    _tpeak;           // time of the peak WRT the charge (ns)
+        float    _rate;            // table bins per ns
+
+      private:
+        // scratch space of (sample x waveform): ADC values, weights, shape and its derivative
+        struct Workspace { std::vector<float> y, w, g, dg; };
+        // fit up to nLanes waveforms
+        void fitBlock(TrkTypes::ADCWaveform const* const* adcData, size_t nwf, PeakFitParams* fits,
+            Workspace& ws) const;
+        // shape and its derivative at time t WRT the charge
+        void shapeAt(float t, float& g, float& dg) const {
+          float x = std::min(std::max((t-_tstart)*_rate,0.0f),static_cast<float>(_shape.size()-2));
+          size_t i = static_cast<size_t>(x);
+          float f = x - i;
+          g = _shape[i] + f*(_shape[i+1]-_shape[i]);
+          dg = _dshape[i] + f*(_dshape[i+1]-_dshape[i]);
+        }
+    };
+  }
+}
+#endif
@@ -26,8 +26,9 @@ namespace mu2e {
           bool filter,
           float ctE, float ctMinT, float ctMaxT, bool usecc, float clusterDt);
 
+      // flag the hits on the straws coupled to a large hit (see TrackerTopology) that follow it in time
       void flagCrossTalk(std::unique_ptr<StrawHitCollection> const& shCol,
-          std::unique_ptr<ComboHitCollection> const& chCol) const;
+          std::unique_ptr<ComboHitCollection> const& chCol, Tracker const& tt) const;
 
       bool createComboHit(EventWindowMarker const& ewm, size_t isd, std::unique_ptr<ComboHitCollection> const& chCol,
           std::unique_ptr<StrawHitCollection> const& shCol,
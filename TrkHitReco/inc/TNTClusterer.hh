@@ -1,6 +1,9 @@
 //
 // Two Niveau Threshold (TNT) algorithm, optimized version of two level threshold clustering originally developed from Dave Brown.
 // Include fast preFilterting algorithm as well
+// Candidate clusters are looked up in a (time, x, y) grid, and cluster centroids are updated incrementally as hits
+// join or leave, when RegressionMode is off. RegressionMode, the default, runs the original time-bucket scan and
+// full centroid recalculation instead; the grid search gives the same hits but moves centroids by up to 2e-4 mm.
 //
 //  Bertrand Echenard (2017) CIT
 //
@@ -13,6 +16,9 @@
 #include "fhiclcpp/types/Sequence.h"
 
 #include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
 
 
 
@@ -52,6 +58,7 @@ namespace mu2e {
         fhicl::Sequence<std::string>  bkgmsk{           Name("BackgroundMask"),   Comment("Bkg hit selection mask") };
         fhicl::Sequence<std::string>  sigmsk{           Name("SignalMask"),       Comment("Signal hit selection mask") };
         fhicl::Atom<bool>             testflag{         Name("TestFlag"),         Comment("Test hit flags") };
+        fhicl::Atom<bool>             regressionMode{   Name("RegressionMode"),   Comment("Reproduce the original time-scan algorithm bit-for-bit"),true };
         fhicl::Atom<int>              diag{             Name("Diag"),             Comment("Diagnosis level"),0 };
       };
 
@@ -67,9 +74,52 @@ namespace mu2e {
     private:
       static constexpr int numBuckets_ =256; //number of buckets to store the cluster ids vs time
 
+      // weighted sums over the hits of a cluster, phi is taken relative to the seed hit
+      struct CentroidSums
+      {
+        CentroidSums(float phiref): phiref_(phiref) {};
+
+        float        phiref_;
+        double       sumw_ = 0.0, sumt_ = 0.0, sumr_ = 0.0, sump_ = 0.0;
+      };
+
+      // clusters bucketed in (time, x, y). A time cell groups tcell_ time buckets, and the x-y cells are at least as wide
+      // as the maximum hit-cluster distance, so only neighbouring cells need to be searched. The clusters present at the
+      // start of a pass are sorted by cell, those created during the pass are chained in a linked list per cell
+      struct ClusterGrid
+      {
+        struct Entry
+        {
+          float        x_, y_, t_;
+          int          ic_, bucket_;
+          int          next_ = -1;
+        };
+
+        int          xCell     (float x) const {return std::min(std::max(int((x-x0_)/cell_),0),nx_-1);}
+        int          yCell     (float y) const {return std::min(std::max(int((y-y0_)/cell_),0),ny_-1);}
+        int          cell      (int it, int ix, int iy) const {return (it*ny_+iy)*nx_+ix;}
+        int          cell      (const Entry& entry) const {return cell(entry.bucket_/tcell_,xCell(entry.x_),yCell(entry.y_));}
+
+        float               x0_ = 0.0f, y0_ = 0.0f, cell_ = 1.0f;
+        int                 nx_ = 1, ny_ = 1, nt_ = 1, tcell_ = 1;
+        std::vector<Entry>  entries_; // clusters sorted by cell
+        std::vector<int>    offsets_; // start of each cell in entries_
+        std::vector<Entry>  added_;   // clusters created during the pass
+        std::vector<int>    head_;    // last cluster created in each cell, index in added_
+      };
+
+      int      timeBucket      (float time) const {return std::min(std::max(int(time/tbin_),0),numBuckets_-1);}
       void     initClustering  (const ComboHitCollection& chcol, std::vector<BkgHit>& hinfo);
       void     doClustering    (const ComboHitCollection& chcol, std::vector<BkgCluster>& clusters, std::vector<BkgHit>& hinfo);
-      unsigned formClusters    (const ComboHitCollection& chcol, std::vector<BkgCluster>& clusters, std::vector<BkgHit>& hinfo);
+      unsigned formClusters    (const ComboHitCollection& chcol, std::vector<BkgCluster>& clusters, std::vector<BkgHit>& hinfo,
+                                std::vector<CentroidSums>& sums);
+      int      findClosest     (const ComboHit& chit, const std::vector<BkgCluster>& clusters,
+                                const std::array<std::vector<int>, numBuckets_>& clusterIndices, float& mindist) const;
+      void     fillGrid        (const std::vector<BkgCluster>& clusters);
+      void     addToGrid       (int ic, const BkgCluster& cluster);
+      int      findClosestGrid (const ComboHit& chit, const std::vector<BkgCluster>& clusters, float& mindist) const;
+      void     addToSums       (CentroidSums& sums, const ComboHit& chit, float sign) const;
+      void     updateCentroid  (BkgCluster& cluster, const CentroidSums& sums, const ComboHitCollection& chcol, std::vector<BkgHit>& hinfo);
       void     mergeClusters   (std::vector<BkgCluster>& clusters, const ComboHitCollection& chcol, std::vector<BkgHit>& hinfo,
                                 float dt, float dd2);
       void     mergeTwoClusters(BkgCluster& clu1, BkgCluster& clu2);
@@ -84,6 +134,7 @@ namespace mu2e {
       float                   dt_;
       int                     minClusterHits_;
       float                   maxwt_;
+      float                   md_;
       float                   md2_;
       float                   trms2inv_;
       float                   maxHitdt_;
@@ -94,8 +145,11 @@ namespace mu2e {
       StrawHitFlag            bkgmask_;
       StrawHitFlag            sigmask_;
       bool                    testflag_;
+      bool                    regression_;
+      bool                    incremental_;
       int                     diag_;
       BkgCluster::distMethod  distMethodFlag_;
+      ClusterGrid             grid_;
   };
 }
 #endif
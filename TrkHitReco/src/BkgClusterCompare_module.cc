@@ -0,0 +1,112 @@
+//
+// Compare the background clusters of 2 FlagBkgHits instances run on the same hits, for instance with the
+// TNTClusterer in RegressionMode and in the grid mode.  Both must partition the hits into the same clusters;
+// the centroids of matching clusters may differ by at most MaxDistance and MaxTimeDifference.  The job fails
+// on the first difference.  Output hits with different background flags are counted, not failed: a centroid
+// shift can move a cluster across a classification cut.
+//
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+
+#include "Offline/RecoDataProducts/inc/BkgCluster.hh"
+#include "Offline/RecoDataProducts/inc/ComboHit.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+namespace mu2e {
+
+  class BkgClusterCompare : public art::EDAnalyzer {
+    public:
+      struct Config {
+        using Name = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<art::InputTag> reference{Name("Reference"), Comment("Reference FlagBkgHits")};
+        fhicl::Atom<art::InputTag> test{Name("Test"), Comment("FlagBkgHits compared to the reference")};
+        fhicl::Atom<float> maxDistance{Name("MaxDistance"), Comment("Max transverse distance of matching cluster centroids (mm)"), 1.0e-3};
+        fhicl::Atom<float> maxTimeDifference{Name("MaxTimeDifference"), Comment("Max time difference of matching clusters (ns)"), 1.0e-3};
+      };
+      typedef art::EDAnalyzer::Table<Config> Parameters;
+
+      explicit BkgClusterCompare(const Parameters& conf);
+
+      void analyze(const art::Event& event) override;
+      void endJob() override;
+
+    private:
+      art::InputTag ref_, test_;
+      float maxdist_, maxdt_;
+      size_t nevents_ = 0;
+      size_t nclusters_ = 0;
+      size_t nhits_ = 0;
+      size_t nflagdiff_ = 0;
+      float maxdistfound_ = 0.0;
+      float maxdtfound_ = 0.0;
+  };
+
+  BkgClusterCompare::BkgClusterCompare(const Parameters& conf) :
+    art::EDAnalyzer(conf),
+    ref_(conf().reference()),
+    test_(conf().test()),
+    maxdist_(conf().maxDistance()),
+    maxdt_(conf().maxTimeDifference()) {
+      consumes<ComboHitCollection>(ref_);
+      consumes<BkgClusterCollection>(ref_);
+      consumes<ComboHitCollection>(test_);
+      consumes<BkgClusterCollection>(test_);
+    }
+
+  void BkgClusterCompare::analyze(const art::Event& event) {
+    auto const& hits = *event.getValidHandle<ComboHitCollection>(ref_);
+    auto const& clusters = *event.getValidHandle<BkgClusterCollection>(ref_);
+    auto const& thits = *event.getValidHandle<ComboHitCollection>(test_);
+    auto const& tclusters = *event.getValidHandle<BkgClusterCollection>(test_);
+    if(hits.size() != thits.size() || clusters.size() != tclusters.size())
+      throw cet::exception("BkgClusterCompare") << event.id() << ": " << ref_ << " has " << hits.size() << " hits and "
+        << clusters.size() << " clusters, " << test_ << " has " << thits.size() << " and " << tclusters.size() << std::endl;
+    // clusters with equal times may come in either order: match them by their (sorted) hits
+    std::map<std::vector<unsigned>,size_t> refclusters;
+    for(size_t icl=0; icl < clusters.size(); ++icl){
+      auto chits = clusters[icl].hits();
+      std::sort(chits.begin(),chits.end());
+      refclusters.emplace(std::move(chits),icl);
+    }
+    for(size_t icl=0; icl < tclusters.size(); ++icl){
+      auto const& tcluster = tclusters[icl];
+      auto chits = tcluster.hits();
+      std::sort(chits.begin(),chits.end());
+      auto iref = refclusters.find(chits);
+      if(iref == refclusters.end())
+        throw cet::exception("BkgClusterCompare") << event.id() << ": " << test_ << " cluster " << icl
+          << " has no " << ref_ << " cluster with the same hits" << std::endl;
+      auto const& cluster = clusters[iref->second];
+      float dist = std::hypot(cluster.pos().x()-tcluster.pos().x(),cluster.pos().y()-tcluster.pos().y());
+      float dt = std::fabs(cluster.time()-tcluster.time());
+      if(dist > maxdist_ || dt > maxdt_)
+        throw cet::exception("BkgClusterCompare") << event.id() << ": " << test_ << " cluster " << icl << " is "
+          << dist << " mm and " << dt << " ns from its " << ref_ << " cluster" << std::endl;
+      maxdistfound_ = std::max(maxdistfound_,dist);
+      maxdtfound_ = std::max(maxdtfound_,dt);
+    }
+    for(size_t ihit=0; ihit < hits.size(); ++ihit){
+      if(!(hits[ihit].flag() == thits[ihit].flag())) ++nflagdiff_;
+    }
+    ++nevents_;
+    nclusters_ += clusters.size();
+    nhits_ += hits.size();
+  }
+
+  void BkgClusterCompare::endJob() {
+    std::cout << "BkgClusterCompare: " << ref_ << " and " << test_ << " agree on " << nclusters_ << " clusters in "
+      << nevents_ << " events, max centroid distance " << maxdistfound_ << " mm and time difference " << maxdtfound_
+      << " ns; " << nflagdiff_ << " of " << nhits_ << " hits have different flags" << std::endl;
+  }
+}
+
+using mu2e::BkgClusterCompare;
+DEFINE_ART_MODULE(BkgClusterCompare)
@@ -18,8 +18,7 @@
 
 #include "Offline/TrkHitReco/inc/TNTClusterer.hh"
 #include "Offline/TrkHitReco/inc/Chi2Clusterer.hh"
-#include "Offline/TrkHitReco/inc/TrainBkgDiag.hxx"
-#include "Offline/TrkHitReco/inc/TrainBkgDiagStationChi2SLine.hxx"
+#include "Offline/Mu2eUtilities/inc/DenseANN.hh"
 
 //root
 #include "TMath.h"
@@ -27,11 +26,6 @@
 #include <string>
 #include <vector>
 
-//Inference class
-namespace TMVA_SOFIE_TrainBkgDiagStationChi2SLine {
-  class Session;
-}
-
 namespace mu2e
 {
 
@@ -80,8 +74,7 @@ namespace mu2e
       bool                                        useSLine_;
       float                                       kerasQ_;
       int                                         iev_;
-      std::shared_ptr<TMVA_SOFIE_TrainBkgDiag::Session> sofiePtr1;
-      std::shared_ptr<TMVA_SOFIE_TrainBkgDiagStationChi2SLine::Session> sofiePtr2;
+      DenseANN                                    kerasANN_;
 
       void classifyCluster(BkgClusterCollection& bkgccol, StrawHitFlagCollection& chfcol, const ComboHitCollection& chcol) const;
       int  findClusterIdx( BkgClusterCollection& bkgccol, unsigned ich) const;
@@ -141,10 +134,11 @@ namespace mu2e
       }
 
       auto kerasWgtsFile = configFile(kerasW_);
-      switch ( useSLine_ ){
-        case 0 :  sofiePtr1 = std::make_shared<TMVA_SOFIE_TrainBkgDiag::Session>(kerasWgtsFile);break;
-        case 1 :  sofiePtr2 = std::make_shared<TMVA_SOFIE_TrainBkgDiagStationChi2SLine::Session>(kerasWgtsFile);break;
-      }
+      kerasANN_ = DenseANN(kerasWgtsFile,DenseANN::relu,DenseANN::sigmoid);
+      size_t nkeras = useSLine_ ? 12 : 9;
+      if (kerasANN_.nInputs() != nkeras)
+        throw cet::exception("RECO")<< "FlagBkgHits: Keras weights " << kerasW_ << " have " << kerasANN_.nInputs()
+        << " inputs, expected " << nkeras << std::endl;
 
       StrawIdMask mask(config().outputLevel());
       level_ = mask.level();
@@ -249,7 +243,14 @@ namespace mu2e
   //------------------------------------------------------------------------------------------
   void FlagBkgHits::classifyCluster(BkgClusterCollection& bkgccol, StrawHitFlagCollection& chfcol, const ComboHitCollection& chcol) const
   {
-    for (auto& cluster : bkgccol) {
+    // the input variables of the selected clusters are collected and classified together
+    size_t nkeras = kerasANN_.nInputs();
+    std::vector<float> kerasin;
+    std::vector<size_t> kerasclust;
+    kerasin.reserve(bkgccol.size()*nkeras);
+    kerasclust.reserve(bkgccol.size());
+    for (size_t icl=0; icl < bkgccol.size(); ++icl) {
+      auto& cluster = bkgccol[icl];
       // count hits and planes
       std::array<int,StrawId::_nplanes> hitplanes{0};
       for (const auto& chit : cluster.hits()) {
@@ -339,23 +340,28 @@ namespace mu2e
         kerasvars[10] = nsthits > 0 ? sumYaw/sumwYaw : 0.;
         kerasvars[11] = sumEcc/sumwEcc;
 
-        std::vector<float> kerasout;
-        switch ( useSLine_ ){
-        case 0 : kerasout = sofiePtr1->infer(kerasvars.data());break;
-        case 1 : kerasout = sofiePtr2->infer(kerasvars.data());break;
-        }
-        cluster.setKerasQ(kerasout[0]);
-        if(debug_>0)std::cout << "kerasout = " << kerasout[0] << std::endl;
-
-        StrawHitFlag flag(StrawHitFlag::bkgclust);
-        if (cluster.getKerasQ()> kerasQ_) {
-          flag.merge(StrawHitFlag(StrawHitFlag::bkg));
-          cluster._flag.merge(BkgClusterFlag::bkg);
-        }
-        for (const auto& chit : cluster.hits()) chfcol[chit].merge(flag);
+        kerasin.insert(kerasin.end(),kerasvars.begin(),kerasvars.begin()+nkeras);
+        kerasclust.push_back(icl);
       } else
         cluster.setKerasQ(-1.0);
     }
+
+    std::vector<float> kerasout(kerasclust.size());
+    DenseANN::Workspace ws;
+    kerasANN_.infer(kerasin.data(),kerasclust.size(),kerasout.data(),ws);
+
+    for (size_t ik=0; ik < kerasclust.size(); ++ik) {
+      auto& cluster = bkgccol[kerasclust[ik]];
+      cluster.setKerasQ(kerasout[ik]);
+      if(debug_>0)std::cout << "kerasout = " << kerasout[ik] << std::endl;
+
+      StrawHitFlag flag(StrawHitFlag::bkgclust);
+      if (cluster.getKerasQ()> kerasQ_) {
+        flag.merge(StrawHitFlag(StrawHitFlag::bkg));
+        cluster._flag.merge(BkgClusterFlag::bkg);
+      }
+      for (const auto& chit : cluster.hits()) chfcol[chit].merge(flag);
+    }
   }
 
 
@@ -0,0 +1,49 @@
+//
+// Build the z- and time-ordered, structure-of-arrays copy of a ComboHit collection shared by the
+// pattern recognition modules (DeltaFinder, CalHelixFinder, AgnosticHelixFinder), so that the hits
+// are sorted once per event instead of once per module
+//
+#include "fhiclcpp/types/Atom.h"
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "Offline/RecoDataProducts/inc/ComboHit.hh"
+#include "Offline/RecoDataProducts/inc/ComboHitStore.hh"
+
+namespace mu2e {
+
+  class MakeComboHitStore : public art::EDProducer {
+
+    public:
+      struct Config
+      {
+        using Name    = fhicl::Name;
+        using Comment = fhicl::Comment;
+        fhicl::Atom<art::InputTag>    CHC     { Name("ComboHitCollection"),    Comment("Input ComboHit collection") };
+        fhicl::Atom<float>            tbin    { Name("TimeBin"),               Comment("Width of the time bins of each face (ns)") };
+      };
+
+      explicit MakeComboHitStore(const art::EDProducer::Table<Config>& config);
+      void produce( art::Event& e) override;
+
+    private:
+      art::ProductToken<ComboHitCollection> const _chctoken;
+      float _tbin;
+  };
+
+  MakeComboHitStore::MakeComboHitStore(const art::EDProducer::Table<Config>& config) :
+    EDProducer{config},
+    _chctoken{consumes<ComboHitCollection>(config().CHC())},
+    _tbin(config().tbin())
+  {
+    produces<ComboHitStore>();
+  }
+
+  void MakeComboHitStore::produce(art::Event& event)
+  {
+    auto chcH = event.getValidHandle(_chctoken);
+    event.put(std::make_unique<ComboHitStore>(*chcH,chcH.id(),_tbin));
+  }
+}
+
+DEFINE_ART_MODULE(mu2e::MakeComboHitStore)
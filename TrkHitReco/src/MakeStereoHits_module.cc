@@ -335,42 +335,26 @@ namespace mu2e {
       init = true;
       // initialize
       const Tracker& tt(*GeomHandle<Tracker>());
-      // establihit the extent of a panel using the longest straw (0)
-      Straw const& straw = tt.getStraw(StrawId(0,0,0));
-      float phi0 = (straw.getMidPoint()-straw.halfLength()*straw.getDirection()).phi();
-      float phi1 = (straw.getMidPoint()+straw.halfLength()*straw.getDirection()).phi();
-      float lophi = std::min(phi0,phi1);
-      float hiphi = std::max(phi0,phi1);
-      float phiwidth = hiphi-lophi;
-      if (phiwidth>M_PI) phiwidth = 2*M_PI-phiwidth;
-      if(_debug > 1)std::cout << "Panel Phi width = " << phiwidth << std::endl;
+      // the tracker topology lists the panels overlapping in phi: select those that can form stereo hits
+      TrackerTopology const& topology = tt.topology();
+      if(_debug > 1)std::cout << "Panel Phi width = " << topology.panelPhiWidth() << std::endl;
       // loop over all unique panels
       for(size_t ipla = 0;ipla < StrawId::_nplanes; ++ipla) {
         for(int ipan=0;ipan<StrawId::_npanels;++ipan){
           StrawId sid(ipla,ipan,0);
           uint16_t upan = sid.uniquePanel();
-          Straw const& straw = tt.getStraw(StrawId(ipla,ipan,0));
-          float phi = straw.getMidPoint().phi();
-          if(_debug > 1)std::cout << "Plane " << ipla << " Panel " << ipan << " phi = " << phi << " z = " << straw.getMidPoint().z() << std::endl;
-          // loop over nearby panels and check for an overlap
-          for(size_t jpla = 0;jpla < StrawId::_nplanes; ++jpla) {
-            for(int jpan=0;jpan<StrawId::_npanels;++jpan){
-              StrawId osid(jpla,jpan,0);
-              if(osid != sid && _smask.equal(osid,sid) && (unsigned)abs(osid.uniqueFace() - sid.uniqueFace()) <= _maxfsep ) {
-                Straw const& ostraw = tt.getStraw(StrawId(jpla,jpan,0));
-                float dphi = fabs(fmod(phi - ostraw.getMidPoint().phi(),2*M_PI));
-                if (dphi > M_PI) dphi = 2*M_PI-dphi;
-                if(_debug > 1)std::cout << "Test Plane " << jpla << " Panel " << jpan << " dphi " << dphi << std::endl;
-                if (dphi < phiwidth){
-                  // insure the straws aren't parallel and are close enough in Z
-                  double wdot = fabs(straw.direction().dot(ostraw.direction()));
-                  double dz = fabs((straw.origin()-ostraw.origin()).z());
-                  if(_debug > 1)std::cout << "Dz " << dz << " wdot " << wdot << std::endl;
-                  if(wdot < _maxwdot && dz < _maxDz ){
-                    if(_debug > 1)std::cout << "Added overlapping panel " << std::endl;
-                    _panelOverlap[upan].push_back(osid);
-                  }
-                }
+          Straw const& straw = tt.getStraw(sid);
+          if(_debug > 1)std::cout << "Plane " << ipla << " Panel " << ipan << " phi = " << straw.getMidPoint().phi() << " z = " << straw.getMidPoint().z() << std::endl;
+          for(auto const& osid : topology.overlappingPanels(sid)) {
+            if(_smask.equal(osid,sid) && (unsigned)abs(osid.uniqueFace() - sid.uniqueFace()) <= _maxfsep ) {
+              Straw const& ostraw = tt.getStraw(osid);
+              // insure the straws aren't parallel and are close enough in Z
+              double wdot = fabs(straw.direction().dot(ostraw.direction()));
+              double dz = fabs((straw.origin()-ostraw.origin()).z());
+              if(_debug > 1)std::cout << "Test Plane " << osid.plane() << " Panel " << osid.panel() << " Dz " << dz << " wdot " << wdot << std::endl;
+              if(wdot < _maxwdot && dz < _maxDz ){
+                if(_debug > 1)std::cout << "Added overlapping panel " << std::endl;
+                _panelOverlap[upan].push_back(osid);
               }
             }
           }
@@ -0,0 +1,234 @@
+// fit waveforms to the shaping function with Gauss-Newton iterations, many waveforms at a time
+#include "Offline/TrkHitReco/inc/PeakFitGN.hh"
+#include "cetlib_except/exception.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+
+namespace mu2e {
+
+  namespace TrkHitReco {
+
+    PeakFitGN::PeakFitGN(const StrawResponse& srep, const fhicl::ParameterSet& pset) :
+      PeakFitGN(srep,
+          pset.get<bool>(    "FloatPedestal",true),
+          pset.get<bool>(    "TruncateADC",true),
+          pset.get<unsigned>("MaxFitIterations",5))
+    {}
+
+    PeakFitGN::PeakFitGN(const StrawResponse& srep, bool floatPedestal, bool truncateADC, unsigned maxFitIter) :
+      PeakFit(srep,FitType::gnpeakfit),
+      _floatPedestal(floatPedestal),
+      _truncateADC(truncateADC),
+      _maxFitIter(maxFitIter),
+      _chargeScale(srep.adcLSB()*srep.peakMinusPedestalEnergyScale()),
+      _rate(1.0/srep.responseTimeStep())
+    {
+      // tabulate the response normalized to its peak, starting just before it rises
+      std::vector<double> shape;
+      double tstart = srep.responseShape(StrawElectronics::adc,responseDistance,shape);
+      auto imax = std::distance(shape.begin(),std::max_element(shape.begin(),shape.end()));
+      if(shape.size() < 2 || !(shape[imax] > 0.0))
+        throw cet::exception("RECO") << "mu2e::PeakFitGN: no StrawElectronics ADC response to fit" << std::endl;
+      double gmax = shape[imax];
+      long istart = imax;
+      while(istart > 0 && std::fabs(shape[istart-1]) > 1.0e-6*gmax) --istart;
+      istart = std::max(istart-1,0L);
+      _tstart = tstart + istart/_rate;
+      _tpeak = tstart + imax/_rate;
+      _shape.reserve(shape.size()-istart);
+      for(size_t ibin=istart; ibin < shape.size(); ++ibin) _shape.push_back(shape[ibin]/gmax);
+      _dshape.resize(_shape.size());
+      for(size_t ibin=1; ibin+1 < _shape.size(); ++ibin) _dshape[ibin] = 0.5f*(_shape[ibin+1]-_shape[ibin-1])*_rate;
+      _dshape.front() = (_shape[1]-_shape[0])*_rate;
+      _dshape.back() = 0.0f; // the response is constant beyond the table
+    }
+
+    void PeakFitGN::process(TrkTypes::ADCWaveform const& adcData, PeakFitParams & fit) const
+    {
+      Workspace ws;
+      TrkTypes::ADCWaveform const* wf(&adcData);
+      fitBlock(&wf,1,&fit,ws);
+    }
+
+    void PeakFitGN::process(std::vector<TrkTypes::ADCWaveform const*> const& adcData, std::vector<PeakFitParams>& fits) const
+    {
+      fits.resize(adcData.size());
+      Workspace ws;
+      for(size_t iwf=0; iwf < adcData.size(); iwf += nLanes)
+        fitBlock(adcData.data()+iwf,std::min(nLanes,adcData.size()-iwf),fits.data()+iwf,ws);
+    }
+
+    double PeakFitGN::peakMinusPedEquivalent(PeakFitParams const& fit) const
+    {
+      return fit._charge/_chargeScale;
+    }
+
+    void PeakFitGN::fitBlock(TrkTypes::ADCWaveform const* const* adcData, size_t nwf, PeakFitParams* fits,
+        Workspace& ws) const
+    {
+      // transpose the waveforms to (sample x lane).  Missing and saturated samples get 0 weight
+      size_t nsamples(0);
+      for(size_t iwf=0; iwf < nwf; ++iwf) nsamples = std::max(nsamples,adcData[iwf]->size());
+      if(ws.y.size() < nsamples*nLanes){
+        ws.y.resize(nsamples*nLanes);
+        ws.w.resize(nsamples*nLanes);
+        ws.g.resize(nsamples*nLanes);
+        ws.dg.resize(nsamples*nLanes);
+      }
+      std::fill(ws.y.begin(),ws.y.begin()+nsamples*nLanes,0.0f);
+      std::fill(ws.w.begin(),ws.w.begin()+nsamples*nLanes,0.0f);
+      const TrkTypes::ADCValue maxadc = _srep.maxADC();
+      for(size_t iwf=0; iwf < nwf; ++iwf){
+        auto const& adc = *adcData[iwf];
+        for(size_t isamp=0; isamp < adc.size(); ++isamp){
+          ws.y[isamp*nLanes+iwf] = adc[isamp];
+          ws.w[isamp*nLanes+iwf] = (_truncateADC && adc[isamp] >= maxadc) ? 0.0f : 1.0f;
+        }
+      }
+
+      // starting values: pedestal from the presamples, peak at the largest later sample
+      const float dt = _srep.adcPeriod();
+      const float tmin = -_tpeak;
+      const float tmax = nsamples*dt;
+      const float maxdt0 = 0.5f*_tpeak;
+      const size_t npre = _srep.nADCPreSamples();
+      std::array<float,nLanes> ped0, amp0, tpeak;
+      for(size_t iwf=0; iwf < nLanes; ++iwf){
+        ped0[iwf] = _srep.ADCPedestal();
+        amp0[iwf] = 1.0f;
+        tpeak[iwf] = 0.0f;
+        if(iwf >= nwf)continue;
+        auto const& adc = *adcData[iwf];
+        if(_floatPedestal && npre > 0 && adc.size() > npre){
+          float sum(0.0);
+          for(size_t isamp=0; isamp < npre; ++isamp) sum += adc[isamp];
+          ped0[iwf] = sum/npre;
+        }
+        size_t imax = std::min(npre,adc.size()-1);
+        for(size_t isamp=imax+1; isamp < adc.size(); ++isamp)
+          if(adc[isamp] > adc[imax]) imax = isamp;
+        amp0[iwf] = std::max(adc[imax]-ped0[iwf],1.0f);
+        tpeak[iwf] = imax*dt;
+      }
+
+      // The chi2 has local minima where t0 crosses a sample time, so the fit is started with the peak
+      // at the largest sample and 1 sample before and after it, and the lowest chi2 is kept
+      static constexpr float starts[] = {0.0f,-1.0f,1.0f};
+      std::array<float,nLanes> bped, bamp, bt0, bchi2, bnused;
+      std::array<bool,nLanes> bok;
+      for(size_t istart=0; istart < std::size(starts); ++istart){
+        std::array<float,nLanes> ped(ped0), amp(amp0), t0;
+        std::array<bool,nLanes> ok;
+        for(size_t il=0; il < nLanes; ++il){
+          t0[il] = std::min(std::max(tpeak[il] + starts[istart]*dt - _tpeak,tmin),tmax);
+          ok[il] = il < nwf;
+        }
+
+        // Gauss-Newton iterations on (pedestal, amplitude, t0); the last pass only computes the chi2
+        std::array<float,nLanes> s00, s01, s02, s11, s12, s22, b0, b1, b2, chi2;
+        for(unsigned iter=0; iter <= _maxFitIter; ++iter){
+          for(size_t il=0; il < nLanes; ++il){
+            s00[il] = s01[il] = s02[il] = s11[il] = s12[il] = s22[il] = 0.0f;
+            b0[il] = b1[il] = b2[il] = chi2[il] = 0.0f;
+          }
+          // the table lookups are done first, so that the sums below are vectorized across waveforms
+          for(size_t il=0; il < nLanes; ++il){
+            for(size_t isamp=0; isamp < nsamples; ++isamp){
+              shapeAt(isamp*dt-t0[il],ws.g[isamp*nLanes+il],ws.dg[isamp*nLanes+il]);
+            }
+          }
+          for(size_t isamp=0; isamp < nsamples; ++isamp){
+            float const* ys = ws.y.data() + isamp*nLanes;
+            float const* wts = ws.w.data() + isamp*nLanes;
+            float const* gs = ws.g.data() + isamp*nLanes;
+            float const* dgs = ws.dg.data() + isamp*nLanes;
+            for(size_t il=0; il < nLanes; ++il){
+              // shape and its derivative WRT t0
+              float g = gs[il];
+              float dg = -amp[il]*dgs[il];
+              float res = ys[il] - ped[il] - amp[il]*g;
+              float wg = wts[il]*g;
+              float wdg = wts[il]*dg;
+              s00[il] += wts[il];
+              s01[il] += wg;
+              s02[il] += wdg;
+              s11[il] += wg*g;
+              s12[il] += wg*dg;
+              s22[il] += wdg*dg;
+              b0[il] += wts[il]*res;
+              b1[il] += wg*res;
+              b2[il] += wdg*res;
+              chi2[il] += wts[il]*res*res;
+            }
+          }
+          if(iter == _maxFitIter)break;
+          for(size_t il=0; il < nLanes; ++il){
+            if(!_floatPedestal){
+              s00[il] = 1.0f;
+              s01[il] = s02[il] = b0[il] = 0.0f;
+            }
+            // solve the symmetric 3x3 normal equations by cofactors
+            float c00 = s11[il]*s22[il] - s12[il]*s12[il];
+            float c01 = s02[il]*s12[il] - s01[il]*s22[il];
+            float c02 = s01[il]*s12[il] - s02[il]*s11[il];
+            float c11 = s00[il]*s22[il] - s02[il]*s02[il];
+            float c12 = s01[il]*s02[il] - s00[il]*s12[il];
+            float c22 = s00[il]*s11[il] - s01[il]*s01[il];
+            float det = s00[il]*c00 + s01[il]*c01 + s02[il]*c02;
+            if(!(det > 0.0f)){
+              ok[il] = false;
+              continue;
+            }
+            float dped = (c00*b0[il] + c01*b1[il] + c02*b2[il])/det;
+            float damp = (c01*b0[il] + c11*b1[il] + c12*b2[il])/det;
+            float dt0 = (c02*b0[il] + c12*b1[il] + c22*b2[il])/det;
+            // limit the time step to half the rise of the shape to keep the linearization valid
+            dt0 = std::min(std::max(dt0,-maxdt0),maxdt0);
+            ped[il] += dped;
+            amp[il] = std::max(amp[il]+damp,1.0e-3f);
+            t0[il] = std::min(std::max(t0[il]+dt0,tmin),tmax);
+          }
+        }
+
+        // keep the best start; a failed fit only replaces another failed fit
+        for(size_t il=0; il < nLanes; ++il){
+          bool better = istart == 0 || (ok[il] && (!bok[il] || chi2[il] < bchi2[il]));
+          if(!better)continue;
+          bped[il] = ped[il];
+          bamp[il] = amp[il];
+          bt0[il] = t0[il];
+          bchi2[il] = chi2[il];
+          bnused[il] = s00[il]; // the last pass counts the samples used
+          bok[il] = ok[il];
+        }
+      }
+
+      const float noise = _srep.analogNoise(StrawElectronics::adc)/_srep.adcLSB();
+      const unsigned npar = _floatPedestal ? 3 : 2;
+      for(size_t iwf=0; iwf < nwf; ++iwf){
+        // The energy scale is calibrated on peak-minus-pedestal, which takes the largest sample after
+        // the presamples, so the amplitude is converted to the largest value of the fitted shape at
+        // those sample times.  This is below the height of the continuous peak unless a sample falls on it
+        float gmax(0.0f), g, dg;
+        for(size_t isamp=npre; isamp < adcData[iwf]->size(); ++isamp){
+          shapeAt(isamp*dt - bt0[iwf],g,dg);
+          gmax = std::max(gmax,g);
+        }
+        auto& fit = fits[iwf];
+        fit = PeakFitParams();
+        fit._pedestal = bped[iwf];
+        fit._time = bt0[iwf];
+        fit._charge = bamp[iwf]*gmax*_chargeScale;
+        fit._chi2 = bchi2[iwf]/(noise*noise);
+        unsigned nused = static_cast<unsigned>(std::lround(bnused[iwf]));
+        fit._ndf = nused > npar ? nused - npar : 0;
+        fit._status = (bok[iwf] && std::isfinite(fit._chi2)) ? 0 : 1;
+        fit.freeParam(PeakFitParams::time);
+        fit.freeParam(PeakFitParams::charge);
+        if(_floatPedestal) fit.freeParam(PeakFitParams::pedestal);
+      }
+    }
+  }
+}
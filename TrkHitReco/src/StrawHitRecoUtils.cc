@@ -7,6 +7,7 @@
 #include "Offline/DataProducts/inc/StrawEnd.hh"
 #include "Offline/DataProducts/inc/EventWindowMarker.hh"
 
+#include <algorithm>
 #include <numeric>
 
 
@@ -26,41 +27,49 @@ namespace mu2e {
     _minE(minE), _maxE(maxE), _minR(minR), _maxR(maxR),
     _filter(filter), _ctE(ctE), _ctMinT(ctMinT), _ctMaxT(ctMaxT), _usecc(usecc), _clusterDt(clusterDt) {
       // Detailed histogram-based waveform fits are no longer supported TODO!
-      if (_fittype != TrkHitReco::FitType::peakminusped && _fittype != TrkHitReco::FitType::peakminuspedavg && _fittype != TrkHitReco::FitType::firmwarepmp)
+      if (_fittype != TrkHitReco::FitType::peakminusped && _fittype != TrkHitReco::FitType::peakminuspedavg && _fittype != TrkHitReco::FitType::firmwarepmp
+          && _fittype != TrkHitReco::FitType::gnpeakfit)
         throw cet::exception("RECO")<<"TrkHitReco: Peak fit " << _fittype << " not implemented " <<  std::endl;
     }
 
 
-  void StrawHitRecoUtils::flagCrossTalk(std::unique_ptr<StrawHitCollection> const& shCol, std::unique_ptr<ComboHitCollection> const& chCol) const {
-    std::vector<std::vector<size_t> > hits_by_panel(StrawId::_nupanels,std::vector<size_t>());
+  void StrawHitRecoUtils::flagCrossTalk(std::unique_ptr<StrawHitCollection> const& shCol, std::unique_ptr<ComboHitCollection> const& chCol,
+      Tracker const& tt) const {
+    std::vector<std::pair<uint16_t,size_t> > hits_by_straw;
     std::vector<size_t> largeHits;
-    std::vector<size_t> largeHitPanels;
 
     size_t numDigis = shCol->size();
+    hits_by_straw.reserve(numDigis);
     largeHits.reserve(numDigis/10);
-    largeHitPanels.reserve(numDigis/10);
 //
     //identify large hit for cross-talk analysis
     for(size_t ish =0; ish < shCol->size(); ++ish){
       auto& sh = (*shCol)[ish];
-      size_t upanel = sh.strawId().uniquePanel();
-      hits_by_panel[upanel].push_back(ish);
-      if (sh.energyDep() >= _ctE) {
-        largeHits.push_back(ish);
-        largeHitPanels.push_back(upanel);
-      }
+      hits_by_straw.emplace_back(sh.strawId().uniqueStraw(),ish);
+      if (sh.energyDep() >= _ctE) largeHits.push_back(ish);
     }
-// loop over large hits and check for correlation with other hits in this panel
-    for (size_t ilarge=0; ilarge < largeHits.size();++ilarge) {
-      const StrawHit& sh = (*shCol)[largeHits[ilarge]];
-      for (size_t jsh : hits_by_panel[largeHitPanels[ilarge]]) {
-        if (jsh==largeHits[ilarge]) continue;
+    if(largeHits.empty())return;
+    std::sort(hits_by_straw.begin(),hits_by_straw.end());
+// flag the hits on a straw that are correlated in time with a large hit
+    auto flagStraw = [&](StrawHit const& sh, size_t ilarge, StrawId const& sid, StrawHitFlag const& flag) {
+      auto first = std::lower_bound(hits_by_straw.begin(),hits_by_straw.end(),std::make_pair(sid.uniqueStraw(),size_t(0)));
+      for(auto ihit = first; ihit != hits_by_straw.end() && ihit->first == sid.uniqueStraw(); ++ihit){
+        size_t jsh = ihit->second;
+        if (jsh==ilarge) continue;
         const StrawHit& sh2 = (*shCol)[jsh];
-        if (sh2.time()-sh.time() > _ctMinT && sh2.time()-sh.time() < _ctMaxT) {
-          if (sh.strawId().samePreamp(sh2.strawId())) (*chCol)[jsh]._flag.merge(StrawHitFlag::elecxtalk);
-          if (sh.strawId().nearestNeighbor(sh2.strawId())) (*chCol)[jsh]._flag.merge(StrawHitFlag::strawxtalk);
-        }
+        if (sh2.time()-sh.time() > _ctMinT && sh2.time()-sh.time() < _ctMaxT) (*chCol)[jsh]._flag.merge(flag);
       }
+    };
+// loop over large hits and check for correlation with hits on the straws coupled to them
+    TrackerTopology const& topology = tt.topology();
+    StrawHitFlag xtalk(StrawHitFlag::elecxtalk);
+    xtalk.merge(StrawHitFlag::strawxtalk);
+    for (size_t ilarge : largeHits) {
+      const StrawHit& sh = (*shCol)[ilarge];
+      StrawId const& sid = sh.strawId();
+      flagStraw(sh,ilarge,sid,xtalk);
+      for (auto const& nid : topology.preampNeighbors(sid)) flagStraw(sh,ilarge,nid,StrawHitFlag::elecxtalk);
+      for (auto const& nid : topology.nearestNeighbors(sid)) flagStraw(sh,ilarge,nid,StrawHitFlag::strawxtalk);
     }
   }
 
@@ -110,7 +119,7 @@ namespace mu2e {
       case TrkHitReco::FitType::peakminuspedavg: default:
         charge = pmp*invgainAvg*srep.peakMinusPedestalEnergyScale();
         break;
-      case TrkHitReco::FitType::peakminusped: case TrkHitReco::FitType::firmwarepmp:
+      case TrkHitReco::FitType::peakminusped: case TrkHitReco::FitType::firmwarepmp: case TrkHitReco::FitType::gnpeakfit:
         charge = pmp*invgainAvg*srep.peakMinusPedestalEnergyScale(sid);
         break;
     }
@@ -23,6 +23,7 @@
 #include "Offline/TrackerConditions/inc/TrackerStatus.hh"
 
 #include "Offline/TrkHitReco/inc/PeakFit.hh"
+#include "Offline/TrkHitReco/inc/PeakFitGN.hh"
 #include "Offline/TrkHitReco/inc/StrawHitRecoUtils.hh"
 
 #include "Offline/RecoDataProducts/inc/ProtonBunchTime.hh"
@@ -52,6 +53,9 @@ namespace mu2e {
         fhicl::Atom<int> diag{ Name("diagLevel"), Comment("Diag level"), 0};
         fhicl::Atom<int> print{ Name("printLevel"), Comment("Print level"), 0};
         fhicl::Atom<int> fittype { Name( "FitType"), Comment("Waveform Fit Type")};
+        fhicl::Atom<bool> floatPedestal{ Name("FloatPedestal"), Comment("Float the pedestal in waveform fits (FitType 6)"), true};
+        fhicl::Atom<bool> truncateADC{ Name("TruncateADC"), Comment("Ignore saturated samples in waveform fits (FitType 6)"), true};
+        fhicl::Atom<unsigned> maxFitIter{ Name("MaxFitIterations"), Comment("Number of Gauss-Newton iterations of waveform fits (FitType 6)"), 5};
         fhicl::Atom<bool> usecc{ Name("UseCalorimeter"), Comment("Use Calo cluster times to filter" )};
         fhicl::Atom<float>clusterDt{ Name("clusterDt"), Comment("Calo cluster time 1/2 window")};
         fhicl::Atom<float>minE{ Name("MinimumEnergy"), Comment("Minimum straw energy deposit (MeV)")};
@@ -89,6 +93,10 @@ namespace mu2e {
       bool  _flagXT; // flag cross-talk
       bool _usecc;
       bool  _useADCWF;
+      bool  _fitADCWF; // fit the waveforms to the shaping function
+      bool  _floatPedestal;
+      bool  _truncateADC;
+      unsigned _maxFitIter;
       int   _printLevel;
       int   _diagLevel;
 
@@ -98,6 +106,10 @@ namespace mu2e {
       art::ProductToken<ProtonBunchTime> const _pbttoken;
       art::ProductToken<EventWindowMarker> const _ewmtoken;
       std::unique_ptr<TrkHitReco::PeakFit> _pfit; // peak fitting algorithm
+      std::unique_ptr<TrkHitReco::PeakFitGN> _wffit; // waveform fitter, FitType 6 only
+      ProditionsHandle<StrawResponse>::cptr_t _wffitResponse; // StrawResponse of _wffit
+      std::vector<TrkTypes::ADCWaveform const*> _adcwfs; // waveforms to fit
+      std::vector<TrkHitReco::PeakFitParams> _wffits; // waveform fit results
       // diagnostic
       TH1F* _maxiter;
       // handles
@@ -136,6 +148,10 @@ namespace mu2e {
     _flagXT(config().flagXT()),
     _usecc(config().usecc()),
     _useADCWF(config().fittype() != mu2e::TrkHitReco::FitType::firmwarepmp ),
+    _fitADCWF(config().fittype() == mu2e::TrkHitReco::FitType::gnpeakfit ),
+    _floatPedestal(config().floatPedestal()),
+    _truncateADC(config().truncateADC()),
+    _maxFitIter(config().maxFitIter()),
     _printLevel(config().print()),
     _diagLevel(config().diag()),
     _sdctoken{consumes<StrawDigiCollection>(config().sdcTag())},
@@ -199,12 +215,27 @@ namespace mu2e {
 
     TrackerStatus const& trackerStatus = _trackerStatus_h.get(event.id());
 
+    // fit all the waveforms together.  The fitter is rebuilt only when the StrawResponse changes
+    if(_fitADCWF){
+      auto srepptr = _strawResponse_h.getPtr(event.id());
+      if(srepptr != _wffitResponse){
+        _wffitResponse = srepptr;
+        _wffit = std::make_unique<TrkHitReco::PeakFitGN>(*_wffitResponse,_floatPedestal,_truncateADC,_maxFitIter);
+      }
+      _adcwfs.clear();
+      for(auto const& adcwf : *sdadcc)_adcwfs.push_back(&adcwf.samples());
+      _wffit->process(_adcwfs,_wffits);
+    }
+
     double pmp(0.0);
     for (size_t isd=0;isd<sdcol.size();++isd) {
       const StrawDigi& digi = sdcol[isd];
       // compute peak-pedestal
       if(!_useADCWF){
         pmp = digi.PMP();
+      } else if(_fitADCWF){
+        pmp = _wffit->peakMinusPedEquivalent(_wffits[isd]);
+        if(_diagLevel > 0)_maxiter->Fill(_wffit->peakTime(_wffits[isd])/srep.adcPeriod());
       } else {
         auto const& adcwf = sdadcc->at(isd).samples();
         ADCWFIter maxiter;
@@ -214,10 +245,10 @@ namespace mu2e {
       _shrUtils.createComboHit(ewm, isd, chCol, shCol, caloClusters, pbtOffset,
           digi.strawId(), digi.TDC(), digi.TOT(), pmp,
           trackerStatus,  srep, tt);
-      //flag straw and electronic cross-talk
-      if(_flagXT){
-        _shrUtils.flagCrossTalk(shCol, chCol);
-      }
+    }
+    //flag straw and electronic cross-talk
+    if(_flagXT){
+      _shrUtils.flagCrossTalk(shCol, chCol, tt);
     }
     if(_writesh)event.put(std::move(shCol));
     intInfo->setNTrackerHits(chCol->size());
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <vector>
 #include <queue>
+#include <utility>
 
 namespace mu2e
 {
@@ -19,6 +20,7 @@ namespace mu2e
     bkgmask_          (config.value().bkgmsk()),
     sigmask_          (config.value().sigmsk()),
     testflag_         (config.value().testflag()),
+    regression_       (config.value().regressionMode()),
     diag_             (config.value().diag())
   {
     float minerr (config.value().minHitError());
@@ -28,9 +30,12 @@ namespace mu2e
     tbin_     =1.0;
     dd2_      = dd_*dd_;
     maxwt_    = 1.0f/minerr;
+    md_       = maxdist;
     md2_      = maxdist*maxdist;
     trms2inv_ = 1.0f/trms/trms;
     distMethodFlag_ = BkgCluster::spatial;
+    // the median can't be updated incrementally
+    incremental_ = !regression_ && !useMedian_;
 
   }
 
@@ -62,15 +67,38 @@ namespace mu2e
   void TNTClusterer::initClustering(const ComboHitCollection& chcol, std::vector<BkgHit>& BkgHits)
   {
      float maxTime(0);
+     float xmin(0),xmax(0),ymin(0),ymax(0);
      for (size_t ich=0;ich<chcol.size();++ich) {
        if (testflag_ && (!chcol[ich].flag().hasAllProperties(sigmask_) || chcol[ich].flag().hasAnyProperty(bkgmask_))) continue;
+       if (BkgHits.empty()) {xmin = xmax = chcol[ich].pos().x();ymin = ymax = chcol[ich].pos().y();}
        BkgHits.emplace_back(BkgHit(ich));
        maxTime = std::max(maxTime,chcol[ich].correctedTime());
+       xmin = std::min(xmin,chcol[ich].pos().x());
+       xmax = std::max(xmax,chcol[ich].pos().x());
+       ymin = std::min(ymin,chcol[ich].pos().y());
+       ymax = std::max(ymax,chcol[ich].pos().y());
      }
      tbin_ = (maxTime+1.0)/float(numBuckets_);
 
-     auto resPred = [&chcol](const BkgHit& x, const BkgHit& y) {return chcol[x.chidx_].wireRes() < chcol[y.chidx_].wireRes();};
-     if (comboInit_) std::sort(BkgHits.begin(),BkgHits.end(),resPred);
+     // slightly wider than the maximum distance, so rounding can't hide a cluster in range.  Centroids outside the
+     // hit range are put in the edge cells, which only adds candidates
+     grid_.cell_ = 1.001f*md_;
+     grid_.x0_   = xmin;
+     grid_.y0_   = ymin;
+     grid_.nx_   = int((xmax-xmin)/grid_.cell_)+1;
+     grid_.ny_   = int((ymax-ymin)/grid_.cell_)+1;
+     grid_.tcell_ = 2*int(maxHitdt_/tbin_)+1;
+     grid_.nt_    = (numBuckets_-1)/grid_.tcell_+1;
+
+     // sort with the resolutions computed once; the comparisons, hence the order, are the same
+     if (comboInit_) {
+       std::vector<std::pair<float,BkgHit>> sorted;
+       sorted.reserve(BkgHits.size());
+       for (const auto& hit : BkgHits) sorted.emplace_back(chcol[hit.chidx_].wireRes(),hit);
+       auto resPred = [](const std::pair<float,BkgHit>& x, const std::pair<float,BkgHit>& y) {return x.first < y.first;};
+       std::sort(sorted.begin(),sorted.end(),resPred);
+       for (size_t ih=0;ih<sorted.size();++ih) BkgHits[ih] = sorted[ih].second;
+     }
   }
 
 
@@ -80,9 +108,10 @@ namespace mu2e
     unsigned niter(0);
     float odist(2.0f*maxDistSum_);
     float tdist(0.0f);
+    std::vector<CentroidSums> sums;
     while ( std::abs(odist - tdist) > maxDistSum_ && niter < maxNiter_ ) {
       ++niter;
-      formClusters(chcol, clusters, BkgHits);
+      formClusters(chcol, clusters, BkgHits, sums);
 
       odist = tdist;
       tdist = 0.0f;
@@ -96,18 +125,19 @@ namespace mu2e
   //-------------------------------------------------------------------------------------------------------------------
   // loop over hits, re-affect them to their original cluster if they are still within the radius, otherwise look at
   // candidate clusters to check if they could be added. If not, make a new cluster.
-  // speed up: don't update clusters who haven't changed + cache cluster id in a given time window in clusterIndex (array if vectors)
+  // speed up: don't update clusters who haven't changed + cache cluster id in a given time window in clusterIndex (array if vectors),
+  // or in the (time, x, y) grid. Without RegressionMode, the centroid sums follow the hits that change cluster
   //
-  unsigned TNTClusterer::formClusters(const ComboHitCollection& chcol, std::vector<BkgCluster>& clusters, std::vector<BkgHit>& BkgHits)
+  unsigned TNTClusterer::formClusters(const ComboHitCollection& chcol, std::vector<BkgCluster>& clusters, std::vector<BkgHit>& BkgHits,
+                                      std::vector<CentroidSums>& sums)
   {
     std::array<std::vector<int>, numBuckets_> clusterIndices;
-    for (size_t ic=0;ic<clusters.size();++ic) {
-      int itime  = int(clusters[ic].time()/tbin_);
-      clusterIndices[itime].emplace_back(ic);
-      clusters[ic].clearHits();
+    if (regression_) {
+      for (size_t ic=0;ic<clusters.size();++ic) clusterIndices[timeBucket(clusters[ic].time())].emplace_back(ic);
     }
+    else fillGrid(clusters);
+    for (auto& cluster : clusters) cluster.clearHits();
 
-    int ditime(int(maxHitdt_/tbin_));
     unsigned nchanged(0);
     for (size_t ihit=0;ihit<BkgHits.size();++ihit) {
 
@@ -120,19 +150,9 @@ namespace mu2e
         continue;
       }
 
-      // -- find closest cluster. restrict search to clusters close in time using the clusterIndices structure
-      int minc(-1);
+      // -- find closest cluster. restrict search to clusters close in time (and space)
       float mindist(dseed_ + 1.0f);
-      int itime = int(chit.correctedTime()/tbin_);
-      int imin = std::max(0,itime-ditime);
-      int imax = std::min(numBuckets_,itime+ditime+1);
-
-      for (int i=imin;i<imax;++i) {
-        for (const auto& ic : clusterIndices[i]) {
-          float dist = distance(clusters[ic],chcol[hit.chidx_]);
-          if (dist < mindist) {mindist = dist;minc = ic;}
-        }
-      }
+      int minc = regression_ ? findClosest(chit, clusters, clusterIndices, mindist) : findClosestGrid(chit, clusters, mindist);
 
       // -- either add hit to existing cluster, form new cluster, or do nothing if hit is "in between"
       if (mindist < dhit_) {
@@ -142,37 +162,37 @@ namespace mu2e
         minc = clusters.size();
         clusters.emplace_back(chit.pos(),chit.correctedTime(),distMethodFlag_);
         clusters[minc].addHit(ihit);
-        int itime = int(chit.correctedTime()/tbin_);
-        clusterIndices[itime].emplace_back(minc);
+        if (regression_) clusterIndices[timeBucket(chit.correctedTime())].emplace_back(minc);
+        else             addToGrid(minc,clusters[minc]);
+        if (incremental_) sums.emplace_back(chit.phi());
       }
       else{
         BkgHits[ihit].distance_ = 10000.0f;
         minc = -1;
       }
 
-      // -- update cluster flag and hit->cluster pointer if association has changed
-      if (minc != -1) {
-        if (hit.clusterIdx_ != minc) {
-          ++nchanged;
-          if (hit.clusterIdx_ != -1) clusters[hit.clusterIdx_]._flag = BkgClusterFlag::update;
-          clusters[minc]._flag = BkgClusterFlag::update;
-        }
-        hit.clusterIdx_ = minc;
-      }
-      else {
+      // -- update cluster flag, centroid sums and hit->cluster pointer if association has changed
+      if (hit.clusterIdx_ != minc) {
+        ++nchanged;
         if (hit.clusterIdx_ != -1) {
-          ++nchanged;
           clusters[hit.clusterIdx_]._flag = BkgClusterFlag::update;
+          if (incremental_) addToSums(sums[hit.clusterIdx_],chit,-1.0f);
+        }
+        if (minc != -1) {
+          clusters[minc]._flag = BkgClusterFlag::update;
+          if (incremental_) addToSums(sums[minc],chit,1.0f);
         }
-        hit.clusterIdx_ = -1;
       }
+      hit.clusterIdx_ = minc;
     }
 
     // -- update cluster and hit distance if needed
-    for (auto& cluster : clusters) {
+    for (size_t ic=0;ic<clusters.size();++ic) {
+      auto& cluster = clusters[ic];
       if (cluster._flag == BkgClusterFlag::update) {
         cluster._flag = BkgClusterFlag::unchanged;
-        updateCluster(cluster, chcol, BkgHits);
+        if (incremental_) updateCentroid(cluster, sums[ic], chcol, BkgHits);
+        else              updateCluster(cluster, chcol, BkgHits);
         if (cluster.hits().size()==1) {BkgHits[cluster.hits().at(0)].distance_ = 0.0f;}
         else {
           for (auto& hit : cluster.hits()) BkgHits[hit].distance_ = distance(cluster,chcol[BkgHits[hit].chidx_]);
@@ -184,6 +204,110 @@ namespace mu2e
   }
 
 
+  //-------------------------------------------------------------------------------------------------------------------
+  // closest cluster in the time buckets around the hit; the first cluster found wins ties
+  int TNTClusterer::findClosest(const ComboHit& chit, const std::vector<BkgCluster>& clusters,
+                                const std::array<std::vector<int>, numBuckets_>& clusterIndices, float& mindist) const
+  {
+    int minc(-1);
+    int ditime(int(maxHitdt_/tbin_));
+    int itime = timeBucket(chit.correctedTime());
+    int imin = std::max(0,itime-ditime);
+    int imax = std::min(numBuckets_,itime+ditime+1);
+
+    for (int i=imin;i<imax;++i) {
+      for (const auto& ic : clusterIndices[i]) {
+        float dist = distance(clusters[ic],chit);
+        if (dist < mindist) {mindist = dist;minc = ic;}
+      }
+    }
+    return minc;
+  }
+
+
+  //-------------------------------------------------------------------------------------------------------------------
+  // counting sort of the clusters by grid cell
+  void TNTClusterer::fillGrid(const std::vector<BkgCluster>& clusters)
+  {
+    size_t ncells = size_t(grid_.nt_)*grid_.nx_*grid_.ny_;
+    grid_.offsets_.assign(ncells+1,0);
+    grid_.head_.assign(ncells,-1);
+    grid_.added_.clear();
+
+    std::vector<ClusterGrid::Entry> entries;
+    std::vector<int> cells;
+    entries.reserve(clusters.size());
+    cells.reserve(clusters.size());
+    for (size_t ic=0;ic<clusters.size();++ic) {
+      const auto& cluster = clusters[ic];
+      entries.push_back({cluster.pos().x(),cluster.pos().y(),cluster.time(),int(ic),timeBucket(cluster.time())});
+      cells.push_back(grid_.cell(entries.back()));
+      ++grid_.offsets_[cells.back()+1];
+    }
+    for (size_t icell=0;icell<ncells;++icell) grid_.offsets_[icell+1] += grid_.offsets_[icell];
+
+    grid_.entries_.resize(entries.size());
+    std::vector<int> next(grid_.offsets_.begin(),grid_.offsets_.end()-1);
+    for (size_t ie=0;ie<entries.size();++ie) grid_.entries_[next[cells[ie]]++] = entries[ie];
+  }
+
+  void TNTClusterer::addToGrid(int ic, const BkgCluster& cluster)
+  {
+    ClusterGrid::Entry entry{cluster.pos().x(),cluster.pos().y(),cluster.time(),ic,timeBucket(cluster.time())};
+    int icell = grid_.cell(entry);
+    entry.next_ = grid_.head_[icell];
+    grid_.head_[icell] = grid_.added_.size();
+    grid_.added_.push_back(entry);
+  }
+
+
+  //-------------------------------------------------------------------------------------------------------------------
+  // closest cluster in the grid cells around the hit, restricted to the same time buckets as the scan above. Clusters
+  // out of the distance range are skipped before calling distance, using the same test. Ties are resolved as in the
+  // scan: earliest time bucket first, then lowest cluster index, so both select the same cluster
+  int TNTClusterer::findClosestGrid(const ComboHit& chit, const std::vector<BkgCluster>& clusters, float& mindist) const
+  {
+    int minc(-1), mint(-1);
+    int ditime(int(maxHitdt_/tbin_));
+    int itime = timeBucket(chit.correctedTime());
+    int imin = std::max(0,itime-ditime);
+    int imax = std::min(numBuckets_,itime+ditime+1);
+    float hx = chit.pos().x();
+    float hy = chit.pos().y();
+    float ht = chit.correctedTime();
+    int ix   = grid_.xCell(hx);
+    int iy   = grid_.yCell(hy);
+    int jxmin(std::max(0,ix-1)), jxmax(std::min(grid_.nx_-1,ix+1));
+    int jymin(std::max(0,iy-1)), jymax(std::min(grid_.ny_-1,iy+1));
+
+    auto test = [&](const ClusterGrid::Entry& entry) {
+      if (entry.bucket_ < imin || entry.bucket_ >= imax) return;
+      float psep_x = hx-entry.x_;
+      float psep_y = hy-entry.y_;
+      if (psep_x*psep_x+psep_y*psep_y > md2_ || std::abs(ht-entry.t_) > maxHitdt_) return;
+      float dist = distance(clusters[entry.ic_],chit);
+      if (dist < mindist || (dist == mindist && (entry.bucket_ < mint || (entry.bucket_ == mint && entry.ic_ < minc)))) {
+        mindist = dist;
+        minc    = entry.ic_;
+        mint    = entry.bucket_;
+      }
+    };
+
+    for (int it=imin/grid_.tcell_;it<=(imax-1)/grid_.tcell_;++it) {
+      for (int jy=jymin;jy<=jymax;++jy) {
+        int cmin = grid_.cell(it,jxmin,jy);
+        int cmax = grid_.cell(it,jxmax,jy);
+        // the x cells of a row are contiguous
+        for (int ie=grid_.offsets_[cmin];ie<grid_.offsets_[cmax+1];++ie) test(grid_.entries_[ie]);
+        for (int icell=cmin;icell<=cmax;++icell) {
+          for (int ia=grid_.head_[icell];ia != -1;ia = grid_.added_[ia].next_) test(grid_.added_[ia]);
+        }
+      }
+    }
+    return minc;
+  }
+
+
   //-----------------------------------------------------------------------------------------------
   void TNTClusterer::mergeClusters(std::vector<BkgCluster>& clusters, const ComboHitCollection& chcol,
                                    std::vector<BkgHit>& BkgHits, float dt, float dd2)
@@ -323,6 +447,33 @@ namespace mu2e
 
 
 
+  //---------------------------------------------------------------------------------------
+  void TNTClusterer::addToSums(CentroidSums& sums, const ComboHit& chit, float sign) const
+  {
+    float weight = sign*chit.nStrawHits();
+    float dp     = chit.phi()-sums.phiref_;
+    if (dp > M_PI)  dp -= 2*M_PI;
+    if (dp < -M_PI) dp += 2*M_PI;
+
+    sums.sumw_ += weight;
+    sums.sumt_ += weight*chit.correctedTime();
+    sums.sumr_ += weight*sqrtf(chit.pos().perp2());
+    sums.sump_ += weight*dp;
+  }
+
+  // weighted mean of the cluster hits, as updateCluster, from the running sums
+  void TNTClusterer::updateCentroid(BkgCluster& cluster, const CentroidSums& sums, const ComboHitCollection& chcol,
+                                    std::vector<BkgHit>& BkgHits)
+  {
+    if (cluster.hits().size() < 2) {updateCluster(cluster, chcol, BkgHits);return;}
+
+    float crho = sums.sumr_/sums.sumw_;
+    float cphi = sums.phiref_ + sums.sump_/sums.sumw_;
+    cluster.time(sums.sumt_/sums.sumw_);
+    cluster.pos(XYZVectorF(crho*cos(cphi),crho*sin(cphi),0.0f));
+  }
+
+
   //-------------------------------------------------------------------------------------------
   void TNTClusterer::dump(const std::vector<BkgCluster>& clusters, const std::vector<BkgHit>& BkgHits)
   {
@@ -10,7 +10,6 @@
 #include "fhiclcpp/types/Sequence.h"
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Core/EDProducer.h"
-#include "art_root_io/TFileService.h"
 // Mu2e
 #include "Offline/GeneralUtilities/inc/Angles.hh"
 #include "Offline/Mu2eUtilities/inc/MVATools.hh"
@@ -23,7 +22,7 @@
 #include "Offline/TrkReco/inc/TrkUtilities.hh"
 #include "Offline/TrkReco/inc/TrkTimeCalculator.hh"
 // root
-#include "TH1F.h"
+#include "Rtypes.h"
 // boost
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/weighted_median.hpp>
@@ -90,9 +89,9 @@ namespace mu2e {
         fhicl::Atom<float>                      minkeepmva             {Name("MinKeepHitMVA"),          Comment("Minimum MVA score to keep in cluster") };
         fhicl::Atom<float>                      minaddmva              {Name("MinAddHitMVA"),           Comment("Minimum MVA score to add in cluster") };
         fhicl::Atom<float>                      maxdPhi                {Name("MaxdPhi"),                Comment("Maximum delta Phi for hit to be in cluster") };
-        fhicl::Atom<float>                      tmin                   {Name("Tmin"),                   Comment("Time histogram start") };
-        fhicl::Atom<float>                      tmax                   {Name("Tmax"),                   Comment("Time histogram end") };
-        fhicl::Atom<float>                      tbin                   {Name("Tbin"),                   Comment("Time histogram bin width") };
+        fhicl::Atom<float>                      tmin                   {Name("Tmin"),                   Comment("Time spectrum start") };
+        fhicl::Atom<float>                      tmax                   {Name("Tmax"),                   Comment("Time spectrum end") };
+        fhicl::Atom<float>                      tbin                   {Name("Tbin"),                   Comment("Time spectrum bin width") };
         fhicl::Atom<float>                      pitch                  {Name("AveragePitch"),           Comment("Average helix pitch (= dz/dflight, =sin(lambda)") };
         fhicl::Atom<float>                      ymin                   {Name("Ymin"),                   Comment("Minimum hit in time histo bin for peak") };
         fhicl::Atom<bool>                       refine                 {Name("RefineClusters"),         Comment("Apply hit refining algorithm") };
@@ -110,7 +109,7 @@ namespace mu2e {
 
 
     private:
-      typedef std::pair<Float_t,int> BinContent;
+      typedef std::pair<Float_t,size_t> BinContent;
       typedef std::vector<StrawHitIndex>::iterator ISH;
 
       int                                             _iev;
@@ -139,13 +138,32 @@ namespace mu2e {
       int                           _npeak;
       int                           _printfreq;
       int                           _debug;
-      TH1F                          _timespec;
+      int                           _nbins;
+      // a bin of the time spectrum, as the run of time-ordered hits which fall in it
+      struct TimeBin {
+        int                         bin;        // bin number, 1 to _nbins
+        size_t                      begin, end; // range of the bin hits in _thits
+        Float_t                     content;    // number of straw hits
+        bool                        used;       // part of a peak window already
+      };
+      std::vector<float>            _chtime;    // comboHitTime of each ComboHit
+      std::vector<std::pair<float,StrawHitIndex>> _thits; // time and index of the selected hits, in time order
+      std::vector<unsigned>         _cumnsh;    // cumulative number of straw hits of _thits
+      std::vector<TimeBin>          _tbins;     // bins which can hold a peak, in time order
+      std::vector<BinContent>       _bcv;       // peak candidates: content and _tbins index
+      std::vector<std::pair<double,size_t>> _seedt0; // time and index of the seeds, in time order
+      std::vector<size_t>           _hitSeed;   // seed assigned to each ComboHit
+      std::vector<bool>             _inCluster; // hits of the cluster being recovered
       TimeCluMVA                    _pmva; // input variables to TMVA for cluster cleaning
 
 
       void findClusters(TimeClusterCollection& tccol);
       void findCaloSeeds(TimeClusterCollection& tccol, art::Handle<CaloClusterCollection> const& ccH);
+      void orderHits();
       void fillTimeSpectrum();
+      size_t firstTimeBin(int bin) const;
+      int  timeBin(double time) const;
+      double binCenter(int bin) const;
       void initCluster(TimeCluster& tc);
       void prefilterCluster(TimeCluster& tc);
       void recoverHits(TimeCluster& tc);
@@ -190,8 +208,7 @@ namespace mu2e {
     _printfreq    ( config().printfreq()),
     _debug        ( config().debugLevel())
     {
-      unsigned nbins = (unsigned)rint((_tmax-_tmin)/_tbin);
-      _timespec = TH1F("timespec","time spectrum",nbins,_tmin,_tmax);
+      _nbins = (unsigned)rint((_tmax-_tmin)/_tbin);
       produces<TimeClusterCollection>();
     }
 
@@ -251,6 +268,7 @@ namespace mu2e {
   //--------------------------------------------------------------------------------------------------------------
   void TimeClusterFinder::findClusters(TimeClusterCollection& tccol) {
     // find seed from hits
+    orderHits();
     fillTimeSpectrum();
     findPeaks(tccol);
     // associate hits to seeds
@@ -272,16 +290,6 @@ namespace mu2e {
         ++itc;
       //std::cout<<"Collection size final"<<tc._strawHitIdxs.size()<<std::endl;
     }
-    // debug test of histogram
-    if (_debug > 2) {
-      art::ServiceHandle<art::TFileService> tfs;
-      TH1F* tspec = tfs->make<TH1F>(_timespec);
-      char name[40];
-      char title[100];
-      snprintf(name,40,"tspec_%i",_iev);
-      snprintf(title,100,"time spectrum event %i;nsec",_iev);
-      tspec->SetNameTitle(name,title);
-    }
   }
 
   void TimeClusterFinder::findCaloSeeds(TimeClusterCollection& tccol, art::Handle<CaloClusterCollection>const& ccH) {
@@ -297,63 +305,136 @@ namespace mu2e {
   }
 
   //--------------------------------------------------------------------------------------------------------------
-  void TimeClusterFinder::fillTimeSpectrum() {
-    _timespec.Reset();
+  // compute the hit times once per event, and order the selected hits in time.  The cumulative number of straw
+  // hits then gives the content of any time window as a difference
+  //--------------------------------------------------------------------------------------------------------------
+  void TimeClusterFinder::orderHits() {
+    _chtime.resize(_chcol->size());
+    _thits.clear();
     for (unsigned istr=0; istr<_chcol->size();++istr) {
-      if (_testflag && !goodHit((*_chcol)[istr].flag())) continue;
       ComboHit const& ch = (*_chcol)[istr];
-      float time = _ttcalc.comboHitTime((*_chcol)[istr],_pitch);
-      _timespec.Fill(time,ch.nStrawHits());
+      _chtime[istr] = _ttcalc.comboHitTime(ch,_pitch);
+      if (_testflag && !goodHit(ch.flag())) continue;
+      _thits.emplace_back(_chtime[istr],istr);
+    }
+    std::sort(_thits.begin(),_thits.end());
+    _cumnsh.resize(_thits.size()+1);
+    _cumnsh[0] = 0;
+    for (size_t ihit=0; ihit<_thits.size(); ++ihit)
+      _cumnsh[ihit+1] = _cumnsh[ihit] + (*_chcol)[_thits[ihit].second].nStrawHits();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------
+  // list the bins of the time spectrum, in one pass over the time-ordered hits.  Empty bins can't pass a positive
+  // Ymin and are skipped; the underflow and overflow hits are in no bin
+  //--------------------------------------------------------------------------------------------------------------
+  void TimeClusterFinder::fillTimeSpectrum() {
+    _tbins.clear();
+    size_t nhits = _thits.size();
+    size_t ihit = 0;
+    while (ihit < nhits && timeBin(_thits[ihit].first) < 1) ++ihit;
+    int ibin = 1;
+    while (ibin <= _nbins) {
+      size_t begin = ihit;
+      while (ihit < nhits && timeBin(_thits[ihit].first) == ibin) ++ihit;
+      Float_t content = _cumnsh[ihit] - _cumnsh[begin];
+      if (content > 0.0 || _ymin <= 0.0) _tbins.push_back(TimeBin{ibin,begin,ihit,content,false});
+      if (_ymin <= 0.0)
+        ++ibin;
+      else if (ihit < nhits)
+        ibin = timeBin(_thits[ihit].first);
+      else
+        break;
     }
   }
 
+  // first entry of _tbins at or after a bin
+  size_t TimeClusterFinder::firstTimeBin(int bin) const {
+    return std::lower_bound(_tbins.begin(),_tbins.end(),bin,
+        [](TimeBin const& tb, int ibin){ return tb.bin < ibin; }) - _tbins.begin();
+  }
+
+  // bin of a time, with the TH1F conventions for fixed bins
+  int TimeClusterFinder::timeBin(double time) const {
+    double tmin(_tmin), tmax(_tmax);
+    if (time < tmin) return 0;
+    if (!(time < tmax)) return _nbins+1;
+    return 1 + int(_nbins*(time-tmin)/(tmax-tmin));
+  }
+
+  // center of a bin, as TH1F computes it
+  double TimeClusterFinder::binCenter(int bin) const {
+    double tmin(_tmin), tmax(_tmax);
+    double binwidth = (tmax-tmin)/double(_nbins);
+    return tmin + (bin-1)*binwidth + 0.5*binwidth;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------
+  // assign each hit to the closest seed in one pass over the time-ordered hits: the seeds within reach of a hit
+  // start at or after those of the previous hit.  The reach is widened by a bin so that rounding can't exclude a seed
+  //--------------------------------------------------------------------------------------------------------------
   void TimeClusterFinder::assignHits(TimeClusterCollection& tccol ) {
-    // assign hits to the closest time peak
-    for(size_t istr=0; istr<_chcol->size(); ++istr) {
-      if ((!_testflag) || goodHit((*_chcol)[istr].flag())) {
-        ComboHit const& ch =(*_chcol)[istr];
-        float time = _ttcalc.comboHitTime(ch,_pitch);
-        float mindt(1e5);
-        auto besttc = tccol.end();
-        // find the closest seed (if any)
-        for (auto itc = tccol.begin(); itc != tccol.end(); ++itc) {
-          float dt = fabs(time - itc->_t0._t0);
-          // make an absolute cut, including error on the cluster t0
-          if (dt < _maxdt+itc->_t0._t0err && dt < mindt){
-            mindt = dt;
-            besttc = itc;
-          }
+    _seedt0.clear();
+    double maxerr(0.0);
+    for (size_t itc=0; itc < tccol.size(); ++itc) {
+      _seedt0.emplace_back(tccol[itc]._t0._t0,itc);
+      maxerr = std::max(maxerr,tccol[itc]._t0._t0err);
+    }
+    std::sort(_seedt0.begin(),_seedt0.end());
+    double reach = _maxdt + maxerr + _tbin;
+    _hitSeed.assign(_chcol->size(),tccol.size());
+    auto iseed0 = _seedt0.begin();
+    for (auto const& thit : _thits) {
+      float time = thit.first;
+      while (iseed0 != _seedt0.end() && iseed0->first < time-reach) ++iseed0;
+      float mindt(1e5);
+      size_t besttc = tccol.size();
+      // find the closest seed (if any); on a tie take the first seed of the collection
+      for (auto iseed = iseed0; iseed != _seedt0.end() && iseed->first <= time+reach; ++iseed) {
+        TimeCluster const& tc = tccol[iseed->second];
+        float dt = fabs(time - tc._t0._t0);
+        // make an absolute cut, including error on the cluster t0
+        if (dt < _maxdt+tc._t0._t0err &&
+            (dt < mindt || (dt == mindt && besttc < tccol.size() && iseed->second < besttc))){
+          mindt = dt;
+          besttc = iseed->second;
         }
-        if(besttc != tccol.end())
-          besttc->_strawHitIdxs.push_back(istr);
       }
+      _hitSeed[thit.second] = besttc;
     }
+    // the clusters list their hits in index order
+    for(size_t istr=0; istr<_chcol->size(); ++istr)
+      if (_hitSeed[istr] != tccol.size()) tccol[_hitSeed[istr]]._strawHitIdxs.push_back(istr);
   }
 
   //--------------------------------------------------------------------------------------------------------------
+  // The number of straw hits in the window around each peak is a difference of the cumulative sums.  The window
+  // time is the mean of its bin centers weighted by the bin contents, summed bin by bin in float as from the TH1F
   void TimeClusterFinder::findPeaks(TimeClusterCollection& tccol) {
-    int nbins = _timespec.GetNbinsX()+1;
-    std::vector<bool> alreadyUsed(nbins,false);
     // blank out bins around input times (from calo clusters)
     for(auto const& tc : tccol ){
-      int ibin = _timespec.FindBin(tc._t0._t0);
-      for(int jbin = std::max(1,ibin-_npeak);jbin < std::min(nbins,ibin+_npeak+1); ++jbin)
-        alreadyUsed[jbin] = true;
+      int ibin = timeBin(tc._t0._t0);
+      int last = std::min(_nbins+1,ibin+_npeak+1);
+      for(size_t kbin = firstTimeBin(std::max(1,ibin-_npeak)); kbin < _tbins.size() && _tbins[kbin].bin < last; ++kbin)
+        _tbins[kbin].used = true;
     }
-    // loop over spectrum to find peaks
-    std::vector<BinContent> bcv;
-    for (int ibin=1;ibin < nbins; ++ibin)
-      if (_timespec.GetBinContent(ibin) >= _ymin) bcv.push_back(make_pair(_timespec.GetBinContent(ibin),ibin));
-    std::sort(bcv.begin(),bcv.end(),[](const BinContent& x, const BinContent& y){return x.first > y.first;});
-
-    for (const auto& bc : bcv) {
-      if (alreadyUsed[bc.second]) continue;
-      float nsh(0.0);
+    // peak candidates, largest first.  The sort only compares contents, and the candidates are in bin order, so
+    // equal contents are ordered as they were for the bins of the TH1F
+    _bcv.clear();
+    for (size_t kbin=0;kbin < _tbins.size(); ++kbin)
+      if (_tbins[kbin].content >= _ymin) _bcv.push_back(make_pair(_tbins[kbin].content,kbin));
+    std::sort(_bcv.begin(),_bcv.end(),[](const BinContent& x, const BinContent& y){return x.first > y.first;});
+
+    for (const auto& bc : _bcv) {
+      TimeBin const& peak = _tbins[bc.second];
+      if (peak.used) continue;
+      size_t first = firstTimeBin(std::max(1,peak.bin-_npeak));
+      size_t last = firstTimeBin(std::min(_nbins+1,peak.bin+_npeak+1));
+      float nsh = _cumnsh[_tbins[last-1].end] - _cumnsh[_tbins[first].begin];
       float t0(0.0);
-      for (int ibin = std::max(1,bc.second-_npeak);ibin < std::min(nbins,bc.second+_npeak+1); ++ibin) {
-        nsh += _timespec.GetBinContent(ibin);
-        t0 += _timespec.GetBinCenter(ibin)*_timespec.GetBinContent(ibin);
-        alreadyUsed[ibin] = true;
+      for (size_t kbin = first;kbin < last; ++kbin) {
+        t0 += binCenter(_tbins[kbin].bin)*_tbins[kbin].content;
+        _tbins[kbin].used = true;
       }
       t0 /= nsh;
       // if the count is enough, create a cluster
@@ -381,7 +462,7 @@ namespace mu2e {
       unsigned nsh = ch.nStrawHits();
       tc._nsh += nsh;
       const XYZVectorF& pos = ch.pos();
-      float htime = _ttcalc.comboHitTime(ch,_pitch);
+      float htime = _chtime[ish];
       float hwt = ch.nStrawHits();
       tmin(htime);
       tmax(htime);
@@ -436,15 +517,18 @@ namespace mu2e {
   }
 
   void TimeClusterFinder::recoverHits(TimeCluster& tc){
+    // flag the hits of the cluster instead of searching the cluster for each hit
+    _inCluster.assign(_chcol->size(),false);
+    for (auto ish : tc._strawHitIdxs) _inCluster[ish] = true;
     bool changed(true);
     while (changed) {
       changed = false;
       float pphi = polyAtan2(tc._pos.y(), tc._pos.x());
       for(size_t ich=0;ich < _chcol->size(); ++ich){
         if ((!_testflag) || goodHit((*_chcol)[ich].flag())) {
-          if(std::find(tc._strawHitIdxs.begin(),tc._strawHitIdxs.end(),ich) == tc._strawHitIdxs.end()){
+          if(!_inCluster[ich]){
             ComboHit const& ch = (*_chcol)[ich];
-            float cht = _ttcalc.comboHitTime(ch,_pitch);
+            float cht = _chtime[ich];
             _pmva._dt = fabs(cht - tc._t0._t0);
             if(_pmva._dt < _maxdt+tc._t0._t0err){
               float phi = polyAtan2(ch.pos().y(), ch.pos().x());//ch.phi();
@@ -464,6 +548,7 @@ namespace mu2e {
                   mvaout = _tcMVA.evalMVA(_pmva._pars);
                 if (mvaout > _minaddmva) {
                   addHit(tc,ich);
+                  _inCluster[ich] = true;
                   changed = true;
                 }
               }
@@ -481,7 +566,7 @@ namespace mu2e {
     if(denom > 0){
       // update time cluster properties
       if(!tc.hasCaloCluster()){
-        float cht = _ttcalc.comboHitTime(ch,_pitch);
+        float cht = _chtime[*iworst];
         float newt0  = (tc._t0._t0*tc._nsh - cht*nsh)/denom;
         double var = tc._t0._t0err*tc._t0._t0err*tc._nsh - (cht-newt0)*(cht-tc._t0._t0)*nsh;
         if(var > 0.0)tc._t0._t0err = sqrt(var/denom);
@@ -499,7 +584,7 @@ namespace mu2e {
     float denom = float(tc._nsh + nsh);
     // update time cluster properties
     if(!tc.hasCaloCluster()){
-      float cht = _ttcalc.comboHitTime(ch,_pitch);
+      float cht = _chtime[iadd];
       float newt0  = (tc._t0._t0*tc._nsh + cht*nsh)/denom;
       tc._t0._t0err = sqrt((tc._t0._t0err*tc._t0._t0err*tc._nsh + (cht-newt0)*(cht-tc._t0._t0)*nsh )/denom);
       tc._t0._t0 = newt0;
@@ -516,7 +601,7 @@ namespace mu2e {
     for(StrawHitIndex ish : tc._strawHitIdxs) {
       ComboHit const& ch = (*_chcol)[ish];
       float hwt = ch.nStrawHits();
-      float cht = _ttcalc.comboHitTime(ch,_pitch);
+      float cht = _chtime[ish];
       terr(cht,weight=hwt);
       xacc(ch.pos().x(),weight=hwt);
       yacc(ch.pos().y(),weight=hwt);
@@ -547,7 +632,7 @@ namespace mu2e {
       float pphi = polyAtan2(tc._pos.y(), tc._pos.x());
       for (auto ips=tc._strawHitIdxs.begin();ips != tc._strawHitIdxs.end();++ips) {
         ComboHit const& ch = (*_chcol)[*ips];
-        float cht = _ttcalc.comboHitTime(ch,_pitch);
+        float cht = _chtime[*ips];
 
         _pmva._dt = fabs(cht - tc._t0._t0);
         float phi = polyAtan2(ch.pos().y(), ch.pos().x());//ch.phi();